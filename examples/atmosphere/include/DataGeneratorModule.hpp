@@ -73,9 +73,6 @@ class DataGenerator {
 	float m_lastMouseY;
 	bool m_lastMouseValid = false;
 
-	VertexData* m_pointBuffer;
-	uint32_t* m_indexBuffer;
-
 	vanadium::graphics::BufferResourceHandle m_vertexBufferHandle;
 	vanadium::graphics::BufferResourceHandle m_indexBufferHandle;
 	vanadium::graphics::ImageResourceHandle m_texHandle;
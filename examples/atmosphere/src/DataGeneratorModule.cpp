@@ -88,11 +88,30 @@ DataGenerator::DataGenerator(vanadium::graphics::GraphicsSubsystem& subsystem,
 									.listenerDestroyCallback = vanadium::windowing::emptyListenerDestroyCallback,
 									.userData = this });
 
-	m_pointBuffer = new VertexData[totalPointCount];
-	m_indexBuffer = new uint32_t[totalIndexCount];
+	VkBufferCreateInfo bufferCreateInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+											.size = sizeof(VertexData) * totalPointCount,
+											.usage =
+												VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+											.sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+	m_vertexBufferHandle =
+		subsystem.context().resourceAllocator->createBuffer(bufferCreateInfo, {}, { .deviceLocal = true }, false);
+	bufferCreateInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+						 .size = sizeof(uint32_t) * totalIndexCount,
+						 .usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+						 .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+	m_indexBufferHandle =
+		subsystem.context().resourceAllocator->createBuffer(bufferCreateInfo, {}, { .deviceLocal = true }, false);
+
+	// the sphere is generated straight into upload memory instead of being copied there afterwards
+	vanadium::graphics::GPUUpload pointUpload = subsystem.context().transferManager->beginUpload(
+		sizeof(VertexData) * totalPointCount, m_vertexBufferHandle);
+	vanadium::graphics::GPUUpload indexUpload =
+		subsystem.context().transferManager->beginUpload(sizeof(uint32_t) * totalIndexCount, m_indexBufferHandle);
+	VertexData* pointBuffer = static_cast<VertexData*>(pointUpload.data);
+	uint32_t* indexBuffer = static_cast<uint32_t*>(indexUpload.data);
 
-	m_pointBuffer[0].pos = glm::vec3(0.0f, 1.0f, 0.0f); // singularity point on top of sphere
-	m_pointBuffer[0].texCoord = glm::vec2(0.5f, 0.0f);
+	pointBuffer[0].pos = glm::vec3(0.0f, 1.0f, 0.0f); // singularity point on top of sphere
+	pointBuffer[0].texCoord = glm::vec2(0.5f, 0.0f);
 
 	float theta = .0f;
 	float dTheta = 1.0f * std::numbers::pi_v<float> / static_cast<float>(pointsPerLatitudeSegment);
@@ -112,25 +131,25 @@ DataGenerator::DataGenerator(vanadium::graphics::GraphicsSubsystem& subsystem,
 			float sinPhi = sinf(phi);
 			float cosPhi = cosf(phi);
 
-			m_pointBuffer[index].pos = glm::vec3(cosPhi * sinTheta, cosTheta, -sinPhi * sinTheta);
+			pointBuffer[index].pos = glm::vec3(cosPhi * sinTheta, cosTheta, -sinPhi * sinTheta);
 
-			m_pointBuffer[index].texCoord.x = 1.0f - phi / (2.0f * std::numbers::pi_v<float>);
-			m_pointBuffer[index].texCoord.y = -theta / std::numbers::pi_v<float>;
+			pointBuffer[index].texCoord.x = 1.0f - phi / (2.0f * std::numbers::pi_v<float>);
+			pointBuffer[index].texCoord.y = -theta / std::numbers::pi_v<float>;
 			phi += dPhi;
 		}
 	}
 
-	m_pointBuffer[totalPointCount - 1].pos = glm::vec3(0.0f, -1.0f, 0.0f);
-	m_pointBuffer[totalPointCount - 1].texCoord = glm::vec2(0.5f, 1.0f);
+	pointBuffer[totalPointCount - 1].pos = glm::vec3(0.0f, -1.0f, 0.0f);
+	pointBuffer[totalPointCount - 1].texCoord = glm::vec2(0.5f, 1.0f);
 
 	for (size_t i = 0; i < individualPointsPerLongitudeSegment; ++i) {
 		uint32_t firstTriangleIndex = i;
 		if (firstTriangleIndex == 0)
 			firstTriangleIndex = individualPointsPerLongitudeSegment;
 
-		m_indexBuffer[i * 3] = firstTriangleIndex;
-		m_indexBuffer[i * 3 + 1] = 0;
-		m_indexBuffer[i * 3 + 2] = i + 1;
+		indexBuffer[i * 3] = firstTriangleIndex;
+		indexBuffer[i * 3 + 1] = 0;
+		indexBuffer[i * 3 + 2] = i + 1;
 	}
 
 	uint32_t indexOffset = 1;
@@ -147,12 +166,12 @@ DataGenerator::DataGenerator(vanadium::graphics::GraphicsSubsystem& subsystem,
 				nextLatitudeThirdPointIndex = nextIndexOffset;
 			}
 
-			m_indexBuffer[indexBufferOffset + j * 6] = nextIndexOffset + j;
-			m_indexBuffer[indexBufferOffset + j * 6 + 1] = indexOffset + j;
-			m_indexBuffer[indexBufferOffset + j * 6 + 2] = nextLatitudeThirdPointIndex;
-			m_indexBuffer[indexBufferOffset + j * 6 + 3] = nextLatitudeThirdPointIndex;
-			m_indexBuffer[indexBufferOffset + j * 6 + 4] = indexOffset + j;
-			m_indexBuffer[indexBufferOffset + j * 6 + 5] = thirdPointIndex;
+			indexBuffer[indexBufferOffset + j * 6] = nextIndexOffset + j;
+			indexBuffer[indexBufferOffset + j * 6 + 1] = indexOffset + j;
+			indexBuffer[indexBufferOffset + j * 6 + 2] = nextLatitudeThirdPointIndex;
+			indexBuffer[indexBufferOffset + j * 6 + 3] = nextLatitudeThirdPointIndex;
+			indexBuffer[indexBufferOffset + j * 6 + 4] = indexOffset + j;
+			indexBuffer[indexBufferOffset + j * 6 + 5] = thirdPointIndex;
 		}
 
 		indexOffset += individualPointsPerLongitudeSegment;
@@ -164,31 +183,16 @@ DataGenerator::DataGenerator(vanadium::graphics::GraphicsSubsystem& subsystem,
 		if (secondTriangleIndex == individualPointsPerLongitudeSegment)
 			secondTriangleIndex = totalPointCount - 1;
 
-		m_indexBuffer[indexBufferOffset + i * 3] = indexOffset + i;
-		m_indexBuffer[indexBufferOffset + i * 3 + 1] = secondTriangleIndex;
-		m_indexBuffer[indexBufferOffset + i * 3 + 2] = totalPointCount - 1;
+		indexBuffer[indexBufferOffset + i * 3] = indexOffset + i;
+		indexBuffer[indexBufferOffset + i * 3 + 1] = secondTriangleIndex;
+		indexBuffer[indexBufferOffset + i * 3 + 2] = totalPointCount - 1;
 	}
 
-	VkBufferCreateInfo bufferCreateInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-											.size = sizeof(VertexData) * totalPointCount,
-											.usage =
-												VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-											.sharingMode = VK_SHARING_MODE_EXCLUSIVE };
-	m_vertexBufferHandle =
-		subsystem.context().resourceAllocator->createBuffer(bufferCreateInfo, {}, { .deviceLocal = true }, false);
-
-	subsystem.context().transferManager->submitOneTimeTransfer(
-		sizeof(VertexData) * totalPointCount, m_vertexBufferHandle, m_pointBuffer, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
-		VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
-	bufferCreateInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-						 .size = sizeof(uint32_t) * totalIndexCount,
-						 .usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-						 .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
-	m_indexBufferHandle =
-		subsystem.context().resourceAllocator->createBuffer(bufferCreateInfo, {}, { .deviceLocal = true }, false);
-
-	subsystem.context().transferManager->submitOneTimeTransfer(sizeof(uint32_t) * totalIndexCount, m_indexBufferHandle,
-															   m_indexBuffer, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+	subsystem.context().transferManager->commitOneTimeTransfer(pointUpload.handle, m_vertexBufferHandle,
+															   VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+															   VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+	subsystem.context().transferManager->commitOneTimeTransfer(indexUpload.handle, m_indexBufferHandle,
+															   VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
 															   VK_ACCESS_INDEX_READ_BIT);
 
 	m_sceneDataTransfer = subsystem.context().transferManager->createTransfer(
@@ -313,7 +317,4 @@ void DataGenerator::update(vanadium::graphics::GraphicsSubsystem& subsystem,
 	subsystem.context().transferManager->updateTransferData(m_sceneDataTransfer, subsystem.frameIndex(), &sceneData);
 }
 
-void DataGenerator::destroy(vanadium::graphics::GraphicsSubsystem& subsystem) {
-	delete[] m_pointBuffer;
-	delete[] m_indexBuffer;
-}
+void DataGenerator::destroy(vanadium::graphics::GraphicsSubsystem& subsystem) {}
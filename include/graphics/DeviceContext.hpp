@@ -27,11 +27,29 @@ namespace vanadium::graphics {
 	struct DeviceCapabilities {
 		bool memoryBudget;
 		bool memoryPriority;
+		// VK_KHR_dedicated_allocation together with VK_KHR_get_memory_requirements2
+		bool dedicatedAllocation;
+		bool timelineSemaphore;
+	};
+
+	// Handles created outside of DeviceContext, e.g. by a mock device in tests. The volk function pointers need to
+	// be loaded already.
+	struct ExternalDeviceInfo {
+		VkInstance instance;
+		VkPhysicalDevice physicalDevice;
+		VkDevice device;
+		uint32_t graphicsQueueFamilyIndex;
+		VkQueue graphicsQueue;
+		uint32_t asyncTransferQueueFamilyIndex;
+		VkQueue asyncTransferQueue;
+		DeviceCapabilities capabilities;
 	};
 
 	class DeviceContext {
 	  public:
 		DeviceContext(const std::string_view& appName, uint32_t appVersion, WindowSurface& windowSurface);
+		// Only creates the frame completion fences, destroy() leaves the device and instance alive.
+		DeviceContext(const ExternalDeviceInfo& info);
 		DeviceContext(const DeviceContext&) = delete;
 		DeviceContext(DeviceContext&&) = delete;
 
@@ -53,6 +71,8 @@ namespace vanadium::graphics {
 		void destroy();
 
 	  private:
+		void createFrameCompletionFences();
+
 		VkInstance m_instance;
 		VkPhysicalDevice m_physicalDevice;
 		VkPhysicalDeviceProperties m_properties;
@@ -64,9 +84,10 @@ namespace vanadium::graphics {
 		uint32_t m_asyncTransferQueueFamilyIndex;
 		VkQueue m_asyncTransferQueue;
 
-		VkDebugUtilsMessengerEXT m_debugMessenger;
+		VkDebugUtilsMessengerEXT m_debugMessenger = VK_NULL_HANDLE;
+		bool m_ownsDevice = true;
 
-		DeviceCapabilities m_capabilities;
+		DeviceCapabilities m_capabilities = {};
 
 		std::vector<VkFence> m_frameCompletionFences;
 	};
@@ -49,6 +49,7 @@ namespace vanadium::graphics {
 		GPUResourceAllocator m_resourceAllocator;
 		GPUDescriptorSetAllocator m_descriptorSetAllocator;
 		GPUTransferManager m_transferManager;
+		FrameRingAllocator m_frameRingAllocator;
 		RenderTargetSurface m_renderTargetSurface;
 		PipelineLibrary m_pipelineLibrary;
 		FramegraphContext m_framegraphContext;
@@ -18,6 +18,7 @@
 
 #include <graphics/DeviceContext.hpp>
 #include <graphics/RenderTargetSurface.hpp>
+#include <graphics/util/FrameRingAllocator.hpp>
 #include <graphics/util/GPUDescriptorSetAllocator.hpp>
 #include <graphics/util/GPUResourceAllocator.hpp>
 #include <graphics/util/GPUTransferManager.hpp>
@@ -31,6 +32,7 @@ namespace vanadium::graphics
 		GPUResourceAllocator* resourceAllocator;
 		GPUDescriptorSetAllocator* descriptorSetAllocator;
 		GPUTransferManager* transferManager;
+		FrameRingAllocator* frameRingAllocator;
 		PipelineLibrary* pipelineLibrary;
 		RenderTargetSurface* targetSurface;
     };
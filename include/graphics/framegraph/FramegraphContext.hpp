@@ -79,6 +79,8 @@ namespace vanadium::graphics {
 		FramegraphNode* node;
 
 		robin_hood::unordered_map<FramegraphImageHandle, std::vector<ImageResourceViewInfo>> resourceViewInfos;
+		// declared whenever the image is (re)created, index-matched with resourceViewInfos
+		robin_hood::unordered_map<FramegraphImageHandle, std::vector<ImageViewHandle>> resourceViewHandles;
 		std::vector<ImageResourceViewInfo> swapchainResourceViewInfos;
 	};
 
@@ -159,6 +161,7 @@ namespace vanadium::graphics {
 	  private:
 		void createBuffer(FramegraphBufferHandle handle);
 		void createImage(FramegraphImageHandle handle);
+		void declareImageViews(FramegraphImageHandle handle);
 
 		// initResources handles initialization when usage etc. is known
 		void initResources();
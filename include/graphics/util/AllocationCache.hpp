@@ -0,0 +1,119 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#define VK_NO_PROTOTYPES
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <mutex>
+#include <optional>
+#include <robin_hood.h>
+#include <thread>
+#include <util/MemoryLiterals.hpp>
+#include <vector>
+
+namespace vanadium::graphics {
+
+	// Caches small ranges carved out of memory blocks ahead of time, so threads can allocate and free small resources
+	// without locking the blocks. Ranges are carved in power-of-two size classes and grouped into buckets chosen by
+	// the owner, e.g. per memory type. The cache is split into shards selected by hashing the thread id, so threads
+	// practically never wait for each other.
+	template <typename Range> class AllocationCache {
+	  public:
+		static constexpr uint32_t sizeClassCount = 9;
+		static constexpr VkDeviceSize minCachedSize = 256;
+		static constexpr VkDeviceSize maxCachedSize = minCachedSize << (sizeClassCount - 1);
+
+		// Returns ~0U if the allocation is too big to be cached. Cached ranges are aligned to their size.
+		static uint32_t sizeClass(VkDeviceSize size, VkDeviceSize alignment) {
+			VkDeviceSize classSize = std::bit_ceil(std::max({ size, alignment, minCachedSize }));
+			if (classSize > maxCachedSize)
+				return ~0U;
+			return static_cast<uint32_t>(std::countr_zero(classSize / minCachedSize));
+		}
+		static VkDeviceSize sizeClassSize(uint32_t sizeClass) { return minCachedSize << sizeClass; }
+		// how many ranges to carve at once when a shard runs out
+		static size_t refillCount(uint32_t sizeClass) {
+			return std::clamp(static_cast<size_t>(64_KiB / sizeClassSize(sizeClass)), size_t(1), size_t(32));
+		}
+
+		std::optional<Range> pop(uint64_t bucket) {
+			Shard& shard = currentShard();
+			auto lock = std::lock_guard<std::mutex>(shard.mutex);
+			auto iterator = shard.ranges.find(bucket);
+			if (iterator == shard.ranges.end() || iterator->second.empty())
+				return std::nullopt;
+			Range range = iterator->second.back();
+			iterator->second.pop_back();
+			return range;
+		}
+
+		// Returns false if the shard holds enough ranges of the bucket already, the range has to be freed then.
+		bool push(uint64_t bucket, uint32_t sizeClass, const Range& range) {
+			Shard& shard = currentShard();
+			auto lock = std::lock_guard<std::mutex>(shard.mutex);
+			auto& ranges = shard.ranges[bucket];
+			if (ranges.size() >= 4 * refillCount(sizeClass))
+				return false;
+			ranges.push_back(range);
+			return true;
+		}
+
+		// Adds freshly carved ranges, regardless of how many are cached already.
+		void refill(uint64_t bucket, const std::vector<Range>& ranges) {
+			Shard& shard = currentShard();
+			auto lock = std::lock_guard<std::mutex>(shard.mutex);
+			auto& cachedRanges = shard.ranges[bucket];
+			cachedRanges.insert(cachedRanges.end(), ranges.begin(), ranges.end());
+		}
+
+		// Removes the cached ranges of all shards that predicate(bucket, range) returns true for and passes them to
+		// callback(bucket, range), which should free them.
+		template <typename Predicate, typename Callback> void drain(Predicate predicate, Callback callback) {
+			for (auto& shard : m_shards) {
+				auto lock = std::lock_guard<std::mutex>(shard.mutex);
+				for (auto& bucketRanges : shard.ranges) {
+					auto& ranges = bucketRanges.second;
+					auto removedBegin = std::partition(ranges.begin(), ranges.end(), [&](const Range& range) {
+						return !predicate(bucketRanges.first, range);
+					});
+					for (auto iterator = removedBegin; iterator != ranges.end(); ++iterator) {
+						callback(bucketRanges.first, *iterator);
+					}
+					ranges.erase(removedBegin, ranges.end());
+				}
+			}
+		}
+
+	  private:
+		static constexpr size_t m_shardCount = 16;
+
+		struct alignas(64) Shard {
+			std::mutex mutex;
+			robin_hood::unordered_map<uint64_t, std::vector<Range>> ranges;
+		};
+
+		Shard& currentShard() {
+			return m_shards[std::hash<std::thread::id>()(std::this_thread::get_id()) % m_shardCount];
+		}
+
+		std::array<Shard, m_shardCount> m_shards;
+	};
+
+} // namespace vanadium::graphics
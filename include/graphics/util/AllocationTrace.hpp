@@ -0,0 +1,115 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace vanadium::graphics {
+
+	constexpr uint32_t allocationTraceMagicNumber = 0x52544156; // "VATR"
+	constexpr uint32_t allocationTraceVersion = 1;
+
+	constexpr uint8_t allocationTraceCustomTypeIndex = 0xFF;
+
+	enum class AllocationTraceEventType : uint8_t {
+		CreateBuffer,
+		CreatePerFrameBuffer,
+		CreateImage,
+		// deferred until the next flush of the same frame-in-flight slot
+		DestroyBuffer,
+		DestroyBufferImmediately,
+		// deferred until the next flush of the same frame-in-flight slot
+		DestroyImage,
+		DestroyImageImmediately,
+		AllocateBlock,
+		FreeBlock,
+		FlushFreeList
+	};
+
+	enum AllocationTraceFlagBits : uint8_t {
+		AllocationTraceFlagImage = 1,
+		AllocationTraceFlagCustomBlock = 2,
+		AllocationTraceFlagMapped = 4,
+		// the resource has its own VkDeviceMemory and doesn't occupy any block
+		AllocationTraceFlagDedicated = 8
+	};
+
+	struct AllocationTraceEvent {
+		AllocationTraceEventType type;
+		uint8_t flags;
+		uint8_t memoryTypeIndex;
+		uint8_t frameInFlightIndex;
+		uint32_t frameIndex;
+		// resource or block handle, depending on the event type
+		uint64_t handle;
+		uint64_t size;
+		uint64_t alignment;
+		// nanoseconds since recording started
+		uint64_t timestamp;
+	};
+	static_assert(sizeof(AllocationTraceEvent) == 40);
+
+	struct AllocationTraceMemoryType {
+		uint32_t properties;
+		uint32_t heapIndex;
+	};
+
+	// File layout: header, memoryTypeCount AllocationTraceMemoryTypes, heapCount uint64_t heap budgets, then events
+	// until the end of the file.
+	struct AllocationTraceHeader {
+		uint32_t magic = allocationTraceMagicNumber;
+		uint32_t version = allocationTraceVersion;
+		uint64_t blockSize;
+		uint64_t bufferBlockFreeThreshold;
+		uint64_t imageBlockFreeThreshold;
+		uint64_t bufferImageGranularity;
+		uint32_t memoryTypeCount;
+		uint32_t heapCount;
+	};
+
+	struct AllocationTrace {
+		AllocationTraceHeader header;
+		std::vector<AllocationTraceMemoryType> memoryTypes;
+		std::vector<uint64_t> heapBudgets;
+		std::vector<AllocationTraceEvent> events;
+	};
+
+	class AllocationTraceRecorder {
+	  public:
+		bool start(const std::string_view& fileName, AllocationTraceHeader header,
+				   const std::vector<AllocationTraceMemoryType>& memoryTypes, const std::vector<uint64_t>& heapBudgets);
+		void stop();
+
+		bool isRecording() const { return m_recording; }
+
+		// fills in the timestamp
+		void record(AllocationTraceEvent event);
+
+	  private:
+		bool m_recording = false;
+		std::ofstream m_stream;
+		std::chrono::steady_clock::time_point m_startTime;
+	};
+
+	std::optional<AllocationTrace> readAllocationTrace(const std::string_view& fileName);
+
+} // namespace vanadium::graphics
@@ -0,0 +1,100 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#define VK_NO_PROTOTYPES
+#include <vulkan/vulkan.h>
+#include <array>
+#include <bit>
+#include <string>
+#include <vector>
+
+namespace vanadium::graphics {
+
+	// Allocations are bucketed by powers of two, starting with everything below 2 KiB and ending with everything
+	// above 32 MiB.
+	constexpr size_t allocationSizeClassCount = 16;
+	constexpr uint32_t allocationSizeClassMinLog2 = 11;
+
+	inline size_t allocationSizeClass(VkDeviceSize size) {
+		if (size < (1ULL << allocationSizeClassMinLog2))
+			return 0;
+		size_t sizeClass = std::bit_width(size) - allocationSizeClassMinLog2;
+		return sizeClass < allocationSizeClassCount ? sizeClass : allocationSizeClassCount - 1;
+	}
+
+	using AllocationSizeClassCounts = std::array<uint32_t, allocationSizeClassCount>;
+
+	struct MemoryBlockStatistics {
+		uint32_t typeIndex;
+		bool isImageBlock;
+		bool isCustomBlock;
+		// memory owned by a single resource
+		bool isDedicatedBlock;
+
+		VkDeviceSize size;
+		VkDeviceSize usedSize;
+		VkDeviceSize largestFreeRange;
+		size_t freeRangeCount;
+		size_t allocationCount;
+		AllocationSizeClassCounts allocationSizeClassCounts;
+	};
+
+	struct MemoryStatistics {
+		size_t blockCount = 0;
+		VkDeviceSize blockSize = 0;
+		VkDeviceSize usedSize = 0;
+		VkDeviceSize largestFreeRange = 0;
+		size_t freeRangeCount = 0;
+		size_t allocationCount = 0;
+		AllocationSizeClassCounts allocationSizeClassCounts = {};
+	};
+
+	struct MemoryTypeStatistics {
+		VkMemoryPropertyFlags properties;
+		uint32_t heapIndex;
+		MemoryStatistics total;
+	};
+
+	struct MemoryHeapStatistics {
+		VkDeviceSize size;
+		// Budget and usage as reported by VK_EXT_memory_budget at the last updateMemoryBudget call. Without the
+		// extension, the budget is the heap size and the usage is the size of all blocks in this heap.
+		VkDeviceSize budget;
+		VkDeviceSize usage;
+		// What the allocator assumes it can still allocate from this heap.
+		VkDeviceSize remainingBudget;
+		MemoryStatistics total;
+	};
+
+	struct AllocatorStatistics {
+		std::vector<MemoryTypeStatistics> memoryTypes;
+		std::vector<MemoryHeapStatistics> heaps;
+		MemoryStatistics customBlocks;
+		// only filled when requested, one entry per block including custom blocks
+		std::vector<MemoryBlockStatistics> blocks;
+
+		size_t bufferCount;
+		size_t imageCount;
+	};
+
+	void accumulateStatistics(MemoryStatistics& statistics, const MemoryBlockStatistics& blockStatistics);
+
+	// VMA-style JSON dump, suitable for logging every few frames and graphing offline.
+	std::string serializeAllocatorStatistics(const AllocatorStatistics& statistics);
+
+} // namespace vanadium::graphics
@@ -0,0 +1,67 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#define VK_NO_PROTOTYPES
+#include <vulkan/vulkan.h>
+#include <util/MemoryLiterals.hpp>
+
+namespace vanadium::graphics {
+
+	struct BlockSizePolicy {
+		VkDeviceSize initialBlockSize = 4_MiB;
+		// every new block is this much bigger than the previous one until the cap is reached
+		float growthFactor = 2.0f;
+		// Blocks are capped at the smaller of maxBlockSize and maxHeapFraction * heap size, but never below
+		// initialBlockSize. Allocations bigger than the cap get a block of their own size.
+		VkDeviceSize maxBlockSize = 128_MiB;
+		float maxHeapFraction = 1.0f / 32.0f;
+
+		// Allocation pressure is the total size of recently allocated blocks, it decays by pressureDecay every
+		// frame. Empty blocks are kept while their total size stays below minRetainedSize or
+		// pressureRetention * pressure, so a type that keeps needing new blocks doesn't free and reallocate them.
+		float pressureDecay = 0.99f;
+		float pressureRetention = 1.0f;
+		VkDeviceSize minRetainedSize = 4_MiB;
+	};
+
+	// Applies a BlockSizePolicy to one memory type.
+	class BlockSizer {
+	  public:
+		BlockSizer() {}
+		BlockSizer(const BlockSizePolicy& policy, VkDeviceSize heapSize);
+
+		// Size of a new block that fits at least minSize bytes. Grows the blocks allocated after it.
+		VkDeviceSize nextBlockSize(VkDeviceSize minSize);
+		// call once per frame, before releasing empty blocks
+		void decayPressure();
+		// retainedSize is the total size of the empty blocks kept so far. Releasing a block for lack of pressure
+		// shrinks the blocks allocated after it again.
+		bool shouldReleaseEmptyBlock(VkDeviceSize blockSize, VkDeviceSize retainedSize);
+
+		const BlockSizePolicy& policy() const { return m_policy; }
+		VkDeviceSize maxBlockSize() const { return m_maxBlockSize; }
+		VkDeviceSize currentBlockSize() const { return m_currentBlockSize; }
+		double pressure() const { return m_pressure; }
+
+	  private:
+		BlockSizePolicy m_policy;
+		VkDeviceSize m_maxBlockSize = 0;
+		VkDeviceSize m_currentBlockSize = 0;
+		double m_pressure = 0.0;
+	};
+} // namespace vanadium::graphics
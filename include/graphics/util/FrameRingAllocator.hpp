@@ -0,0 +1,76 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <graphics/DeviceContext.hpp>
+#include <graphics/util/GPUResourceAllocator.hpp>
+#include <optional>
+#include <util/MemoryLiterals.hpp>
+
+namespace vanadium::graphics {
+
+	struct FrameRingAllocation {
+		void* data;
+		VkBuffer buffer;
+		// offset into buffer, usable as a dynamic offset or vertex buffer offset
+		VkDeviceSize offset;
+	};
+
+	// Hands out transient per-frame memory from one persistently mapped buffer that is split into one region per
+	// frame in flight. Allocating only bumps an offset, nothing has to be freed: a frame's region is reset once the
+	// frame's completion fence has signaled.
+	class FrameRingAllocator {
+	  public:
+		FrameRingAllocator() {}
+		FrameRingAllocator(const FrameRingAllocator&) = delete;
+		FrameRingAllocator& operator=(const FrameRingAllocator&) = delete;
+
+		void create(DeviceContext* context, GPUResourceAllocator* allocator, VkDeviceSize regionSize = 4_MiB);
+
+		// Threadsafe. Returns std::nullopt if the current frame's region is exhausted.
+		std::optional<FrameRingAllocation> allocate(VkDeviceSize size, VkDeviceSize alignment);
+
+		// Switches to the region of frameIndex. It is reset if the frame's completion fence has signaled, so call
+		// this after waiting for the fence and before resetting it. Must not run concurrently with allocate.
+		void setFrameIndex(uint32_t frameIndex);
+		// Makes this frame's writes visible to the device if the memory isn't host coherent. Call before submitting.
+		void flush();
+
+		VkDeviceSize regionSize() const { return m_regionSize; }
+		VkDeviceSize usedSize() const { return m_regionOffset.load(std::memory_order_relaxed); }
+
+		void destroy();
+
+	  private:
+		DeviceContext* m_context;
+		GPUResourceAllocator* m_resourceAllocator;
+
+		BufferResourceHandle m_buffer = ~0U;
+		VkBuffer m_nativeBuffer = VK_NULL_HANDLE;
+		unsigned char* m_mappedData = nullptr;
+		bool m_isCoherent = true;
+
+		VkDeviceSize m_regionSize = 0;
+		uint32_t m_frameIndex = 0;
+		std::atomic<VkDeviceSize> m_regionOffset = 0;
+		// used sizes of the other regions, restored if their frame is still in flight when switching back
+		std::array<VkDeviceSize, frameInFlightCount> m_regionUsedSizes = {};
+	};
+
+} // namespace vanadium::graphics
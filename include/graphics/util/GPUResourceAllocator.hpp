@@ -17,9 +17,17 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <mutex>
 #include <Slotmap.hpp>
 #include <graphics/DeviceContext.hpp>
+#include <graphics/util/AllocationCache.hpp>
+#include <graphics/util/AllocationTrace.hpp>
+#include <graphics/util/AllocatorStatistics.hpp>
+#include <graphics/util/BlockSizePolicy.hpp>
+#include <graphics/util/ImageViewTable.hpp>
 #include <graphics/util/RangeAllocator.hpp>
+#include <graphics/util/SlabAllocator.hpp>
 #include <shared_mutex>
 #include <util/MemoryLiterals.hpp>
 
@@ -29,41 +37,125 @@ namespace vanadium::graphics {
 		bool deviceLocal;
 		bool hostVisible;
 		bool hostCoherent;
+		bool hostCached;
 	};
 
+	// Decides which memory the driver demotes to system memory first when VRAM runs out (VK_EXT_memory_priority).
+	// Render targets and per-frame data should be High, streamed assets Low. Blocks only contain allocations of a
+	// single priority.
+	enum class MemoryPriority : uint8_t { Low, Default, High };
+
+	// Usage of the VkBuffers spanning whole blocks that suballocated buffers are handed out from.
+	constexpr VkBufferUsageFlags suballocatedBufferUsage =
+		VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT |
+		VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+		VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+
 	struct MemoryBlock {
-		std::vector<MemoryRange> freeBlocksSizeSorted;
-		std::vector<MemoryRange> freeBlocksOffsetSorted;
+		RangeAllocator allocator;
 
 		MemoryCapabilities capabilities;
+		uint32_t typeIndex;
+		MemoryPriority priority;
 
 		VkDeviceSize maxAllocatableSize;
 		VkDeviceSize originalSize;
 
 		VkDeviceMemory memoryHandle;
 		void* mappedPointer;
+		// bound to the whole block, created on the first suballocation from it
+		VkBuffer blockBuffer = VK_NULL_HANDLE;
+
+		AllocationSizeClassCounts allocationSizeClassCounts = {};
 	};
 
 	using BlockHandle = SlotmapHandle;
 
+	struct AllocationResult {
+		MemoryRange allocationRange;
+		MemoryRange usableRange;
+		BlockHandle blockHandle;
+
+		VkDeviceMemory memoryHandle;
+		MemoryCapabilities capabilities;
+		void* mappedPointer;
+		VkBuffer blockBuffer;
+		uint64_t cacheBucket = ~0ULL;
+		uint32_t slabIndex = ~0U;
+	};
+
+	// Slots of one allocation cache bucket, carved out of ranges of the type's blocks.
+	struct SlabPool {
+		SlabAllocator allocator;
+		// block, memory and range of every slab, indexed like the slabs of the allocator
+		std::vector<AllocationResult> slabRanges;
+	};
+
 	struct MemoryType {
 		VkMemoryPropertyFlags properties;
 		uint32_t heapIndex;
 
+		// sizes the shared buffer and image blocks, guarded by the type mutex
+		BlockSizer blockSizer;
+
+		// also holds images if mixed blocks are enabled
 		Slotmap<MemoryBlock> blocks;
 		Slotmap<MemoryBlock> imageBlocks;
+
+		// each block holds exactly one resource and is freed together with it
+		Slotmap<MemoryBlock> dedicatedBlocks;
+		Slotmap<MemoryBlock> dedicatedImageBlocks;
+
+		// keyed by allocation cache bucket, guarded by the type mutex
+		robin_hood::unordered_map<uint64_t, SlabPool> slabPools;
 	};
 
+	using BufferResourceHandle = SlotmapHandle;
+	using ImageResourceHandle = SlotmapHandle;
+
+	using BufferMoveCallback = void (*)(BufferResourceHandle handle, void* userData);
+	// bytesOverBudget is how much memory should be freed from the heap to get back within budget
+	using OverBudgetCallback = void (*)(uint32_t heapIndex, VkDeviceSize bytesOverBudget, void* userData);
+	using ImageMoveCallback = void (*)(ImageResourceHandle handle, void* userData);
+
 	struct BufferAllocation {
 		bool isMultipleBuffered = false;
+		bool isDedicated = false;
+		// buffers are the block's VkBuffer, the resource starts at bufferOffsets
+		bool isSuballocated = false;
 
 		uint32_t typeIndex;
 		BlockHandle blockHandle;
 		MemoryRange bufferContentRange;
 		MemoryRange allocationRange;
 
+		// copied from the block so lookups don't need to lock it
+		MemoryCapabilities capabilities;
+		VkDeviceMemory memoryHandle;
+		void* blockMappedPointer;
+		// ~0 if the range wasn't taken from the allocation cache
+		uint64_t cacheBucket = ~0ULL;
+		// ~0 if the range isn't a slab slot
+		uint32_t slabIndex = ~0U;
+		// set on the old allocation of a moved buffer, its range goes back to its block or slab instead of the cache
+		bool bypassesAllocationCache = false;
+
 		VkBuffer buffers[frameInFlightCount];
+		VkDeviceSize bufferOffsets[frameInFlightCount];
 		void* mappedData[frameInFlightCount];
+
+		// kept for recreating the buffer when it is moved
+		VkBufferCreateInfo createInfo;
+		bool isMovable = false;
+		BufferMoveCallback moveCallback;
+		void* moveCallbackUserData;
+	};
+
+	struct BufferView {
+		VkBuffer buffer;
+		VkDeviceSize offset;
+		VkDeviceSize size;
 	};
 
 	struct ImageResourceViewInfo {
@@ -73,12 +165,6 @@ namespace vanadium::graphics {
 		VkImageSubresourceRange subresourceRange;
 	};
 
-	struct AllocationResult {
-		MemoryRange allocationRange;
-		MemoryRange usableRange;
-		BlockHandle blockHandle;
-	};
-
 	inline bool operator==(const ImageResourceViewInfo& one, const ImageResourceViewInfo& other) {
 		return one.flags == other.flags && one.viewType == other.viewType && one.components.r == other.components.r &&
 			   one.components.g == other.components.g && one.components.b == other.components.b &&
@@ -120,15 +206,25 @@ namespace vanadium::graphics {
 	struct ImageAllocation {
 		ImageResourceInfo resourceInfo;
 		robin_hood::unordered_map<ImageResourceViewInfo, VkImageView> views;
+		// the views behind these handles are recreated when the image is moved
+		robin_hood::unordered_map<ImageResourceViewInfo, ImageViewHandle> declaredViews;
 
 		uint32_t typeIndex;
+		bool isDedicated = false;
+		// placed in the type's buffer blocks instead of its image blocks
+		bool isInMixedBlock = false;
 		BlockHandle blockHandle;
 		VkDeviceSize alignmentMargin;
 		MemoryRange allocationRange;
 		VkImage image;
+
+		// kept for recreating the image when it is moved
+		VkImageCreateInfo createInfo;
+		bool isMovable = false;
+		VkImageLayout restingLayout;
+		ImageMoveCallback moveCallback;
+		void* moveCallbackUserData;
 	};
-	using BufferResourceHandle = SlotmapHandle;
-	using ImageResourceHandle = SlotmapHandle;
 
 	class GPUResourceAllocator {
 	  public:
@@ -139,89 +235,285 @@ namespace vanadium::graphics {
 		void create(DeviceContext* gpuContext);
 
 		BlockHandle createBufferBlock(size_t size, MemoryCapabilities required, MemoryCapabilities preferred,
-									  bool createMapped);
-		BlockHandle createImageBlock(size_t size, MemoryCapabilities required, MemoryCapabilities preferred);
+									  bool createMapped, MemoryPriority priority = MemoryPriority::Default);
+		BlockHandle createImageBlock(size_t size, MemoryCapabilities required, MemoryCapabilities preferred,
+									 MemoryPriority priority = MemoryPriority::Default);
 
 		// createMapped doesn't force mapping, specify hostVisible in required capabilities to require mappable
 		// allocations
 		BufferResourceHandle createBuffer(const VkBufferCreateInfo& bufferCreateInfo, MemoryCapabilities required,
-										  MemoryCapabilities preferred, bool createMapped);
+										  MemoryCapabilities preferred, bool createMapped,
+										  MemoryPriority priority = MemoryPriority::Default);
 		// createMapped doesn't force mapping, specify hostVisible in required capabilities to require mappable
 		// allocations
 		BufferResourceHandle createPerFrameBuffer(const VkBufferCreateInfo& bufferCreateInfo,
 												  MemoryCapabilities required, MemoryCapabilities preferred,
-												  bool createMapped);
+												  bool createMapped, MemoryPriority priority = MemoryPriority::Default);
 		BufferResourceHandle createBuffer(const VkBufferCreateInfo& bufferCreateInfo, BlockHandle block,
 										  bool createMapped);
+		// Hands out a range of a VkBuffer owned by a shared block instead of creating a VkBuffer for the resource, so
+		// no driver calls are made unless a new block is needed. usage must be a subset of suballocatedBufferUsage.
+		// Use bufferView to access the buffer, nativeBufferHandle returns the VkBuffer of the whole block.
+		BufferResourceHandle createSuballocatedBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+													  MemoryCapabilities required, MemoryCapabilities preferred,
+													  bool createMapped,
+													  MemoryPriority priority = MemoryPriority::Default);
+		// One range per frame in flight, all inside the same VkBuffer.
+		BufferResourceHandle createSuballocatedPerFrameBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+															  MemoryCapabilities required, MemoryCapabilities preferred,
+															  bool createMapped,
+															  MemoryPriority priority = MemoryPriority::Default);
 
 		MemoryCapabilities bufferMemoryCapabilities(BufferResourceHandle handle);
 		VkDeviceMemory nativeMemoryHandle(BufferResourceHandle handle);
 		MemoryRange allocationRange(BufferResourceHandle handle);
 		VkBuffer nativeBufferHandle(BufferResourceHandle handle);
+		// Range of the current frame's buffer. Buffers that aren't suballocated start at offset 0 and span
+		// VK_WHOLE_SIZE.
+		BufferView bufferView(BufferResourceHandle handle);
 		void* mappedBufferData(BufferResourceHandle handle);
 		void destroyBuffer(BufferResourceHandle handle);
 		void destroyBufferImmediately(BufferResourceHandle handle);
 
 		ImageResourceHandle createImage(const VkImageCreateInfo& imageCreateInfo, MemoryCapabilities required,
-										MemoryCapabilities preferred);
+										MemoryCapabilities preferred,
+										MemoryPriority priority = MemoryPriority::Default);
 		ImageResourceHandle createImage(const VkImageCreateInfo& imageCreateInfo, BlockHandle block);
 		VkImage nativeImageHandle(ImageResourceHandle handle);
-		const ImageResourceInfo& imageResourceInfo(ImageResourceHandle handle);
+		ImageResourceInfo imageResourceInfo(ImageResourceHandle handle);
 		VkImageView requestImageView(ImageResourceHandle handle, const ImageResourceViewInfo& info);
+		// Resolves the view once, imageView then returns it without locking. Prefer this over requestImageView for
+		// views that are used every frame. The handle stays valid until the image is destroyed and follows the image
+		// when it is moved.
+		ImageViewHandle declareImageView(ImageResourceHandle handle, const ImageResourceViewInfo& info);
+		VkImageView imageView(ImageViewHandle handle) const { return m_imageViewTable.load(handle); }
 		void destroyImage(ImageResourceHandle handle);
 		void destroyImageImmediately(ImageResourceHandle handle);
 
+		// Allows the defragmenter to move the buffer to another block. Moving recreates the VkBuffer and changes the
+		// mapped pointer, moveCallback is called afterwards so cached handles (e.g. in descriptor sets) can be
+		// updated. The old VkBuffer stays valid until the frame it was moved in has finished.
+		// Only buffers created with createBuffer from the shared blocks can be movable. They need transfer source and
+		// destination usage and exclusive sharing.
+		void setBufferMovable(BufferResourceHandle handle, BufferMoveCallback moveCallback, void* userData);
+		// Like setBufferMovable. The image must be in restingLayout whenever the transfer command buffer executes.
+		void setImageMovable(ImageResourceHandle handle, VkImageLayout restingLayout, ImageMoveCallback moveCallback,
+							 void* userData);
+
+		// Moves movable resources out of the most sparsely used block of each memory type into the remaining blocks,
+		// copying at most byteBudget bytes. The source blocks are released by the free list flush once empty.
+		// Move callbacks are invoked after the allocator is unlocked.
+		void recordDefragmentationCopies(VkCommandBuffer commandBuffer, VkDeviceSize byteBudget);
+
 		void destroyBufferBlock(BlockHandle handle);
 		void destroyImageBlock(BlockHandle handle);
 		// not threadsafe
 		void destroy();
 
+		// Resources larger than blockSizeFraction * the largest block size of their memory type get their own
+		// VkDeviceMemory, as do resources the driver prefers dedicated allocations for. 0.5 by default.
+		void setDedicatedAllocationThreshold(float blockSizeFraction);
+		// Places images created afterwards in the same blocks as buffers instead of separate image blocks. Optimal
+		// tiling images are padded to bufferImageGranularity so they never share a page with linear resources, which
+		// costs nothing if the granularity is 1. Enabled by default on such devices.
+		void setMixedBlocks(bool enable);
+		// Replaces the policy of every memory type and becomes the default policy. Existing blocks keep their size.
+		void setBlockSizePolicy(const BlockSizePolicy& policy);
+		// Overrides the policy of a single memory type.
+		void setBlockSizePolicy(uint32_t typeIndex, const BlockSizePolicy& policy);
+
 		void setFrameIndex(uint32_t frameIndex);
+		// Refreshes the heap budgets and invokes the over-budget callback for every heap that went over budget since
+		// the last call, either because an allocation had no other choice or because the driver reports it.
 		void updateMemoryBudget();
+		// The callback is invoked from updateMemoryBudget without the allocator being locked, so it can destroy
+		// resources right away.
+		void setOverBudgetCallback(OverBudgetCallback callback, void* userData);
+
+		// Cost is linear in the number of blocks, cheap enough to query every frame.
+		AllocatorStatistics statistics(bool includeBlocks = false);
+		// JSON dump of statistics(true)
+		std::string buildStatisticsString();
+
+		// Records every resource and block (de)allocation to fileName until stopped. Traces can be replayed
+		// against different block settings with the AllocationReplay tool.
+		bool startTraceRecording(const std::string_view& fileName);
+		void stopTraceRecording();
 
 	  private:
-		static constexpr VkDeviceSize m_blockSize = 32_MiB;
-		static constexpr VkDeviceSize m_bufferBlockFreeThreshold = 64_MiB;
-		static constexpr VkDeviceSize m_imageBlockFreeThreshold = 128_MiB;
+		// Cached size classes up to this size are handed out as slots of slabs instead of individual ranges.
+		static constexpr VkDeviceSize m_slabSizeThreshold = 4_KiB;
 
 		void destroyBufferImmediatelyUnsynchronized(const BufferAllocation& handle);
 		void destroyImageImmediatelyUnsynchronized(const ImageAllocation& handle);
 
+		BufferResourceHandle addBuffer(const BufferAllocation& allocation);
+		BufferAllocation removeBuffer(BufferResourceHandle handle);
+		ImageResourceHandle addImage(const ImageAllocation& allocation);
+		ImageAllocation removeImage(ImageResourceHandle handle);
+
 		void flushFreeList();
 
+		BufferResourceHandle suballocateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, MemoryCapabilities required,
+											   MemoryCapabilities preferred, bool createMapped, MemoryPriority priority,
+											   bool isPerFrame);
+		bool createBlockBuffer(MemoryBlock& block);
+		void freeBlockMemory(const MemoryBlock& block);
+
+		struct ResourceMemoryRequirements {
+			VkMemoryRequirements requirements;
+			bool prefersDedicated;
+			bool requiresDedicated;
+		};
+
+		ResourceMemoryRequirements bufferMemoryRequirements(VkBuffer buffer);
+		ResourceMemoryRequirements imageMemoryRequirements(VkImage image);
+		// Whether a resource is large enough compared to the blocks of its memory type to get its own VkDeviceMemory.
+		bool exceedsDedicatedAllocationThreshold(uint32_t typeIndex, VkDeviceSize size);
+		MemoryPriority effectivePriority(MemoryPriority priority);
+
+		struct DefragmentationBufferCopy {
+			VkBuffer srcBuffer;
+			VkBuffer dstBuffer;
+			VkDeviceSize size;
+		};
+
+		struct DefragmentationImageCopy {
+			VkImage srcImage;
+			VkImage dstImage;
+			VkImageLayout restingLayout;
+			VkImageAspectFlags aspectMask;
+			VkExtent3D extent;
+			uint32_t mipLevelCount;
+			uint32_t arrayLayerCount;
+		};
+
+		bool moveBuffer(BufferResourceHandle handle, const std::vector<BlockHandle>& dstBlockCandidates,
+						std::vector<DefragmentationBufferCopy>& copies);
+		bool moveImage(ImageResourceHandle handle, const std::vector<BlockHandle>& dstBlockCandidates,
+					   std::vector<DefragmentationImageCopy>& copies);
+
 		uint32_t bestTypeIndex(VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred,
-							   VkMemoryRequirements requirements, bool createMapped);
-		bool isTypeBigEnough(uint32_t typeIndex, VkDeviceSize size, bool createMapped);
+							   VkMemoryRequirements requirements, bool createMapped, MemoryPriority priority,
+							   bool respectBudget);
+		bool isTypeBigEnough(uint32_t typeIndex, VkDeviceSize size, bool createMapped, MemoryPriority priority);
+		// Takes small allocations from the allocation cache, everything else from the blocks of the type.
+		// needsBlockBuffer restricts the allocation to blocks that have (or can create) a block VkBuffer.
 		std::optional<AllocationResult> allocate(uint32_t typeIndex, VkDeviceSize alignment, VkDeviceSize size,
-												 bool createMapped);
-		std::optional<AllocationResult> allocateImage(uint32_t typeIndex, VkDeviceSize alignment, VkDeviceSize size);
+												 bool createMapped, MemoryPriority priority, bool allowOverBudget,
+												 bool needsBlockBuffer);
+		// expects the type's mutex to be locked
+		std::optional<AllocationResult> allocateFromBlocks(uint32_t typeIndex, VkDeviceSize alignment,
+														   VkDeviceSize size, bool createMapped,
+														   MemoryPriority priority, bool allowOverBudget,
+														   bool needsBlockBuffer);
+		static uint64_t cacheBucket(uint32_t typeIndex, MemoryPriority priority, bool createMapped,
+									bool needsBlockBuffer, uint32_t sizeClass);
+		void freeCachedRange(uint64_t bucket, const AllocationResult& range);
+		// Takes count slots of the bucket's size class, carving new slabs as needed. Only the first slot may go over
+		// budget. Expects the type's mutex to be locked.
+		std::vector<AllocationResult> allocateSlabSlots(uint32_t typeIndex, uint64_t bucket, size_t count,
+														bool createMapped, MemoryPriority priority,
+														bool allowOverBudget, bool needsBlockBuffer);
+		// Returns a range that came from the allocation cache to its slab or block. Expects the type's mutex to be
+		// locked.
+		void releaseCachedRange(uint32_t typeIndex, uint64_t bucket, const AllocationResult& range);
+		std::optional<AllocationResult> allocateImage(uint32_t typeIndex, VkDeviceSize alignment, VkDeviceSize size,
+													  MemoryPriority priority, bool allowOverBudget);
+		// Tries typeIndex first, then all other compatible types that have budget left, and only then goes over the
+		// budget of typeIndex. typeIndex is updated to the type that was allocated from.
+		enum class AllocationKind { Buffer, SuballocatedBuffer, Image, MixedImage };
+		std::optional<AllocationResult> allocateWithFallback(uint32_t& typeIndex, VkMemoryPropertyFlags requiredFlags,
+															 const VkMemoryRequirements& requirements,
+															 bool createMapped, AllocationKind kind,
+															 MemoryPriority priority);
+		// Requirements of the range an image occupies in a block.
+		VkMemoryRequirements imagePlacementRequirements(const VkImageCreateInfo& createInfo,
+														VkMemoryRequirements requirements, bool isInMixedBlock);
 		std::optional<AllocationResult> allocateInBlock(BlockHandle blockHandle, MemoryBlock& block,
 														VkDeviceSize alignment, VkDeviceSize size, bool createMapped);
 		void freeInBlock(MemoryBlock& block, VkDeviceSize offset, VkDeviceSize size);
 
-		bool allocateBlock(uint32_t typeIndex, VkDeviceSize size, bool createMapped, bool createImageBlock);
-		bool allocateCustomBlock(uint32_t typeIndex, VkDeviceSize size, bool createMapped, bool createImageBlock);
+		bool allocateBlock(uint32_t typeIndex, VkDeviceSize size, bool createMapped, bool createImageBlock,
+						   MemoryPriority priority, bool allowOverBudget);
+		bool allocateCustomBlock(uint32_t typeIndex, VkDeviceSize size, bool createMapped, bool createImageBlock,
+								 MemoryPriority priority);
+		// Exactly one of buffer and image is expected to be non-null.
+		std::optional<AllocationResult> allocateDedicated(uint32_t typeIndex, VkDeviceSize size, bool createMapped,
+														  VkBuffer buffer, VkImage image, MemoryPriority priority,
+														  bool allowOverBudget);
+		void freeDedicatedBlock(uint32_t typeIndex, BlockHandle handle, bool isImageBlock);
+
+		VkDeviceSize heapBudget(uint32_t heapIndex);
+		// Clamps at zero, recordOverrun adds the part that didn't fit into the budget to the heap's overrun.
+		void consumeHeapBudget(uint32_t heapIndex, VkDeviceSize size, bool recordOverrun);
+		void releaseHeapBudget(uint32_t heapIndex, VkDeviceSize size);
+		// called when the driver fails to allocate size bytes in the heap
+		void limitHeapBudget(uint32_t heapIndex, VkDeviceSize size);
+		void recordHeapOverrun(uint32_t heapIndex, VkDeviceSize size);
+
+		MemoryBlockStatistics blockStatistics(const MemoryBlock& block, bool isImageBlock, bool isCustomBlock,
+											  bool isDedicatedBlock);
+
+		void recordTraceEvent(AllocationTraceEventType type, uint8_t flags, uint32_t typeIndex, uint64_t handle,
+							  VkDeviceSize size, VkDeviceSize alignment);
 
 		DeviceContext* m_context = nullptr;
 
 		uint32_t m_currentFrameIndex = 0;
+		uint32_t m_absoluteFrameIndex = 0;
 
 		VkDeviceSize m_bufferImageGranularity;
+		bool m_useMixedBlocks = false;
+		// satisfies every offset alignment limit of suballocatedBufferUsage
+		VkDeviceSize m_suballocationAlignment;
+		uint32_t m_blockBufferMemoryTypeBits;
+		float m_dedicatedAllocationFraction = 0.5f;
+		BlockSizePolicy m_defaultBlockSizePolicy;
 
 		std::vector<MemoryType> m_memoryTypes;
+		// remaining budget per heap
 		std::vector<size_t> m_heapBudgets;
+		std::vector<VkDeviceSize> m_heapSizes;
+		std::vector<VkDeviceSize> m_reportedHeapBudgets;
+		std::vector<VkDeviceSize> m_reportedHeapUsages;
+		// bytes allocated beyond the budget since the last updateMemoryBudget
+		std::vector<VkDeviceSize> m_heapOverruns;
+
+		OverBudgetCallback m_overBudgetCallback = nullptr;
+		void* m_overBudgetCallbackUserData = nullptr;
 
 		Slotmap<MemoryBlock> m_customBufferBlocks;
 		Slotmap<MemoryBlock> m_customImageBlocks;
 
 		Slotmap<BufferAllocation> m_buffers;
 		Slotmap<ImageAllocation> m_images;
+		std::atomic<size_t> m_movableResourceCount = 0;
+		ImageViewTable m_imageViewTable;
+
+		AllocationCache<AllocationResult> m_allocationCache;
 
 		std::vector<std::vector<BufferAllocation>> m_bufferFreeList;
 		std::vector<std::vector<ImageAllocation>> m_imageFreeList;
 		std::vector<std::vector<MemoryBlock>> m_blockFreeList;
 
+		AllocationTraceRecorder m_traceRecorder;
+
+		// Lock order: m_accessMutex, then one type mutex or m_customBlockMutex, then any one of the others.
+		// Creating and destroying resources holds m_accessMutex shared, so only allocations from the same memory
+		// type wait for each other. Operations that touch every block (flushing the free lists, defragmentation,
+		// statistics, budget updates) hold it exclusively.
 		std::shared_mutex m_accessMutex;
+		// one per memory type, guards the block lists of the type
+		std::vector<std::mutex> m_typeMutexes;
+		std::mutex m_customBlockMutex;
+		// Guards m_buffers, m_images and m_currentFrameIndex. Only held for lookups and (de)registering resources,
+		// never while allocating.
+		std::shared_mutex m_resourceMutex;
+		// guards m_heapBudgets and m_heapOverruns
+		std::mutex m_budgetMutex;
+		std::mutex m_freeListMutex;
+		std::mutex m_traceMutex;
 	};
 
 } // namespace vanadium::graphics
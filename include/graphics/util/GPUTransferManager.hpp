@@ -17,9 +17,12 @@
 #pragma once
 
 #include <Slotmap.hpp>
+#include <atomic>
+#include <deque>
 #include <graphics/DeviceContext.hpp>
 #include <graphics/util/GPUResourceAllocator.hpp>
 #include <graphics/util/RangeAllocator.hpp>
+#include <graphics/util/StreamingCopy.hpp>
 #include <shared_mutex>
 #include <util/MemoryLiterals.hpp>
 
@@ -30,8 +33,7 @@ namespace vanadium::graphics {
 		VkDeviceSize maxAllocatableSize;
 		VkDeviceSize originalSize;
 
-		std::vector<MemoryRange> freeRangesOffsetSorted;
-		std::vector<MemoryRange> freeRangesSizeSorted;
+		RangeAllocator allocator;
 	};
 
 	using StagingBufferHandle = SlotmapHandle;
@@ -41,19 +43,91 @@ namespace vanadium::graphics {
 		RangeAllocationResult allocationResult;
 	};
 
+	// Space for short-lived staging data. It is reclaimed as soon as the submission reading it has finished.
+	struct StagingRingAllocation {
+		VkBuffer buffer;
+		VkDeviceSize offset;
+		void* data;
+		// start in head/tail coordinates of the ring generation, ~0 if the allocation is in an overflow buffer
+		VkDeviceSize ringPosition = ~0ULL;
+		uint32_t ringGeneration = 0;
+		// ~0U if the allocation is in the ring
+		BufferResourceHandle overflowBuffer = ~0U;
+	};
+
+	// Transfers are recorded in order of priority, within a priority in order of submission. Urgent and Default
+	// transfers are always recorded in the next frame, so their data can be used in that frame. Low transfers are
+	// only recorded while the frame's transfer budget lasts and may take several frames. Only async transfers report
+	// when they are done, one-time and image transfers should only be Low if nothing waits for their data.
+	// A transfer takes on the priority of later transfers to the same destination, so the last write always wins.
+	enum class TransferPriority : uint8_t { Urgent, Default, Low };
+
+	struct StagingRing {
+		BufferResourceHandle buffer = ~0U;
+		VkBuffer nativeBuffer = VK_NULL_HANDLE;
+		unsigned char* mappedData = nullptr;
+		VkDeviceSize size = 0;
+		bool isCoherent = true;
+
+		// head and tail only ever increase, the ring offset is the value modulo size
+		VkDeviceSize head = 0;
+		VkDeviceSize tail = 0;
+		VkDeviceSize flushedHead = 0;
+		uint32_t generation = 0;
+	};
+
+	// Everything allocated from the staging ring before a recordTransfers call. Retires once that frame and the async
+	// transfers submitted with it have finished, which frees the ring up to end and destroys the retired buffers.
+	struct StagingRingRetirement {
+		VkDeviceSize end;
+		uint32_t ringGeneration;
+		uint32_t frameIndex;
+		// 0 if no async transfers were submitted with the frame
+		uint64_t asyncBatchValue;
+		// overflow buffers and replaced rings
+		std::vector<BufferResourceHandle> retiredBuffers;
+	};
+
+	// Number of pending transfers of each kind that are recorded in the current frame. The scheduled transfers are at
+	// the front of their queues.
+	struct TransferSchedule {
+		size_t oneTimeTransferCount;
+		size_t imageTransferCount;
+		size_t asyncBufferTransferCount;
+		size_t asyncImageTransferCount;
+	};
+
+	// copies with the same source and destination buffer are recorded as regions of one vkCmdCopyBuffer
+	struct BufferCopyCommand {
+		VkBuffer srcBuffer;
+		VkBuffer dstBuffer;
+		VkBufferCopy region;
+		// assigned by recordBufferCopies, copies of later layers overwrite overlapping copies of earlier ones
+		uint32_t layer = 0;
+	};
+
 	struct GPUTransfer {
 		BufferResourceHandle dstBuffer;
+		// per frame in flight for continuous transfers
 		std::vector<StagingBufferAllocation> stagingBuffers;
-		std::vector<bool> hasNewData;
+		// used by one-time transfers instead of stagingBuffers
+		StagingRingAllocation stagingRingAllocation;
+		// per frame in flight, sorted and disjoint:
+		// ranges written since the last recordTransfers of the frame, which copies them to the destination buffer
+		std::vector<std::vector<MemoryRange>> dirtyRanges;
+		// ranges the frame's copy of the data doesn't have yet, written by flushTransferData
+		std::vector<std::vector<MemoryRange>> staleRanges;
 		bool needsStagingBuffer;
 		VkDeviceSize bufferSize;
 
 		VkPipelineStageFlags dstUsageStageFlags;
 		VkAccessFlags dstUsageAccessFlags;
+		// only used by one-time transfers, continuous transfers are recorded every frame
+		TransferPriority priority = TransferPriority::Default;
 	};
 
 	struct GPUImageTransfer {
-		BufferResourceHandle stagingBuffer;
+		StagingRingAllocation stagingRingAllocation;
 		ImageResourceHandle dstImage;
 		VkDeviceSize stagingBufferSize;
 
@@ -62,35 +136,39 @@ namespace vanadium::graphics {
 		VkAccessFlags dstUsageAccessFlags;
 		VkImageLayout dstUsageLayout;
 		VkImageLayout srcLayout;
+		TransferPriority priority;
 	};
 
 	using GPUTransferHandle = SlotmapHandle;
 
-	struct AsyncTransferCommandPool {
-		uint32_t refCount = 0;
+	// Async transfers are recorded into batches, each submitted to the async transfer queue on its own. Batches are
+	// numbered in submission order, so a finished batch implies that all batches before it have finished too.
+	struct AsyncTransferBatch {
 		VkCommandPool pool;
 		VkCommandBuffer buffer;
+		// only used without timeline semaphores, otherwise the batch signals its value on the transfer semaphore
 		VkFence fence;
+		uint64_t value;
 	};
 
-	using AsyncTransferCommandPoolHandle = SlotmapHandle;
-
 	struct AsyncBufferTransfer {
-		StagingBufferAllocation stagingBufferAllocation;
+		StagingRingAllocation stagingRingAllocation;
 		BufferResourceHandle dstBufferHandle;
 
 		VkBufferCopy copy;
 		VkBufferMemoryBarrier transferBarrier;
 		VkBufferMemoryBarrier acquireBarrier;
 		VkPipelineStageFlags dstStageFlags;
+		TransferPriority priority;
 
-		AsyncTransferCommandPoolHandle containingCommandPool = ~0U;
+		// value of the batch containing the transfer, 0 until it is recorded
+		uint64_t batchValue = 0;
 	};
 
 	using AsyncBufferTransferHandle = SlotmapHandle;
 
 	struct AsyncImageTransfer {
-		StagingBufferAllocation stagingBufferAllocation;
+		StagingRingAllocation stagingRingAllocation;
 		ImageResourceHandle dstImageHandle;
 
 		VkBufferImageCopy copy;
@@ -98,12 +176,55 @@ namespace vanadium::graphics {
 		VkImageMemoryBarrier transferBarrier;
 		VkImageMemoryBarrier acquireBarrier;
 		VkPipelineStageFlags dstStageFlags;
+		VkDeviceSize size;
+		TransferPriority priority;
 
-		AsyncTransferCommandPoolHandle containingCommandPool = ~0U;
+		// value of the batch containing the transfer, 0 until it is recorded
+		uint64_t batchValue = 0;
 	};
 
 	using AsyncImageTransferHandle = SlotmapHandle;
 
+	// Memory reserved by beginUpload that the caller is still writing to.
+	struct OpenUpload {
+		StagingRingAllocation stagingRingAllocation;
+		VkDeviceSize size;
+		// the data is written straight into this host-visible buffer, nothing needs to be copied
+		BufferResourceHandle directBuffer;
+	};
+
+	using GPUUploadHandle = SlotmapHandle;
+
+	struct GPUUpload {
+		GPUUploadHandle handle;
+		void* data;
+	};
+
+	enum class ReadbackState : uint8_t { Pending, Recorded, Finished };
+
+	// A copy from a buffer or an image region into host memory, recorded at the end of a frame.
+	struct GPUReadback {
+		// in the readback ring, or in a buffer of its own if the ring was full
+		StagingRingAllocation allocation;
+		VkDeviceSize size;
+
+		// ~0U if the readback copies from an image
+		BufferResourceHandle srcBuffer;
+		VkBufferCopy bufferCopy;
+		ImageResourceHandle srcImage;
+		VkBufferImageCopy imageCopy;
+		VkImageLayout srcLayout;
+		VkPipelineStageFlags srcStageFlags;
+		VkAccessFlags srcAccessFlags;
+
+		ReadbackState state = ReadbackState::Pending;
+		// frame whose completion fence signals that the copy has finished, valid once recorded
+		uint32_t frameIndex = 0;
+		bool released = false;
+	};
+
+	using GPUReadbackHandle = SlotmapHandle;
+
 	class GPUTransferManager {
 	  public:
 		GPUTransferManager() {}
@@ -117,54 +238,256 @@ namespace vanadium::graphics {
 
 		void destroyTransfer(GPUTransferHandle handle);
 
+		// The submit and create functions copy the data into upload memory without holding the manager's lock, large
+		// copies are spread over the copy threads.
+
 		// Transmits data to a buffer using the asynchronous transfer queue of the device, if any exists.
 		AsyncBufferTransferHandle createAsyncBufferTransfer(void* data, size_t size, BufferResourceHandle dstBuffer,
 															size_t offset, VkPipelineStageFlags usageStageFlags,
-															VkAccessFlags usageAccessFlags);
+															VkAccessFlags usageAccessFlags,
+															TransferPriority priority = TransferPriority::Default);
 
 		// Transmits data to an image using the asynchronous transfer queue of the device, if any exists.
 		AsyncImageTransferHandle createAsyncImageTransfer(void* data, size_t size, ImageResourceHandle dstImage,
 														  const VkBufferImageCopy& copy, VkImageLayout dstImageLayout,
 														  VkPipelineStageFlags usageStageFlags,
-														  VkAccessFlags usageAccessFlags);
+														  VkAccessFlags usageAccessFlags,
+														  TransferPriority priority = TransferPriority::Default);
 
 		void submitOneTimeTransfer(VkDeviceSize transferBufferSize, BufferResourceHandle handle, const void* data,
-								   VkPipelineStageFlags usageStageFlags, VkAccessFlags usageAccessFlags);
+								   VkPipelineStageFlags usageStageFlags, VkAccessFlags usageAccessFlags,
+								   TransferPriority priority = TransferPriority::Default);
 
 		void submitImageTransfer(ImageResourceHandle dstImage, const VkBufferImageCopy& copy, const void* data,
 								 VkDeviceSize size, VkPipelineStageFlags usageStageFlags,
 								 VkAccessFlags usageAccessFlags, VkImageLayout dstUsageLayout,
-								 VkImageLayout srcLayout = VK_IMAGE_LAYOUT_UNDEFINED);
+								 VkImageLayout srcLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+								 TransferPriority priority = TransferPriority::Default);
+
+		// Reserves size bytes of upload memory for the caller to write into, without holding any lock while doing
+		// so. If dstBuffer is mapped (e.g. device-local memory on resizable BAR or unified memory), data points
+		// straight into it and the upload may only be committed with commitOneTimeTransfer to that buffer. Otherwise
+		// data points into the staging ring. Every upload has to be committed or cancelled, until then the staging
+		// ring doesn't resize and doesn't reclaim anything allocated after the upload.
+		GPUUpload beginUpload(VkDeviceSize size, BufferResourceHandle dstBuffer = ~0U);
+		// The commit functions take the place of the submit and create functions above, the data has to be
+		// completely written when they are called.
+		void commitOneTimeTransfer(GPUUploadHandle upload, BufferResourceHandle dstBuffer,
+								   VkPipelineStageFlags usageStageFlags, VkAccessFlags usageAccessFlags,
+								   TransferPriority priority = TransferPriority::Default);
+		void commitImageTransfer(GPUUploadHandle upload, ImageResourceHandle dstImage, const VkBufferImageCopy& copy,
+								 VkPipelineStageFlags usageStageFlags, VkAccessFlags usageAccessFlags,
+								 VkImageLayout dstUsageLayout, VkImageLayout srcLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+								 TransferPriority priority = TransferPriority::Default);
+		AsyncBufferTransferHandle commitAsyncBufferTransfer(GPUUploadHandle upload, BufferResourceHandle dstBuffer,
+															size_t offset, VkPipelineStageFlags usageStageFlags,
+															VkAccessFlags usageAccessFlags,
+															TransferPriority priority = TransferPriority::Default);
+		AsyncImageTransferHandle commitAsyncImageTransfer(GPUUploadHandle upload, ImageResourceHandle dstImage,
+														  const VkBufferImageCopy& copy, VkImageLayout dstImageLayout,
+														  VkPipelineStageFlags usageStageFlags,
+														  VkAccessFlags usageAccessFlags,
+														  TransferPriority priority = TransferPriority::Default);
+		void cancelUpload(GPUUploadHandle upload);
+
+		// Copies size bytes at offset of srcBuffer into host-cached memory after the frame's commands.
+		// srcStageFlags and srcAccessFlags describe the last write to the range in the frame.
+		GPUReadbackHandle readBuffer(BufferResourceHandle srcBuffer, VkDeviceSize offset, VkDeviceSize size,
+									 VkPipelineStageFlags srcStageFlags, VkAccessFlags srcAccessFlags);
+		// Like readBuffer, for an image region that is size bytes large in the layout described by copy, whose
+		// bufferOffset is relative to the readback data. The image has to be in srcLayout when the frame's commands
+		// have finished, it is transitioned back to srcLayout after the copy.
+		GPUReadbackHandle readImage(ImageResourceHandle srcImage, const VkBufferImageCopy& copy, VkDeviceSize size,
+									VkImageLayout srcLayout, VkPipelineStageFlags srcStageFlags,
+									VkAccessFlags srcAccessFlags);
+		// Polls the completion fence of the frame that recorded the readback, never waits.
+		bool isReadbackFinished(GPUReadbackHandle handle);
+		// nullptr until the readback has finished, stays valid until it is released
+		const void* readbackData(GPUReadbackHandle handle);
+		// Every readback has to be released, the memory of unreleased readbacks can't be reused. Pending readbacks
+		// are dropped.
+		void releaseReadback(GPUReadbackHandle handle);
 
 		BufferResourceHandle dstBufferHandle(GPUTransferHandle handle);
 
 		void updateTransferData(GPUTransferHandle transfer, uint32_t frameIndex, const void* data);
-
+		// Only updates size bytes at offset, data points to the new contents of the range.
+		void updateTransferData(GPUTransferHandle transfer, uint32_t frameIndex, const void* data, VkDeviceSize offset,
+								VkDeviceSize size);
+
+		// Marks a range as changed for the copies of every frame in flight, flushTransferData then writes it once per
+		// frame. New transfers start out with their whole range marked.
+		void invalidateTransferRange(GPUTransferHandle transfer, VkDeviceSize offset, VkDeviceSize size);
+		// Compares both versions of the data in blocks of compareGranularity bytes and invalidates the blocks that
+		// differ, as well as everything in data past previousSize.
+		void invalidateChangedTransferData(GPUTransferHandle transfer, const void* previousData,
+										   VkDeviceSize previousSize, const void* data, VkDeviceSize size,
+										   VkDeviceSize compareGranularity);
+		// Writes the ranges the frame's copy is missing from data, which holds the complete contents of the transfer
+		// up to dataSize. Ranges past dataSize stay invalidated. Does nothing if the copy is up to date, so it can be
+		// called every frame.
+		void flushTransferData(GPUTransferHandle transfer, uint32_t frameIndex, const void* data,
+							   VkDeviceSize dataSize);
+
+		// Pending async transfers are split into batches of at most this many bytes, so the first ones finish without
+		// waiting for everything else submitted in the same frame. Transfers larger than the limit get a batch alone.
+		void setAsyncTransferBatchSizeLimit(VkDeviceSize bytes);
+
+		// Limits how many bytes of transfers are recorded per frame, counting the staged ranges of continuous
+		// transfers as well. Only Low transfers are deferred to later frames if they don't fit. The first Low transfer
+		// of a frame is recorded even if it exceeds the rest of the budget alone, as long as some of it is left.
+		void setTransferBudget(VkDeviceSize bytesPerFrame);
+
+		// Limits how many bytes of movable resources the allocator may copy per frame to defragment its blocks.
+		void setDefragmentationBudget(VkDeviceSize bytesPerFrame);
+
+		// Call after the last submission of frameIndex has finished and its frame completion fence has been reset. The
+		// command buffer must be submitted with that fence before recordTransfers is called again.
 		VkCommandBuffer recordTransfers(uint32_t frameIndex);
+		// Records the readbacks requested since the last call. Call after recordTransfers and submit the command
+		// buffer after the frame's other command buffers, with the same fence.
+		VkCommandBuffer recordReadbacks(uint32_t frameIndex);
 
 		void destroy();
+		// Destroys empty staging buffers of continuous transfers. One-time and async transfers use the staging ring,
+		// which adapts its size by itself.
 		void tryCleanupStagingBuffers();
 
+		// Only compare the value of the transfer's batch against the completed value, which recordTransfers updates
+		// once per frame. Call completedTransferValue first to see transfers that finished in the meantime.
 		bool isBufferTransferFinished(AsyncBufferTransferHandle transferHandle);
 		bool isImageTransferFinished(AsyncImageTransferHandle transferHandle);
 
+		// Asks the device how far the async transfers have progressed. Every transfer whose batch value is at most the
+		// returned value has finished.
+		uint64_t completedTransferValue();
+		// Value of the batch containing the transfer, 0 until the transfer has been submitted.
+		uint64_t bufferTransferValue(AsyncBufferTransferHandle transferHandle);
+		uint64_t imageTransferValue(AsyncImageTransferHandle transferHandle);
+
+		// Signaled with the batch values as the batches finish. VK_NULL_HANDLE if the device doesn't support
+		// timeline semaphores.
+		VkSemaphore asyncTransferSemaphore() const { return m_asyncTransferSemaphore; }
+
+		// Transfers must have finished before they are finalized, unless asyncTransferSemaphore exists. Then they can
+		// be finalized as soon as they have been submitted, and the command buffer of the next recordTransfers has to
+		// wait until the semaphore reaches transferWaitValue.
 		void finalizeAsyncBufferTransfer(AsyncBufferTransferHandle transferHandle);
 		void finalizeAsyncImageTransfer(AsyncImageTransferHandle transferHandle);
+		// 0 if the command buffer of the last recordTransfers doesn't need to wait for async transfers.
+		uint64_t transferWaitValue() const { return m_transferWaitValue; }
 
 		StagingBufferAllocation allocateStagingBufferArea(VkDeviceSize size);
+		// The allocation stays valid until the next recordTransfers has been submitted and has finished executing, or
+		// the async transfer submitted by it, if there was one.
+		StagingRingAllocation allocateStagingRingArea(VkDeviceSize size);
+
+		VkDeviceSize stagingRingSize() const { return m_stagingRing.size; }
 
 	  private:
+		void freeStagingBufferArea(const StagingBufferAllocation& allocation);
+
+		// The enqueue functions take staging memory that already holds the data. Only call with the lock held.
+		void enqueueOneTimeTransfer(const StagingRingAllocation& stagingAllocation, VkDeviceSize size,
+									BufferResourceHandle dstBuffer, VkPipelineStageFlags usageStageFlags,
+									VkAccessFlags usageAccessFlags, TransferPriority priority);
+		void enqueueImageTransfer(const StagingRingAllocation& stagingAllocation, VkDeviceSize size,
+								  ImageResourceHandle dstImage, const VkBufferImageCopy& copy,
+								  VkPipelineStageFlags usageStageFlags, VkAccessFlags usageAccessFlags,
+								  VkImageLayout dstUsageLayout, VkImageLayout srcLayout, TransferPriority priority);
+		AsyncBufferTransferHandle enqueueAsyncBufferTransfer(const StagingRingAllocation& stagingAllocation,
+															 VkDeviceSize size, BufferResourceHandle dstBuffer,
+															 size_t offset, VkPipelineStageFlags usageStageFlags,
+															 VkAccessFlags usageAccessFlags,
+															 TransferPriority priority);
+		AsyncImageTransferHandle enqueueAsyncImageTransfer(const StagingRingAllocation& stagingAllocation,
+														   VkDeviceSize size, ImageResourceHandle dstImage,
+														   const VkBufferImageCopy& copy, VkImageLayout dstImageLayout,
+														   VkPipelineStageFlags usageStageFlags,
+														   VkAccessFlags usageAccessFlags, TransferPriority priority);
+		// Removes the upload and hands its staging memory back to the regular retirement.
+		OpenUpload closeUpload(GPUUploadHandle handle);
+		// Sorts the pending transfers by priority and decides how many of them fit into this frame's budget.
+		TransferSchedule scheduleTransfers(uint32_t frameIndex);
+
+		// Collects the staging allocations of open uploads and deferred transfers into m_heldStagingAllocations. They
+		// haven't been read yet, so their memory can't be retired.
+		void collectHeldStagingAllocations();
+		// Everything in the staging ring before this may be retired, needs up-to-date held allocations.
+		VkDeviceSize stagingRingRetirableHead() const;
+
+		// Records and submits the first pending async transfers, returns the value of the last batch or 0 if nothing
+		// was submitted.
+		uint64_t submitAsyncTransfers(size_t bufferTransferCount, size_t imageTransferCount);
+		AsyncTransferBatch beginAsyncTransferBatch();
+		// Recycles the batches that have finished executing. Only call with the exclusive lock held.
+		void retireAsyncTransferBatches();
+		// Queries the transfer semaphore or the batch fences and returns the new completed value. Needs at least a
+		// shared lock.
+		uint64_t updateCompletedAsyncBatchValue();
+		bool isAsyncBatchFinished(uint64_t batchValue) const {
+			return batchValue && batchValue <= m_completedAsyncBatchValue.load();
+		}
+
+		// copies data to the range of the frame's copy and marks it dirty
+		void writeTransferRange(GPUTransfer& transfer, uint32_t frameIndex, const void* data, MemoryRange range);
+
+		// Queues a flush of a range of the buffer's memory if it isn't host-coherent. Queued ranges are merged and
+		// flushed with one call at the start of the next recordTransfers.
+		void queueMemoryFlush(BufferResourceHandle buffer, VkDeviceSize offset, VkDeviceSize size);
+		void flushQueuedMemoryRanges();
+		// Sorts the copies by buffer pair and records one vkCmdCopyBuffer per pair. Copies overlapping earlier ones
+		// in the destination are recorded after a barrier.
+		void recordBufferCopies(VkCommandBuffer commandBuffer, std::vector<BufferCopyCommand>& copies);
+
+		void createStagingRing(VkDeviceSize size);
+		// Pass ~0U if no frame is known to have finished, retirement then only relies on fences.
+		void retireStagingRingAllocations(uint32_t finishedFrameIndex);
+		void flushStagingRing();
+		// called once per recordTransfers, grows or shrinks the ring based on the usage since the last call
+		void updateStagingRingSize();
+		void replaceStagingRing(VkDeviceSize newSize);
+
+		GPUReadbackHandle enqueueReadback(GPUReadback readback);
+		StagingRingAllocation allocateReadbackArea(VkDeviceSize size);
+		// Marks readbacks of finished frames as finished and frees released readbacks in allocation order. Pass ~0U
+		// if no frame is known to have finished.
+		void retireReadbacks(uint32_t finishedFrameIndex);
+		void finishReadback(GPUReadback& readback);
+
 		constexpr static size_t m_minStagingBlockSize = 32_MiB;
 
+		constexpr static VkDeviceSize m_minStagingRingSize = 16_MiB;
+		constexpr static VkDeviceSize m_maxStagingRingSize = 512_MiB;
+		constexpr static VkDeviceSize m_stagingRingAlignment = 16;
+		// frames in a row that have to overflow the ring before it grows
+		constexpr static uint32_t m_stagingRingGrowthFrames = 4;
+		// frames in a row that have to use less than a quarter of the ring before it shrinks
+		constexpr static uint32_t m_stagingRingShrinkFrames = 256;
+
+		constexpr static VkDeviceSize m_readbackRingSize = 16_MiB;
+
 		DeviceContext* m_context;
 		GPUResourceAllocator* m_resourceAllocator;
 
-		Slotmap<AsyncTransferCommandPool> m_asyncTransferCommandPools;
-		std::vector<AsyncTransferCommandPool> m_freeAsyncTransferCommandPools;
+		// submitted batches in submission order
+		std::deque<AsyncTransferBatch> m_asyncTransferBatches;
+		std::vector<AsyncTransferBatch> m_freeAsyncTransferBatches;
+		uint64_t m_nextAsyncBatchValue = 1;
+		// also updated by completedTransferValue, which only holds a shared lock
+		std::atomic<uint64_t> m_completedAsyncBatchValue = 0;
+		VkSemaphore m_asyncTransferSemaphore = VK_NULL_HANDLE;
+		// newest batch of the transfers finalized since the last recordTransfers
+		uint64_t m_finalizedBatchValue = 0;
+		uint64_t m_transferWaitValue = 0;
+		VkDeviceSize m_asyncTransferBatchSizeLimit = 64_MiB;
 
 		VkDeviceSize m_nonCoherentAtomSize;
+		VkDeviceSize m_defragmentationBudget = 4_MiB;
+		VkDeviceSize m_transferBudget = 32_MiB;
 
 		VkCommandBuffer m_transferCommandBuffers[frameInFlightCount];
+		VkCommandBuffer m_readbackCommandBuffers[frameInFlightCount];
 		VkCommandPool m_transferCommandPools[frameInFlightCount];
 
 		Slotmap<GPUTransfer> m_continuousTransfers;
@@ -185,11 +508,36 @@ namespace vanadium::graphics {
 		// Barriers performing Queue Family Ownership Transfers from the asynchronous copy queue to the destination
 		// queue.
 		std::vector<VkImageMemoryBarrier> m_imageFinalizationBarriers;
+		VkPipelineStageFlags m_finalizationStageFlags = 0;
 
 		Slotmap<StagingBuffer> m_stagingBuffers;
 
-		// An array of free staging buffers for each frame in flight.
-		std::vector<std::vector<StagingBufferAllocation>> m_stagingBufferAllocationFreeList;
+		std::vector<VkMappedMemoryRange> m_queuedFlushRanges;
+		// only used inside recordTransfers and recordReadbacks, kept to reuse its allocation
+		std::vector<BufferCopyCommand> m_bufferCopies;
+
+		StagingRing m_stagingRing;
+		std::deque<StagingRingRetirement> m_stagingRingRetirements;
+		// allocations that didn't fit into the ring since the last recordTransfers
+		std::vector<BufferResourceHandle> m_stagingOverflowBuffers;
+		bool m_stagingRingOverflowed = false;
+		bool m_stagingRingRetirementPending = false;
+		Slotmap<OpenUpload> m_openUploads;
+		// only used inside recordTransfers, kept to reuse its allocation
+		std::vector<StagingRingAllocation> m_heldStagingAllocations;
+		VkDeviceSize m_stagingFrameAllocatedSize = 0;
+		VkDeviceSize m_stagingFramePeakUsage = 0;
+		uint32_t m_stagingOverflowFrameCount = 0;
+		uint32_t m_stagingLowUsageFrameCount = 0;
+
+		StreamingCopyPool m_copyPool;
+
+		// generation and flushedHead are unused, readback memory is never written by the host
+		StagingRing m_readbackRing;
+		Slotmap<GPUReadback> m_readbacks;
+		// every readback that hasn't been freed yet, in allocation order
+		std::deque<GPUReadbackHandle> m_readbackOrder;
+		std::vector<GPUReadbackHandle> m_pendingReadbacks;
 
 		std::shared_mutex m_accessMutex;
 	};
@@ -0,0 +1,90 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#define VK_NO_PROTOTYPES
+#include <vulkan/vulkan.h>
+#include <Log.hpp>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace vanadium::graphics {
+
+	using ImageViewHandle = uint32_t;
+
+	// Image views behind stable handles. Reading a view never locks, so handles can be resolved every frame from any
+	// thread. Slots live in fixed-size chunks that are never moved or freed before the table is destroyed.
+	class ImageViewTable {
+	  public:
+		static constexpr uint32_t chunkSize = 1024;
+		static constexpr uint32_t maxChunkCount = 1024;
+
+		ImageViewTable() {}
+		ImageViewTable(const ImageViewTable&) = delete;
+		ImageViewTable& operator=(const ImageViewTable&) = delete;
+
+		ImageViewHandle acquire(VkImageView view) {
+			auto lock = std::lock_guard<std::mutex>(m_mutex);
+			ImageViewHandle handle;
+			if (!m_freeHandles.empty()) {
+				handle = m_freeHandles.back();
+				m_freeHandles.pop_back();
+			} else {
+				handle = m_handleCount++;
+				assertFatal(handle < chunkSize * maxChunkCount, "ImageViewTable: Too many image view handles!");
+				if (handle % chunkSize == 0) {
+					m_chunks[handle / chunkSize].store(new std::atomic<VkImageView>[chunkSize],
+													   std::memory_order_release);
+				}
+			}
+			store(handle, view);
+			return handle;
+		}
+
+		void release(ImageViewHandle handle) {
+			store(handle, VK_NULL_HANDLE);
+			auto lock = std::lock_guard<std::mutex>(m_mutex);
+			m_freeHandles.push_back(handle);
+		}
+
+		void store(ImageViewHandle handle, VkImageView view) {
+			slot(handle).store(view, std::memory_order_release);
+		}
+		VkImageView load(ImageViewHandle handle) const { return slot(handle).load(std::memory_order_acquire); }
+
+		~ImageViewTable() {
+			for (auto& chunk : m_chunks) {
+				delete[] chunk.load(std::memory_order_relaxed);
+			}
+		}
+
+	  private:
+		std::atomic<VkImageView>& slot(ImageViewHandle handle) const {
+			return m_chunks[handle / chunkSize].load(std::memory_order_acquire)[handle % chunkSize];
+		}
+
+		std::array<std::atomic<std::atomic<VkImageView>*>, maxChunkCount> m_chunks = {};
+
+		std::mutex m_mutex;
+		uint32_t m_handleCount = 0;
+		std::vector<ImageViewHandle> m_freeHandles;
+	};
+
+} // namespace vanadium::graphics
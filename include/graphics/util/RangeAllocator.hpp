@@ -18,8 +18,10 @@
 
 #define VK_NO_PROTOTYPES
 #include <vulkan/vulkan.h>
-#include <vector>
+#include <array>
 #include <optional>
+#include <robin_hood.h>
+#include <vector>
 
 namespace vanadium::graphics {
 	struct MemoryRange {
@@ -42,4 +44,82 @@ namespace vanadium::graphics {
 	void freeToRanges(std::vector<MemoryRange>& gapsOffsetSorted, std::vector<MemoryRange>& gapsSizeSorted,
 					  VkDeviceSize offset, VkDeviceSize size);
 	void mergeFreeAreas(std::vector<MemoryRange>& gapsOffsetSorted, std::vector<MemoryRange>& gapsSizeSorted);
+
+	// ranges are kept sorted by offset and disjoint, overlapping or adjacent ranges are merged on insertion
+	void insertMergedRange(std::vector<MemoryRange>& ranges, MemoryRange range);
+	void eraseRange(std::vector<MemoryRange>& ranges, MemoryRange range);
+
+	// Two-Level Segregated Fit allocator managing a single contiguous range. Allocating and freeing is O(1), freed
+	// ranges are coalesced with their free neighbours immediately.
+	class RangeAllocator {
+	  public:
+		RangeAllocator();
+		RangeAllocator(VkDeviceSize size);
+
+		// The returned allocation range includes the alignment margin and must be passed to free unchanged.
+		std::optional<RangeAllocationResult> allocate(VkDeviceSize alignment, VkDeviceSize size);
+		void free(VkDeviceSize offset, VkDeviceSize size);
+
+		VkDeviceSize totalSize() const { return m_totalSize; }
+		VkDeviceSize freeSize() const { return m_freeSize; }
+		size_t freeRangeCount() const { return m_freeRangeCount; }
+		size_t allocationCount() const { return m_usedNodes.size(); }
+		bool empty() const { return m_freeSize == m_totalSize; }
+
+		// Size of the largest free range. Only scans the highest non-empty size class.
+		VkDeviceSize maxAllocatableSize() const;
+
+	  private:
+		static constexpr uint32_t m_secondLevelCountLog2 = 5;
+		static constexpr uint32_t m_secondLevelCount = 1U << m_secondLevelCountLog2;
+		static constexpr uint32_t m_firstLevelCount = 64 - m_secondLevelCountLog2 + 1;
+		static constexpr uint32_t m_invalidNodeIndex = ~0U;
+
+		struct RangeNode {
+			VkDeviceSize offset;
+			VkDeviceSize size;
+
+			uint32_t prevPhysical = m_invalidNodeIndex;
+			uint32_t nextPhysical = m_invalidNodeIndex;
+			uint32_t prevFree = m_invalidNodeIndex;
+			uint32_t nextFree = m_invalidNodeIndex;
+			bool isFree = false;
+		};
+
+		struct SizeClass {
+			uint32_t firstLevel;
+			uint32_t secondLevel;
+		};
+
+		static SizeClass sizeClass(VkDeviceSize size);
+		static VkDeviceSize roundUpToSizeClass(VkDeviceSize size);
+		static size_t listIndex(SizeClass sizeClass) {
+			return sizeClass.firstLevel * m_secondLevelCount + sizeClass.secondLevel;
+		}
+
+		bool fits(uint32_t nodeIndex, VkDeviceSize alignment, VkDeviceSize size) const;
+		// Returns the head of the first non-empty free list whose ranges are all at least size bytes big.
+		uint32_t findFreeNode(VkDeviceSize size) const;
+		// Walks all free lists that may contain a fitting range, only used when the constant-time lookups fail.
+		uint32_t searchFreeNodes(VkDeviceSize alignment, VkDeviceSize size) const;
+
+		void insertFreeNode(uint32_t nodeIndex);
+		void removeFreeNode(uint32_t nodeIndex);
+
+		uint32_t acquireNode();
+		void releaseNode(uint32_t nodeIndex);
+
+		VkDeviceSize m_totalSize = 0;
+		VkDeviceSize m_freeSize = 0;
+		size_t m_freeRangeCount = 0;
+
+		uint64_t m_firstLevelBitmap = 0;
+		std::array<uint32_t, m_firstLevelCount> m_secondLevelBitmaps = {};
+		std::array<uint32_t, m_firstLevelCount * m_secondLevelCount> m_freeListHeads;
+
+		std::vector<RangeNode> m_nodes;
+		std::vector<uint32_t> m_unusedNodeIndices;
+		// Maps offsets of allocated ranges to their nodes.
+		robin_hood::unordered_flat_map<VkDeviceSize, uint32_t> m_usedNodes;
+	};
 } // namespace vanadium::graphics
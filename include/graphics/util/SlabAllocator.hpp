@@ -0,0 +1,82 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#define VK_NO_PROTOTYPES
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace vanadium::graphics {
+	struct SlabSlot {
+		uint32_t slabIndex;
+		uint32_t slotIndex;
+	};
+
+	// Splits ranges (slabs) provided by the owner into equally sized slots. Used slots are tracked in one bitmap word
+	// per slab, so allocating and freeing slots is O(1). Slots are aligned to the slot size if the slabs are, no
+	// alignment margin is needed per slot.
+	class SlabAllocator {
+	  public:
+		static constexpr uint32_t maxSlotsPerSlab = 64;
+
+		SlabAllocator() {}
+		SlabAllocator(VkDeviceSize slotSize, uint32_t slotsPerSlab);
+
+		// Returns std::nullopt if every slab is full, a new slab has to be added then.
+		std::optional<SlabSlot> allocate();
+		// Returns true if the slab has no used slots left. Empty slabs keep serving allocations until removed.
+		bool free(SlabSlot slot);
+
+		// The slab spans slabSize() bytes from offset on.
+		uint32_t addSlab(VkDeviceSize offset);
+		// Only empty slabs can be removed.
+		void removeSlab(uint32_t slabIndex);
+
+		VkDeviceSize slotSize() const { return m_slotSize; }
+		VkDeviceSize slabSize() const { return m_slotSize * m_slotsPerSlab; }
+		VkDeviceSize slotOffset(SlabSlot slot) const {
+			return m_slabs[slot.slabIndex].offset + slot.slotIndex * m_slotSize;
+		}
+		size_t slabCount() const { return m_slabs.size() - m_unusedSlabIndices.size(); }
+		size_t usedSlotCount() const { return m_usedSlotCount; }
+
+	  private:
+		static constexpr uint32_t m_invalidIndex = ~0U;
+
+		struct Slab {
+			VkDeviceSize offset;
+			uint64_t usedSlots = 0;
+			// position in m_partialSlabs, m_invalidIndex if the slab is full
+			uint32_t partialSlabIndex = m_invalidIndex;
+		};
+
+		void addPartialSlab(uint32_t slabIndex);
+		void removePartialSlab(uint32_t slabIndex);
+
+		VkDeviceSize m_slotSize = 0;
+		uint32_t m_slotsPerSlab = 0;
+		uint64_t m_fullMask = 0;
+		size_t m_usedSlotCount = 0;
+
+		std::vector<Slab> m_slabs;
+		std::vector<uint32_t> m_unusedSlabIndices;
+		// slabs with at least one free slot
+		std::vector<uint32_t> m_partialSlabs;
+	};
+} // namespace vanadium::graphics
@@ -0,0 +1,75 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <util/MemoryLiterals.hpp>
+#include <vector>
+
+namespace vanadium::graphics {
+
+	// Copies with non-temporal stores where available, so the destination doesn't pass through the caches. Writes to
+	// write-combined memory (staging buffers, BAR) become full-line writes, and large copies don't evict the working
+	// set. Small copies go through std::memcpy.
+	void streamingCopy(void* dst, const void* src, size_t size);
+
+	// Splits large copies into chunks that worker threads copy with streamingCopy while the calling thread copies one
+	// chunk itself. copy may be called from multiple threads at once.
+	class StreamingCopyPool {
+	  public:
+		StreamingCopyPool() {}
+
+		// 0 picks a worker count suited to the machine, a single thread can't saturate memory bandwidth on its own
+		void create(uint32_t workerCount = 0);
+		void destroy();
+
+		void copy(void* dst, const void* src, size_t size);
+
+		uint32_t workerCount() const { return static_cast<uint32_t>(m_workers.size()); }
+
+		// copies smaller than this stay on the calling thread
+		constexpr static size_t minParallelCopySize = 1_MiB;
+		constexpr static size_t minChunkSize = 512_KiB;
+
+	  private:
+		struct CopyChunk {
+			unsigned char* dst;
+			const unsigned char* src;
+			size_t size;
+			std::atomic<size_t>* remainingChunks;
+		};
+
+		void workerLoop();
+		void copyChunk(const CopyChunk& chunk);
+
+		constexpr static uint32_t m_maxWorkerCount = 4;
+
+		std::vector<std::thread> m_workers;
+		std::deque<CopyChunk> m_chunks;
+		bool m_stopping = false;
+
+		std::mutex m_chunkMutex;
+		std::condition_variable m_chunksAvailable;
+		std::condition_variable m_chunkFinished;
+	};
+
+} // namespace vanadium::graphics
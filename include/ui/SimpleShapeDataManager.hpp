@@ -70,16 +70,12 @@ namespace vanadium::ui {
 		// Cache for the most recent result of rebuilding the data buffer, since there is one GPU buffer for each frame
 		// in flight and all of them need to be updated
 		std::vector<T> m_shapeDataBuffer;
+		// The data buffer the transfer's ranges were last invalidated against. uploadDataBuffer only invalidates the
+		// elements that differ from it, so mostly unchanged buffers only upload a few ranges.
+		std::vector<T> m_previousShapeDataBuffer;
+		bool m_dataBufferChanged = false;
 		std::vector<RenderedLayer> m_renderedLayers;
 
-		uint32_t m_lastDataUpdateFrameIndex;
-
-		// The frame index of the last data update is set in rebuildDataBuffer, uploadDataBuffer would have no way of
-		// distinguishing whether the data was updated in the current frame or if the frame index wrapped around (which
-		// would mean all buffers are sufficiently updated). If this variable is true, the data was updated in the
-		// current frame.
-		bool m_dataUpdatedThisFrame = false;
-
 		VkDescriptorSet m_shapeDataSets[graphics::frameInFlightCount];
 		std::vector<graphics::DescriptorSetAllocation> m_shapeDataSetAllocations;
 		graphics::DescriptorSetAllocationInfo m_setAllocationInfo;
@@ -134,9 +130,10 @@ namespace vanadium::ui {
 		std::sort(sortedShapeData.begin(), sortedShapeData.end(),
 				  [](const auto& one, const auto& other) { return one.layerIndex < other.layerIndex; });
 
-		// reserve maximum shape data capacity so the transfer won't read out-of-bounds
+		// if the last rebuild wasn't uploaded yet, its changes still have to be compared against the older buffer
+		if (!m_dataBufferChanged)
+			std::swap(m_previousShapeDataBuffer, m_shapeDataBuffer);
 		m_shapeDataBuffer.clear();
-		m_shapeDataBuffer.reserve(m_maxShapeDataCapacity);
 
 		for (auto& data : sortedShapeData)
 			m_shapeDataBuffer.push_back(data.data);
@@ -163,16 +160,19 @@ namespace vanadium::ui {
 				std::lower_bound(sortedShapeData.begin(), sortedShapeData.end(), layerIndex + 1, dataComparator);
 		}
 
-		m_lastDataUpdateFrameIndex = frameIndex;
-		m_dataUpdatedThisFrame = true;
+		m_dataBufferChanged = true;
 	}
 
 	template <typename T>
 	void SimpleShapeDataManager<T>::uploadDataBuffer(const graphics::RenderContext& context, size_t frameIndex) {
-		if (m_lastDataUpdateFrameIndex == ~0U)
-			return;
-
-		context.transferManager->updateTransferData(m_shapeDataTransfer, frameIndex, m_shapeDataBuffer.data());
+		if (m_dataBufferChanged) {
+			context.transferManager->invalidateChangedTransferData(
+				m_shapeDataTransfer, m_previousShapeDataBuffer.data(), m_previousShapeDataBuffer.size() * sizeof(T),
+				m_shapeDataBuffer.data(), m_shapeDataBuffer.size() * sizeof(T), sizeof(T));
+			m_dataBufferChanged = false;
+		}
+		context.transferManager->flushTransferData(m_shapeDataTransfer, frameIndex, m_shapeDataBuffer.data(),
+												   m_shapeDataBuffer.size() * sizeof(T));
 
 		if (m_bufferRevisionCount > m_descriptorSetRevisionCount[frameIndex]) {
 			VkDescriptorBufferInfo bufferInfo = { .buffer = context.resourceAllocator->nativeBufferHandle(
@@ -189,11 +189,6 @@ namespace vanadium::ui {
 			vkUpdateDescriptorSets(context.deviceContext->device(), 1, &writeDescriptorSet, 0, nullptr);
 			m_descriptorSetRevisionCount[frameIndex] = m_bufferRevisionCount;
 		}
-
-		if (m_lastDataUpdateFrameIndex == frameIndex && !m_dataUpdatedThisFrame)
-			m_lastDataUpdateFrameIndex = ~0U;
-
-		m_dataUpdatedThisFrame = false;
 	}
 
 	template <typename T> void SimpleShapeDataManager<T>::eraseShapeData(size_t index) {
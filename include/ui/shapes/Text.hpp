@@ -76,7 +76,6 @@ namespace vanadium::ui::shapes {
 		bool bufferDirtyFlag = false;
 
 		uint32_t lastRecreateFrameIndex = ~0U;
-		uint32_t lastUpdateFrameIndex = ~0U;
 
 		VkDeviceSize transferBufferCapacity = 0U;
 		graphics::GPUTransferHandle glyphDataTransfer = ~0U;
@@ -182,6 +182,8 @@ namespace vanadium::graphics {
 			enumerate<VkPhysicalDevice, VkExtensionProperties, const char*>(m_physicalDevice, nullptr,
 																			vkEnumerateDeviceExtensionProperties);
 
+		bool hasMemoryRequirements2 = false;
+		bool hasDedicatedAllocation = false;
 		for (auto& extension : availableDeviceExtensions) {
 			if (!strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)) {
 				deviceExtensionNames.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
@@ -191,6 +193,49 @@ namespace vanadium::graphics {
 				deviceExtensionNames.push_back(VK_EXT_MEMORY_PRIORITY_EXTENSION_NAME);
 				m_capabilities.memoryPriority = true;
 			}
+			if (!strcmp(extension.extensionName, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)) {
+				deviceExtensionNames.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+				m_capabilities.timelineSemaphore = true;
+			}
+			if (!strcmp(extension.extensionName, VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME)) {
+				hasMemoryRequirements2 = true;
+			}
+			if (!strcmp(extension.extensionName, VK_KHR_DEDICATED_ALLOCATION_EXTENSION_NAME)) {
+				hasDedicatedAllocation = true;
+			}
+		}
+		if (hasMemoryRequirements2 && hasDedicatedAllocation) {
+			deviceExtensionNames.push_back(VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME);
+			deviceExtensionNames.push_back(VK_KHR_DEDICATED_ALLOCATION_EXTENSION_NAME);
+			m_capabilities.dedicatedAllocation = true;
+		}
+
+		// the extensions alone aren't enough, their features have to be enabled too
+		VkPhysicalDeviceMemoryPriorityFeaturesEXT memoryPriorityFeatures = {
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PRIORITY_FEATURES_EXT
+		};
+		VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphoreFeatures = {
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR
+		};
+		void* featureChain = nullptr;
+		if (m_capabilities.memoryPriority) {
+			memoryPriorityFeatures.pNext = featureChain;
+			featureChain = &memoryPriorityFeatures;
+		}
+		if (m_capabilities.timelineSemaphore) {
+			timelineSemaphoreFeatures.pNext = featureChain;
+			featureChain = &timelineSemaphoreFeatures;
+		}
+		if (featureChain && vkGetPhysicalDeviceFeatures2KHR) {
+			VkPhysicalDeviceFeatures2KHR features = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR,
+													  .pNext = featureChain };
+			vkGetPhysicalDeviceFeatures2KHR(m_physicalDevice, &features);
+			m_capabilities.memoryPriority = memoryPriorityFeatures.memoryPriority;
+			m_capabilities.timelineSemaphore = timelineSemaphoreFeatures.timelineSemaphore;
+		} else {
+			m_capabilities.memoryPriority = false;
+			m_capabilities.timelineSemaphore = false;
+			featureChain = nullptr;
 		}
 
 		float graphicsPriority = 1.0f;
@@ -205,6 +250,7 @@ namespace vanadium::graphics {
 														  .pQueuePriorities = &transferPriority } };
 
 		VkDeviceCreateInfo deviceCreateInfo = { .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+												.pNext = featureChain,
 												.queueCreateInfoCount = 2,
 												.pQueueCreateInfos = queueCreateInfos,
 												.enabledExtensionCount =
@@ -223,12 +269,17 @@ namespace vanadium::graphics {
 
 		vkGetPhysicalDeviceProperties(m_physicalDevice, &m_properties);
 
-		m_frameCompletionFences.resize(frameInFlightCount);
-		VkFenceCreateInfo fenceCreateInfo = { .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-											  .flags = VK_FENCE_CREATE_SIGNALED_BIT };
-		for (uint32_t i = 0; i < frameInFlightCount; ++i) {
-			verifyResult(vkCreateFence(m_device, &fenceCreateInfo, nullptr, &m_frameCompletionFences[i]));
-		}
+		createFrameCompletionFences();
+	}
+
+	DeviceContext::DeviceContext(const ExternalDeviceInfo& info)
+		: m_instance(info.instance), m_physicalDevice(info.physicalDevice), m_device(info.device),
+		  m_graphicsQueueFamilyIndex(info.graphicsQueueFamilyIndex), m_graphicsQueue(info.graphicsQueue),
+		  m_asyncTransferQueueFamilyIndex(info.asyncTransferQueueFamilyIndex),
+		  m_asyncTransferQueue(info.asyncTransferQueue), m_ownsDevice(false), m_capabilities(info.capabilities) {
+		vkGetPhysicalDeviceProperties(m_physicalDevice, &m_properties);
+
+		createFrameCompletionFences();
 	}
 
 	void DeviceContext::destroy() {
@@ -236,6 +287,10 @@ namespace vanadium::graphics {
 			vkDestroyFence(m_device, fence, nullptr);
 		}
 
+		if (!m_ownsDevice) {
+			return;
+		}
+
 		if constexpr (vanadiumGPUDebug) {
 			vkDestroyDebugUtilsMessengerEXT(m_instance, m_debugMessenger, nullptr);
 		}
@@ -244,4 +299,13 @@ namespace vanadium::graphics {
 		vkDestroyInstance(m_instance, nullptr);
 	}
 
+	void DeviceContext::createFrameCompletionFences() {
+		m_frameCompletionFences.resize(frameInFlightCount);
+		VkFenceCreateInfo fenceCreateInfo = { .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+											  .flags = VK_FENCE_CREATE_SIGNALED_BIT };
+		for (uint32_t i = 0; i < frameInFlightCount; ++i) {
+			verifyResult(vkCreateFence(m_device, &fenceCreateInfo, nullptr, &m_frameCompletionFences[i]));
+		}
+	}
+
 } // namespace vanadium::graphics
@@ -43,12 +43,14 @@ namespace vanadium::graphics {
 		m_resourceAllocator.create(&m_deviceContext);
 		m_descriptorSetAllocator.create(&m_deviceContext);
 		m_transferManager.create(&m_deviceContext, &m_resourceAllocator);
+		m_frameRingAllocator.create(&m_deviceContext, &m_resourceAllocator);
 		m_pipelineLibrary.create(pipelineLibraryFileName, &m_deviceContext);
 
 		m_context = { .deviceContext = &m_deviceContext,
 					  .resourceAllocator = &m_resourceAllocator,
 					  .descriptorSetAllocator = &m_descriptorSetAllocator,
 					  .transferManager = &m_transferManager,
+					  .frameRingAllocator = &m_frameRingAllocator,
 					  .pipelineLibrary = &m_pipelineLibrary,
 					  .targetSurface = &m_renderTargetSurface };
 		m_framegraphContext.create(m_context);
@@ -72,6 +74,8 @@ namespace vanadium::graphics {
 		vkWaitForFences(m_deviceContext.device(), 1, &m_deviceContext.frameCompletionFence(m_frameIndex), VK_TRUE,
 						UINT64_MAX);
 		m_resourceAllocator.setFrameIndex(m_frameIndex);
+		m_resourceAllocator.updateMemoryBudget();
+		m_frameRingAllocator.setFrameIndex(m_frameIndex);
 
 		if (m_surface.swapchainDirtyFlag() || m_framegraphContext.swapchainDirtyFlag()) {
 			m_surface.createSwapchain(m_deviceContext.physicalDevice(), m_deviceContext.device(),
@@ -92,15 +96,29 @@ namespace vanadium::graphics {
 
 			VkCommandBuffer graphicsCommandBuffer = m_framegraphContext.recordFrame(m_frameIndex);
 
-			VkCommandBuffer commandBuffers[2] = { m_transferManager.recordTransfers(m_frameIndex),
-												  graphicsCommandBuffer };
-
-			VkPipelineStageFlags waitFlags = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+			m_frameRingAllocator.flush();
+
+			VkCommandBuffer transferCommandBuffer = m_transferManager.recordTransfers(m_frameIndex);
+			VkCommandBuffer commandBuffers[3] = { transferCommandBuffer, graphicsCommandBuffer,
+												  m_transferManager.recordReadbacks(m_frameIndex) };
+
+			// async transfers finalized before the CPU saw them finish are waited for on the GPU
+			VkSemaphore waitSemaphores[2] = { m_surface.acquireSemaphore(m_frameIndex),
+											  m_transferManager.asyncTransferSemaphore() };
+			VkPipelineStageFlags waitFlags[2] = { VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+												  VK_PIPELINE_STAGE_ALL_COMMANDS_BIT };
+			uint64_t waitValues[2] = { 0, m_transferManager.transferWaitValue() };
+			VkTimelineSemaphoreSubmitInfoKHR timelineSubmitInfo = {
+				.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR,
+				.waitSemaphoreValueCount = 2,
+				.pWaitSemaphoreValues = waitValues
+			};
 			VkSubmitInfo submitInfo = { .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-										.waitSemaphoreCount = 1,
-										.pWaitSemaphores = &m_surface.acquireSemaphore(m_frameIndex),
-										.pWaitDstStageMask = &waitFlags,
-										.commandBufferCount = 2,
+										.pNext = waitValues[1] ? &timelineSubmitInfo : nullptr,
+										.waitSemaphoreCount = waitValues[1] ? 2U : 1U,
+										.pWaitSemaphores = waitSemaphores,
+										.pWaitDstStageMask = waitFlags,
+										.commandBufferCount = 3,
 										.pCommandBuffers = commandBuffers,
 										.signalSemaphoreCount = 1,
 										.pSignalSemaphores = &m_surface.presentSemaphore(m_frameIndex) };
@@ -125,6 +143,7 @@ namespace vanadium::graphics {
 	GraphicsSubsystem::~GraphicsSubsystem() {
 		m_pipelineLibrary.destroy();
 		m_transferManager.destroy();
+		m_frameRingAllocator.destroy();
 		m_descriptorSetAllocator.destroy();
 		m_resourceAllocator.destroy();
 		m_renderTargetSurface.destroy();
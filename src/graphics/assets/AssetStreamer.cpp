@@ -23,8 +23,10 @@ namespace vanadium::graphics {
 		m_resourceAllocator = resourceAllocator;
 		m_transferManager = transferManager;
 
-		m_bufferStreamPool = resourceAllocator->createBufferBlock(m_bufferPoolSize, {}, { .deviceLocal = true }, false);
-		m_imageStreamPool = resourceAllocator->createImageBlock(m_imagePoolSize, {}, { .deviceLocal = true });
+		m_bufferStreamPool = resourceAllocator->createBufferBlock(m_bufferPoolSize, {}, { .deviceLocal = true }, false,
+																  MemoryPriority::Low);
+		m_imageStreamPool =
+			resourceAllocator->createImageBlock(m_imagePoolSize, {}, { .deviceLocal = true }, MemoryPriority::Low);
 	}
 
 	// TODO: evict unused stuff if new buffer allocation fails
@@ -54,7 +56,7 @@ namespace vanadium::graphics {
 					m_bufferResourceStates[id].loadingTransferHandle = m_transferManager->createAsyncBufferTransfer(
 						m_library->mesh(id).data, m_library->mesh(id).dataSize, m_bufferResourceStates[id].loadedHandle,
 						0, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
-						VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+						VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, TransferPriority::Low);
 					m_bufferResourceStates[id].residency = ResourceResidency::Loading;
 					return false;
 				}
@@ -99,7 +101,7 @@ namespace vanadium::graphics {
 												.layerCount = 1 },
 						  .imageExtent = { .width = image.width, .height = image.height, .depth = 1 } },
 						VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
-						VK_ACCESS_SHADER_READ_BIT);
+						VK_ACCESS_SHADER_READ_BIT, TransferPriority::Low);
 					return false;
 				}
 				break;
@@ -110,13 +110,15 @@ namespace vanadium::graphics {
 			if (m_images[handle].resourceHandle == ~0U)
 				createImage(handle);
 		}
-
+		// transient images declare their views on creation
 		for (auto& node : m_nodes) {
 			for (auto& infos : node.resourceViewInfos) {
-				for (auto& info : infos.second) {
-					m_context.resourceAllocator->requestImageView(m_images[infos.first].resourceHandle, info);
-				}
+				if (m_images[infos.first].isImported)
+					declareImageViews(infos.first);
 			}
+		}
+
+		for (auto& node : m_nodes) {
 			for (auto& info : node.swapchainResourceViewInfos) {
 				m_context.targetSurface->addRequestedView(info);
 			}
@@ -321,6 +323,8 @@ namespace vanadium::graphics {
 
 	void FramegraphContext::invalidateImage(FramegraphImageHandle handle, ImageResourceHandle newHandle) {
 		m_images[handle].resourceHandle = newHandle;
+		if (newHandle != ~0U)
+			declareImageViews(handle);
 	}
 
 	FramegraphBufferResource FramegraphContext::bufferResource(FramegraphBufferHandle handle) const {
@@ -386,8 +390,7 @@ namespace vanadium::graphics {
 			printf("invalid node for dependency!\n");
 			return VK_NULL_HANDLE;
 		}
-		return m_context.resourceAllocator->requestImageView(m_images[handle].resourceHandle,
-															 nodeIterator->resourceViewInfos[handle][index]);
+		return m_context.resourceAllocator->imageView(nodeIterator->resourceViewHandles[handle][index]);
 	}
 
 	VkImageView FramegraphContext::targetImageView(FramegraphNode* node, uint32_t index) {
@@ -452,15 +455,14 @@ namespace vanadium::graphics {
 
 			nodeContext.resourceImageViews.clear();
 			nodeContext.targetImageViews.clear();
-			for (auto& viewInfos : node.resourceViewInfos) {
+			for (auto& viewHandles : node.resourceViewHandles) {
 				std::vector<VkImageView> views;
-				views.reserve(viewInfos.second.size());
-				for (auto& info : viewInfos.second) {
-					views.push_back(
-						m_context.resourceAllocator->requestImageView(m_images[viewInfos.first].resourceHandle, info));
+				views.reserve(viewHandles.second.size());
+				for (auto viewHandle : viewHandles.second) {
+					views.push_back(m_context.resourceAllocator->imageView(viewHandle));
 				}
 				nodeContext.resourceImageViews.insert(
-					robin_hood::pair<FramegraphImageHandle, std::vector<VkImageView>>(viewInfos.first, views));
+					robin_hood::pair<FramegraphImageHandle, std::vector<VkImageView>>(viewHandles.first, views));
 			}
 
 			if (!node.swapchainResourceViewInfos.empty()) {
@@ -539,8 +541,8 @@ namespace vanadium::graphics {
 										  .size = parameters.size,
 										  .usage = usage,
 										  .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
-		m_buffers[handle].resourceHandle =
-			m_context.resourceAllocator->createBuffer(createInfo, {}, { .deviceLocal = true }, false);
+		m_buffers[handle].resourceHandle = m_context.resourceAllocator->createBuffer(
+			createInfo, {}, { .deviceLocal = true }, false, MemoryPriority::High);
 	}
 
 	void FramegraphContext::createImage(FramegraphImageHandle handle) {
@@ -563,7 +565,23 @@ namespace vanadium::graphics {
 			createInfo.extent.height = m_context.targetSurface->properties().height;
 		}
 		m_images[handle].resourceHandle =
-			m_context.resourceAllocator->createImage(createInfo, {}, { .deviceLocal = true });
+			m_context.resourceAllocator->createImage(createInfo, {}, { .deviceLocal = true }, MemoryPriority::High);
+		declareImageViews(handle);
+	}
+
+	void FramegraphContext::declareImageViews(FramegraphImageHandle handle) {
+		for (auto& node : m_nodes) {
+			auto infoIterator = node.resourceViewInfos.find(handle);
+			if (infoIterator == node.resourceViewInfos.end())
+				continue;
+			std::vector<ImageViewHandle> viewHandles;
+			viewHandles.reserve(infoIterator->second.size());
+			for (auto& info : infoIterator->second) {
+				viewHandles.push_back(
+					m_context.resourceAllocator->declareImageView(m_images[handle].resourceHandle, info));
+			}
+			node.resourceViewHandles[handle] = std::move(viewHandles);
+		}
 	}
 
 	void FramegraphContext::updateDependencyInfo() {
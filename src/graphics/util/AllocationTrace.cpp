@@ -0,0 +1,91 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <graphics/util/AllocationTrace.hpp>
+#include <string>
+
+namespace vanadium::graphics {
+
+	template <typename T> void writeToStream(std::ofstream& stream, const T* data, size_t count = 1) {
+		stream.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(sizeof(T) * count));
+	}
+
+	template <typename T> bool readFromStream(std::ifstream& stream, T* data, size_t count = 1) {
+		stream.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(sizeof(T) * count));
+		return stream.gcount() == static_cast<std::streamsize>(sizeof(T) * count);
+	}
+
+	bool AllocationTraceRecorder::start(const std::string_view& fileName, AllocationTraceHeader header,
+										const std::vector<AllocationTraceMemoryType>& memoryTypes,
+										const std::vector<uint64_t>& heapBudgets) {
+		stop();
+
+		m_stream = std::ofstream(std::string(fileName), std::ios_base::binary | std::ios_base::trunc);
+		if (!m_stream.is_open())
+			return false;
+
+		header.magic = allocationTraceMagicNumber;
+		header.version = allocationTraceVersion;
+		header.memoryTypeCount = static_cast<uint32_t>(memoryTypes.size());
+		header.heapCount = static_cast<uint32_t>(heapBudgets.size());
+		writeToStream(m_stream, &header);
+		writeToStream(m_stream, memoryTypes.data(), memoryTypes.size());
+		writeToStream(m_stream, heapBudgets.data(), heapBudgets.size());
+
+		m_startTime = std::chrono::steady_clock::now();
+		m_recording = true;
+		return true;
+	}
+
+	void AllocationTraceRecorder::stop() {
+		if (!m_recording)
+			return;
+		m_stream.close();
+		m_recording = false;
+	}
+
+	void AllocationTraceRecorder::record(AllocationTraceEvent event) {
+		event.timestamp = static_cast<uint64_t>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_startTime)
+				.count());
+		writeToStream(m_stream, &event);
+	}
+
+	std::optional<AllocationTrace> readAllocationTrace(const std::string_view& fileName) {
+		std::ifstream stream = std::ifstream(std::string(fileName), std::ios_base::binary);
+		if (!stream.is_open())
+			return std::nullopt;
+
+		AllocationTrace trace;
+		if (!readFromStream(stream, &trace.header) || trace.header.magic != allocationTraceMagicNumber ||
+			trace.header.version != allocationTraceVersion)
+			return std::nullopt;
+
+		trace.memoryTypes.resize(trace.header.memoryTypeCount);
+		trace.heapBudgets.resize(trace.header.heapCount);
+		if (!readFromStream(stream, trace.memoryTypes.data(), trace.memoryTypes.size()) ||
+			!readFromStream(stream, trace.heapBudgets.data(), trace.heapBudgets.size()))
+			return std::nullopt;
+
+		AllocationTraceEvent event;
+		while (readFromStream(stream, &event)) {
+			trace.events.push_back(event);
+		}
+		// a truncated trailing event is dropped, the capture may have been cut off by a crash
+		return trace;
+	}
+
+} // namespace vanadium::graphics
@@ -0,0 +1,199 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <graphics/util/AllocatorStatistics.hpp>
+
+namespace vanadium::graphics {
+
+	void accumulateStatistics(MemoryStatistics& statistics, const MemoryBlockStatistics& blockStatistics) {
+		++statistics.blockCount;
+		statistics.blockSize += blockStatistics.size;
+		statistics.usedSize += blockStatistics.usedSize;
+		statistics.largestFreeRange = std::max(statistics.largestFreeRange, blockStatistics.largestFreeRange);
+		statistics.freeRangeCount += blockStatistics.freeRangeCount;
+		statistics.allocationCount += blockStatistics.allocationCount;
+		for (size_t i = 0; i < allocationSizeClassCount; ++i) {
+			statistics.allocationSizeClassCounts[i] += blockStatistics.allocationSizeClassCounts[i];
+		}
+	}
+
+	// Fraction of free memory that is not part of the largest free range.
+	double fragmentation(VkDeviceSize freeSize, VkDeviceSize largestFreeRange) {
+		if (!freeSize)
+			return 0.0;
+		return 1.0 - static_cast<double>(largestFreeRange) / static_cast<double>(freeSize);
+	}
+
+	void appendKey(std::string& json, const std::string_view& key) {
+		json += '"';
+		json += key;
+		json += "\": ";
+	}
+
+	void appendValue(std::string& json, const std::string_view& key, uint64_t value) {
+		appendKey(json, key);
+		json += std::to_string(value);
+	}
+
+	void appendValue(std::string& json, const std::string_view& key, double value) {
+		appendKey(json, key);
+		json += std::to_string(value);
+	}
+
+	void appendValue(std::string& json, const std::string_view& key, bool value) {
+		appendKey(json, key);
+		json += value ? "true" : "false";
+	}
+
+	void appendStatistics(std::string& json, const MemoryStatistics& statistics) {
+		json += "{ ";
+		appendValue(json, "blockCount", uint64_t{ statistics.blockCount });
+		json += ", ";
+		appendValue(json, "blockBytes", uint64_t{ statistics.blockSize });
+		json += ", ";
+		appendValue(json, "usedBytes", uint64_t{ statistics.usedSize });
+		json += ", ";
+		appendValue(json, "freeBytes", uint64_t{ statistics.blockSize - statistics.usedSize });
+		json += ", ";
+		appendValue(json, "largestFreeRange", uint64_t{ statistics.largestFreeRange });
+		json += ", ";
+		appendValue(json, "freeRangeCount", uint64_t{ statistics.freeRangeCount });
+		json += ", ";
+		appendValue(json, "fragmentation",
+					fragmentation(statistics.blockSize - statistics.usedSize, statistics.largestFreeRange));
+		json += ", ";
+		appendValue(json, "allocationCount", uint64_t{ statistics.allocationCount });
+		json += ", ";
+		// keyed by the lower bound of each size class in bytes
+		appendKey(json, "allocationSizeClasses");
+		json += "{ ";
+		for (size_t i = 0; i < allocationSizeClassCount; ++i) {
+			if (i)
+				json += ", ";
+			appendValue(json, std::to_string(i ? 1ULL << (allocationSizeClassMinLog2 - 1 + i) : 0),
+						uint64_t{ statistics.allocationSizeClassCounts[i] });
+		}
+		json += " } }";
+	}
+
+	void appendMemoryPropertyFlags(std::string& json, VkMemoryPropertyFlags flags) {
+		constexpr std::pair<VkMemoryPropertyFlags, const char*> flagNames[] = {
+			{ VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, "DEVICE_LOCAL" },
+			{ VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, "HOST_VISIBLE" },
+			{ VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, "HOST_COHERENT" },
+			{ VK_MEMORY_PROPERTY_HOST_CACHED_BIT, "HOST_CACHED" },
+			{ VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT, "LAZILY_ALLOCATED" },
+			{ VK_MEMORY_PROPERTY_PROTECTED_BIT, "PROTECTED" }
+		};
+
+		appendKey(json, "flags");
+		json += "[";
+		bool first = true;
+		for (auto& [flag, name] : flagNames) {
+			if (!(flags & flag))
+				continue;
+			json += first ? " \"" : ", \"";
+			json += name;
+			json += '"';
+			first = false;
+		}
+		json += first ? "]" : " ]";
+	}
+
+	std::string serializeAllocatorStatistics(const AllocatorStatistics& statistics) {
+		std::string json = "{\n\t";
+		appendValue(json, "bufferCount", uint64_t{ statistics.bufferCount });
+		json += ",\n\t";
+		appendValue(json, "imageCount", uint64_t{ statistics.imageCount });
+		json += ",\n\t";
+
+		appendKey(json, "heaps");
+		json += "[";
+		for (size_t i = 0; i < statistics.heaps.size(); ++i) {
+			auto& heap = statistics.heaps[i];
+			json += i ? ",\n\t\t{ " : "\n\t\t{ ";
+			appendValue(json, "index", uint64_t{ i });
+			json += ", ";
+			appendValue(json, "size", uint64_t{ heap.size });
+			json += ", ";
+			appendValue(json, "budget", uint64_t{ heap.budget });
+			json += ", ";
+			appendValue(json, "usage", uint64_t{ heap.usage });
+			json += ", ";
+			appendValue(json, "remainingBudget", uint64_t{ heap.remainingBudget });
+			json += ", ";
+			appendKey(json, "statistics");
+			appendStatistics(json, heap.total);
+			json += " }";
+		}
+		json += "\n\t],\n\t";
+
+		appendKey(json, "memoryTypes");
+		json += "[";
+		for (size_t i = 0; i < statistics.memoryTypes.size(); ++i) {
+			auto& type = statistics.memoryTypes[i];
+			json += i ? ",\n\t\t{ " : "\n\t\t{ ";
+			appendValue(json, "index", uint64_t{ i });
+			json += ", ";
+			appendValue(json, "heapIndex", uint64_t{ type.heapIndex });
+			json += ", ";
+			appendMemoryPropertyFlags(json, type.properties);
+			json += ", ";
+			appendKey(json, "statistics");
+			appendStatistics(json, type.total);
+			json += " }";
+		}
+		json += "\n\t],\n\t";
+
+		appendKey(json, "customBlocks");
+		appendStatistics(json, statistics.customBlocks);
+
+		if (!statistics.blocks.empty()) {
+			json += ",\n\t";
+			appendKey(json, "blocks");
+			json += "[";
+			for (size_t i = 0; i < statistics.blocks.size(); ++i) {
+				auto& block = statistics.blocks[i];
+				json += i ? ",\n\t\t{ " : "\n\t\t{ ";
+				appendValue(json, "memoryType", uint64_t{ block.typeIndex });
+				json += ", ";
+				appendValue(json, "image", block.isImageBlock);
+				json += ", ";
+				appendValue(json, "custom", block.isCustomBlock);
+				json += ", ";
+				appendValue(json, "dedicated", block.isDedicatedBlock);
+				json += ", ";
+				appendValue(json, "size", uint64_t{ block.size });
+				json += ", ";
+				appendValue(json, "usedBytes", uint64_t{ block.usedSize });
+				json += ", ";
+				appendValue(json, "largestFreeRange", uint64_t{ block.largestFreeRange });
+				json += ", ";
+				appendValue(json, "freeRangeCount", uint64_t{ block.freeRangeCount });
+				json += ", ";
+				appendValue(json, "fragmentation", fragmentation(block.size - block.usedSize, block.largestFreeRange));
+				json += ", ";
+				appendValue(json, "allocationCount", uint64_t{ block.allocationCount });
+				json += " }";
+			}
+			json += "\n\t]";
+		}
+		json += "\n}\n";
+		return json;
+	}
+
+} // namespace vanadium::graphics
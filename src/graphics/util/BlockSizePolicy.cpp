@@ -0,0 +1,50 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <graphics/util/BlockSizePolicy.hpp>
+
+namespace vanadium::graphics {
+	BlockSizer::BlockSizer(const BlockSizePolicy& policy, VkDeviceSize heapSize) : m_policy(policy) {
+		auto heapRelativeSize = static_cast<VkDeviceSize>(static_cast<double>(heapSize) * policy.maxHeapFraction);
+		m_maxBlockSize = std::max(std::min(policy.maxBlockSize, heapRelativeSize), policy.initialBlockSize);
+		m_currentBlockSize = policy.initialBlockSize;
+	}
+
+	VkDeviceSize BlockSizer::nextBlockSize(VkDeviceSize minSize) {
+		VkDeviceSize size = std::max(m_currentBlockSize, minSize);
+		auto grownSize = static_cast<VkDeviceSize>(static_cast<double>(m_currentBlockSize) * m_policy.growthFactor);
+		m_currentBlockSize = std::clamp(grownSize, m_policy.initialBlockSize, m_maxBlockSize);
+		m_pressure += static_cast<double>(size);
+		return size;
+	}
+
+	void BlockSizer::decayPressure() { m_pressure *= m_policy.pressureDecay; }
+
+	bool BlockSizer::shouldReleaseEmptyBlock(VkDeviceSize blockSize, VkDeviceSize retainedSize) {
+		// blocks sized for a single big allocation are unlikely to be reused
+		if (blockSize > m_maxBlockSize)
+			return true;
+		auto allowedSize =
+			std::max(static_cast<double>(m_policy.minRetainedSize), m_pressure * m_policy.pressureRetention);
+		if (static_cast<double>(retainedSize + blockSize) <= allowedSize)
+			return false;
+
+		auto shrunkSize = static_cast<VkDeviceSize>(static_cast<double>(m_currentBlockSize) / m_policy.growthFactor);
+		m_currentBlockSize = std::clamp(shrunkSize, m_policy.initialBlockSize, m_maxBlockSize);
+		return true;
+	}
+} // namespace vanadium::graphics
@@ -0,0 +1,100 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <graphics/helper/ErrorHelper.hpp>
+#include <graphics/util/FrameRingAllocator.hpp>
+#include <volk.h>
+
+namespace vanadium::graphics {
+
+	void FrameRingAllocator::create(DeviceContext* context, GPUResourceAllocator* allocator,
+									VkDeviceSize regionSize) {
+		m_context = context;
+		m_resourceAllocator = allocator;
+
+		// every region starts at an offset that is valid for any kind of binding and for flushing
+		const VkPhysicalDeviceLimits& limits = m_context->properties().limits;
+		VkDeviceSize regionAlignment =
+			std::max({ limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment,
+					   limits.minTexelBufferOffsetAlignment, limits.nonCoherentAtomSize });
+		m_regionSize = roundUpAligned(regionSize, regionAlignment);
+
+		VkBufferUsageFlags usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+								   VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+								   VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		VkBufferCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+										  .size = m_regionSize * frameInFlightCount,
+										  .usage = usage,
+										  .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+		m_buffer = m_resourceAllocator->createBuffer(createInfo, { .hostVisible = true },
+													 { .deviceLocal = true, .hostCoherent = true }, true,
+													 MemoryPriority::High);
+		assertFatal(m_buffer != ~0U, "FrameRingAllocator: Couldn't allocate the ring buffer!\n");
+
+		m_nativeBuffer = m_resourceAllocator->nativeBufferHandle(m_buffer);
+		m_mappedData = static_cast<unsigned char*>(m_resourceAllocator->mappedBufferData(m_buffer));
+		m_isCoherent = m_resourceAllocator->bufferMemoryCapabilities(m_buffer).hostCoherent;
+	}
+
+	std::optional<FrameRingAllocation> FrameRingAllocator::allocate(VkDeviceSize size, VkDeviceSize alignment) {
+		VkDeviceSize offset = m_regionOffset.load(std::memory_order_relaxed);
+		VkDeviceSize alignedOffset;
+		do {
+			alignedOffset = roundUpAligned(offset, alignment);
+			if (alignedOffset + size > m_regionSize)
+				return std::nullopt;
+		} while (!m_regionOffset.compare_exchange_weak(offset, alignedOffset + size, std::memory_order_relaxed));
+
+		VkDeviceSize bufferOffset = m_frameIndex * m_regionSize + alignedOffset;
+		return FrameRingAllocation{ .data = m_mappedData + bufferOffset,
+									.buffer = m_nativeBuffer,
+									.offset = bufferOffset };
+	}
+
+	void FrameRingAllocator::setFrameIndex(uint32_t frameIndex) {
+		m_regionUsedSizes[m_frameIndex] = m_regionOffset.load(std::memory_order_relaxed);
+		m_frameIndex = frameIndex;
+		// if the frame is still in flight, its data stays and this frame appends to it
+		if (vkGetFenceStatus(m_context->device(), m_context->frameCompletionFence(frameIndex)) == VK_SUCCESS) {
+			m_regionUsedSizes[frameIndex] = 0;
+		}
+		m_regionOffset.store(m_regionUsedSizes[frameIndex], std::memory_order_relaxed);
+	}
+
+	void FrameRingAllocator::flush() {
+		VkDeviceSize usedSize = m_regionOffset.load(std::memory_order_relaxed);
+		if (m_isCoherent || !usedSize)
+			return;
+
+		VkDeviceSize atomSize = m_context->properties().limits.nonCoherentAtomSize;
+		VkDeviceSize regionStart = m_resourceAllocator->allocationRange(m_buffer).offset + m_frameIndex * m_regionSize;
+		VkDeviceSize flushStart = regionStart / atomSize * atomSize;
+		VkMappedMemoryRange flushRange = { .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+										   .memory = m_resourceAllocator->nativeMemoryHandle(m_buffer),
+										   .offset = flushStart,
+										   .size = roundUpAligned(regionStart + usedSize - flushStart, atomSize) };
+		verifyResult(vkFlushMappedMemoryRanges(m_context->device(), 1, &flushRange));
+	}
+
+	void FrameRingAllocator::destroy() {
+		if (m_buffer != ~0U) {
+			m_resourceAllocator->destroyBufferImmediately(m_buffer);
+			m_buffer = ~0U;
+		}
+	}
+
+} // namespace vanadium::graphics
@@ -14,14 +14,48 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
+#include <algorithm>
 #include <bit>
 #include <graphics/helper/ErrorHelper.hpp>
 #include <graphics/util/GPUResourceAllocator.hpp>
+#include <Log.hpp>
 #include <util/SharedLockGuard.hpp>
 #include <volk.h>
 
 namespace vanadium::graphics {
 
+	VkImageAspectFlags formatAspectFlags(VkFormat format) {
+		switch (format) {
+			case VK_FORMAT_D16_UNORM:
+			case VK_FORMAT_X8_D24_UNORM_PACK32:
+			case VK_FORMAT_D32_SFLOAT:
+				return VK_IMAGE_ASPECT_DEPTH_BIT;
+			case VK_FORMAT_S8_UINT:
+				return VK_IMAGE_ASPECT_STENCIL_BIT;
+			case VK_FORMAT_D16_UNORM_S8_UINT:
+			case VK_FORMAT_D24_UNORM_S8_UINT:
+			case VK_FORMAT_D32_SFLOAT_S8_UINT:
+				return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+			default:
+				return VK_IMAGE_ASPECT_COLOR_BIT;
+		}
+	}
+
+	float memoryPriorityValue(MemoryPriority priority) {
+		switch (priority) {
+			case MemoryPriority::Low:
+				return 0.2f;
+			case MemoryPriority::High:
+				return 1.0f;
+			default:
+				return 0.5f;
+		}
+	}
+
+	VkDeviceSize remainingHeapBudget(VkDeviceSize budget, VkDeviceSize usage) {
+		return budget > usage ? budget - usage : 0;
+	}
+
 	void GPUResourceAllocator::create(DeviceContext* gpuContext) {
 		m_bufferFreeList.resize(frameInFlightCount);
 		m_imageFreeList.resize(frameInFlightCount);
@@ -39,9 +73,16 @@ namespace vanadium::graphics {
 			vkGetPhysicalDeviceMemoryProperties2KHR(gpuContext->physicalDevice(), &memoryProperties2);
 			m_memoryTypes.resize(memoryProperties2.memoryProperties.memoryTypeCount);
 			m_heapBudgets.resize(memoryProperties2.memoryProperties.memoryHeapCount);
+			m_heapSizes.resize(memoryProperties2.memoryProperties.memoryHeapCount);
+			m_reportedHeapBudgets.resize(memoryProperties2.memoryProperties.memoryHeapCount);
+			m_reportedHeapUsages.resize(memoryProperties2.memoryProperties.memoryHeapCount);
 
 			for (uint32_t i = 0; i < memoryProperties2.memoryProperties.memoryHeapCount; ++i) {
-				m_heapBudgets[i] = memoryBudgetProperties.heapBudget[i];
+				m_heapBudgets[i] = remainingHeapBudget(memoryBudgetProperties.heapBudget[i],
+													   memoryBudgetProperties.heapUsage[i]);
+				m_heapSizes[i] = memoryProperties2.memoryProperties.memoryHeaps[i].size;
+				m_reportedHeapBudgets[i] = memoryBudgetProperties.heapBudget[i];
+				m_reportedHeapUsages[i] = memoryBudgetProperties.heapUsage[i];
 			}
 			for (uint32_t i = 0; i < memoryProperties2.memoryProperties.memoryTypeCount; ++i) {
 				m_memoryTypes[i].properties = memoryProperties2.memoryProperties.memoryTypes[i].propertyFlags;
@@ -53,9 +94,11 @@ namespace vanadium::graphics {
 			vkGetPhysicalDeviceMemoryProperties(gpuContext->physicalDevice(), &memoryProperties);
 			m_memoryTypes.resize(memoryProperties.memoryTypeCount);
 			m_heapBudgets.resize(memoryProperties.memoryHeapCount);
+			m_heapSizes.resize(memoryProperties.memoryHeapCount);
 
 			for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; ++i) {
 				m_heapBudgets[i] = memoryProperties.memoryHeaps[i].size;
+				m_heapSizes[i] = memoryProperties.memoryHeaps[i].size;
 			}
 			for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i) {
 				m_memoryTypes[i].properties = memoryProperties.memoryTypes[i].propertyFlags;
@@ -63,119 +106,169 @@ namespace vanadium::graphics {
 			}
 		}
 
+		m_heapOverruns.resize(m_heapBudgets.size());
+		m_typeMutexes = std::vector<std::mutex>(m_memoryTypes.size());
+		for (auto& type : m_memoryTypes) {
+			type.blockSizer = BlockSizer(m_defaultBlockSizePolicy, m_heapSizes[type.heapIndex]);
+		}
+
 		VkPhysicalDeviceProperties properties;
 		vkGetPhysicalDeviceProperties(gpuContext->physicalDevice(), &properties);
 		m_bufferImageGranularity = properties.limits.bufferImageGranularity;
+		m_useMixedBlocks = m_bufferImageGranularity == 1;
+		m_suballocationAlignment = std::max({ properties.limits.minUniformBufferOffsetAlignment,
+											  properties.limits.minStorageBufferOffsetAlignment,
+											  properties.limits.minTexelBufferOffsetAlignment,
+											  static_cast<VkDeviceSize>(4) });
+
+		// memoryTypeBits only depends on flags and usage, not on the size of the buffer
+		VkBufferCreateInfo blockBufferCreateInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+													 .size = m_defaultBlockSizePolicy.initialBlockSize,
+													 .usage = suballocatedBufferUsage,
+													 .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+		VkBuffer blockBuffer;
+		verifyResult(vkCreateBuffer(gpuContext->device(), &blockBufferCreateInfo, nullptr, &blockBuffer));
+		VkMemoryRequirements blockBufferRequirements;
+		vkGetBufferMemoryRequirements(gpuContext->device(), blockBuffer, &blockBufferRequirements);
+		m_blockBufferMemoryTypeBits = blockBufferRequirements.memoryTypeBits;
+		vkDestroyBuffer(gpuContext->device(), blockBuffer, nullptr);
 
 		m_context = gpuContext;
 	}
 
 	BlockHandle GPUResourceAllocator::createBufferBlock(size_t size, MemoryCapabilities required,
-														MemoryCapabilities preferred, bool createMapped) {
-		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+														MemoryCapabilities preferred, bool createMapped,
+														MemoryPriority priority) {
+		auto lock = SharedLockGuard(m_accessMutex);
 		VkMemoryPropertyFlags requiredFlags = (required.deviceLocal ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT : 0) |
 											  (required.hostCoherent ? VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : 0) |
-											  ((required.hostVisible) ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : 0);
+											  ((required.hostVisible) ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : 0) |
+											  (required.hostCached ? VK_MEMORY_PROPERTY_HOST_CACHED_BIT : 0);
 		VkMemoryPropertyFlags preferredFlags = (preferred.deviceLocal ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT : 0) |
 											   (preferred.hostCoherent ? VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : 0) |
-											   (preferred.hostVisible ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : 0);
+											   (preferred.hostVisible ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : 0) |
+											   (preferred.hostCached ? VK_MEMORY_PROPERTY_HOST_CACHED_BIT : 0);
 
 		uint32_t typeIndex =
-			bestTypeIndex(requiredFlags, preferredFlags, { .size = 0, .memoryTypeBits = 0xFFFFFF }, false);
-		return allocateCustomBlock(typeIndex, size, createMapped, false);
+			bestTypeIndex(requiredFlags, preferredFlags, { .size = 0, .memoryTypeBits = 0xFFFFFF }, false,
+						  MemoryPriority::Default, false);
+		return allocateCustomBlock(typeIndex, size, createMapped, false, priority);
 	}
 
 	BlockHandle GPUResourceAllocator::createImageBlock(size_t size, MemoryCapabilities required,
-													   MemoryCapabilities preferred) {
-		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+													   MemoryCapabilities preferred, MemoryPriority priority) {
+		auto lock = SharedLockGuard(m_accessMutex);
 		VkMemoryPropertyFlags requiredFlags = (required.deviceLocal ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT : 0) |
 											  (required.hostCoherent ? VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : 0) |
-											  ((required.hostVisible) ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : 0);
+											  ((required.hostVisible) ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : 0) |
+											  (required.hostCached ? VK_MEMORY_PROPERTY_HOST_CACHED_BIT : 0);
 		VkMemoryPropertyFlags preferredFlags = (preferred.deviceLocal ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT : 0) |
 											   (preferred.hostCoherent ? VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : 0) |
-											   (preferred.hostVisible ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : 0);
+											   (preferred.hostVisible ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : 0) |
+											   (preferred.hostCached ? VK_MEMORY_PROPERTY_HOST_CACHED_BIT : 0);
 
 		uint32_t typeIndex =
-			bestTypeIndex(requiredFlags, preferredFlags, { .size = 0, .memoryTypeBits = 0xFFFFFF }, false);
-		return allocateCustomBlock(typeIndex, size, false, true);
+			bestTypeIndex(requiredFlags, preferredFlags, { .size = 0, .memoryTypeBits = 0xFFFFFF }, false,
+						  MemoryPriority::Default, false);
+		return allocateCustomBlock(typeIndex, size, false, true, priority);
 	}
 
 	BufferResourceHandle GPUResourceAllocator::createBuffer(const VkBufferCreateInfo& bufferCreateInfo,
 															MemoryCapabilities required, MemoryCapabilities preferred,
-															bool createMapped) {
-		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+															bool createMapped, MemoryPriority priority) {
+		auto lock = SharedLockGuard(m_accessMutex);
+		priority = effectivePriority(priority);
 		VkMemoryPropertyFlags requiredFlags = (required.deviceLocal ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT : 0) |
 											  (required.hostCoherent ? VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : 0) |
-											  (required.hostVisible ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : 0);
+											  (required.hostVisible ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : 0) |
+											  (required.hostCached ? VK_MEMORY_PROPERTY_HOST_CACHED_BIT : 0);
 		VkMemoryPropertyFlags preferredFlags = (preferred.deviceLocal ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT : 0) |
 											   (preferred.hostCoherent ? VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : 0) |
-											   (preferred.hostVisible ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : 0);
+											   (preferred.hostVisible ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : 0) |
+											   (preferred.hostCached ? VK_MEMORY_PROPERTY_HOST_CACHED_BIT : 0);
 
 		VkBuffer buffer;
 		verifyResult(vkCreateBuffer(m_context->device(), &bufferCreateInfo, nullptr, &buffer));
 
-		VkMemoryRequirements requirements;
-		vkGetBufferMemoryRequirements(m_context->device(), buffer, &requirements);
+		ResourceMemoryRequirements memoryRequirements = bufferMemoryRequirements(buffer);
+		VkMemoryRequirements& requirements = memoryRequirements.requirements;
 
-		uint32_t typeIndex = bestTypeIndex(requiredFlags, preferredFlags, requirements, createMapped);
+		uint32_t typeIndex = bestTypeIndex(requiredFlags, preferredFlags, requirements, createMapped, priority, true);
+		if (typeIndex == ~0U)
+			typeIndex = bestTypeIndex(requiredFlags, preferredFlags, requirements, createMapped, priority, false);
 
 		if (typeIndex == ~0U) {
 			vkDestroyBuffer(m_context->device(), buffer, nullptr);
 			return ~0U;
 		}
 
-		auto result = allocate(typeIndex, requirements.alignment, requirements.size, createMapped);
-		if (!result.has_value()) {
-			typeIndex = 0;
-			for (auto& type : m_memoryTypes) {
-				if ((type.properties & requiredFlags) != requiredFlags) {
-					++typeIndex;
-					continue;
-				}
-				result = allocate(typeIndex, requirements.alignment, requirements.size, createMapped);
-				if (result.has_value())
-					break;
-				++typeIndex;
-			}
-			--typeIndex;
-			if (!result.has_value()) {
+		std::optional<AllocationResult> result;
+		bool isDedicated = false;
+		if (memoryRequirements.prefersDedicated || exceedsDedicatedAllocationThreshold(typeIndex, requirements.size)) {
+			result = allocateDedicated(typeIndex, requirements.size, createMapped, buffer, VK_NULL_HANDLE, priority,
+									   memoryRequirements.requiresDedicated);
+			isDedicated = result.has_value();
+			if (!isDedicated && memoryRequirements.requiresDedicated) {
 				vkDestroyBuffer(m_context->device(), buffer, nullptr);
 				return ~0U;
 			}
 		}
+		if (!isDedicated)
+			result = allocateWithFallback(typeIndex, requiredFlags, requirements, createMapped, AllocationKind::Buffer,
+										  priority);
+		if (!result.has_value()) {
+			vkDestroyBuffer(m_context->device(), buffer, nullptr);
+			return ~0U;
+		}
 
 		BufferAllocation allocation = { .isMultipleBuffered = false,
+										.isDedicated = isDedicated,
 										.typeIndex = typeIndex,
 										.blockHandle = result.value().blockHandle,
 										.bufferContentRange = result.value().usableRange,
-										.allocationRange = result.value().allocationRange };
-		verifyResult(vkBindBufferMemory(m_context->device(), buffer,
-										m_memoryTypes[typeIndex].blocks[result.value().blockHandle].memoryHandle,
+										.allocationRange = result.value().allocationRange,
+										.capabilities = result.value().capabilities,
+										.memoryHandle = result.value().memoryHandle,
+										.blockMappedPointer = result.value().mappedPointer,
+										.cacheBucket = result.value().cacheBucket,
+										.slabIndex = result.value().slabIndex };
+		allocation.createInfo = bufferCreateInfo;
+		allocation.createInfo.pNext = nullptr;
+		allocation.createInfo.queueFamilyIndexCount = 0;
+		allocation.createInfo.pQueueFamilyIndices = nullptr;
+		verifyResult(vkBindBufferMemory(m_context->device(), buffer, result.value().memoryHandle,
 										result.value().usableRange.offset));
 		for (size_t i = 0; i < frameInFlightCount; ++i) {
 			allocation.buffers[i] = buffer;
 			if (createMapped) {
 				auto bufferStartPointer =
-					reinterpret_cast<uintptr_t>(
-						m_memoryTypes[typeIndex].blocks[result.value().blockHandle].mappedPointer) +
-					result.value().usableRange.offset;
+					reinterpret_cast<uintptr_t>(result.value().mappedPointer) + result.value().usableRange.offset;
 				allocation.mappedData[i] = reinterpret_cast<void*>(bufferStartPointer);
 			}
 		}
 
-		return m_buffers.addElement(allocation);
+		BufferResourceHandle handle = addBuffer(allocation);
+		recordTraceEvent(AllocationTraceEventType::CreateBuffer,
+						 (createMapped ? AllocationTraceFlagMapped : 0) |
+							 (isDedicated ? AllocationTraceFlagDedicated : 0),
+						 typeIndex, handle, requirements.size, requirements.alignment);
+		return handle;
 	}
 
 	BufferResourceHandle GPUResourceAllocator::createPerFrameBuffer(const VkBufferCreateInfo& bufferCreateInfo,
 																	MemoryCapabilities required,
-																	MemoryCapabilities preferred, bool createMapped) {
-		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+																	MemoryCapabilities preferred, bool createMapped,
+																	MemoryPriority priority) {
+		auto lock = SharedLockGuard(m_accessMutex);
+		priority = effectivePriority(priority);
 		VkMemoryPropertyFlags requiredFlags = (required.deviceLocal ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT : 0) |
 											  (required.hostCoherent ? VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : 0) |
-											  (required.hostVisible ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : 0);
+											  (required.hostVisible ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : 0) |
+											  (required.hostCached ? VK_MEMORY_PROPERTY_HOST_CACHED_BIT : 0);
 		VkMemoryPropertyFlags preferredFlags = (preferred.deviceLocal ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT : 0) |
 											   (preferred.hostCoherent ? VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : 0) |
-											   (preferred.hostVisible ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : 0);
+											   (preferred.hostVisible ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : 0) |
+											   (preferred.hostCached ? VK_MEMORY_PROPERTY_HOST_CACHED_BIT : 0);
 
 		VkBuffer buffer;
 		verifyResult(vkCreateBuffer(m_context->device(), &bufferCreateInfo, nullptr, &buffer));
@@ -188,73 +281,72 @@ namespace vanadium::graphics {
 
 		requirements.size = totalSize;
 
-		uint32_t typeIndex = bestTypeIndex(requiredFlags, preferredFlags, requirements, createMapped);
+		uint32_t typeIndex = bestTypeIndex(requiredFlags, preferredFlags, requirements, createMapped, priority, true);
+		if (typeIndex == ~0U)
+			typeIndex = bestTypeIndex(requiredFlags, preferredFlags, requirements, createMapped, priority, false);
 
 		if (typeIndex == ~0U) {
 			vkDestroyBuffer(m_context->device(), buffer, nullptr);
 			return ~0U;
 		}
 
-		auto result = allocate(typeIndex, requirements.alignment, totalSize, createMapped);
+		auto result = allocateWithFallback(typeIndex, requiredFlags, requirements, createMapped, AllocationKind::Buffer,
+										   priority);
 		if (!result.has_value()) {
-			typeIndex = 0;
-			for (auto& type : m_memoryTypes) {
-				if ((type.properties & requiredFlags) != requiredFlags) {
-					++typeIndex;
-					continue;
-				}
-				result = allocate(typeIndex, requirements.alignment, totalSize, createMapped);
-				if (result.has_value())
-					break;
-				++typeIndex;
-			}
-			--typeIndex;
-			if (!result.has_value()) {
-				vkDestroyBuffer(m_context->device(), buffer, nullptr);
-				return ~0U;
-			}
+			vkDestroyBuffer(m_context->device(), buffer, nullptr);
+			return ~0U;
 		}
 
 		BufferAllocation allocation = { .isMultipleBuffered = true,
 										.typeIndex = typeIndex,
 										.blockHandle = result.value().blockHandle,
 										.bufferContentRange = result.value().usableRange,
-										.allocationRange = result.value().allocationRange };
+										.allocationRange = result.value().allocationRange,
+										.capabilities = result.value().capabilities,
+										.memoryHandle = result.value().memoryHandle,
+										.blockMappedPointer = result.value().mappedPointer,
+										.cacheBucket = result.value().cacheBucket,
+										.slabIndex = result.value().slabIndex };
 		allocation.buffers[0] = buffer;
 		for (size_t i = 1; i < frameInFlightCount; ++i) {
 			verifyResult(vkCreateBuffer(m_context->device(), &bufferCreateInfo, nullptr, &allocation.buffers[i]));
 		}
 		for (size_t i = 0; i < frameInFlightCount; ++i) {
-			verifyResult(vkBindBufferMemory(m_context->device(), allocation.buffers[i],
-											m_memoryTypes[typeIndex].blocks[result.value().blockHandle].memoryHandle,
+			verifyResult(vkBindBufferMemory(m_context->device(), allocation.buffers[i], result.value().memoryHandle,
 											result.value().usableRange.offset + i * alignedSize));
 			if (createMapped) {
-				auto bufferStartPointer =
-					reinterpret_cast<uintptr_t>(
-						m_memoryTypes[typeIndex].blocks[result.value().blockHandle].mappedPointer) +
-					result.value().usableRange.offset + i * alignedSize;
+				auto bufferStartPointer = reinterpret_cast<uintptr_t>(result.value().mappedPointer) +
+										  result.value().usableRange.offset + i * alignedSize;
 				allocation.mappedData[i] = reinterpret_cast<void*>(bufferStartPointer);
 			}
 		}
 
-		return m_buffers.addElement(allocation);
+		BufferResourceHandle handle = addBuffer(allocation);
+		recordTraceEvent(AllocationTraceEventType::CreatePerFrameBuffer,
+						 createMapped ? AllocationTraceFlagMapped : 0, typeIndex, handle, totalSize,
+						 requirements.alignment);
+		return handle;
 	}
 
 	BufferResourceHandle GPUResourceAllocator::createBuffer(const VkBufferCreateInfo& bufferCreateInfo,
 															BlockHandle block, bool createMapped) {
-		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
-		if (createMapped && !m_customBufferBlocks[block].mappedPointer) {
-			return ~0U;
-		}
-
+		auto lock = SharedLockGuard(m_accessMutex);
 		VkBuffer buffer;
 		verifyResult(vkCreateBuffer(m_context->device(), &bufferCreateInfo, nullptr, &buffer));
 
 		VkMemoryRequirements requirements;
 		vkGetBufferMemoryRequirements(m_context->device(), buffer, &requirements);
 
-		auto result = allocateInBlock(block, m_customBufferBlocks[block], requirements.alignment, requirements.size,
-									  createMapped);
+		std::optional<AllocationResult> result;
+		{
+			auto blockLock = std::lock_guard<std::mutex>(m_customBlockMutex);
+			if (createMapped && !m_customBufferBlocks[block].mappedPointer) {
+				vkDestroyBuffer(m_context->device(), buffer, nullptr);
+				return ~0U;
+			}
+			result = allocateInBlock(block, m_customBufferBlocks[block], requirements.alignment, requirements.size,
+									 createMapped);
+		}
 		if (!result.has_value()) {
 			return ~0U;
 		} else {
@@ -262,62 +354,175 @@ namespace vanadium::graphics {
 											.typeIndex = ~0U,
 											.blockHandle = result.value().blockHandle,
 											.bufferContentRange = result.value().usableRange,
-											.allocationRange = result.value().allocationRange };
-			verifyResult(vkBindBufferMemory(m_context->device(), buffer, m_customBufferBlocks[block].memoryHandle,
+											.allocationRange = result.value().allocationRange,
+											.capabilities = result.value().capabilities,
+											.memoryHandle = result.value().memoryHandle,
+											.blockMappedPointer = result.value().mappedPointer };
+			verifyResult(vkBindBufferMemory(m_context->device(), buffer, result.value().memoryHandle,
 											result.value().usableRange.offset));
 			for (size_t i = 0; i < frameInFlightCount; ++i) {
 				allocation.buffers[i] = buffer;
 				if (createMapped) {
-					auto bufferStartPointer = reinterpret_cast<uintptr_t>(m_customBufferBlocks[block].mappedPointer) +
-											  result.value().usableRange.offset;
+					auto bufferStartPointer =
+						reinterpret_cast<uintptr_t>(result.value().mappedPointer) + result.value().usableRange.offset;
 					allocation.mappedData[i] = reinterpret_cast<void*>(bufferStartPointer);
 				}
 			}
-			return m_buffers.addElement(allocation);
+			BufferResourceHandle handle = addBuffer(allocation);
+			recordTraceEvent(AllocationTraceEventType::CreateBuffer,
+							 AllocationTraceFlagCustomBlock | (createMapped ? AllocationTraceFlagMapped : 0), ~0U,
+							 handle, requirements.size, requirements.alignment);
+			return handle;
 		}
 	}
 
-	MemoryCapabilities GPUResourceAllocator::bufferMemoryCapabilities(BufferResourceHandle handle) {
+	BufferResourceHandle GPUResourceAllocator::suballocateBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+																 MemoryCapabilities required,
+																 MemoryCapabilities preferred, bool createMapped,
+																 MemoryPriority priority, bool isPerFrame) {
+		assertFatal((usage & suballocatedBufferUsage) == usage,
+					"GPUResourceAllocator: Buffer usage not supported by suballocated buffers!");
 		auto lock = SharedLockGuard(m_accessMutex);
-		return m_memoryTypes[m_buffers[handle].typeIndex].blocks[m_buffers[handle].blockHandle].capabilities;
+		priority = effectivePriority(priority);
+		VkMemoryPropertyFlags requiredFlags = (required.deviceLocal ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT : 0) |
+											  (required.hostCoherent ? VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : 0) |
+											  (required.hostVisible ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : 0) |
+											  (required.hostCached ? VK_MEMORY_PROPERTY_HOST_CACHED_BIT : 0);
+		VkMemoryPropertyFlags preferredFlags = (preferred.deviceLocal ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT : 0) |
+											   (preferred.hostCoherent ? VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : 0) |
+											   (preferred.hostVisible ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : 0) |
+											   (preferred.hostCached ? VK_MEMORY_PROPERTY_HOST_CACHED_BIT : 0);
+
+		VkDeviceSize alignedSize = roundUpAligned(size, m_suballocationAlignment);
+		VkMemoryRequirements requirements = { .size = isPerFrame ? (frameInFlightCount - 1) * alignedSize + size : size,
+											  .alignment = m_suballocationAlignment,
+											  .memoryTypeBits = m_blockBufferMemoryTypeBits };
+
+		uint32_t typeIndex = bestTypeIndex(requiredFlags, preferredFlags, requirements, createMapped, priority, true);
+		if (typeIndex == ~0U)
+			typeIndex = bestTypeIndex(requiredFlags, preferredFlags, requirements, createMapped, priority, false);
+		if (typeIndex == ~0U)
+			return ~0U;
+
+		auto result = allocateWithFallback(typeIndex, requiredFlags, requirements, createMapped,
+										   AllocationKind::SuballocatedBuffer, priority);
+		if (!result.has_value())
+			return ~0U;
+
+		BufferAllocation allocation = { .isMultipleBuffered = isPerFrame,
+										.isSuballocated = true,
+										.typeIndex = typeIndex,
+										.blockHandle = result.value().blockHandle,
+										.bufferContentRange = result.value().usableRange,
+										.allocationRange = result.value().allocationRange,
+										.capabilities = result.value().capabilities,
+										.memoryHandle = result.value().memoryHandle,
+										.blockMappedPointer = result.value().mappedPointer,
+										.cacheBucket = result.value().cacheBucket,
+										.slabIndex = result.value().slabIndex };
+		allocation.createInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+								  .size = size,
+								  .usage = usage,
+								  .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+		for (size_t i = 0; i < frameInFlightCount; ++i) {
+			allocation.buffers[i] = result.value().blockBuffer;
+			allocation.bufferOffsets[i] = result.value().usableRange.offset + (isPerFrame ? i * alignedSize : 0);
+			if (createMapped) {
+				auto bufferStartPointer =
+					reinterpret_cast<uintptr_t>(result.value().mappedPointer) + allocation.bufferOffsets[i];
+				allocation.mappedData[i] = reinterpret_cast<void*>(bufferStartPointer);
+			}
+		}
+
+		BufferResourceHandle handle = addBuffer(allocation);
+		recordTraceEvent(isPerFrame ? AllocationTraceEventType::CreatePerFrameBuffer
+									: AllocationTraceEventType::CreateBuffer,
+						 createMapped ? AllocationTraceFlagMapped : 0, typeIndex, handle, requirements.size,
+						 requirements.alignment);
+		return handle;
+	}
+
+	BufferResourceHandle GPUResourceAllocator::createSuballocatedBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
+																		MemoryCapabilities required,
+																		MemoryCapabilities preferred, bool createMapped,
+																		MemoryPriority priority) {
+		return suballocateBuffer(size, usage, required, preferred, createMapped, priority, false);
+	}
+
+	BufferResourceHandle GPUResourceAllocator::createSuballocatedPerFrameBuffer(VkDeviceSize size,
+																				VkBufferUsageFlags usage,
+																				MemoryCapabilities required,
+																				MemoryCapabilities preferred,
+																				bool createMapped,
+																				MemoryPriority priority) {
+		return suballocateBuffer(size, usage, required, preferred, createMapped, priority, true);
+	}
+
+	MemoryCapabilities GPUResourceAllocator::bufferMemoryCapabilities(BufferResourceHandle handle) {
+		auto lock = SharedLockGuard(m_resourceMutex);
+		return m_buffers[handle].capabilities;
 	}
 
 	VkDeviceMemory GPUResourceAllocator::nativeMemoryHandle(BufferResourceHandle handle) {
-		auto lock = SharedLockGuard(m_accessMutex);
-		return m_memoryTypes[m_buffers[handle].typeIndex].blocks[m_buffers[handle].blockHandle].memoryHandle;
+		auto lock = SharedLockGuard(m_resourceMutex);
+		return m_buffers[handle].memoryHandle;
 	}
 
 	MemoryRange GPUResourceAllocator::allocationRange(BufferResourceHandle handle) {
-		auto lock = SharedLockGuard(m_accessMutex);
+		auto lock = SharedLockGuard(m_resourceMutex);
 		return m_buffers[handle].bufferContentRange;
 	}
 
 	VkBuffer GPUResourceAllocator::nativeBufferHandle(BufferResourceHandle handle) {
-		auto lock = SharedLockGuard(m_accessMutex);
+		auto lock = SharedLockGuard(m_resourceMutex);
 		return m_buffers[handle].buffers[m_currentFrameIndex];
 	}
 
+	BufferView GPUResourceAllocator::bufferView(BufferResourceHandle handle) {
+		auto lock = SharedLockGuard(m_resourceMutex);
+		auto& allocation = m_buffers[handle];
+		if (allocation.isSuballocated)
+			return { .buffer = allocation.buffers[m_currentFrameIndex],
+					 .offset = allocation.bufferOffsets[m_currentFrameIndex],
+					 .size = allocation.createInfo.size };
+		else
+			return { .buffer = allocation.buffers[m_currentFrameIndex], .offset = 0, .size = VK_WHOLE_SIZE };
+	}
+
 	void* GPUResourceAllocator::mappedBufferData(BufferResourceHandle handle) {
-		auto lock = SharedLockGuard(m_accessMutex);
+		auto lock = SharedLockGuard(m_resourceMutex);
 		return m_buffers[handle].mappedData[m_currentFrameIndex];
 	}
 
 	void GPUResourceAllocator::destroyBuffer(BufferResourceHandle handle) {
-		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
-		auto& allocation = m_buffers[handle];
+		auto lock = SharedLockGuard(m_accessMutex);
+		BufferAllocation allocation = removeBuffer(handle);
+		recordTraceEvent(AllocationTraceEventType::DestroyBuffer,
+						 (allocation.typeIndex == ~0U ? AllocationTraceFlagCustomBlock : 0) |
+							 (allocation.isDedicated ? AllocationTraceFlagDedicated : 0),
+						 allocation.typeIndex, handle, allocation.allocationRange.size, 0);
+		if (allocation.isMovable)
+			--m_movableResourceCount;
+		auto freeListLock = std::lock_guard<std::mutex>(m_freeListMutex);
 		m_bufferFreeList[m_currentFrameIndex].push_back(allocation);
-		m_buffers.removeElement(handle);
 	}
 
 	void GPUResourceAllocator::destroyBufferImmediately(BufferResourceHandle handle) {
-		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
-		auto& allocation = m_buffers[handle];
+		auto lock = SharedLockGuard(m_accessMutex);
+		BufferAllocation allocation = removeBuffer(handle);
+		recordTraceEvent(AllocationTraceEventType::DestroyBufferImmediately,
+						 (allocation.typeIndex == ~0U ? AllocationTraceFlagCustomBlock : 0) |
+							 (allocation.isDedicated ? AllocationTraceFlagDedicated : 0),
+						 allocation.typeIndex, handle, allocation.allocationRange.size, 0);
+		if (allocation.isMovable)
+			--m_movableResourceCount;
 		destroyBufferImmediatelyUnsynchronized(allocation);
-		m_buffers.removeElement(handle);
 	}
 
 	void GPUResourceAllocator::destroyBufferImmediatelyUnsynchronized(const BufferAllocation& allocation) {
-		if (allocation.isMultipleBuffered) {
+		if (allocation.isSuballocated) {
+			// the block owns the VkBuffer
+		} else if (allocation.isMultipleBuffered) {
 			for (auto& buffer : allocation.buffers) {
 				vkDestroyBuffer(m_context->device(), buffer, nullptr);
 			}
@@ -325,18 +530,42 @@ namespace vanadium::graphics {
 			vkDestroyBuffer(m_context->device(), allocation.buffers[0], nullptr);
 		}
 
-		if (allocation.typeIndex != ~0U) {
+		if (allocation.isDedicated) {
+			freeDedicatedBlock(allocation.typeIndex, allocation.blockHandle, false);
+		} else if (allocation.cacheBucket != ~0ULL) {
+			AllocationResult range = {
+				.allocationRange = allocation.allocationRange,
+				.usableRange = allocation.bufferContentRange,
+				.blockHandle = allocation.blockHandle,
+				.memoryHandle = allocation.memoryHandle,
+				.capabilities = allocation.capabilities,
+				.mappedPointer = allocation.blockMappedPointer,
+				.blockBuffer = allocation.isSuballocated ? allocation.buffers[0] : VK_NULL_HANDLE,
+				.cacheBucket = allocation.cacheBucket,
+				.slabIndex = allocation.slabIndex
+			};
+			if (allocation.bypassesAllocationCache) {
+				auto typeLock = std::lock_guard<std::mutex>(m_typeMutexes[allocation.typeIndex]);
+				releaseCachedRange(allocation.typeIndex, allocation.cacheBucket, range);
+			} else {
+				freeCachedRange(allocation.cacheBucket, range);
+			}
+		} else if (allocation.typeIndex != ~0U) {
+			auto typeLock = std::lock_guard<std::mutex>(m_typeMutexes[allocation.typeIndex]);
 			freeInBlock(m_memoryTypes[allocation.typeIndex].blocks[allocation.blockHandle],
 						allocation.allocationRange.offset, allocation.allocationRange.size);
 		} else {
+			auto blockLock = std::lock_guard<std::mutex>(m_customBlockMutex);
 			freeInBlock(m_customBufferBlocks[allocation.blockHandle], allocation.allocationRange.offset,
 						allocation.allocationRange.size);
 		}
 	}
 
 	ImageResourceHandle GPUResourceAllocator::createImage(const VkImageCreateInfo& imageCreateInfo,
-														  MemoryCapabilities required, MemoryCapabilities preferred) {
-		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+														  MemoryCapabilities required, MemoryCapabilities preferred,
+														  MemoryPriority priority) {
+		auto lock = SharedLockGuard(m_accessMutex);
+		priority = effectivePriority(priority);
 		// clang-format off
 	VkMemoryPropertyFlags requiredFlags = (required.deviceLocal  ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT  : 0) | 
 										  (required.hostCoherent ? VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : 0) |
@@ -349,35 +578,39 @@ namespace vanadium::graphics {
 		VkImage image;
 		verifyResult(vkCreateImage(m_context->device(), &imageCreateInfo, nullptr, &image));
 
-		VkMemoryRequirements requirements;
-		vkGetImageMemoryRequirements(m_context->device(), image, &requirements);
+		ResourceMemoryRequirements memoryRequirements = imageMemoryRequirements(image);
+		VkMemoryRequirements& requirements = memoryRequirements.requirements;
 
-		uint32_t typeIndex = bestTypeIndex(requiredFlags, preferredFlags, requirements, false);
+		uint32_t typeIndex = bestTypeIndex(requiredFlags, preferredFlags, requirements, false, priority, true);
+		if (typeIndex == ~0U)
+			typeIndex = bestTypeIndex(requiredFlags, preferredFlags, requirements, false, priority, false);
 
 		if (typeIndex == ~0U) {
 			vkDestroyImage(m_context->device(), image, nullptr);
 			return ~0U;
 		}
 
-		auto result = allocateImage(typeIndex, requirements.alignment, requirements.size);
-		if (!result.has_value()) {
-			typeIndex = 0;
-			for (auto& type : m_memoryTypes) {
-				if ((type.properties & requiredFlags) != requiredFlags) {
-					++typeIndex;
-					continue;
-				}
-				result = allocateImage(typeIndex, requirements.alignment, requirements.size);
-				if (result.has_value())
-					break;
-				++typeIndex;
-			}
-			--typeIndex;
-			if (!result.has_value()) {
+		std::optional<AllocationResult> result;
+		bool isDedicated = false;
+		if (memoryRequirements.prefersDedicated || exceedsDedicatedAllocationThreshold(typeIndex, requirements.size)) {
+			result = allocateDedicated(typeIndex, requirements.size, false, VK_NULL_HANDLE, image, priority,
+									   memoryRequirements.requiresDedicated);
+			isDedicated = result.has_value();
+			if (!isDedicated && memoryRequirements.requiresDedicated) {
 				vkDestroyImage(m_context->device(), image, nullptr);
 				return ~0U;
 			}
 		}
+		bool isInMixedBlock = !isDedicated && m_useMixedBlocks;
+		if (!isDedicated)
+			result = allocateWithFallback(typeIndex, requiredFlags,
+										  imagePlacementRequirements(imageCreateInfo, requirements, isInMixedBlock),
+										  false, isInMixedBlock ? AllocationKind::MixedImage : AllocationKind::Image,
+										  priority);
+		if (!result.has_value()) {
+			vkDestroyImage(m_context->device(), image, nullptr);
+			return ~0U;
+		}
 
 		ImageAllocation allocation = {
 			.resourceInfo = { .format = imageCreateInfo.format,
@@ -385,26 +618,39 @@ namespace vanadium::graphics {
 							  .mipLevelCount = imageCreateInfo.mipLevels,
 							  .arrayLayerCount = imageCreateInfo.arrayLayers },
 			.typeIndex = typeIndex,
+			.isDedicated = isDedicated,
+			.isInMixedBlock = isInMixedBlock,
 			.blockHandle = result.value().blockHandle,
 			.allocationRange = result.value().allocationRange,
 		};
 		allocation.image = image;
-		vkBindImageMemory(m_context->device(), image,
-						  m_memoryTypes[typeIndex].imageBlocks[result.value().blockHandle].memoryHandle,
-						  result.value().usableRange.offset);
-		return m_images.addElement(allocation);
+		allocation.createInfo = imageCreateInfo;
+		allocation.createInfo.pNext = nullptr;
+		allocation.createInfo.queueFamilyIndexCount = 0;
+		allocation.createInfo.pQueueFamilyIndices = nullptr;
+		allocation.createInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		vkBindImageMemory(m_context->device(), image, result.value().memoryHandle, result.value().usableRange.offset);
+		ImageResourceHandle handle = addImage(allocation);
+		recordTraceEvent(AllocationTraceEventType::CreateImage,
+						 AllocationTraceFlagImage | (isDedicated ? AllocationTraceFlagDedicated : 0), typeIndex, handle,
+						 requirements.size, requirements.alignment);
+		return handle;
 	}
 
 	ImageResourceHandle GPUResourceAllocator::createImage(const VkImageCreateInfo& imageCreateInfo, BlockHandle block) {
-		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		auto lock = SharedLockGuard(m_accessMutex);
 		VkImage image;
 		verifyResult(vkCreateImage(m_context->device(), &imageCreateInfo, nullptr, &image));
 
 		VkMemoryRequirements requirements;
 		vkGetImageMemoryRequirements(m_context->device(), image, &requirements);
 
-		auto result =
-			allocateInBlock(block, m_customImageBlocks[block], requirements.alignment, requirements.size, false);
+		std::optional<AllocationResult> result;
+		{
+			auto blockLock = std::lock_guard<std::mutex>(m_customBlockMutex);
+			result =
+				allocateInBlock(block, m_customImageBlocks[block], requirements.alignment, requirements.size, false);
+		}
 		if (!result.has_value()) {
 			return ~0U;
 		} else {
@@ -418,53 +664,91 @@ namespace vanadium::graphics {
 				.allocationRange = result.value().allocationRange,
 			};
 			allocation.image = image;
-			vkBindImageMemory(m_context->device(), image, m_customImageBlocks[block].memoryHandle,
+			vkBindImageMemory(m_context->device(), image, result.value().memoryHandle,
 							  result.value().usableRange.offset);
-			return m_images.addElement(allocation);
+			ImageResourceHandle handle = addImage(allocation);
+			recordTraceEvent(AllocationTraceEventType::CreateImage,
+							 AllocationTraceFlagImage | AllocationTraceFlagCustomBlock, ~0U, handle,
+							 requirements.size, requirements.alignment);
+			return handle;
 		}
 	}
 
 	VkImage GPUResourceAllocator::nativeImageHandle(ImageResourceHandle handle) {
-		auto lock = SharedLockGuard(m_accessMutex);
+		auto lock = SharedLockGuard(m_resourceMutex);
 		return m_images[handle].image;
 	}
 
-	const ImageResourceInfo& GPUResourceAllocator::imageResourceInfo(ImageResourceHandle handle) {
-		auto lock = SharedLockGuard(m_accessMutex);
+	ImageResourceInfo GPUResourceAllocator::imageResourceInfo(ImageResourceHandle handle) {
+		auto lock = SharedLockGuard(m_resourceMutex);
 		return m_images[handle].resourceInfo;
 	}
 
 	VkImageView GPUResourceAllocator::requestImageView(ImageResourceHandle handle, const ImageResourceViewInfo& info) {
-		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
-		auto viewIterator = m_images[handle].views.find(info);
-		if (viewIterator == m_images[handle].views.end()) {
-			VkImageViewCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-												 .flags = info.flags,
-												 .image = m_images[handle].image,
-												 .viewType = info.viewType,
-												 .format = m_images[handle].resourceInfo.format,
-												 .components = info.components,
-												 .subresourceRange = info.subresourceRange };
-			VkImageView view;
-			verifyResult(vkCreateImageView(m_context->device(), &createInfo, nullptr, &view));
+		VkImageViewCreateInfo createInfo;
+		{
+			auto lock = SharedLockGuard(m_resourceMutex);
+			auto viewIterator = m_images[handle].views.find(info);
+			if (viewIterator != m_images[handle].views.end())
+				return viewIterator->second;
+			createInfo = { .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+						   .flags = info.flags,
+						   .image = m_images[handle].image,
+						   .viewType = info.viewType,
+						   .format = m_images[handle].resourceInfo.format,
+						   .components = info.components,
+						   .subresourceRange = info.subresourceRange };
+		}
+
+		VkImageView view;
+		verifyResult(vkCreateImageView(m_context->device(), &createInfo, nullptr, &view));
 
+		auto lock = std::lock_guard<std::shared_mutex>(m_resourceMutex);
+		// another thread may have created the same view in the meantime
+		auto insertResult =
 			m_images[handle].views.insert(robin_hood::pair<const ImageResourceViewInfo, VkImageView>(info, view));
-			return view;
-		} else
+		if (!insertResult.second)
+			vkDestroyImageView(m_context->device(), view, nullptr);
+		return insertResult.first->second;
+	}
+
+	ImageViewHandle GPUResourceAllocator::declareImageView(ImageResourceHandle handle,
+														   const ImageResourceViewInfo& info) {
+		VkImageView view = requestImageView(handle, info);
+
+		auto lock = std::lock_guard<std::shared_mutex>(m_resourceMutex);
+		auto& declaredViews = m_images[handle].declaredViews;
+		auto viewIterator = declaredViews.find(info);
+		if (viewIterator != declaredViews.end())
 			return viewIterator->second;
+		ImageViewHandle viewHandle = m_imageViewTable.acquire(view);
+		declaredViews.insert(robin_hood::pair<const ImageResourceViewInfo, ImageViewHandle>(info, viewHandle));
+		return viewHandle;
 	}
 
 	void GPUResourceAllocator::destroyImage(ImageResourceHandle handle) {
-		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
-		auto& allocation = m_images[handle];
-		m_imageFreeList[m_currentFrameIndex].push_back(allocation);
-		m_images.removeElement(handle);
+		auto lock = SharedLockGuard(m_accessMutex);
+		ImageAllocation allocation = removeImage(handle);
+		recordTraceEvent(AllocationTraceEventType::DestroyImage,
+						 AllocationTraceFlagImage | (allocation.typeIndex == ~0U ? AllocationTraceFlagCustomBlock : 0) |
+							 (allocation.isDedicated ? AllocationTraceFlagDedicated : 0),
+						 allocation.typeIndex, handle, allocation.allocationRange.size, 0);
+		if (allocation.isMovable)
+			--m_movableResourceCount;
+		auto freeListLock = std::lock_guard<std::mutex>(m_freeListMutex);
+		m_imageFreeList[m_currentFrameIndex].push_back(std::move(allocation));
 	}
 
 	void GPUResourceAllocator::destroyImageImmediately(ImageResourceHandle handle) {
-		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
-		destroyImageImmediatelyUnsynchronized(m_images[handle]);
-		m_images.removeElement(handle);
+		auto lock = SharedLockGuard(m_accessMutex);
+		ImageAllocation allocation = removeImage(handle);
+		recordTraceEvent(AllocationTraceEventType::DestroyImageImmediately,
+						 AllocationTraceFlagImage | (allocation.typeIndex == ~0U ? AllocationTraceFlagCustomBlock : 0) |
+							 (allocation.isDedicated ? AllocationTraceFlagDedicated : 0),
+						 allocation.typeIndex, handle, allocation.allocationRange.size, 0);
+		if (allocation.isMovable)
+			--m_movableResourceCount;
+		destroyImageImmediatelyUnsynchronized(allocation);
 	}
 
 	void GPUResourceAllocator::destroyImageImmediatelyUnsynchronized(const ImageAllocation& allocation) {
@@ -473,28 +757,446 @@ namespace vanadium::graphics {
 		}
 		vkDestroyImage(m_context->device(), allocation.image, nullptr);
 
-		if (allocation.typeIndex != ~0U) {
-			freeInBlock(m_memoryTypes[allocation.typeIndex].imageBlocks[allocation.blockHandle],
+		if (allocation.isDedicated) {
+			freeDedicatedBlock(allocation.typeIndex, allocation.blockHandle, true);
+		} else if (allocation.typeIndex != ~0U) {
+			auto typeLock = std::lock_guard<std::mutex>(m_typeMutexes[allocation.typeIndex]);
+			auto& type = m_memoryTypes[allocation.typeIndex];
+			freeInBlock(allocation.isInMixedBlock ? type.blocks[allocation.blockHandle]
+												  : type.imageBlocks[allocation.blockHandle],
 						allocation.allocationRange.offset - allocation.alignmentMargin,
 						allocation.allocationRange.size + allocation.alignmentMargin);
 		} else {
+			auto blockLock = std::lock_guard<std::mutex>(m_customBlockMutex);
 			freeInBlock(m_customImageBlocks[allocation.blockHandle], allocation.allocationRange.offset,
 						allocation.allocationRange.size);
 		}
 	}
 
 	void GPUResourceAllocator::destroyBufferBlock(BlockHandle handle) {
-		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		auto lock = SharedLockGuard(m_accessMutex);
+		auto blockLock = std::lock_guard<std::mutex>(m_customBlockMutex);
+		auto freeListLock = std::lock_guard<std::mutex>(m_freeListMutex);
 		m_blockFreeList[m_currentFrameIndex].push_back(m_customBufferBlocks[handle]);
 		m_customBufferBlocks.removeElement(handle);
 	}
 	void GPUResourceAllocator::destroyImageBlock(BlockHandle handle) {
-		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		auto lock = SharedLockGuard(m_accessMutex);
+		auto blockLock = std::lock_guard<std::mutex>(m_customBlockMutex);
+		auto freeListLock = std::lock_guard<std::mutex>(m_freeListMutex);
 		m_blockFreeList[m_currentFrameIndex].push_back(m_customImageBlocks[handle]);
 		m_customImageBlocks.removeElement(handle);
 	}
 
+	void GPUResourceAllocator::setBufferMovable(BufferResourceHandle handle, BufferMoveCallback moveCallback,
+												void* userData) {
+		auto lock = SharedLockGuard(m_accessMutex);
+		auto resourceLock = std::lock_guard<std::shared_mutex>(m_resourceMutex);
+		auto& allocation = m_buffers[handle];
+		assertFatal(!allocation.isMultipleBuffered && !allocation.isDedicated && !allocation.isSuballocated &&
+						allocation.typeIndex != ~0U,
+					"GPUResourceAllocator: Only buffers in shared blocks can be movable!");
+		constexpr VkBufferUsageFlags transferUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		assertFatal((allocation.createInfo.usage & transferUsage) == transferUsage &&
+						allocation.createInfo.sharingMode == VK_SHARING_MODE_EXCLUSIVE,
+					"GPUResourceAllocator: Movable buffers need transfer usage and exclusive sharing!");
+
+		if (!allocation.isMovable)
+			++m_movableResourceCount;
+		allocation.isMovable = true;
+		allocation.moveCallback = moveCallback;
+		allocation.moveCallbackUserData = userData;
+	}
+
+	void GPUResourceAllocator::setImageMovable(ImageResourceHandle handle, VkImageLayout restingLayout,
+											   ImageMoveCallback moveCallback, void* userData) {
+		auto lock = SharedLockGuard(m_accessMutex);
+		auto resourceLock = std::lock_guard<std::shared_mutex>(m_resourceMutex);
+		auto& allocation = m_images[handle];
+		assertFatal(!allocation.isDedicated && allocation.typeIndex != ~0U,
+					"GPUResourceAllocator: Only images in shared blocks can be movable!");
+		constexpr VkImageUsageFlags transferUsage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+		assertFatal((allocation.createInfo.usage & transferUsage) == transferUsage &&
+						allocation.createInfo.sharingMode == VK_SHARING_MODE_EXCLUSIVE,
+					"GPUResourceAllocator: Movable images need transfer usage and exclusive sharing!");
+		assertFatal(restingLayout != VK_IMAGE_LAYOUT_UNDEFINED && restingLayout != VK_IMAGE_LAYOUT_PREINITIALIZED,
+					"GPUResourceAllocator: Invalid resting layout for movable image!");
+
+		if (!allocation.isMovable)
+			++m_movableResourceCount;
+		allocation.isMovable = true;
+		allocation.restingLayout = restingLayout;
+		allocation.moveCallback = moveCallback;
+		allocation.moveCallbackUserData = userData;
+	}
+
+	void GPUResourceAllocator::recordDefragmentationCopies(VkCommandBuffer commandBuffer, VkDeviceSize byteBudget) {
+		struct MoveNotification {
+			SlotmapHandle handle;
+			void (*callback)(SlotmapHandle handle, void* userData);
+			void* userData;
+		};
+		std::vector<MoveNotification> moveNotifications;
+
+		{
+			auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+			if (!m_movableResourceCount)
+				return;
+			auto resourceLock = std::lock_guard<std::shared_mutex>(m_resourceMutex);
+
+			struct BlockUsage {
+				bool hasUnmovableResources = false;
+				std::vector<SlotmapHandle> movableResources;
+				std::vector<ImageResourceHandle> movableMixedImages;
+			};
+			std::vector<robin_hood::unordered_map<BlockHandle, BlockUsage>> bufferBlockUsages =
+				std::vector<robin_hood::unordered_map<BlockHandle, BlockUsage>>(m_memoryTypes.size());
+			std::vector<robin_hood::unordered_map<BlockHandle, BlockUsage>> imageBlockUsages =
+				std::vector<robin_hood::unordered_map<BlockHandle, BlockUsage>>(m_memoryTypes.size());
+
+			for (auto iterator = m_buffers.begin(); iterator != m_buffers.end(); ++iterator) {
+				if (iterator->typeIndex == ~0U || iterator->isDedicated)
+					continue;
+				auto& usage = bufferBlockUsages[iterator->typeIndex][iterator->blockHandle];
+				if (iterator->isMovable)
+					usage.movableResources.push_back(m_buffers.handle(iterator));
+				else
+					usage.hasUnmovableResources = true;
+			}
+			for (auto iterator = m_images.begin(); iterator != m_images.end(); ++iterator) {
+				if (iterator->typeIndex == ~0U || iterator->isDedicated)
+					continue;
+				if (iterator->isInMixedBlock) {
+					auto& usage = bufferBlockUsages[iterator->typeIndex][iterator->blockHandle];
+					if (iterator->isMovable)
+						usage.movableMixedImages.push_back(m_images.handle(iterator));
+					else
+						usage.hasUnmovableResources = true;
+					continue;
+				}
+				auto& usage = imageBlockUsages[iterator->typeIndex][iterator->blockHandle];
+				if (iterator->isMovable)
+					usage.movableResources.push_back(m_images.handle(iterator));
+				else
+					usage.hasUnmovableResources = true;
+			}
+
+			std::vector<DefragmentationBufferCopy> bufferCopies;
+			std::vector<DefragmentationImageCopy> imageCopies;
+			VkDeviceSize movedSize = 0;
+
+			for (uint32_t typeIndex = 0; typeIndex < m_memoryTypes.size(); ++typeIndex) {
+				for (bool isImage : { false, true }) {
+					auto& blocks = isImage ? m_memoryTypes[typeIndex].imageBlocks : m_memoryTypes[typeIndex].blocks;
+					auto& usages = isImage ? imageBlockUsages[typeIndex] : bufferBlockUsages[typeIndex];
+
+					// Only blocks that can be emptied completely are worth moving out of. Pick the one with the least
+					// used memory, if the other blocks have enough free space to take its resources.
+					BlockHandle srcBlockHandle = ~0U;
+					VkDeviceSize srcUsedSize = ~0ULL;
+					VkDeviceSize totalFreeSize = 0;
+					for (auto iterator = blocks.begin(); iterator != blocks.end(); ++iterator) {
+						totalFreeSize += iterator->allocator.freeSize();
+						VkDeviceSize usedSize = iterator->originalSize - iterator->allocator.freeSize();
+						auto usage = usages.find(blocks.handle(iterator));
+						// A used block without resources holds cached ranges or the old ranges of moved resources. It
+						// stays the source until those are freed instead of taking back what was moved out of it.
+						if (usage == usages.end() ? usedSize == 0 : usage->second.hasUnmovableResources)
+							continue;
+						if (usedSize < srcUsedSize) {
+							srcUsedSize = usedSize;
+							srcBlockHandle = blocks.handle(iterator);
+						}
+					}
+					if (srcBlockHandle == ~0U)
+						continue;
+					VkDeviceSize otherBlocksFreeSize = totalFreeSize - blocks[srcBlockHandle].allocator.freeSize();
+					if (!isImage) {
+						auto releaseRange = [&](uint64_t bucket, const AllocationResult& range) {
+							releaseCachedRange(typeIndex, bucket, range);
+						};
+						// cached ranges count as used, those in the source block would keep it alive after all
+						// resources moved out
+						m_allocationCache.drain(
+							[&](uint64_t bucket, const AllocationResult& range) {
+								return (bucket >> 32) == typeIndex && range.blockHandle == srcBlockHandle;
+							},
+							releaseRange);
+						srcUsedSize = blocks[srcBlockHandle].originalSize - blocks[srcBlockHandle].allocator.freeSize();
+						// those in the other blocks may hide the space the resources need
+						if (otherBlocksFreeSize < srcUsedSize) {
+							m_allocationCache.drain(
+								[&](uint64_t bucket, const AllocationResult&) { return (bucket >> 32) == typeIndex; },
+								releaseRange);
+							otherBlocksFreeSize = 0;
+							for (auto iterator = blocks.begin(); iterator != blocks.end(); ++iterator) {
+								if (blocks.handle(iterator) != srcBlockHandle)
+									otherBlocksFreeSize += iterator->allocator.freeSize();
+							}
+						}
+					}
+					if (otherBlocksFreeSize < srcUsedSize)
+						continue;
+
+					// fill up the fullest blocks first
+					std::vector<BlockHandle> dstBlockCandidates;
+					for (auto iterator = blocks.begin(); iterator != blocks.end(); ++iterator) {
+						if (blocks.handle(iterator) != srcBlockHandle &&
+							iterator->priority == blocks[srcBlockHandle].priority)
+							dstBlockCandidates.push_back(blocks.handle(iterator));
+					}
+					std::sort(dstBlockCandidates.begin(), dstBlockCandidates.end(),
+							  [&blocks](BlockHandle one, BlockHandle other) {
+								  return blocks[one].allocator.freeSize() < blocks[other].allocator.freeSize();
+							  });
+
+					for (auto resourceHandle : usages[srcBlockHandle].movableResources) {
+						VkDeviceSize size = isImage ? m_images[resourceHandle].allocationRange.size
+													: m_buffers[resourceHandle].allocationRange.size;
+						if (movedSize + size > byteBudget)
+							continue;
+
+						if (isImage && moveImage(resourceHandle, dstBlockCandidates, imageCopies)) {
+							moveNotifications.push_back({ .handle = resourceHandle,
+														  .callback = m_images[resourceHandle].moveCallback,
+														  .userData = m_images[resourceHandle].moveCallbackUserData });
+							movedSize += size;
+						} else if (!isImage && moveBuffer(resourceHandle, dstBlockCandidates, bufferCopies)) {
+							moveNotifications.push_back({ .handle = resourceHandle,
+														  .callback = m_buffers[resourceHandle].moveCallback,
+														  .userData = m_buffers[resourceHandle].moveCallbackUserData });
+							movedSize += size;
+						}
+					}
+					for (auto imageHandle : usages[srcBlockHandle].movableMixedImages) {
+						VkDeviceSize size = m_images[imageHandle].allocationRange.size;
+						if (movedSize + size > byteBudget)
+							continue;
+						if (moveImage(imageHandle, dstBlockCandidates, imageCopies)) {
+							moveNotifications.push_back({ .handle = imageHandle,
+														  .callback = m_images[imageHandle].moveCallback,
+														  .userData = m_images[imageHandle].moveCallbackUserData });
+							movedSize += size;
+						}
+					}
+				}
+			}
+
+			if (bufferCopies.empty() && imageCopies.empty())
+				return;
+
+			// wait for all previous writes to the old resources, including those of earlier frames
+			VkMemoryBarrier memoryBarrier = { .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+											  .srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
+											  .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT };
+			std::vector<VkImageMemoryBarrier> imageBarriers;
+			imageBarriers.reserve(imageCopies.size() * 2);
+			for (auto& copy : imageCopies) {
+				VkImageSubresourceRange subresourceRange = { .aspectMask = copy.aspectMask,
+															 .baseMipLevel = 0,
+															 .levelCount = copy.mipLevelCount,
+															 .baseArrayLayer = 0,
+															 .layerCount = copy.arrayLayerCount };
+				imageBarriers.push_back({ .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+										  .srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
+										  .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+										  .oldLayout = copy.restingLayout,
+										  .newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+										  .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+										  .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+										  .image = copy.srcImage,
+										  .subresourceRange = subresourceRange });
+				imageBarriers.push_back({ .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+										  .srcAccessMask = 0,
+										  .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+										  .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+										  .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+										  .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+										  .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+										  .image = copy.dstImage,
+										  .subresourceRange = subresourceRange });
+			}
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1,
+								 &memoryBarrier, 0, nullptr, static_cast<uint32_t>(imageBarriers.size()),
+								 imageBarriers.data());
+
+			for (auto& copy : bufferCopies) {
+				VkBufferCopy region = { .srcOffset = 0, .dstOffset = 0, .size = copy.size };
+				vkCmdCopyBuffer(commandBuffer, copy.srcBuffer, copy.dstBuffer, 1, &region);
+			}
+			std::vector<VkImageCopy> regions;
+			for (auto& copy : imageCopies) {
+				regions.clear();
+				for (uint32_t i = 0; i < copy.mipLevelCount; ++i) {
+					VkImageSubresourceLayers subresource = { .aspectMask = copy.aspectMask,
+															 .mipLevel = i,
+															 .baseArrayLayer = 0,
+															 .layerCount = copy.arrayLayerCount };
+					regions.push_back({ .srcSubresource = subresource,
+										.srcOffset = {},
+										.dstSubresource = subresource,
+										.dstOffset = {},
+										.extent = { .width = std::max(copy.extent.width >> i, 1U),
+													.height = std::max(copy.extent.height >> i, 1U),
+													.depth = std::max(copy.extent.depth >> i, 1U) } });
+				}
+				vkCmdCopyImage(commandBuffer, copy.srcImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, copy.dstImage,
+							   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()),
+							   regions.data());
+			}
+
+			memoryBarrier = { .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+							  .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+							  .dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT };
+			imageBarriers.clear();
+			for (auto& copy : imageCopies) {
+				imageBarriers.push_back({ .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+										  .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+										  .dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT,
+										  .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+										  .newLayout = copy.restingLayout,
+										  .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+										  .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+										  .image = copy.dstImage,
+										  .subresourceRange = { .aspectMask = copy.aspectMask,
+																.baseMipLevel = 0,
+																.levelCount = copy.mipLevelCount,
+																.baseArrayLayer = 0,
+																.layerCount = copy.arrayLayerCount } });
+			}
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1,
+								 &memoryBarrier, 0, nullptr, static_cast<uint32_t>(imageBarriers.size()),
+								 imageBarriers.data());
+		}
+
+		for (auto& notification : moveNotifications) {
+			if (notification.callback)
+				notification.callback(notification.handle, notification.userData);
+		}
+	}
+
+	bool GPUResourceAllocator::moveBuffer(BufferResourceHandle handle,
+										  const std::vector<BlockHandle>& dstBlockCandidates,
+										  std::vector<DefragmentationBufferCopy>& copies) {
+		auto& allocation = m_buffers[handle];
+		auto& blocks = m_memoryTypes[allocation.typeIndex].blocks;
+		bool isMapped = allocation.mappedData[0] != nullptr;
+
+		VkBuffer newBuffer;
+		verifyResult(vkCreateBuffer(m_context->device(), &allocation.createInfo, nullptr, &newBuffer));
+		VkMemoryRequirements requirements;
+		vkGetBufferMemoryRequirements(m_context->device(), newBuffer, &requirements);
+
+		std::optional<AllocationResult> result;
+		for (auto blockHandle : dstBlockCandidates) {
+			auto& block = blocks[blockHandle];
+			if (block.maxAllocatableSize < requirements.size || (isMapped && !block.mappedPointer))
+				continue;
+			result = allocateInBlock(blockHandle, block, requirements.alignment, requirements.size, isMapped);
+			if (result.has_value())
+				break;
+		}
+		if (!result.has_value()) {
+			vkDestroyBuffer(m_context->device(), newBuffer, nullptr);
+			return false;
+		}
+
+		verifyResult(vkBindBufferMemory(m_context->device(), newBuffer, result.value().memoryHandle,
+										result.value().usableRange.offset));
+		copies.push_back({ .srcBuffer = allocation.buffers[0], .dstBuffer = newBuffer, .size = allocation.createInfo.size });
+
+		// the old buffer and memory are released when this frame in flight comes around again, parking the range in
+		// the allocation cache would keep the source block alive
+		BufferAllocation oldAllocation = allocation;
+		oldAllocation.isMovable = false;
+		oldAllocation.bypassesAllocationCache = true;
+		m_bufferFreeList[m_currentFrameIndex].push_back(oldAllocation);
+
+		allocation.blockHandle = result.value().blockHandle;
+		allocation.bufferContentRange = result.value().usableRange;
+		allocation.allocationRange = result.value().allocationRange;
+		allocation.memoryHandle = result.value().memoryHandle;
+		allocation.blockMappedPointer = result.value().mappedPointer;
+		allocation.cacheBucket = ~0ULL;
+		allocation.slabIndex = ~0U;
+		for (size_t i = 0; i < frameInFlightCount; ++i) {
+			allocation.buffers[i] = newBuffer;
+			if (isMapped) {
+				auto bufferStartPointer =
+					reinterpret_cast<uintptr_t>(result.value().mappedPointer) + result.value().usableRange.offset;
+				allocation.mappedData[i] = reinterpret_cast<void*>(bufferStartPointer);
+			}
+		}
+		return true;
+	}
+
+	bool GPUResourceAllocator::moveImage(ImageResourceHandle handle, const std::vector<BlockHandle>& dstBlockCandidates,
+										 std::vector<DefragmentationImageCopy>& copies) {
+		auto& allocation = m_images[handle];
+		auto& blocks = allocation.isInMixedBlock ? m_memoryTypes[allocation.typeIndex].blocks
+												 : m_memoryTypes[allocation.typeIndex].imageBlocks;
+
+		VkImage newImage;
+		verifyResult(vkCreateImage(m_context->device(), &allocation.createInfo, nullptr, &newImage));
+		VkMemoryRequirements requirements;
+		vkGetImageMemoryRequirements(m_context->device(), newImage, &requirements);
+		requirements = imagePlacementRequirements(allocation.createInfo, requirements, allocation.isInMixedBlock);
+
+		std::optional<AllocationResult> result;
+		for (auto blockHandle : dstBlockCandidates) {
+			auto& block = blocks[blockHandle];
+			if (block.maxAllocatableSize < requirements.size)
+				continue;
+			result = allocateInBlock(blockHandle, block, requirements.alignment, requirements.size, false);
+			if (result.has_value())
+				break;
+		}
+		if (!result.has_value()) {
+			vkDestroyImage(m_context->device(), newImage, nullptr);
+			return false;
+		}
+
+		verifyResult(vkBindImageMemory(m_context->device(), newImage, result.value().memoryHandle,
+									   result.value().usableRange.offset));
+		copies.push_back({ .srcImage = allocation.image,
+						   .dstImage = newImage,
+						   .restingLayout = allocation.restingLayout,
+						   .aspectMask = formatAspectFlags(allocation.createInfo.format),
+						   .extent = allocation.createInfo.extent,
+						   .mipLevelCount = allocation.createInfo.mipLevels,
+						   .arrayLayerCount = allocation.createInfo.arrayLayers });
+
+		// the old image, its views and memory are released when this frame in flight comes around again
+		ImageAllocation oldAllocation = allocation;
+		oldAllocation.isMovable = false;
+		m_imageFreeList[m_currentFrameIndex].push_back(oldAllocation);
+
+		allocation.views.clear();
+		allocation.blockHandle = result.value().blockHandle;
+		allocation.alignmentMargin = 0;
+		allocation.allocationRange = result.value().allocationRange;
+		allocation.image = newImage;
+
+		for (auto& declaredView : allocation.declaredViews) {
+			VkImageViewCreateInfo viewCreateInfo = { .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+													 .flags = declaredView.first.flags,
+													 .image = newImage,
+													 .viewType = declaredView.first.viewType,
+													 .format = allocation.resourceInfo.format,
+													 .components = declaredView.first.components,
+													 .subresourceRange = declaredView.first.subresourceRange };
+			VkImageView view;
+			verifyResult(vkCreateImageView(m_context->device(), &viewCreateInfo, nullptr, &view));
+			allocation.views.insert(
+				robin_hood::pair<const ImageResourceViewInfo, VkImageView>(declaredView.first, view));
+			m_imageViewTable.store(declaredView.second, view);
+		}
+		return true;
+	}
+
 	void GPUResourceAllocator::destroy() {
+		m_traceRecorder.stop();
+
 		// work around iterator invalidation
 		while (m_buffers.size()) {
 			destroyBuffer(m_buffers.handle(m_buffers.begin()));
@@ -507,10 +1209,14 @@ namespace vanadium::graphics {
 			m_currentFrameIndex = i;
 			flushFreeList();
 		}
+		// the blocks are freed as a whole, cached ranges don't need to be returned to them
+		m_allocationCache.drain([](uint64_t, const AllocationResult&) { return true; },
+								[](uint64_t, const AllocationResult&) {});
 
 		for (auto& type : m_memoryTypes) {
+			type.slabPools.clear();
 			for (auto& block : type.blocks) {
-				vkFreeMemory(m_context->device(), block.memoryHandle, nullptr);
+				freeBlockMemory(block);
 			}
 			for (auto& block : type.imageBlocks) {
 				vkFreeMemory(m_context->device(), block.memoryHandle, nullptr);
@@ -525,31 +1231,164 @@ namespace vanadium::graphics {
 		}
 	}
 
+	void GPUResourceAllocator::setDedicatedAllocationThreshold(float blockSizeFraction) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		m_dedicatedAllocationFraction = blockSizeFraction;
+	}
+
+	void GPUResourceAllocator::setMixedBlocks(bool enable) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		m_useMixedBlocks = enable;
+	}
+
+	void GPUResourceAllocator::setBlockSizePolicy(const BlockSizePolicy& policy) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		m_defaultBlockSizePolicy = policy;
+		for (auto& type : m_memoryTypes) {
+			type.blockSizer = BlockSizer(policy, m_heapSizes[type.heapIndex]);
+		}
+	}
+
+	void GPUResourceAllocator::setBlockSizePolicy(uint32_t typeIndex, const BlockSizePolicy& policy) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		m_memoryTypes[typeIndex].blockSizer = BlockSizer(policy, m_heapSizes[m_memoryTypes[typeIndex].heapIndex]);
+	}
+
 	void GPUResourceAllocator::setFrameIndex(uint32_t frameIndex) {
 		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
-		m_currentFrameIndex = frameIndex;
+		{
+			auto resourceLock = std::lock_guard<std::shared_mutex>(m_resourceMutex);
+			m_currentFrameIndex = frameIndex;
+		}
+		++m_absoluteFrameIndex;
 		flushFreeList();
 	}
 
+	void GPUResourceAllocator::setOverBudgetCallback(OverBudgetCallback callback, void* userData) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		m_overBudgetCallback = callback;
+		m_overBudgetCallbackUserData = userData;
+	}
+
 	void GPUResourceAllocator::updateMemoryBudget() {
+		std::vector<VkDeviceSize> heapOverruns;
+		OverBudgetCallback overBudgetCallback;
+		void* overBudgetCallbackUserData;
+		{
+			auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+			if (m_context->deviceCapabilities().memoryBudget) {
+				VkPhysicalDeviceMemoryProperties2KHR memoryProperties2 = {
+					.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2_KHR
+				};
+				VkPhysicalDeviceMemoryBudgetPropertiesEXT memoryBudgetProperties = {
+					.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT
+				};
+				memoryProperties2.pNext = &memoryBudgetProperties;
+				vkGetPhysicalDeviceMemoryProperties2KHR(m_context->physicalDevice(), &memoryProperties2);
+
+				for (uint32_t i = 0; i < memoryProperties2.memoryProperties.memoryHeapCount; ++i) {
+					m_heapBudgets[i] = remainingHeapBudget(memoryBudgetProperties.heapBudget[i],
+														   memoryBudgetProperties.heapUsage[i]);
+					m_reportedHeapBudgets[i] = memoryBudgetProperties.heapBudget[i];
+					m_reportedHeapUsages[i] = memoryBudgetProperties.heapUsage[i];
+					// other processes may push us over budget as well
+					if (memoryBudgetProperties.heapUsage[i] > memoryBudgetProperties.heapBudget[i])
+						m_heapOverruns[i] = std::max(m_heapOverruns[i], memoryBudgetProperties.heapUsage[i] -
+																			memoryBudgetProperties.heapBudget[i]);
+				}
+			}
+
+			heapOverruns = m_heapOverruns;
+			std::fill(m_heapOverruns.begin(), m_heapOverruns.end(), 0);
+			overBudgetCallback = m_overBudgetCallback;
+			overBudgetCallbackUserData = m_overBudgetCallbackUserData;
+		}
+
+		if (!overBudgetCallback)
+			return;
+		for (uint32_t i = 0; i < heapOverruns.size(); ++i) {
+			if (heapOverruns[i])
+				overBudgetCallback(i, heapOverruns[i], overBudgetCallbackUserData);
+		}
+	}
+
+	AllocatorStatistics GPUResourceAllocator::statistics(bool includeBlocks) {
 		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
-		if (m_context->deviceCapabilities().memoryBudget) {
-			VkPhysicalDeviceMemoryProperties2KHR memoryProperties2 = {
-				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2_KHR
-			};
-			VkPhysicalDeviceMemoryBudgetPropertiesEXT memoryBudgetProperties = {
-				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT
-			};
-			memoryProperties2.pNext = &memoryBudgetProperties;
-			vkGetPhysicalDeviceMemoryProperties2KHR(m_context->physicalDevice(), &memoryProperties2);
+		AllocatorStatistics statistics = { .memoryTypes = std::vector<MemoryTypeStatistics>(m_memoryTypes.size()),
+										   .heaps = std::vector<MemoryHeapStatistics>(m_heapSizes.size()),
+										   .bufferCount = m_buffers.size(),
+										   .imageCount = m_images.size() };
+
+		auto addBlock = [&](const MemoryBlock& block, bool isImageBlock, bool isCustomBlock, bool isDedicatedBlock) {
+			MemoryBlockStatistics blockInfo = blockStatistics(block, isImageBlock, isCustomBlock, isDedicatedBlock);
+			if (isCustomBlock)
+				accumulateStatistics(statistics.customBlocks, blockInfo);
+			else
+				accumulateStatistics(statistics.memoryTypes[block.typeIndex].total, blockInfo);
+			accumulateStatistics(statistics.heaps[m_memoryTypes[block.typeIndex].heapIndex].total, blockInfo);
+			if (includeBlocks)
+				statistics.blocks.push_back(blockInfo);
+		};
 
-			for (uint32_t i = 0; i < memoryProperties2.memoryProperties.memoryHeapCount; ++i) {
-				m_heapBudgets[i] = memoryBudgetProperties.heapBudget[i];
+		for (uint32_t i = 0; i < m_memoryTypes.size(); ++i) {
+			statistics.memoryTypes[i].properties = m_memoryTypes[i].properties;
+			statistics.memoryTypes[i].heapIndex = m_memoryTypes[i].heapIndex;
+			for (auto& block : m_memoryTypes[i].blocks) {
+				addBlock(block, false, false, false);
+			}
+			for (auto& block : m_memoryTypes[i].imageBlocks) {
+				addBlock(block, true, false, false);
+			}
+			for (auto& block : m_memoryTypes[i].dedicatedBlocks) {
+				addBlock(block, false, false, true);
 			}
+			for (auto& block : m_memoryTypes[i].dedicatedImageBlocks) {
+				addBlock(block, true, false, true);
+			}
+		}
+		for (auto& block : m_customBufferBlocks) {
+			addBlock(block, false, true, false);
 		}
+		for (auto& block : m_customImageBlocks) {
+			addBlock(block, true, true, false);
+		}
+
+		for (uint32_t i = 0; i < m_heapSizes.size(); ++i) {
+			auto& heap = statistics.heaps[i];
+			heap.size = m_heapSizes[i];
+			heap.remainingBudget = m_heapBudgets[i];
+			if (m_context->deviceCapabilities().memoryBudget) {
+				heap.budget = m_reportedHeapBudgets[i];
+				heap.usage = m_reportedHeapUsages[i];
+			} else {
+				heap.budget = m_heapSizes[i];
+				heap.usage = heap.total.blockSize;
+			}
+		}
+		return statistics;
+	}
+
+	std::string GPUResourceAllocator::buildStatisticsString() {
+		return serializeAllocatorStatistics(statistics(true));
+	}
+
+	MemoryBlockStatistics GPUResourceAllocator::blockStatistics(const MemoryBlock& block, bool isImageBlock,
+																bool isCustomBlock, bool isDedicatedBlock) {
+		return { .typeIndex = block.typeIndex,
+				 .isImageBlock = isImageBlock,
+				 .isCustomBlock = isCustomBlock,
+				 .isDedicatedBlock = isDedicatedBlock,
+				 .size = block.originalSize,
+				 .usedSize = block.originalSize - block.allocator.freeSize(),
+				 .largestFreeRange = block.maxAllocatableSize,
+				 .freeRangeCount = block.allocator.freeRangeCount(),
+				 .allocationCount = block.allocator.allocationCount(),
+				 .allocationSizeClassCounts = block.allocationSizeClassCounts };
 	}
 
 	void GPUResourceAllocator::flushFreeList() {
+		recordTraceEvent(AllocationTraceEventType::FlushFreeList, 0, ~0U, 0, 0, 0);
+
 		for (auto& allocation : m_bufferFreeList[m_currentFrameIndex]) {
 			destroyBufferImmediatelyUnsynchronized(allocation);
 		}
@@ -560,53 +1399,119 @@ namespace vanadium::graphics {
 		}
 		m_imageFreeList[m_currentFrameIndex].clear();
 
+		uint32_t typeIndex = 0;
 		for (auto& type : m_memoryTypes) {
-			size_t freeBlockCount = 0;
+			type.blockSizer.decayPressure();
+			// total size of the empty blocks kept, buffer and image blocks share the allowance
+			VkDeviceSize retainedSize;
 
 		blockFreeStart:
+			retainedSize = 0;
 			auto iterator = type.blocks.begin();
 			for (auto& block : type.blocks) {
 				if (block.maxAllocatableSize == block.originalSize) {
-					if (block.originalSize > m_blockSize) {
-						vkFreeMemory(m_context->device(), block.memoryHandle, nullptr);
+					if (type.blockSizer.shouldReleaseEmptyBlock(block.originalSize, retainedSize)) {
+						recordTraceEvent(AllocationTraceEventType::FreeBlock, 0, typeIndex,
+										 type.blocks.handle(iterator), block.originalSize, 0);
+						freeBlockMemory(block);
+						releaseHeapBudget(type.heapIndex, block.originalSize);
 						type.blocks.removeElement(type.blocks.handle(iterator));
 						// no way to handle iterator invalidation gracefully, restart loop
 						goto blockFreeStart;
-					} else if (++freeBlockCount > 1) {
-						vkFreeMemory(m_context->device(), block.memoryHandle, nullptr);
-						type.blocks.removeElement(type.blocks.handle(iterator));
-						goto blockFreeStart;
 					}
+					retainedSize += block.originalSize;
 				}
 				++iterator;
 			}
+			VkDeviceSize bufferRetainedSize = retainedSize;
+
 		imageBlockFreeStart:
+			retainedSize = bufferRetainedSize;
 			auto imageIterator = type.imageBlocks.begin();
 			for (auto& block : type.imageBlocks) {
 				if (block.maxAllocatableSize == block.originalSize) {
-					if (block.originalSize > m_blockSize) {
+					if (type.blockSizer.shouldReleaseEmptyBlock(block.originalSize, retainedSize)) {
+						recordTraceEvent(AllocationTraceEventType::FreeBlock, AllocationTraceFlagImage, typeIndex,
+										 type.imageBlocks.handle(imageIterator), block.originalSize, 0);
 						vkFreeMemory(m_context->device(), block.memoryHandle, nullptr);
+						releaseHeapBudget(type.heapIndex, block.originalSize);
 						type.imageBlocks.removeElement(type.imageBlocks.handle(imageIterator));
 						// no way to handle iterator invalidation gracefully, restart loop
 						goto imageBlockFreeStart;
-					} else if (++freeBlockCount > 1) {
-						vkFreeMemory(m_context->device(), block.memoryHandle, nullptr);
-						type.imageBlocks.removeElement(type.imageBlocks.handle(imageIterator));
-						goto imageBlockFreeStart;
 					}
+					retainedSize += block.originalSize;
 				}
 				++imageIterator;
 			}
+			++typeIndex;
 		}
 
 		for (auto& block : m_blockFreeList[m_currentFrameIndex]) {
+			recordTraceEvent(AllocationTraceEventType::FreeBlock, AllocationTraceFlagCustomBlock, ~0U, ~0U,
+							 block.originalSize, 0);
 			vkFreeMemory(m_context->device(), block.memoryHandle, nullptr);
+			releaseHeapBudget(m_memoryTypes[block.typeIndex].heapIndex, block.originalSize);
 		}
 		m_blockFreeList[m_currentFrameIndex].clear();
 	}
 
+	GPUResourceAllocator::ResourceMemoryRequirements GPUResourceAllocator::bufferMemoryRequirements(VkBuffer buffer) {
+		ResourceMemoryRequirements result = {};
+		if (m_context->deviceCapabilities().dedicatedAllocation) {
+			VkMemoryDedicatedRequirementsKHR dedicatedRequirements = {
+				.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS_KHR
+			};
+			VkMemoryRequirements2KHR requirements = { .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2_KHR,
+													  .pNext = &dedicatedRequirements };
+			VkBufferMemoryRequirementsInfo2KHR info = {
+				.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2_KHR, .buffer = buffer
+			};
+			vkGetBufferMemoryRequirements2KHR(m_context->device(), &info, &requirements);
+
+			result.requirements = requirements.memoryRequirements;
+			result.prefersDedicated = dedicatedRequirements.prefersDedicatedAllocation;
+			result.requiresDedicated = dedicatedRequirements.requiresDedicatedAllocation;
+		} else {
+			vkGetBufferMemoryRequirements(m_context->device(), buffer, &result.requirements);
+		}
+		result.prefersDedicated |= result.requiresDedicated;
+		return result;
+	}
+
+	GPUResourceAllocator::ResourceMemoryRequirements GPUResourceAllocator::imageMemoryRequirements(VkImage image) {
+		ResourceMemoryRequirements result = {};
+		if (m_context->deviceCapabilities().dedicatedAllocation) {
+			VkMemoryDedicatedRequirementsKHR dedicatedRequirements = {
+				.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS_KHR
+			};
+			VkMemoryRequirements2KHR requirements = { .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2_KHR,
+													  .pNext = &dedicatedRequirements };
+			VkImageMemoryRequirementsInfo2KHR info = { .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2_KHR,
+													   .image = image };
+			vkGetImageMemoryRequirements2KHR(m_context->device(), &info, &requirements);
+
+			result.requirements = requirements.memoryRequirements;
+			result.prefersDedicated = dedicatedRequirements.prefersDedicatedAllocation;
+			result.requiresDedicated = dedicatedRequirements.requiresDedicatedAllocation;
+		} else {
+			vkGetImageMemoryRequirements(m_context->device(), image, &result.requirements);
+		}
+		result.prefersDedicated |= result.requiresDedicated;
+		return result;
+	}
+
+	bool GPUResourceAllocator::exceedsDedicatedAllocationThreshold(uint32_t typeIndex, VkDeviceSize size) {
+		return size > m_memoryTypes[typeIndex].blockSizer.maxBlockSize() * m_dedicatedAllocationFraction;
+	}
+
+	MemoryPriority GPUResourceAllocator::effectivePriority(MemoryPriority priority) {
+		// separating blocks by priority only wastes memory if the driver can't use it
+		return m_context->deviceCapabilities().memoryPriority ? priority : MemoryPriority::Default;
+	}
+
 	uint32_t GPUResourceAllocator::bestTypeIndex(VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred,
-												 VkMemoryRequirements requirements, bool createMapped) {
+												 VkMemoryRequirements requirements, bool createMapped,
+												 MemoryPriority priority, bool respectBudget) {
 		uint32_t bestMatchingTypeIndex = ~0U;
 		size_t bestNumMatchingCapabilities = 0;
 		size_t bestNumUnrelatedCapabilities = ~0U;
@@ -624,7 +1529,7 @@ namespace vanadium::graphics {
 				 (numMatchingCapabilities == bestNumMatchingCapabilities &&
 				  numUnrelatedCapabilities < bestNumUnrelatedCapabilities)) &&
 				((1U << typeIndex) & requirements.memoryTypeBits)) {
-				if (!isTypeBigEnough(typeIndex, requirements.size, createMapped)) {
+				if (respectBudget && !isTypeBigEnough(typeIndex, requirements.size, createMapped, priority)) {
 					++typeIndex;
 					continue;
 				}
@@ -638,23 +1543,79 @@ namespace vanadium::graphics {
 		return bestMatchingTypeIndex;
 	}
 
-	bool GPUResourceAllocator::isTypeBigEnough(uint32_t typeIndex, VkDeviceSize size, bool createMapped) {
-		for (auto& block : m_memoryTypes[typeIndex].blocks) {
-			if (block.maxAllocatableSize >= size && (!createMapped || block.mappedPointer != nullptr)) {
-				return true;
+	bool GPUResourceAllocator::isTypeBigEnough(uint32_t typeIndex, VkDeviceSize size, bool createMapped,
+											   MemoryPriority priority) {
+		{
+			auto lock = std::lock_guard<std::mutex>(m_typeMutexes[typeIndex]);
+			for (auto& block : m_memoryTypes[typeIndex].blocks) {
+				if (block.maxAllocatableSize >= size && block.priority == priority &&
+					(!createMapped || block.mappedPointer != nullptr)) {
+					return true;
+				}
 			}
 		}
-		if (m_heapBudgets[m_memoryTypes[typeIndex].heapIndex] > size)
+		if (heapBudget(m_memoryTypes[typeIndex].heapIndex) > size)
 			return true;
 		return false;
 	}
 
 	std::optional<AllocationResult> GPUResourceAllocator::allocate(uint32_t typeIndex, VkDeviceSize alignment,
-																   VkDeviceSize size, bool createMapped) {
+																   VkDeviceSize size, bool createMapped,
+																   MemoryPriority priority, bool allowOverBudget,
+																   bool needsBlockBuffer) {
+		uint32_t sizeClass = AllocationCache<AllocationResult>::sizeClass(size, alignment);
+		if (sizeClass == ~0U) {
+			auto lock = std::lock_guard<std::mutex>(m_typeMutexes[typeIndex]);
+			return allocateFromBlocks(typeIndex, alignment, size, createMapped, priority, allowOverBudget,
+									  needsBlockBuffer);
+		}
+
+		uint64_t bucket = cacheBucket(typeIndex, priority, createMapped, needsBlockBuffer, sizeClass);
+		auto cachedRange = m_allocationCache.pop(bucket);
+		if (cachedRange.has_value())
+			return cachedRange;
+
+		// carve a batch at once, so the following allocations of this size class don't need the type lock
+		VkDeviceSize classSize = AllocationCache<AllocationResult>::sizeClassSize(sizeClass);
+		size_t refillCount = AllocationCache<AllocationResult>::refillCount(sizeClass);
+		std::vector<AllocationResult> ranges;
+		{
+			auto lock = std::lock_guard<std::mutex>(m_typeMutexes[typeIndex]);
+			if (classSize <= m_slabSizeThreshold) {
+				ranges = allocateSlabSlots(typeIndex, bucket, refillCount, createMapped, priority, allowOverBudget,
+										   needsBlockBuffer);
+			} else {
+				for (size_t i = 0; i < refillCount; ++i) {
+					// only the range that is needed right away may go over budget
+					auto result = allocateFromBlocks(typeIndex, classSize, classSize, createMapped, priority,
+													 allowOverBudget && ranges.empty(), needsBlockBuffer);
+					if (!result.has_value())
+						break;
+					result.value().cacheBucket = bucket;
+					ranges.push_back(result.value());
+				}
+			}
+		}
+		if (ranges.empty())
+			return std::nullopt;
+
+		AllocationResult result = ranges.back();
+		ranges.pop_back();
+		m_allocationCache.refill(bucket, ranges);
+		return result;
+	}
+
+	std::optional<AllocationResult> GPUResourceAllocator::allocateFromBlocks(uint32_t typeIndex,
+																			 VkDeviceSize alignment,
+																			 VkDeviceSize size, bool createMapped,
+																			 MemoryPriority priority,
+																			 bool allowOverBudget,
+																			 bool needsBlockBuffer) {
 		auto blockIterator = m_memoryTypes[typeIndex].blocks.begin();
 		for (auto& block : m_memoryTypes[typeIndex].blocks) {
-			if (block.maxAllocatableSize >= size &&
-				(!createMapped || !block.capabilities.hostVisible || block.mappedPointer != nullptr)) {
+			if (block.maxAllocatableSize >= size && block.priority == priority &&
+				(!createMapped || !block.capabilities.hostVisible || block.mappedPointer != nullptr) &&
+				(!needsBlockBuffer || createBlockBuffer(block))) {
 				auto result = allocateInBlock(m_memoryTypes[typeIndex].blocks.handle(blockIterator), block, alignment,
 											  size, createMapped);
 				if (result.has_value())
@@ -662,22 +1623,27 @@ namespace vanadium::graphics {
 			}
 			++blockIterator;
 		}
-		if (m_heapBudgets[m_memoryTypes[typeIndex].heapIndex] > size) {
-			if (!allocateBlock(typeIndex, size, createMapped, false)) {
+		if (allowOverBudget || heapBudget(m_memoryTypes[typeIndex].heapIndex) > size) {
+			if (!allocateBlock(typeIndex, size, createMapped, false, priority, allowOverBudget)) {
 				return std::nullopt;
 			}
 			auto blockHandle = m_memoryTypes[typeIndex].blocks.handle(--m_memoryTypes[typeIndex].blocks.end());
-			return allocateInBlock(blockHandle, *(--m_memoryTypes[typeIndex].blocks.end()), alignment, size,
-								   createMapped);
+			auto& block = *(--m_memoryTypes[typeIndex].blocks.end());
+			// the empty block is released again by the next free list flush
+			if (needsBlockBuffer && !createBlockBuffer(block))
+				return std::nullopt;
+			return allocateInBlock(blockHandle, block, alignment, size, createMapped);
 		}
 		return std::nullopt;
 	}
 
 	std::optional<AllocationResult> GPUResourceAllocator::allocateImage(uint32_t typeIndex, VkDeviceSize alignment,
-																		VkDeviceSize size) {
+																		VkDeviceSize size, MemoryPriority priority,
+																		bool allowOverBudget) {
+		auto lock = std::lock_guard<std::mutex>(m_typeMutexes[typeIndex]);
 		auto blockIterator = m_memoryTypes[typeIndex].imageBlocks.begin();
 		for (auto& block : m_memoryTypes[typeIndex].imageBlocks) {
-			if (block.maxAllocatableSize >= size) {
+			if (block.maxAllocatableSize >= size && block.priority == priority) {
 				auto result = allocateInBlock(m_memoryTypes[typeIndex].imageBlocks.handle(blockIterator), block,
 											  alignment, size, false);
 				if (result.has_value())
@@ -685,8 +1651,8 @@ namespace vanadium::graphics {
 			}
 			++blockIterator;
 		}
-		if (m_heapBudgets[m_memoryTypes[typeIndex].heapIndex] > size) {
-			if (!allocateBlock(typeIndex, size, false, true)) {
+		if (allowOverBudget || heapBudget(m_memoryTypes[typeIndex].heapIndex) > size) {
+			if (!allocateBlock(typeIndex, size, false, true, priority, allowOverBudget)) {
 				return std::nullopt;
 			}
 			auto blockHandle =
@@ -697,42 +1663,131 @@ namespace vanadium::graphics {
 		return std::nullopt;
 	}
 
+	std::optional<AllocationResult> GPUResourceAllocator::allocateWithFallback(uint32_t& typeIndex,
+																			   VkMemoryPropertyFlags requiredFlags,
+																			   const VkMemoryRequirements& requirements,
+																			   bool createMapped, AllocationKind kind,
+																			   MemoryPriority priority) {
+		auto allocateFromType = [&](uint32_t index, bool allowOverBudget) {
+			if (kind == AllocationKind::Image)
+				return allocateImage(index, requirements.alignment, requirements.size, priority, allowOverBudget);
+			if (kind == AllocationKind::MixedImage) {
+				auto lock = std::lock_guard<std::mutex>(m_typeMutexes[index]);
+				return allocateFromBlocks(index, requirements.alignment, requirements.size, false, priority,
+										  allowOverBudget, false);
+			}
+			return allocate(index, requirements.alignment, requirements.size, createMapped, priority, allowOverBudget,
+							kind == AllocationKind::SuballocatedBuffer);
+		};
+
+		auto result = allocateFromType(typeIndex, false);
+		if (result.has_value())
+			return result;
+
+		for (uint32_t i = 0; i < m_memoryTypes.size(); ++i) {
+			if (i == typeIndex || (m_memoryTypes[i].properties & requiredFlags) != requiredFlags ||
+				!((1U << i) & requirements.memoryTypeBits))
+				continue;
+			result = allocateFromType(i, false);
+			if (result.has_value()) {
+				typeIndex = i;
+				return result;
+			}
+		}
+
+		// Every compatible heap is out of budget. Exceeding the budget risks paging, but failing outright would be
+		// worse, so allocate anyway and let the application know it should free something.
+		recordHeapOverrun(m_memoryTypes[typeIndex].heapIndex, requirements.size);
+		return allocateFromType(typeIndex, true);
+	}
+
+	VkMemoryRequirements GPUResourceAllocator::imagePlacementRequirements(const VkImageCreateInfo& createInfo,
+																		  VkMemoryRequirements requirements,
+																		  bool isInMixedBlock) {
+		// Linear resources and optimal images must not share a page of bufferImageGranularity bytes. Optimal images
+		// in mixed blocks own whole pages, so buffers and linear images can be packed next to them without padding.
+		if (isInMixedBlock && createInfo.tiling == VK_IMAGE_TILING_OPTIMAL && m_bufferImageGranularity > 1) {
+			requirements.alignment = std::max(requirements.alignment, m_bufferImageGranularity);
+			requirements.size = roundUpAligned(requirements.size, m_bufferImageGranularity);
+		}
+		return requirements;
+	}
+
 	std::optional<AllocationResult> GPUResourceAllocator::allocateInBlock(BlockHandle blockHandle, MemoryBlock& block,
 																		  VkDeviceSize alignment, VkDeviceSize size,
 																		  bool createMapped) {
-		auto result = allocateFromRanges(block.freeBlocksOffsetSorted, block.freeBlocksSizeSorted, alignment, size);
-		if (block.freeBlocksSizeSorted.empty())
-			block.maxAllocatableSize = 0U;
-		else {
-			block.maxAllocatableSize = block.freeBlocksSizeSorted.back().size;
-		}
+		auto result = block.allocator.allocate(alignment, size);
+		block.maxAllocatableSize = block.allocator.maxAllocatableSize();
 
 		if (result.has_value()) {
+			++block.allocationSizeClassCounts[allocationSizeClass(result.value().allocationRange.size)];
 			return AllocationResult{ .allocationRange = result.value().allocationRange,
 									 .usableRange = result.value().usableRange,
-									 .blockHandle = blockHandle };
+									 .blockHandle = blockHandle,
+									 .memoryHandle = block.memoryHandle,
+									 .capabilities = block.capabilities,
+									 .mappedPointer = block.mappedPointer,
+									 .blockBuffer = block.blockBuffer };
 		} else {
 			return std::nullopt;
 		}
 	}
 
 	void GPUResourceAllocator::freeInBlock(MemoryBlock& block, VkDeviceSize offset, VkDeviceSize size) {
-		freeToRanges(block.freeBlocksOffsetSorted, block.freeBlocksSizeSorted, offset, size);
-		block.maxAllocatableSize = block.freeBlocksSizeSorted.back().size;
+		block.allocator.free(offset, size);
+		block.maxAllocatableSize = block.allocator.maxAllocatableSize();
+		--block.allocationSizeClassCounts[allocationSizeClass(size)];
+	}
+
+	bool GPUResourceAllocator::createBlockBuffer(MemoryBlock& block) {
+		if (block.blockBuffer != VK_NULL_HANDLE)
+			return true;
+		if (!((1U << block.typeIndex) & m_blockBufferMemoryTypeBits))
+			return false;
+
+		VkBufferCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+										  .size = block.originalSize,
+										  .usage = suballocatedBufferUsage,
+										  .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+		VkBuffer buffer;
+		verifyResult(vkCreateBuffer(m_context->device(), &createInfo, nullptr, &buffer));
+		VkMemoryRequirements requirements;
+		vkGetBufferMemoryRequirements(m_context->device(), buffer, &requirements);
+		// blocks shrunk to the remaining budget can have sizes the driver needs to pad
+		if (requirements.size > block.originalSize) {
+			vkDestroyBuffer(m_context->device(), buffer, nullptr);
+			return false;
+		}
+		verifyResult(vkBindBufferMemory(m_context->device(), buffer, block.memoryHandle, 0));
+		block.blockBuffer = buffer;
+		return true;
+	}
+
+	void GPUResourceAllocator::freeBlockMemory(const MemoryBlock& block) {
+		if (block.blockBuffer != VK_NULL_HANDLE)
+			vkDestroyBuffer(m_context->device(), block.blockBuffer, nullptr);
+		vkFreeMemory(m_context->device(), block.memoryHandle, nullptr);
 	}
 
 	bool GPUResourceAllocator::allocateBlock(uint32_t typeIndex, VkDeviceSize size, bool createMapped,
-											 bool createImageBlock) {
-		size = std::max(m_blockSize, size);
+											 bool createImageBlock, MemoryPriority priority, bool allowOverBudget) {
+		VkDeviceSize remainingBudget = heapBudget(m_memoryTypes[typeIndex].heapIndex);
+		if (remainingBudget < size && !allowOverBudget)
+			return false;
+		// rather allocate a smaller block than go over budget
+		size = std::max(std::min(m_memoryTypes[typeIndex].blockSizer.nextBlockSize(size), remainingBudget), size);
 		VkDeviceMemory newMemory;
+		VkMemoryPriorityAllocateInfoEXT priorityInfo = { .sType = VK_STRUCTURE_TYPE_MEMORY_PRIORITY_ALLOCATE_INFO_EXT,
+														 .priority = memoryPriorityValue(priority) };
 		VkMemoryAllocateInfo info = { .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+									  .pNext = m_context->deviceCapabilities().memoryPriority ? &priorityInfo : nullptr,
 									  .allocationSize = size,
 									  .memoryTypeIndex = typeIndex };
 
 		VkResult result = vkAllocateMemory(m_context->device(), &info, nullptr, &newMemory);
 
 		if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY) {
-			m_heapBudgets[m_memoryTypes[typeIndex].heapIndex] = size - 1;
+			limitHeapBudget(m_memoryTypes[typeIndex].heapIndex, size);
 			return false;
 		}
 		verifyResult(result);
@@ -741,7 +1796,8 @@ namespace vanadium::graphics {
 			.deviceLocal = static_cast<bool>(m_memoryTypes[typeIndex].properties & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
 			.hostVisible = static_cast<bool>(m_memoryTypes[typeIndex].properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT),
 			.hostCoherent =
-				static_cast<bool>(m_memoryTypes[typeIndex].properties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+				static_cast<bool>(m_memoryTypes[typeIndex].properties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
+			.hostCached = static_cast<bool>(m_memoryTypes[typeIndex].properties & VK_MEMORY_PROPERTY_HOST_CACHED_BIT)
 		};
 
 		void* mappedPointer = nullptr;
@@ -749,37 +1805,45 @@ namespace vanadium::graphics {
 			verifyResult(vkMapMemory(m_context->device(), newMemory, 0, size, 0, &mappedPointer));
 		}
 
-		MemoryBlock block = { .freeBlocksSizeSorted = { { .offset = 0, .size = size } },
-							  .freeBlocksOffsetSorted = { { .offset = 0, .size = size } },
+		MemoryBlock block = { .allocator = RangeAllocator(size),
 							  .capabilities = capabilities,
+							  .typeIndex = typeIndex,
+							  .priority = priority,
 							  .maxAllocatableSize = size,
 							  .originalSize = size,
 							  .memoryHandle = newMemory,
 							  .mappedPointer = mappedPointer };
+		BlockHandle handle;
 		if (createImageBlock)
-			m_memoryTypes[typeIndex].imageBlocks.addElement(block);
+			handle = m_memoryTypes[typeIndex].imageBlocks.addElement(block);
 		else
-			m_memoryTypes[typeIndex].blocks.addElement(block);
-
-		if (m_heapBudgets[m_memoryTypes[typeIndex].heapIndex] < size)
-			m_heapBudgets[m_memoryTypes[typeIndex].heapIndex] = size;
+			handle = m_memoryTypes[typeIndex].blocks.addElement(block);
+		recordTraceEvent(AllocationTraceEventType::AllocateBlock,
+						 (createImageBlock ? AllocationTraceFlagImage : 0) |
+							 (createMapped ? AllocationTraceFlagMapped : 0),
+						 typeIndex, handle, size, 0);
 
-		m_heapBudgets[m_memoryTypes[typeIndex].heapIndex] -= size;
+		// going over budget was already recorded by allocateWithFallback
+		consumeHeapBudget(m_memoryTypes[typeIndex].heapIndex, size, false);
 
 		return true;
 	}
 
 	bool GPUResourceAllocator::allocateCustomBlock(uint32_t typeIndex, VkDeviceSize size, bool createMapped,
-												   bool createImageBlock) {
+												   bool createImageBlock, MemoryPriority priority) {
+		priority = effectivePriority(priority);
 		VkDeviceMemory newMemory;
+		VkMemoryPriorityAllocateInfoEXT priorityInfo = { .sType = VK_STRUCTURE_TYPE_MEMORY_PRIORITY_ALLOCATE_INFO_EXT,
+														 .priority = memoryPriorityValue(priority) };
 		VkMemoryAllocateInfo info = { .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+									  .pNext = m_context->deviceCapabilities().memoryPriority ? &priorityInfo : nullptr,
 									  .allocationSize = size,
 									  .memoryTypeIndex = typeIndex };
 
 		VkResult result = vkAllocateMemory(m_context->device(), &info, nullptr, &newMemory);
 
 		if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY) {
-			m_heapBudgets[m_memoryTypes[typeIndex].heapIndex] = size - 1;
+			limitHeapBudget(m_memoryTypes[typeIndex].heapIndex, size);
 			return false;
 		}
 		verifyResult(result);
@@ -788,7 +1852,8 @@ namespace vanadium::graphics {
 			.deviceLocal = static_cast<bool>(m_memoryTypes[typeIndex].properties & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
 			.hostVisible = static_cast<bool>(m_memoryTypes[typeIndex].properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT),
 			.hostCoherent =
-				static_cast<bool>(m_memoryTypes[typeIndex].properties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+				static_cast<bool>(m_memoryTypes[typeIndex].properties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
+			.hostCached = static_cast<bool>(m_memoryTypes[typeIndex].properties & VK_MEMORY_PROPERTY_HOST_CACHED_BIT)
 		};
 
 		void* mappedPointer = nullptr;
@@ -796,23 +1861,306 @@ namespace vanadium::graphics {
 			verifyResult(vkMapMemory(m_context->device(), newMemory, 0, size, 0, &mappedPointer));
 		}
 
-		MemoryBlock block = { .freeBlocksSizeSorted = { { .offset = 0, .size = size } },
-							  .freeBlocksOffsetSorted = { { .offset = 0, .size = size } },
+		MemoryBlock block = { .allocator = RangeAllocator(size),
 							  .capabilities = capabilities,
+							  .typeIndex = typeIndex,
+							  .priority = priority,
 							  .maxAllocatableSize = size,
 							  .originalSize = size,
 							  .memoryHandle = newMemory,
 							  .mappedPointer = mappedPointer };
-		if (createImageBlock)
-			m_customImageBlocks.addElement(block);
-		else
-			m_customBufferBlocks.addElement(block);
+		BlockHandle handle;
+		{
+			auto blockLock = std::lock_guard<std::mutex>(m_customBlockMutex);
+			if (createImageBlock)
+				handle = m_customImageBlocks.addElement(block);
+			else
+				handle = m_customBufferBlocks.addElement(block);
+		}
+		recordTraceEvent(AllocationTraceEventType::AllocateBlock,
+						 AllocationTraceFlagCustomBlock | (createImageBlock ? AllocationTraceFlagImage : 0) |
+							 (createMapped ? AllocationTraceFlagMapped : 0),
+						 typeIndex, handle, size, 0);
 
-		if (m_heapBudgets[m_memoryTypes[typeIndex].heapIndex] < size)
-			m_heapBudgets[m_memoryTypes[typeIndex].heapIndex] = size;
+		consumeHeapBudget(m_memoryTypes[typeIndex].heapIndex, size, true);
 
-		m_heapBudgets[m_memoryTypes[typeIndex].heapIndex] -= size;
+		return true;
+	}
 
+	bool GPUResourceAllocator::startTraceRecording(const std::string_view& fileName) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		std::vector<AllocationTraceMemoryType> memoryTypes;
+		memoryTypes.reserve(m_memoryTypes.size());
+		for (auto& type : m_memoryTypes) {
+			memoryTypes.push_back({ .properties = type.properties, .heapIndex = type.heapIndex });
+		}
+
+		// block sizes adapt at runtime, the trace's AllocateBlock events record the actual sizes
+		AllocationTraceHeader header = { .blockSize = m_defaultBlockSizePolicy.maxBlockSize,
+										 .bufferBlockFreeThreshold = m_defaultBlockSizePolicy.minRetainedSize,
+										 .imageBlockFreeThreshold = m_defaultBlockSizePolicy.minRetainedSize,
+										 .bufferImageGranularity = m_bufferImageGranularity };
+		if (!m_traceRecorder.start(fileName, header, memoryTypes,
+								   std::vector<uint64_t>(m_heapBudgets.begin(), m_heapBudgets.end()))) {
+			logError("GPUResourceAllocator: Couldn't open allocation trace file {}!", fileName);
+			return false;
+		}
+
+		// Replay starts from an empty allocator, so snapshot everything that is alive already. Exact memory
+		// requirements of live resources aren't kept, their allocation range is recorded instead.
+		uint32_t typeIndex = 0;
+		for (auto& type : m_memoryTypes) {
+			for (auto iterator = type.blocks.begin(); iterator != type.blocks.end(); ++iterator) {
+				recordTraceEvent(AllocationTraceEventType::AllocateBlock,
+								 iterator->mappedPointer ? AllocationTraceFlagMapped : 0, typeIndex,
+								 type.blocks.handle(iterator), iterator->originalSize, 0);
+			}
+			for (auto iterator = type.imageBlocks.begin(); iterator != type.imageBlocks.end(); ++iterator) {
+				recordTraceEvent(AllocationTraceEventType::AllocateBlock, AllocationTraceFlagImage, typeIndex,
+								 type.imageBlocks.handle(iterator), iterator->originalSize, 0);
+			}
+			++typeIndex;
+		}
+		for (auto iterator = m_buffers.begin(); iterator != m_buffers.end(); ++iterator) {
+			recordTraceEvent(AllocationTraceEventType::CreateBuffer,
+							 (iterator->typeIndex == ~0U ? AllocationTraceFlagCustomBlock : 0) |
+								 (iterator->isDedicated ? AllocationTraceFlagDedicated : 0),
+							 iterator->typeIndex, m_buffers.handle(iterator), iterator->allocationRange.size, 1);
+		}
+		for (auto iterator = m_images.begin(); iterator != m_images.end(); ++iterator) {
+			recordTraceEvent(AllocationTraceEventType::CreateImage,
+							 AllocationTraceFlagImage |
+								 (iterator->typeIndex == ~0U ? AllocationTraceFlagCustomBlock : 0) |
+								 (iterator->isDedicated ? AllocationTraceFlagDedicated : 0),
+							 iterator->typeIndex, m_images.handle(iterator), iterator->allocationRange.size, 1);
+		}
 		return true;
 	}
+
+	void GPUResourceAllocator::stopTraceRecording() {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		m_traceRecorder.stop();
+	}
+
+	std::optional<AllocationResult> GPUResourceAllocator::allocateDedicated(uint32_t typeIndex, VkDeviceSize size,
+																			bool createMapped, VkBuffer buffer,
+																			VkImage image, MemoryPriority priority,
+																			bool allowOverBudget) {
+		if (heapBudget(m_memoryTypes[typeIndex].heapIndex) <= size && !allowOverBudget)
+			return std::nullopt;
+
+		VkMemoryPriorityAllocateInfoEXT priorityInfo = { .sType = VK_STRUCTURE_TYPE_MEMORY_PRIORITY_ALLOCATE_INFO_EXT,
+														 .priority = memoryPriorityValue(priority) };
+		const void* priorityInfoChain = m_context->deviceCapabilities().memoryPriority ? &priorityInfo : nullptr;
+		VkMemoryDedicatedAllocateInfoKHR dedicatedInfo = {
+			.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO_KHR,
+			.pNext = priorityInfoChain,
+			.image = image,
+			.buffer = buffer,
+		};
+		// without the extension the resource still gets its own memory, the driver just doesn't know about it
+		VkMemoryAllocateInfo info = { .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+									  .pNext = m_context->deviceCapabilities().dedicatedAllocation ? &dedicatedInfo
+																								  : priorityInfoChain,
+									  .allocationSize = size,
+									  .memoryTypeIndex = typeIndex };
+
+		VkDeviceMemory newMemory;
+		VkResult result = vkAllocateMemory(m_context->device(), &info, nullptr, &newMemory);
+
+		if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY) {
+			limitHeapBudget(m_memoryTypes[typeIndex].heapIndex, size);
+			return std::nullopt;
+		}
+		verifyResult(result);
+
+		MemoryCapabilities capabilities = {
+			.deviceLocal = static_cast<bool>(m_memoryTypes[typeIndex].properties & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
+			.hostVisible = static_cast<bool>(m_memoryTypes[typeIndex].properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT),
+			.hostCoherent =
+				static_cast<bool>(m_memoryTypes[typeIndex].properties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
+			.hostCached = static_cast<bool>(m_memoryTypes[typeIndex].properties & VK_MEMORY_PROPERTY_HOST_CACHED_BIT)
+		};
+
+		void* mappedPointer = nullptr;
+		if (createMapped && capabilities.hostVisible) {
+			verifyResult(vkMapMemory(m_context->device(), newMemory, 0, size, 0, &mappedPointer));
+		}
+
+		MemoryBlock block = { .allocator = RangeAllocator(size),
+							  .capabilities = capabilities,
+							  .typeIndex = typeIndex,
+							  .priority = priority,
+							  .maxAllocatableSize = size,
+							  .originalSize = size,
+							  .memoryHandle = newMemory,
+							  .mappedPointer = mappedPointer };
+		consumeHeapBudget(m_memoryTypes[typeIndex].heapIndex, size, true);
+
+		auto lock = std::lock_guard<std::mutex>(m_typeMutexes[typeIndex]);
+		auto& blocks = image ? m_memoryTypes[typeIndex].dedicatedImageBlocks : m_memoryTypes[typeIndex].dedicatedBlocks;
+		BlockHandle handle = blocks.addElement(block);
+		return allocateInBlock(handle, blocks[handle], 1, size, createMapped);
+	}
+
+	void GPUResourceAllocator::freeDedicatedBlock(uint32_t typeIndex, BlockHandle handle, bool isImageBlock) {
+		VkDeviceMemory memory;
+		VkDeviceSize size;
+		{
+			auto lock = std::lock_guard<std::mutex>(m_typeMutexes[typeIndex]);
+			auto& blocks =
+				isImageBlock ? m_memoryTypes[typeIndex].dedicatedImageBlocks : m_memoryTypes[typeIndex].dedicatedBlocks;
+			memory = blocks[handle].memoryHandle;
+			size = blocks[handle].originalSize;
+			blocks.removeElement(handle);
+		}
+		vkFreeMemory(m_context->device(), memory, nullptr);
+		releaseHeapBudget(m_memoryTypes[typeIndex].heapIndex, size);
+	}
+
+	VkDeviceSize GPUResourceAllocator::heapBudget(uint32_t heapIndex) {
+		auto lock = std::lock_guard<std::mutex>(m_budgetMutex);
+		return m_heapBudgets[heapIndex];
+	}
+
+	void GPUResourceAllocator::consumeHeapBudget(uint32_t heapIndex, VkDeviceSize size, bool recordOverrun) {
+		auto lock = std::lock_guard<std::mutex>(m_budgetMutex);
+		if (m_heapBudgets[heapIndex] < size) {
+			if (recordOverrun)
+				m_heapOverruns[heapIndex] += size - m_heapBudgets[heapIndex];
+			m_heapBudgets[heapIndex] = size;
+		}
+		m_heapBudgets[heapIndex] -= size;
+	}
+
+	void GPUResourceAllocator::releaseHeapBudget(uint32_t heapIndex, VkDeviceSize size) {
+		auto lock = std::lock_guard<std::mutex>(m_budgetMutex);
+		m_heapBudgets[heapIndex] += size;
+	}
+
+	void GPUResourceAllocator::limitHeapBudget(uint32_t heapIndex, VkDeviceSize size) {
+		auto lock = std::lock_guard<std::mutex>(m_budgetMutex);
+		m_heapBudgets[heapIndex] = size - 1;
+	}
+
+	void GPUResourceAllocator::recordHeapOverrun(uint32_t heapIndex, VkDeviceSize size) {
+		auto lock = std::lock_guard<std::mutex>(m_budgetMutex);
+		m_heapOverruns[heapIndex] += size;
+	}
+
+	uint64_t GPUResourceAllocator::cacheBucket(uint32_t typeIndex, MemoryPriority priority, bool createMapped,
+											   bool needsBlockBuffer, uint32_t sizeClass) {
+		// the type index is kept in the upper half so ranges of one type can be found again
+		return static_cast<uint64_t>(typeIndex) << 32 | static_cast<uint64_t>(priority) << 16 |
+			   static_cast<uint64_t>(createMapped) << 9 | static_cast<uint64_t>(needsBlockBuffer) << 8 | sizeClass;
+	}
+
+	void GPUResourceAllocator::freeCachedRange(uint64_t bucket, const AllocationResult& range) {
+		uint32_t sizeClass = bucket & 0xFF;
+		if (m_allocationCache.push(bucket, sizeClass, range))
+			return;
+		uint32_t typeIndex = static_cast<uint32_t>(bucket >> 32);
+		auto lock = std::lock_guard<std::mutex>(m_typeMutexes[typeIndex]);
+		releaseCachedRange(typeIndex, bucket, range);
+	}
+
+	std::vector<AllocationResult> GPUResourceAllocator::allocateSlabSlots(uint32_t typeIndex, uint64_t bucket,
+																		  size_t count, bool createMapped,
+																		  MemoryPriority priority,
+																		  bool allowOverBudget,
+																		  bool needsBlockBuffer) {
+		VkDeviceSize slotSize = AllocationCache<AllocationResult>::sizeClassSize(bucket & 0xFF);
+		auto& pool = m_memoryTypes[typeIndex].slabPools[bucket];
+		if (pool.allocator.slotSize() == 0)
+			pool.allocator = SlabAllocator(slotSize, SlabAllocator::maxSlotsPerSlab);
+
+		std::vector<AllocationResult> slots;
+		slots.reserve(count);
+		while (slots.size() < count) {
+			auto slot = pool.allocator.allocate();
+			if (!slot.has_value()) {
+				// slabs are aligned to the slot size, so every slot in them is
+				auto slabRange = allocateFromBlocks(typeIndex, slotSize, pool.allocator.slabSize(), createMapped,
+													priority, allowOverBudget && slots.empty(), needsBlockBuffer);
+				if (!slabRange.has_value())
+					break;
+				uint32_t slabIndex = pool.allocator.addSlab(slabRange.value().usableRange.offset);
+				if (slabIndex >= pool.slabRanges.size())
+					pool.slabRanges.resize(slabIndex + 1);
+				pool.slabRanges[slabIndex] = slabRange.value();
+				continue;
+			}
+
+			AllocationResult result = pool.slabRanges[slot.value().slabIndex];
+			result.allocationRange = { .offset = pool.allocator.slotOffset(slot.value()), .size = slotSize };
+			result.usableRange = result.allocationRange;
+			result.cacheBucket = bucket;
+			result.slabIndex = slot.value().slabIndex;
+			slots.push_back(result);
+		}
+		return slots;
+	}
+
+	void GPUResourceAllocator::releaseCachedRange(uint32_t typeIndex, uint64_t bucket, const AllocationResult& range) {
+		auto& type = m_memoryTypes[typeIndex];
+		if (range.slabIndex == ~0U) {
+			freeInBlock(type.blocks[range.blockHandle], range.allocationRange.offset, range.allocationRange.size);
+			return;
+		}
+
+		auto& pool = type.slabPools[bucket];
+		const AllocationResult& slabRange = pool.slabRanges[range.slabIndex];
+		auto slotIndex = static_cast<uint32_t>((range.allocationRange.offset - slabRange.usableRange.offset) /
+											   pool.allocator.slotSize());
+		// the allocation cache already absorbs short-lived churn, empty slabs can go back to the block right away
+		if (pool.allocator.free({ .slabIndex = range.slabIndex, .slotIndex = slotIndex })) {
+			pool.allocator.removeSlab(range.slabIndex);
+			freeInBlock(type.blocks[slabRange.blockHandle], slabRange.allocationRange.offset,
+						slabRange.allocationRange.size);
+		}
+	}
+
+	BufferResourceHandle GPUResourceAllocator::addBuffer(const BufferAllocation& allocation) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_resourceMutex);
+		return m_buffers.addElement(allocation);
+	}
+
+	BufferAllocation GPUResourceAllocator::removeBuffer(BufferResourceHandle handle) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_resourceMutex);
+		BufferAllocation allocation = m_buffers[handle];
+		m_buffers.removeElement(handle);
+		return allocation;
+	}
+
+	ImageResourceHandle GPUResourceAllocator::addImage(const ImageAllocation& allocation) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_resourceMutex);
+		return m_images.addElement(allocation);
+	}
+
+	ImageAllocation GPUResourceAllocator::removeImage(ImageResourceHandle handle) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_resourceMutex);
+		ImageAllocation allocation = std::move(m_images[handle]);
+		m_images.removeElement(handle);
+		for (auto& view : allocation.declaredViews) {
+			m_imageViewTable.release(view.second);
+		}
+		return allocation;
+	}
+
+	void GPUResourceAllocator::recordTraceEvent(AllocationTraceEventType type, uint8_t flags, uint32_t typeIndex,
+												uint64_t handle, VkDeviceSize size, VkDeviceSize alignment) {
+		// recording only starts and stops while the allocator is locked exclusively
+		if (!m_traceRecorder.isRecording())
+			return;
+		auto lock = std::lock_guard<std::mutex>(m_traceMutex);
+		m_traceRecorder.record({ .type = type,
+								 .flags = flags,
+								 .memoryTypeIndex = typeIndex == ~0U ? allocationTraceCustomTypeIndex
+																	 : static_cast<uint8_t>(typeIndex),
+								 .frameInFlightIndex = static_cast<uint8_t>(m_currentFrameIndex),
+								 .frameIndex = m_absoluteFrameIndex,
+								 .handle = handle,
+								 .size = size,
+								 .alignment = alignment });
+	}
 } // namespace vanadium::graphics
@@ -14,18 +14,39 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
+#include <algorithm>
 #include <cstring>
+#include <numeric>
+#include <span>
 #include <graphics/helper/ErrorHelper.hpp>
 #include <graphics/util/GPUTransferManager.hpp>
+#include <Log.hpp>
 #include <util/SharedLockGuard.hpp>
 #include <volk.h>
 
 namespace vanadium::graphics {
 
+	// Gives every transfer the highest priority of the later transfers to its destination. Sorting by priority then
+	// keeps transfers to the same destination in submission order and never defers an older write behind a newer one.
+	template <typename Transfers, typename Transfer, typename Handle, typename TransferAccessor>
+	void inheritLaterTransferPriorities(Transfers& transfers, Handle Transfer::*dstHandle,
+										TransferAccessor transferAccessor) {
+		robin_hood::unordered_map<Handle, TransferPriority> laterPriorities;
+		for (auto iterator = transfers.rbegin(); iterator != transfers.rend(); ++iterator) {
+			Transfer& transfer = transferAccessor(*iterator);
+			auto [laterPriority, isFirst] = laterPriorities.try_emplace(transfer.*dstHandle, transfer.priority);
+			if (!isFirst) {
+				transfer.priority = std::min(transfer.priority, laterPriority->second);
+				laterPriority->second = transfer.priority;
+			}
+		}
+	}
+
 	void GPUTransferManager::create(DeviceContext* context, GPUResourceAllocator* allocator) {
 		m_context = context;
 		m_resourceAllocator = allocator;
-		m_stagingBufferAllocationFreeList.resize(frameInFlightCount);
+		m_nonCoherentAtomSize = m_context->properties().limits.nonCoherentAtomSize;
+		m_copyPool.create();
 
 		VkCommandPoolCreateInfo poolCreateInfo = { .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
 												   .queueFamilyIndex = m_context->graphicsQueueFamilyIndex() };
@@ -39,6 +60,17 @@ namespace vanadium::graphics {
 														 .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
 														 .commandBufferCount = 1 };
 			verifyResult(vkAllocateCommandBuffers(m_context->device(), &allocateInfo, &m_transferCommandBuffers[i]));
+			verifyResult(vkAllocateCommandBuffers(m_context->device(), &allocateInfo, &m_readbackCommandBuffers[i]));
+		}
+
+		if (m_context->deviceCapabilities().timelineSemaphore) {
+			VkSemaphoreTypeCreateInfoKHR typeCreateInfo = { .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR,
+															.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR,
+															.initialValue = 0 };
+			VkSemaphoreCreateInfo semaphoreCreateInfo = { .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+														  .pNext = &typeCreateInfo };
+			verifyResult(
+				vkCreateSemaphore(m_context->device(), &semaphoreCreateInfo, nullptr, &m_asyncTransferSemaphore));
 		}
 	}
 
@@ -51,7 +83,7 @@ namespace vanadium::graphics {
 														.usage = usageFlags | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
 														.sharingMode = VK_SHARING_MODE_EXCLUSIVE };
 		BufferResourceHandle dstBuffer = m_resourceAllocator->createPerFrameBuffer(
-			transferBufferCreateInfo, { .deviceLocal = true, .hostVisible = true }, {}, true);
+			transferBufferCreateInfo, { .deviceLocal = true, .hostVisible = true }, {}, true, MemoryPriority::High);
 		GPUTransfer transfer = { .dstBuffer = dstBuffer,
 								 .bufferSize = transferBufferSize,
 								 .dstUsageStageFlags = usageStageFlags,
@@ -60,7 +92,8 @@ namespace vanadium::graphics {
 		if (dstBuffer == ~0U) {
 			// Nothing has used the buffer yet, no need for it to hang around in free lists
 			dstBuffer = m_resourceAllocator->createBuffer(transferBufferCreateInfo, {},
-														  { .deviceLocal = true, .hostVisible = true }, false);
+														  { .deviceLocal = true, .hostVisible = true }, false,
+														  MemoryPriority::High);
 			transfer.dstBuffer = dstBuffer;
 			transfer.needsStagingBuffer = true;
 			for (size_t i = 0; i < frameInFlightCount; ++i) {
@@ -68,7 +101,9 @@ namespace vanadium::graphics {
 			}
 		}
 
-		transfer.hasNewData = std::vector<bool>(graphics::frameInFlightCount, true);
+		transfer.dirtyRanges.resize(frameInFlightCount);
+		transfer.staleRanges = std::vector<std::vector<MemoryRange>>(
+			frameInFlightCount, { { .offset = 0, .size = transferBufferSize } });
 
 		return m_continuousTransfers.addElement(transfer);
 	}
@@ -77,11 +112,7 @@ namespace vanadium::graphics {
 		auto& transfer = m_continuousTransfers[handle];
 		if (transfer.needsStagingBuffer) {
 			for (auto& buffer : transfer.stagingBuffers) {
-				auto bufferHandle = buffer.bufferHandle;
-				auto& allocationRange = buffer.allocationResult.allocationRange;
-				freeToRanges(m_stagingBuffers[bufferHandle].freeRangesOffsetSorted,
-							 m_stagingBuffers[bufferHandle].freeRangesSizeSorted, allocationRange.offset,
-							 allocationRange.size);
+				freeStagingBufferArea(buffer);
 			}
 		}
 		m_resourceAllocator->destroyBuffer(transfer.dstBuffer);
@@ -92,14 +123,166 @@ namespace vanadium::graphics {
 																			BufferResourceHandle dstBuffer,
 																			size_t offset,
 																			VkPipelineStageFlags usageStageFlags,
-																			VkAccessFlags usageAccessFlags) {
+																			VkAccessFlags usageAccessFlags,
+																			TransferPriority priority) {
+		GPUUpload upload = beginUpload(size);
+		m_copyPool.copy(upload.data, data, size);
+		return commitAsyncBufferTransfer(upload.handle, dstBuffer, offset, usageStageFlags, usageAccessFlags,
+										 priority);
+	}
+
+	AsyncImageTransferHandle GPUTransferManager::createAsyncImageTransfer(
+		void* data, size_t size, ImageResourceHandle dstImage, const VkBufferImageCopy& copy,
+		VkImageLayout dstImageLayout, VkPipelineStageFlags usageStageFlags, VkAccessFlags usageAccessFlags,
+		TransferPriority priority) {
+		GPUUpload upload = beginUpload(size);
+		m_copyPool.copy(upload.data, data, size);
+		return commitAsyncImageTransfer(upload.handle, dstImage, copy, dstImageLayout, usageStageFlags,
+										usageAccessFlags, priority);
+	}
+
+	void GPUTransferManager::submitOneTimeTransfer(VkDeviceSize transferBufferSize, BufferResourceHandle handle,
+												   const void* data, VkPipelineStageFlags usageStageFlags,
+												   VkAccessFlags usageAccessFlags, TransferPriority priority) {
+		GPUUpload upload = beginUpload(transferBufferSize, handle);
+		m_copyPool.copy(upload.data, data, transferBufferSize);
+		commitOneTimeTransfer(upload.handle, handle, usageStageFlags, usageAccessFlags, priority);
+	}
+
+	void GPUTransferManager::submitImageTransfer(ImageResourceHandle dstImage, const VkBufferImageCopy& copy,
+												 const void* data, VkDeviceSize size,
+												 VkPipelineStageFlags usageStageFlags, VkAccessFlags usageAccessFlags,
+												 VkImageLayout dstUsageLayout, VkImageLayout srcLayout,
+												 TransferPriority priority) {
+		GPUUpload upload = beginUpload(size);
+		m_copyPool.copy(upload.data, data, size);
+		commitImageTransfer(upload.handle, dstImage, copy, usageStageFlags, usageAccessFlags, dstUsageLayout,
+							srcLayout, priority);
+	}
+
+	GPUUpload GPUTransferManager::beginUpload(VkDeviceSize size, BufferResourceHandle dstBuffer) {
 		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		OpenUpload upload = { .size = size, .directBuffer = ~0U };
+
+		void* mappedData = dstBuffer != ~0U ? m_resourceAllocator->mappedBufferData(dstBuffer) : nullptr;
+		if (mappedData) {
+			upload.directBuffer = dstBuffer;
+			upload.stagingRingAllocation.data = mappedData;
+		} else {
+			upload.stagingRingAllocation = allocateStagingRingArea(size);
+		}
+		void* data = upload.stagingRingAllocation.data;
+		return { .handle = m_openUploads.addElement(upload), .data = data };
+	}
+
+	void GPUTransferManager::commitOneTimeTransfer(GPUUploadHandle uploadHandle, BufferResourceHandle dstBuffer,
+												   VkPipelineStageFlags usageStageFlags,
+												   VkAccessFlags usageAccessFlags, TransferPriority priority) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		OpenUpload upload = closeUpload(uploadHandle);
+		assertFatal(upload.directBuffer == ~0U || upload.directBuffer == dstBuffer,
+					"GPUTransferManager: Committed a direct upload to a different buffer!\n");
+		if (upload.directBuffer != ~0U) {
+			upload.stagingRingAllocation = {};
+		}
+		enqueueOneTimeTransfer(upload.stagingRingAllocation, upload.size, dstBuffer, usageStageFlags,
+							   usageAccessFlags, priority);
+	}
+
+	void GPUTransferManager::commitImageTransfer(GPUUploadHandle uploadHandle, ImageResourceHandle dstImage,
+												 const VkBufferImageCopy& copy, VkPipelineStageFlags usageStageFlags,
+												 VkAccessFlags usageAccessFlags, VkImageLayout dstUsageLayout,
+												 VkImageLayout srcLayout, TransferPriority priority) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		OpenUpload upload = closeUpload(uploadHandle);
+		assertFatal(upload.directBuffer == ~0U, "GPUTransferManager: Committed a direct upload to an image!\n");
+		enqueueImageTransfer(upload.stagingRingAllocation, upload.size, dstImage, copy, usageStageFlags,
+							 usageAccessFlags, dstUsageLayout, srcLayout, priority);
+	}
+
+	AsyncBufferTransferHandle GPUTransferManager::commitAsyncBufferTransfer(GPUUploadHandle uploadHandle,
+																			BufferResourceHandle dstBuffer,
+																			size_t offset,
+																			VkPipelineStageFlags usageStageFlags,
+																			VkAccessFlags usageAccessFlags,
+																			TransferPriority priority) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		OpenUpload upload = closeUpload(uploadHandle);
+		assertFatal(upload.directBuffer == ~0U,
+					"GPUTransferManager: Committed a direct upload to an async transfer!\n");
+		return enqueueAsyncBufferTransfer(upload.stagingRingAllocation, upload.size, dstBuffer, offset,
+										  usageStageFlags, usageAccessFlags, priority);
+	}
+
+	AsyncImageTransferHandle GPUTransferManager::commitAsyncImageTransfer(
+		GPUUploadHandle uploadHandle, ImageResourceHandle dstImage, const VkBufferImageCopy& copy,
+		VkImageLayout dstImageLayout, VkPipelineStageFlags usageStageFlags, VkAccessFlags usageAccessFlags,
+		TransferPriority priority) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		OpenUpload upload = closeUpload(uploadHandle);
+		assertFatal(upload.directBuffer == ~0U,
+					"GPUTransferManager: Committed a direct upload to an async transfer!\n");
+		return enqueueAsyncImageTransfer(upload.stagingRingAllocation, upload.size, dstImage, copy, dstImageLayout,
+										 usageStageFlags, usageAccessFlags, priority);
+	}
+
+	void GPUTransferManager::cancelUpload(GPUUploadHandle uploadHandle) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		closeUpload(uploadHandle);
+	}
+
+	OpenUpload GPUTransferManager::closeUpload(GPUUploadHandle handle) {
+		OpenUpload upload = m_openUploads[handle];
+		m_openUploads.removeElement(handle);
+
+		auto& allocation = upload.stagingRingAllocation;
+		if (allocation.ringPosition != ~0ULL && !m_stagingRing.isCoherent &&
+			allocation.ringGeneration == m_stagingRing.generation) {
+			// flushStagingRing may have flushed the range before it was written
+			queueMemoryFlush(m_stagingRing.buffer, allocation.offset, upload.size);
+		}
+		return upload;
+	}
+
+	void GPUTransferManager::collectHeldStagingAllocations() {
+		m_heldStagingAllocations.clear();
+		for (auto& upload : m_openUploads) {
+			m_heldStagingAllocations.push_back(upload.stagingRingAllocation);
+		}
+		for (auto& transfer : m_oneTimeTransfers) {
+			if (transfer.needsStagingBuffer) {
+				m_heldStagingAllocations.push_back(transfer.stagingRingAllocation);
+			}
+		}
+		for (auto& transfer : m_imageTransfers) {
+			m_heldStagingAllocations.push_back(transfer.stagingRingAllocation);
+		}
+		for (auto& handle : m_bufferHandlesToBegin) {
+			m_heldStagingAllocations.push_back(m_asyncBufferTransfers[handle].stagingRingAllocation);
+		}
+		for (auto& handle : m_imageHandlesToBegin) {
+			m_heldStagingAllocations.push_back(m_asyncImageTransfers[handle].stagingRingAllocation);
+		}
+	}
+
+	VkDeviceSize GPUTransferManager::stagingRingRetirableHead() const {
+		VkDeviceSize retirableHead = m_stagingRing.head;
+		for (auto& allocation : m_heldStagingAllocations) {
+			if (allocation.ringPosition != ~0ULL && allocation.ringGeneration == m_stagingRing.generation) {
+				retirableHead = std::min(retirableHead, allocation.ringPosition);
+			}
+		}
+		return retirableHead;
+	}
+
+	AsyncBufferTransferHandle GPUTransferManager::enqueueAsyncBufferTransfer(
+		const StagingRingAllocation& stagingAllocation, VkDeviceSize size, BufferResourceHandle dstBuffer,
+		size_t offset, VkPipelineStageFlags usageStageFlags, VkAccessFlags usageAccessFlags,
+		TransferPriority priority) {
 		AsyncBufferTransfer transfer = {
-			.stagingBufferAllocation = allocateStagingBufferArea(size),
+			.stagingRingAllocation = stagingAllocation,
 			.dstBufferHandle = dstBuffer,
-			.copy = { .srcOffset = transfer.stagingBufferAllocation.allocationResult.usableRange.offset,
-					  .dstOffset = offset,
-					  .size = size },
+			.copy = { .srcOffset = stagingAllocation.offset, .dstOffset = offset, .size = size },
 			.transferBarrier = { .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
 								 .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
 								 .dstAccessMask = 0,
@@ -117,23 +300,21 @@ namespace vanadium::graphics {
 								.buffer = m_resourceAllocator->nativeBufferHandle(dstBuffer),
 								.offset = offset,
 								.size = size },
-			.dstStageFlags = usageStageFlags
+			.dstStageFlags = usageStageFlags,
+			.priority = priority
 		};
-		std::memcpy(
-			reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(m_resourceAllocator->mappedBufferData(
-										m_stagingBuffers[transfer.stagingBufferAllocation.bufferHandle].buffer)) +
-									transfer.stagingBufferAllocation.allocationResult.usableRange.offset),
-			data, size);
 
-		return m_asyncBufferTransfers.addElement(transfer);
+		AsyncBufferTransferHandle handle = m_asyncBufferTransfers.addElement(transfer);
+		m_bufferHandlesToBegin.push_back(handle);
+		return handle;
 	}
 
-	AsyncImageTransferHandle GPUTransferManager::createAsyncImageTransfer(
-		void* data, size_t size, ImageResourceHandle dstImage, const VkBufferImageCopy& copy,
-		VkImageLayout dstImageLayout, VkPipelineStageFlags usageStageFlags, VkAccessFlags usageAccessFlags) {
-		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+	AsyncImageTransferHandle GPUTransferManager::enqueueAsyncImageTransfer(
+		const StagingRingAllocation& stagingAllocation, VkDeviceSize size, ImageResourceHandle dstImage,
+		const VkBufferImageCopy& copy, VkImageLayout dstImageLayout, VkPipelineStageFlags usageStageFlags,
+		VkAccessFlags usageAccessFlags, TransferPriority priority) {
 		AsyncImageTransfer transfer = {
-			.stagingBufferAllocation = allocateStagingBufferArea(size),
+			.stagingRingAllocation = stagingAllocation,
 			.dstImageHandle = dstImage,
 			.copy = copy,
 			.layoutTransitionBarrier = { .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
@@ -141,8 +322,8 @@ namespace vanadium::graphics {
 										 .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
 										 .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
 										 .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-										 .srcQueueFamilyIndex = m_context->asyncTransferQueueFamilyIndex(),
-										 .dstQueueFamilyIndex = m_context->graphicsQueueFamilyIndex(),
+										 .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+										 .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
 										 .image = m_resourceAllocator->nativeImageHandle(dstImage),
 										 .subresourceRange = { .aspectMask = copy.imageSubresource.aspectMask,
 															   .baseMipLevel = copy.imageSubresource.mipLevel,
@@ -178,90 +359,257 @@ namespace vanadium::graphics {
 													  .baseArrayLayer = copy.imageSubresource.baseArrayLayer,
 													  .layerCount = copy.imageSubresource.layerCount,
 													  } },
-			.dstStageFlags = usageStageFlags
+			.dstStageFlags = usageStageFlags,
+			.size = size,
+			.priority = priority
 		};
+		transfer.copy.bufferOffset += stagingAllocation.offset;
 
-		return m_asyncImageTransfers.addElement(transfer);
+		AsyncImageTransferHandle handle = m_asyncImageTransfers.addElement(transfer);
+		m_imageHandlesToBegin.push_back(handle);
+		return handle;
 	}
 
-	void GPUTransferManager::submitOneTimeTransfer(VkDeviceSize transferBufferSize, BufferResourceHandle handle,
-												   const void* data, VkPipelineStageFlags usageStageFlags,
-												   VkAccessFlags usageAccessFlags) {
-		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
-		GPUTransfer transfer = { .bufferSize = transferBufferSize,
+	void GPUTransferManager::enqueueOneTimeTransfer(const StagingRingAllocation& stagingAllocation,
+													VkDeviceSize size, BufferResourceHandle dstBuffer,
+													VkPipelineStageFlags usageStageFlags,
+													VkAccessFlags usageAccessFlags, TransferPriority priority) {
+		// without staging memory, the data has been written to the destination directly
+		GPUTransfer transfer = { .dstBuffer = dstBuffer,
+								 .stagingRingAllocation = stagingAllocation,
+								 .needsStagingBuffer = stagingAllocation.buffer != VK_NULL_HANDLE,
+								 .bufferSize = size,
 								 .dstUsageStageFlags = usageStageFlags,
-								 .dstUsageAccessFlags = usageAccessFlags };
-
-		if (!m_resourceAllocator->bufferMemoryCapabilities(handle).hostVisible) {
-			transfer.needsStagingBuffer = true;
-			transfer.stagingBuffers = { allocateStagingBufferArea(transferBufferSize) };
-			auto mappedDataStart =
-				m_resourceAllocator->mappedBufferData(m_stagingBuffers[transfer.stagingBuffers[0].bufferHandle].buffer);
-			std::memcpy(reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(mappedDataStart) +
-												transfer.stagingBuffers[0].allocationResult.usableRange.offset),
-						data, transferBufferSize);
-		} else {
-			std::memcpy(m_resourceAllocator->mappedBufferData(handle), data, transferBufferSize);
+								 .dstUsageAccessFlags = usageAccessFlags,
+								 .priority = priority };
+		if (!transfer.needsStagingBuffer) {
+			queueMemoryFlush(dstBuffer, 0, m_resourceAllocator->allocationRange(dstBuffer).size);
 		}
-
-		transfer.dstBuffer = handle;
 		m_oneTimeTransfers.push_back(transfer);
 	}
 
-	void GPUTransferManager::submitImageTransfer(ImageResourceHandle dstImage, const VkBufferImageCopy& copy,
-												 const void* data, VkDeviceSize size,
-												 VkPipelineStageFlags usageStageFlags, VkAccessFlags usageAccessFlags,
-												 VkImageLayout dstUsageLayout, VkImageLayout srcLayout) {
-		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
-		VkBufferCreateInfo transferBufferCreateInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-														.size = size,
-														.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-														.sharingMode = VK_SHARING_MODE_EXCLUSIVE };
-		BufferResourceHandle buffer = m_resourceAllocator->createBuffer(
-			transferBufferCreateInfo, { .hostVisible = true }, { .deviceLocal = true }, true);
-
-		std::memcpy(m_resourceAllocator->mappedBufferData(buffer), data, size);
-
-		m_imageTransfers.push_back({ .stagingBuffer = buffer,
+	void GPUTransferManager::enqueueImageTransfer(const StagingRingAllocation& stagingAllocation, VkDeviceSize size,
+												  ImageResourceHandle dstImage, const VkBufferImageCopy& copy,
+												  VkPipelineStageFlags usageStageFlags,
+												  VkAccessFlags usageAccessFlags, VkImageLayout dstUsageLayout,
+												  VkImageLayout srcLayout, TransferPriority priority) {
+		m_imageTransfers.push_back({ .stagingRingAllocation = stagingAllocation,
 									 .dstImage = dstImage,
 									 .stagingBufferSize = size,
 									 .copy = copy,
 									 .dstUsageStageFlags = usageStageFlags,
 									 .dstUsageAccessFlags = usageAccessFlags,
 									 .dstUsageLayout = dstUsageLayout,
-									 .srcLayout = srcLayout });
+									 .srcLayout = srcLayout,
+									 .priority = priority });
+		m_imageTransfers.back().copy.bufferOffset += stagingAllocation.offset;
 	}
 
 	void GPUTransferManager::updateTransferData(GPUTransferHandle transferHandle, uint32_t frameIndex,
 												const void* data) {
 		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		auto& transfer = m_continuousTransfers[transferHandle];
+
+		writeTransferRange(transfer, frameIndex, data, { .offset = 0, .size = transfer.bufferSize });
+		transfer.staleRanges[frameIndex].clear();
+	}
+
+	void GPUTransferManager::updateTransferData(GPUTransferHandle transferHandle, uint32_t frameIndex,
+												const void* data, VkDeviceSize offset, VkDeviceSize size) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		auto& transfer = m_continuousTransfers[transferHandle];
+
+		writeTransferRange(transfer, frameIndex, data, { .offset = offset, .size = size });
+		eraseRange(transfer.staleRanges[frameIndex], { .offset = offset, .size = size });
+	}
 
+	void GPUTransferManager::invalidateTransferRange(GPUTransferHandle transferHandle, VkDeviceSize offset,
+													 VkDeviceSize size) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
 		auto& transfer = m_continuousTransfers[transferHandle];
+		size = std::min(size, transfer.bufferSize - std::min(offset, transfer.bufferSize));
+		for (auto& ranges : transfer.staleRanges) {
+			insertMergedRange(ranges, { .offset = offset, .size = size });
+		}
+	}
 
-		BufferResourceHandle dstWriteBuffer;
-		void* dstData;
+	void GPUTransferManager::invalidateChangedTransferData(GPUTransferHandle transferHandle, const void* previousData,
+														   VkDeviceSize previousSize, const void* data,
+														   VkDeviceSize size, VkDeviceSize compareGranularity) {
+		auto previousBytes = static_cast<const unsigned char*>(previousData);
+		auto bytes = static_cast<const unsigned char*>(data);
+		VkDeviceSize comparedSize = std::min(previousSize, size);
+		compareGranularity = std::max(compareGranularity, VkDeviceSize(1));
+
+		VkDeviceSize changeStart = ~0ULL;
+		for (VkDeviceSize offset = 0; offset < comparedSize; offset += compareGranularity) {
+			VkDeviceSize blockSize = std::min(compareGranularity, comparedSize - offset);
+			bool changed = std::memcmp(previousBytes + offset, bytes + offset, blockSize) != 0;
+			if (changed && changeStart == ~0ULL) {
+				changeStart = offset;
+			} else if (!changed && changeStart != ~0ULL) {
+				invalidateTransferRange(transferHandle, changeStart, offset - changeStart);
+				changeStart = ~0ULL;
+			}
+		}
+		if (changeStart != ~0ULL) {
+			invalidateTransferRange(transferHandle, changeStart, comparedSize - changeStart);
+		}
+		if (size > previousSize) {
+			invalidateTransferRange(transferHandle, previousSize, size - previousSize);
+		}
+	}
+
+	void GPUTransferManager::flushTransferData(GPUTransferHandle transferHandle, uint32_t frameIndex,
+											   const void* data, VkDeviceSize dataSize) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		auto& transfer = m_continuousTransfers[transferHandle];
+		auto& staleRanges = transfer.staleRanges[frameIndex];
+		if (staleRanges.empty())
+			return;
+
+		std::vector<MemoryRange> remainingRanges;
+		for (auto& range : staleRanges) {
+			if (range.offset >= dataSize) {
+				remainingRanges.push_back(range);
+				continue;
+			}
+			VkDeviceSize writtenSize = std::min(range.size, dataSize - range.offset);
+			writeTransferRange(transfer, frameIndex, static_cast<const unsigned char*>(data) + range.offset,
+							   { .offset = range.offset, .size = writtenSize });
+			if (writtenSize < range.size) {
+				remainingRanges.push_back({ .offset = dataSize, .size = range.size - writtenSize });
+			}
+		}
+		staleRanges = std::move(remainingRanges);
+	}
+
+	void GPUTransferManager::writeTransferRange(GPUTransfer& transfer, uint32_t frameIndex, const void* data,
+												MemoryRange range) {
 		if (transfer.needsStagingBuffer) {
-			dstWriteBuffer = m_stagingBuffers[transfer.stagingBuffers[frameIndex].bufferHandle].buffer;
-			dstData = reinterpret_cast<void*>(
-				reinterpret_cast<uintptr_t>(m_resourceAllocator->mappedBufferData(
-					m_stagingBuffers[transfer.stagingBuffers[frameIndex].bufferHandle].buffer)) +
-				transfer.stagingBuffers[frameIndex].allocationResult.usableRange.offset);
+			auto& stagingAllocation = transfer.stagingBuffers[frameIndex];
+			BufferResourceHandle stagingBuffer = m_stagingBuffers[stagingAllocation.bufferHandle].buffer;
+			VkDeviceSize stagingOffset = stagingAllocation.allocationResult.usableRange.offset + range.offset;
+			std::memcpy(static_cast<unsigned char*>(m_resourceAllocator->mappedBufferData(stagingBuffer)) +
+							stagingOffset,
+						data, range.size);
+			queueMemoryFlush(stagingBuffer, stagingOffset, range.size);
 		} else {
-			dstWriteBuffer = transfer.dstBuffer;
-			dstData = m_resourceAllocator->mappedBufferData(dstWriteBuffer);
+			std::memcpy(static_cast<unsigned char*>(m_resourceAllocator->mappedBufferData(transfer.dstBuffer)) +
+							range.offset,
+						data, range.size);
+			// the frame's copy of a host-visible destination buffer has no known memory offset, it is flushed whole
+			queueMemoryFlush(transfer.dstBuffer, 0, m_resourceAllocator->allocationRange(transfer.dstBuffer).size);
+		}
+		insertMergedRange(transfer.dirtyRanges[frameIndex], range);
+	}
+
+	void GPUTransferManager::queueMemoryFlush(BufferResourceHandle buffer, VkDeviceSize offset, VkDeviceSize size) {
+		if (m_resourceAllocator->bufferMemoryCapabilities(buffer).hostCoherent)
+			return;
+		VkDeviceSize start = m_resourceAllocator->allocationRange(buffer).offset + offset;
+		VkDeviceSize alignedStart = start / m_nonCoherentAtomSize * m_nonCoherentAtomSize;
+		m_queuedFlushRanges.push_back({ .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+										.memory = m_resourceAllocator->nativeMemoryHandle(buffer),
+										.offset = alignedStart,
+										.size = roundUpAligned(start + size - alignedStart, m_nonCoherentAtomSize) });
+	}
+
+	void GPUTransferManager::flushQueuedMemoryRanges() {
+		if (m_queuedFlushRanges.empty())
+			return;
+		std::sort(m_queuedFlushRanges.begin(), m_queuedFlushRanges.end(),
+				  [](const VkMappedMemoryRange& one, const VkMappedMemoryRange& other) {
+					  return one.memory < other.memory || (one.memory == other.memory && one.offset < other.offset);
+				  });
+
+		// ranges are atom-aligned already, so merging overlapping and adjacent ones keeps them aligned
+		size_t mergedCount = 0;
+		for (auto& range : m_queuedFlushRanges) {
+			if (mergedCount) {
+				auto& lastRange = m_queuedFlushRanges[mergedCount - 1];
+				if (lastRange.memory == range.memory && range.offset <= lastRange.offset + lastRange.size) {
+					lastRange.size = std::max(lastRange.size, range.offset + range.size - lastRange.offset);
+					continue;
+				}
+			}
+			m_queuedFlushRanges[mergedCount++] = range;
 		}
+		verifyResult(vkFlushMappedMemoryRanges(m_context->device(), static_cast<uint32_t>(mergedCount),
+											   m_queuedFlushRanges.data()));
+		m_queuedFlushRanges.clear();
+	}
 
-		std::memcpy(dstData, data, transfer.bufferSize);
-		if (!m_resourceAllocator->bufferMemoryCapabilities(dstWriteBuffer).hostCoherent) {
-			auto range = m_resourceAllocator->allocationRange(dstWriteBuffer);
-			VkMappedMemoryRange flushRange = { .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
-											   .memory = m_resourceAllocator->nativeMemoryHandle(dstWriteBuffer),
-											   .offset = range.offset,
-											   .size = range.size };
-			vkFlushMappedMemoryRanges(m_context->device(), 1, &flushRange);
+	void GPUTransferManager::recordBufferCopies(VkCommandBuffer commandBuffer, std::vector<BufferCopyCommand>& copies) {
+		// Transfer writes aren't ordered without a barrier. A copy overlapping an earlier one in the destination goes
+		// into a later layer, and the layers are separated by barriers, so the copy submitted last wins.
+		std::vector<size_t> order = std::vector<size_t>(copies.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&copies](size_t one, size_t other) {
+			if (copies[one].dstBuffer != copies[other].dstBuffer)
+				return copies[one].dstBuffer < copies[other].dstBuffer;
+			if (copies[one].region.dstOffset != copies[other].region.dstOffset)
+				return copies[one].region.dstOffset < copies[other].region.dstOffset;
+			return one < other;
+		});
+		for (size_t clusterStart = 0; clusterStart < order.size();) {
+			// copies that can only overlap each other, in most cases just one
+			auto& firstCopy = copies[order[clusterStart]];
+			VkDeviceSize clusterEnd = firstCopy.region.dstOffset + firstCopy.region.size;
+			size_t clusterSize = 1;
+			for (; clusterStart + clusterSize < order.size(); ++clusterSize) {
+				auto& copy = copies[order[clusterStart + clusterSize]];
+				if (copy.dstBuffer != firstCopy.dstBuffer || copy.region.dstOffset >= clusterEnd)
+					break;
+				clusterEnd = std::max(clusterEnd, copy.region.dstOffset + copy.region.size);
+			}
+
+			auto cluster = std::span(order).subspan(clusterStart, clusterSize);
+			std::sort(cluster.begin(), cluster.end());
+			for (size_t i = 1; i < cluster.size(); ++i) {
+				auto& copy = copies[cluster[i]];
+				for (size_t j = 0; j < i; ++j) {
+					auto& earlierCopy = copies[cluster[j]];
+					if (copy.region.dstOffset < earlierCopy.region.dstOffset + earlierCopy.region.size &&
+						earlierCopy.region.dstOffset < copy.region.dstOffset + copy.region.size) {
+						copy.layer = std::max(copy.layer, earlierCopy.layer + 1);
+					}
+				}
+			}
+			clusterStart += clusterSize;
 		}
 
-		transfer.hasNewData[frameIndex] = true;
+		std::sort(copies.begin(), copies.end(), [](const BufferCopyCommand& one, const BufferCopyCommand& other) {
+			if (one.layer != other.layer)
+				return one.layer < other.layer;
+			if (one.srcBuffer != other.srcBuffer)
+				return one.srcBuffer < other.srcBuffer;
+			if (one.dstBuffer != other.dstBuffer)
+				return one.dstBuffer < other.dstBuffer;
+			return one.region.dstOffset < other.region.dstOffset;
+		});
+
+		std::vector<VkBufferCopy> regions;
+		for (size_t i = 0; i < copies.size(); ++i) {
+			if (i && copies[i].layer != copies[i - 1].layer) {
+				VkMemoryBarrier barrier = { .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+											.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+											.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT };
+				vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+									 1, &barrier, 0, nullptr, 0, nullptr);
+			}
+			regions.push_back(copies[i].region);
+			// copies of one layer never overlap in the destination, so they can be regions of a single command
+			bool endsBatch = i + 1 == copies.size() || copies[i + 1].layer != copies[i].layer ||
+							 copies[i + 1].srcBuffer != copies[i].srcBuffer ||
+							 copies[i + 1].dstBuffer != copies[i].dstBuffer;
+			if (endsBatch) {
+				vkCmdCopyBuffer(commandBuffer, copies[i].srcBuffer, copies[i].dstBuffer,
+								static_cast<uint32_t>(regions.size()), regions.data());
+				regions.clear();
+			}
+		}
+		copies.clear();
 	}
 
 	BufferResourceHandle GPUTransferManager::dstBufferHandle(GPUTransferHandle handle) {
@@ -269,138 +617,102 @@ namespace vanadium::graphics {
 		return m_continuousTransfers[handle].dstBuffer;
 	}
 
-	VkCommandBuffer GPUTransferManager::recordTransfers(uint32_t frameIndex) {
+	void GPUTransferManager::setAsyncTransferBatchSizeLimit(VkDeviceSize bytes) {
 		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
-		verifyResult(vkResetCommandPool(m_context->device(), m_transferCommandPools[frameIndex], 0));
-
-		if (!m_bufferHandlesToBegin.empty() || !m_imageHandlesToBegin.empty()) {
-			AsyncTransferCommandPoolHandle poolHandle;
-			if (m_freeAsyncTransferCommandPools.empty()) {
-				AsyncTransferCommandPool newPool = {};
-				VkCommandPoolCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
-													   .queueFamilyIndex = m_context->asyncTransferQueueFamilyIndex() };
-				verifyResult(vkCreateCommandPool(m_context->device(), &createInfo, nullptr, &newPool.pool));
-
-				VkCommandBufferAllocateInfo allocateInfo = { .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-															 .commandPool = newPool.pool,
-															 .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-															 .commandBufferCount = 1 };
-				verifyResult(vkAllocateCommandBuffers(m_context->device(), &allocateInfo, &newPool.buffer));
-
-				VkFenceCreateInfo fenceCreateInfo = { .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
-				verifyResult(vkCreateFence(m_context->device(), &fenceCreateInfo, nullptr, &newPool.fence));
-
-				poolHandle = m_asyncTransferCommandPools.addElement(newPool);
-			} else {
-				vkResetFences(m_context->device(), 1, &m_freeAsyncTransferCommandPools.back().fence);
-				poolHandle = m_asyncTransferCommandPools.addElement(m_freeAsyncTransferCommandPools.back());
-				m_freeAsyncTransferCommandPools.pop_back();
-			}
-			m_asyncTransferCommandPools[poolHandle].refCount =
-				m_bufferHandlesToBegin.size() + m_imageHandlesToBegin.size();
-			VkCommandBufferBeginInfo beginInfo = { .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-												   .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT };
-			vkBeginCommandBuffer(m_asyncTransferCommandPools[poolHandle].buffer, &beginInfo);
-
-			std::vector<VkImageMemoryBarrier> imageLayoutTransitionBarriers;
-			imageLayoutTransitionBarriers.reserve(m_imageHandlesToBegin.size());
-
-			for (auto& handle : m_imageHandlesToBegin) {
-				auto& transfer = m_asyncImageTransfers[handle];
-				imageLayoutTransitionBarriers.push_back(transfer.layoutTransitionBarrier);
-			}
-			vkCmdPipelineBarrier(m_asyncTransferCommandPools[poolHandle].buffer, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
-								 0, nullptr, 0, nullptr, static_cast<uint32_t>(imageLayoutTransitionBarriers.size()),
-								 imageLayoutTransitionBarriers.data());
-
-			std::vector<VkBufferMemoryBarrier> releaseBarriers;
-			releaseBarriers.reserve(m_bufferHandlesToBegin.size());
-			for (auto& handle : m_bufferHandlesToBegin) {
-				auto& transfer = m_asyncBufferTransfers[handle];
-
-				transfer.containingCommandPool = poolHandle;
-				vkCmdCopyBuffer(m_asyncTransferCommandPools[poolHandle].buffer,
-								m_resourceAllocator->nativeBufferHandle(
-									m_stagingBuffers[transfer.stagingBufferAllocation.bufferHandle].buffer),
-								m_resourceAllocator->nativeBufferHandle(transfer.dstBufferHandle), 1, &transfer.copy);
-				releaseBarriers.push_back(transfer.transferBarrier);
-			}
+		m_asyncTransferBatchSizeLimit = bytes;
+	}
 
-			std::vector<VkImageMemoryBarrier> imageReleaseBarriers;
-			imageReleaseBarriers.reserve(m_imageHandlesToBegin.size());
-			for (auto& handle : m_imageHandlesToBegin) {
-				auto& transfer = m_asyncImageTransfers[handle];
+	void GPUTransferManager::setTransferBudget(VkDeviceSize bytesPerFrame) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		m_transferBudget = bytesPerFrame;
+	}
 
-				transfer.containingCommandPool = poolHandle;
-				vkCmdCopyBufferToImage(m_asyncTransferCommandPools[poolHandle].buffer,
-									   m_resourceAllocator->nativeBufferHandle(
-										   m_stagingBuffers[transfer.stagingBufferAllocation.bufferHandle].buffer),
-									   m_resourceAllocator->nativeImageHandle(transfer.dstImageHandle),
-									   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &transfer.copy);
-				imageReleaseBarriers.push_back(transfer.transferBarrier);
-			}
+	void GPUTransferManager::setDefragmentationBudget(VkDeviceSize bytesPerFrame) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		m_defragmentationBudget = bytesPerFrame;
+	}
 
-			vkCmdPipelineBarrier(m_asyncTransferCommandPools[poolHandle].buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
-								 0, nullptr, static_cast<uint32_t>(releaseBarriers.size()), releaseBarriers.data(),
-								 static_cast<uint32_t>(imageReleaseBarriers.size()), imageReleaseBarriers.data());
-			verifyResult(vkEndCommandBuffer(m_asyncTransferCommandPools[poolHandle].buffer));
+	VkCommandBuffer GPUTransferManager::recordTransfers(uint32_t frameIndex) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		verifyResult(vkResetCommandPool(m_context->device(), m_transferCommandPools[frameIndex], 0));
 
-			VkSubmitInfo transferSubmitInfo = { .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-												.commandBufferCount = 1,
-												.pCommandBuffers = &m_asyncTransferCommandPools[poolHandle].buffer };
-			verifyResult(vkQueueSubmit(m_context->asyncTransferQueue(), 1, &transferSubmitInfo,
-									   m_asyncTransferCommandPools[poolHandle].fence));
-		}
+		updateCompletedAsyncBatchValue();
+		retireStagingRingAllocations(frameIndex);
+		retireReadbacks(frameIndex);
+		flushStagingRing();
+		flushQueuedMemoryRanges();
 
-		for (auto& bufferToFree : m_stagingBufferAllocationFreeList[frameIndex]) {
-			freeToRanges(m_stagingBuffers[bufferToFree.bufferHandle].freeRangesOffsetSorted,
-						 m_stagingBuffers[bufferToFree.bufferHandle].freeRangesSizeSorted,
-						 bufferToFree.allocationResult.allocationRange.offset,
-						 bufferToFree.allocationResult.allocationRange.size);
-		}
+		retireAsyncTransferBatches();
+		TransferSchedule schedule = scheduleTransfers(frameIndex);
+		uint64_t asyncBatchValue =
+			submitAsyncTransfers(schedule.asyncBufferTransferCount, schedule.asyncImageTransferCount);
 
 		VkCommandBuffer commandBuffer = m_transferCommandBuffers[frameIndex];
 		VkCommandBufferBeginInfo info = { .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
 										  .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT };
 		verifyResult(vkBeginCommandBuffer(commandBuffer, &info));
 
-		std::vector<VkBufferMemoryBarrier> bufferBarriers;
-		std::vector<VkImageMemoryBarrier> imageBarriers;
-		bufferBarriers.reserve(m_continuousTransfers.size());
-		imageBarriers.reserve(m_imageTransfers.size());
+		// acquire ownership of the finalized async transfers, their data can be used from here on
+		m_transferWaitValue = isAsyncBatchFinished(m_finalizedBatchValue) ? 0 : m_finalizedBatchValue;
+		m_finalizedBatchValue = 0;
+		if (!m_bufferFinalizationBarriers.empty() || !m_imageFinalizationBarriers.empty()) {
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_finalizationStageFlags, 0, 0,
+								 nullptr, static_cast<uint32_t>(m_bufferFinalizationBarriers.size()),
+								 m_bufferFinalizationBarriers.data(),
+								 static_cast<uint32_t>(m_imageFinalizationBarriers.size()),
+								 m_imageFinalizationBarriers.data());
+			m_bufferFinalizationBarriers.clear();
+			m_imageFinalizationBarriers.clear();
+			m_finalizationStageFlags = 0;
+		}
 
-		VkPipelineStageFlags srcStageFlags = 0;
+		// moves have to be recorded before this frame's uploads, which already target the new resources
+		m_resourceAllocator->recordDefragmentationCopies(commandBuffer, m_defragmentationBudget);
 
 		for (auto& transfer : m_continuousTransfers) {
-			if (transfer.needsStagingBuffer && transfer.hasNewData[frameIndex]) {
-				bufferBarriers.push_back(
-					{ .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
-					  .srcAccessMask = VK_ACCESS_HOST_WRITE_BIT,
-					  .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
-					  .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-					  .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-					  .buffer = m_resourceAllocator->nativeBufferHandle(
-						  m_stagingBuffers[transfer.stagingBuffers[frameIndex].bufferHandle].buffer),
-					  .offset = 0,
-					  .size = VK_WHOLE_SIZE });
-				srcStageFlags |= VK_PIPELINE_STAGE_HOST_BIT;
+			auto& dirtyRanges = transfer.dirtyRanges[frameIndex];
+			if (!transfer.needsStagingBuffer || dirtyRanges.empty())
+				continue;
+			auto& stagingAllocation = transfer.stagingBuffers[frameIndex];
+			VkBuffer srcBuffer =
+				m_resourceAllocator->nativeBufferHandle(m_stagingBuffers[stagingAllocation.bufferHandle].buffer);
+			VkBuffer dstBuffer = m_resourceAllocator->nativeBufferHandle(transfer.dstBuffer);
+			VkDeviceSize stagingOffset = stagingAllocation.allocationResult.usableRange.offset;
+			for (auto& range : dirtyRanges) {
+				m_bufferCopies.push_back({ .srcBuffer = srcBuffer,
+										   .dstBuffer = dstBuffer,
+										   .region = { .srcOffset = stagingOffset + range.offset,
+													   .dstOffset = range.offset,
+													   .size = range.size } });
 			}
 		}
-		for (auto& transfer : m_oneTimeTransfers) {
+		for (size_t i = 0; i < schedule.oneTimeTransferCount; ++i) {
+			auto& transfer = m_oneTimeTransfers[i];
 			if (transfer.needsStagingBuffer) {
-				bufferBarriers.push_back({ .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
-										   .srcAccessMask = VK_ACCESS_HOST_WRITE_BIT,
-										   .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
-										   .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-										   .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-										   .buffer = m_resourceAllocator->nativeBufferHandle(
-											   m_stagingBuffers[transfer.stagingBuffers[0].bufferHandle].buffer),
-										   .offset = 0,
-										   .size = VK_WHOLE_SIZE });
-				srcStageFlags |= VK_PIPELINE_STAGE_HOST_BIT;
+				BufferView dstView = m_resourceAllocator->bufferView(transfer.dstBuffer);
+				m_bufferCopies.push_back({ .srcBuffer = transfer.stagingRingAllocation.buffer,
+										   .dstBuffer = dstView.buffer,
+										   .region = { .srcOffset = transfer.stagingRingAllocation.offset,
+													   .dstOffset = dstView.offset,
+													   .size = transfer.bufferSize } });
 			}
 		}
-		for (auto& transfer : m_imageTransfers) {
+
+		// All buffer copies share one memory barrier instead of a buffer barrier per transfer, images still need
+		// their own barriers for the layout transitions.
+		VkMemoryBarrier memoryBarrier = { .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+		std::vector<VkImageMemoryBarrier> imageBarriers;
+		imageBarriers.reserve(schedule.imageTransferCount);
+
+		VkPipelineStageFlags srcStageFlags = 0;
+
+		if (!m_bufferCopies.empty()) {
+			memoryBarrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT;
+			memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			srcStageFlags |= VK_PIPELINE_STAGE_HOST_BIT;
+		}
+		for (size_t i = 0; i < schedule.imageTransferCount; ++i) {
+			auto& transfer = m_imageTransfers[i];
 			imageBarriers.push_back(
 				{ .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
 				  .srcAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT,
@@ -417,85 +729,53 @@ namespace vanadium::graphics {
 										.layerCount = transfer.copy.imageSubresource.layerCount } });
 			srcStageFlags |= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
 		}
-		if (!bufferBarriers.empty() || !imageBarriers.empty()) {
-			vkCmdPipelineBarrier(commandBuffer, srcStageFlags, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr,
-								 static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+		if (memoryBarrier.srcAccessMask || !imageBarriers.empty()) {
+			vkCmdPipelineBarrier(commandBuffer, srcStageFlags, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+								 memoryBarrier.srcAccessMask ? 1 : 0, &memoryBarrier, 0, nullptr,
 								 static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
 		}
 
-		for (auto& transfer : m_continuousTransfers) {
-			if (transfer.needsStagingBuffer && transfer.hasNewData[frameIndex]) {
-				VkBufferCopy copy = { .srcOffset =
-										  transfer.stagingBuffers[frameIndex].allocationResult.usableRange.offset,
-									  .size = transfer.bufferSize };
-				vkCmdCopyBuffer(commandBuffer,
-								m_resourceAllocator->nativeBufferHandle(
-									m_stagingBuffers[transfer.stagingBuffers[frameIndex].bufferHandle].buffer),
-								m_resourceAllocator->nativeBufferHandle(transfer.dstBuffer), 1, &copy);
-			}
-		}
-		for (auto& transfer : m_oneTimeTransfers) {
-			if (transfer.needsStagingBuffer) {
-				VkBufferCopy copy = { .srcOffset = transfer.stagingBuffers[0].allocationResult.usableRange.offset,
-									  .size = transfer.bufferSize };
-				vkCmdCopyBuffer(commandBuffer,
-								m_resourceAllocator->nativeBufferHandle(
-									m_stagingBuffers[transfer.stagingBuffers[0].bufferHandle].buffer),
-								m_resourceAllocator->nativeBufferHandle(transfer.dstBuffer), 1, &copy);
-			}
-		}
-		for (auto& transfer : m_imageTransfers) {
-			vkCmdCopyBufferToImage(commandBuffer, m_resourceAllocator->nativeBufferHandle(transfer.stagingBuffer),
+		recordBufferCopies(commandBuffer, m_bufferCopies);
+		for (size_t i = 0; i < schedule.imageTransferCount; ++i) {
+			auto& transfer = m_imageTransfers[i];
+			vkCmdCopyBufferToImage(commandBuffer, transfer.stagingRingAllocation.buffer,
 								   m_resourceAllocator->nativeImageHandle(transfer.dstImage),
 								   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &transfer.copy);
 		}
 
-		bufferBarriers.clear();
+		memoryBarrier = { .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER };
 		imageBarriers.clear();
 		srcStageFlags = 0;
 		VkPipelineStageFlags dstStageFlags = 0;
 
 		for (auto& transfer : m_continuousTransfers) {
-			if (transfer.hasNewData[frameIndex]) {
-				VkBufferMemoryBarrier barrier = { .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
-												  .srcAccessMask = VK_ACCESS_HOST_WRITE_BIT,
-												  .dstAccessMask = transfer.dstUsageAccessFlags,
-												  .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-												  .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-												  .buffer = m_resourceAllocator->nativeBufferHandle(transfer.dstBuffer),
-												  .offset = 0,
-												  .size = VK_WHOLE_SIZE };
+			if (!transfer.dirtyRanges[frameIndex].empty()) {
 				if (transfer.needsStagingBuffer) {
-					barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+					memoryBarrier.srcAccessMask |= VK_ACCESS_TRANSFER_WRITE_BIT;
 					srcStageFlags |= VK_PIPELINE_STAGE_TRANSFER_BIT;
 				} else {
+					memoryBarrier.srcAccessMask |= VK_ACCESS_HOST_WRITE_BIT;
 					srcStageFlags |= VK_PIPELINE_STAGE_HOST_BIT;
 				}
+				memoryBarrier.dstAccessMask |= transfer.dstUsageAccessFlags;
 				dstStageFlags |= transfer.dstUsageStageFlags;
-				bufferBarriers.push_back(barrier);
 			}
-			transfer.hasNewData[frameIndex] = false;
+			transfer.dirtyRanges[frameIndex].clear();
 		}
-		for (auto& transfer : m_oneTimeTransfers) {
-			VkBufferMemoryBarrier barrier = { .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
-											  .srcAccessMask = VK_ACCESS_HOST_WRITE_BIT,
-											  .dstAccessMask = transfer.dstUsageAccessFlags,
-											  .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-											  .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-											  .buffer = m_resourceAllocator->nativeBufferHandle(transfer.dstBuffer),
-											  .offset = 0,
-											  .size = VK_WHOLE_SIZE };
+		for (size_t i = 0; i < schedule.oneTimeTransferCount; ++i) {
+			auto& transfer = m_oneTimeTransfers[i];
 			if (transfer.needsStagingBuffer) {
-				m_stagingBufferAllocationFreeList[frameIndex].push_back(transfer.stagingBuffers[0]);
-				barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				memoryBarrier.srcAccessMask |= VK_ACCESS_TRANSFER_WRITE_BIT;
 				srcStageFlags |= VK_PIPELINE_STAGE_TRANSFER_BIT;
 			} else {
+				memoryBarrier.srcAccessMask |= VK_ACCESS_HOST_WRITE_BIT;
 				srcStageFlags |= VK_PIPELINE_STAGE_HOST_BIT;
 			}
+			memoryBarrier.dstAccessMask |= transfer.dstUsageAccessFlags;
 			dstStageFlags |= transfer.dstUsageStageFlags;
-			bufferBarriers.push_back(barrier);
 		}
-		for (auto& transfer : m_imageTransfers) {
+		for (size_t i = 0; i < schedule.imageTransferCount; ++i) {
+			auto& transfer = m_imageTransfers[i];
 			VkImageMemoryBarrier barrier = { .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
 											 .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
 											 .dstAccessMask = transfer.dstUsageAccessFlags,
@@ -512,34 +792,338 @@ namespace vanadium::graphics {
 												 .layerCount = transfer.copy.imageSubresource.layerCount } };
 			srcStageFlags |= VK_PIPELINE_STAGE_TRANSFER_BIT;
 			dstStageFlags |= transfer.dstUsageStageFlags;
-			m_resourceAllocator->destroyBuffer(transfer.stagingBuffer);
 			imageBarriers.push_back(barrier);
 		}
-		if (bufferBarriers.size() > 0 && imageBarriers.size() > 0)
-			vkCmdPipelineBarrier(commandBuffer, srcStageFlags, dstStageFlags, 0, 0, nullptr,
-								 static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
-								 static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+		if (memoryBarrier.srcAccessMask || !imageBarriers.empty())
+			vkCmdPipelineBarrier(commandBuffer, srcStageFlags, dstStageFlags, 0, memoryBarrier.srcAccessMask ? 1 : 0,
+								 &memoryBarrier, 0, nullptr, static_cast<uint32_t>(imageBarriers.size()),
+								 imageBarriers.data());
 
 		verifyResult(vkEndCommandBuffer(commandBuffer));
 
-		m_imageTransfers.clear();
-		m_oneTimeTransfers.clear();
+		m_imageTransfers.erase(m_imageTransfers.begin(),
+							   m_imageTransfers.begin() + static_cast<ptrdiff_t>(schedule.imageTransferCount));
+		m_oneTimeTransfers.erase(m_oneTimeTransfers.begin(),
+								 m_oneTimeTransfers.begin() + static_cast<ptrdiff_t>(schedule.oneTimeTransferCount));
+
+		// open uploads and deferred transfers haven't been copied yet, they retire with a later frame
+		collectHeldStagingAllocations();
+		VkDeviceSize retirementEnd = stagingRingRetirableHead();
+		std::vector<BufferResourceHandle> retiredBuffers;
+		for (auto& buffer : m_stagingOverflowBuffers) {
+			bool isHeld = std::any_of(m_heldStagingAllocations.begin(), m_heldStagingAllocations.end(),
+									  [buffer](const auto& allocation) { return allocation.overflowBuffer == buffer; });
+			if (!isHeld) {
+				retiredBuffers.push_back(buffer);
+			}
+		}
+		bool hasNewAllocations = retirementEnd != m_stagingRing.tail &&
+								 (m_stagingRingRetirements.empty() ||
+								  m_stagingRingRetirements.back().ringGeneration != m_stagingRing.generation ||
+								  m_stagingRingRetirements.back().end != retirementEnd);
+		if (hasNewAllocations || !retiredBuffers.empty()) {
+			for (auto& buffer : retiredBuffers) {
+				std::erase(m_stagingOverflowBuffers, buffer);
+			}
+			m_stagingRingRetirements.push_back({ .end = retirementEnd,
+												 .ringGeneration = m_stagingRing.generation,
+												 .frameIndex = frameIndex,
+												 .asyncBatchValue = asyncBatchValue,
+												 .retiredBuffers = std::move(retiredBuffers) });
+		}
+		updateStagingRingSize();
+		m_stagingRingRetirementPending = true;
 		return commandBuffer;
 	}
 
+	TransferSchedule GPUTransferManager::scheduleTransfers(uint32_t frameIndex) {
+		VkDeviceSize scheduledSize = 0;
+		for (auto& transfer : m_continuousTransfers) {
+			if (transfer.needsStagingBuffer) {
+				for (auto& range : transfer.dirtyRanges[frameIndex]) {
+					scheduledSize += range.size;
+				}
+			}
+		}
+
+		auto identity = [](auto& transfer) -> auto& { return transfer; };
+		inheritLaterTransferPriorities(m_oneTimeTransfers, &GPUTransfer::dstBuffer, identity);
+		inheritLaterTransferPriorities(m_imageTransfers, &GPUImageTransfer::dstImage, identity);
+		inheritLaterTransferPriorities(m_bufferHandlesToBegin, &AsyncBufferTransfer::dstBufferHandle,
+									   [this](AsyncBufferTransferHandle handle) -> auto& {
+										   return m_asyncBufferTransfers[handle];
+									   });
+		inheritLaterTransferPriorities(m_imageHandlesToBegin, &AsyncImageTransfer::dstImageHandle,
+									   [this](AsyncImageTransferHandle handle) -> auto& {
+										   return m_asyncImageTransfers[handle];
+									   });
+
+		auto priorityLess = [](const auto& first, const auto& second) { return first.priority < second.priority; };
+		std::stable_sort(m_oneTimeTransfers.begin(), m_oneTimeTransfers.end(), priorityLess);
+		std::stable_sort(m_imageTransfers.begin(), m_imageTransfers.end(), priorityLess);
+		std::stable_sort(m_bufferHandlesToBegin.begin(), m_bufferHandlesToBegin.end(),
+						 [this](AsyncBufferTransferHandle first, AsyncBufferTransferHandle second) {
+							 return m_asyncBufferTransfers[first].priority < m_asyncBufferTransfers[second].priority;
+						 });
+		std::stable_sort(m_imageHandlesToBegin.begin(), m_imageHandlesToBegin.end(),
+						 [this](AsyncImageTransferHandle first, AsyncImageTransferHandle second) {
+							 return m_asyncImageTransfers[first].priority < m_asyncImageTransfers[second].priority;
+						 });
+
+		// Only low-priority transfers are deferred, after everything else has been scheduled. The first one is
+		// recorded while any budget is left even if it doesn't fit, and once one is deferred, everything after it
+		// waits too, so large low-priority uploads can't be overtaken forever.
+		TransferSchedule schedule = {};
+		bool scheduledLow = false;
+		bool budgetExhausted = false;
+		auto trySchedule = [&](TransferPriority priority, VkDeviceSize size) {
+			if (priority == TransferPriority::Low) {
+				bool fits = scheduledSize + size <= m_transferBudget ||
+							(!scheduledLow && scheduledSize < m_transferBudget);
+				if (budgetExhausted || !fits) {
+					budgetExhausted = true;
+					return false;
+				}
+				scheduledLow = true;
+			}
+			scheduledSize += size;
+			return true;
+		};
+
+		for (auto priority : { TransferPriority::Urgent, TransferPriority::Default, TransferPriority::Low }) {
+			for (size_t& i = schedule.oneTimeTransferCount; i < m_oneTimeTransfers.size(); ++i) {
+				auto& transfer = m_oneTimeTransfers[i];
+				VkDeviceSize size = transfer.needsStagingBuffer ? transfer.bufferSize : 0;
+				if (transfer.priority != priority || !trySchedule(priority, size))
+					break;
+			}
+			for (size_t& i = schedule.imageTransferCount; i < m_imageTransfers.size(); ++i) {
+				auto& transfer = m_imageTransfers[i];
+				if (transfer.priority != priority || !trySchedule(priority, transfer.stagingBufferSize))
+					break;
+			}
+			for (size_t& i = schedule.asyncBufferTransferCount; i < m_bufferHandlesToBegin.size(); ++i) {
+				auto& transfer = m_asyncBufferTransfers[m_bufferHandlesToBegin[i]];
+				if (transfer.priority != priority || !trySchedule(priority, transfer.copy.size))
+					break;
+			}
+			for (size_t& i = schedule.asyncImageTransferCount; i < m_imageHandlesToBegin.size(); ++i) {
+				auto& transfer = m_asyncImageTransfers[m_imageHandlesToBegin[i]];
+				if (transfer.priority != priority || !trySchedule(priority, transfer.size))
+					break;
+			}
+		}
+		return schedule;
+	}
+
+	uint64_t GPUTransferManager::submitAsyncTransfers(size_t bufferTransferCount, size_t imageTransferCount) {
+		uint64_t lastBatchValue = 0;
+		std::vector<VkImageMemoryBarrier> layoutTransitionBarriers;
+		std::vector<VkBufferMemoryBarrier> bufferReleaseBarriers;
+		std::vector<VkImageMemoryBarrier> imageReleaseBarriers;
+
+		size_t bufferIndex = 0;
+		size_t imageIndex = 0;
+		while (bufferIndex < bufferTransferCount || imageIndex < imageTransferCount) {
+			// fill the batch up to the size limit, but always take at least one transfer
+			VkDeviceSize batchSize = 0;
+			size_t bufferEnd = bufferIndex;
+			for (; bufferEnd < bufferTransferCount; ++bufferEnd) {
+				VkDeviceSize size = m_asyncBufferTransfers[m_bufferHandlesToBegin[bufferEnd]].copy.size;
+				if (batchSize && batchSize + size > m_asyncTransferBatchSizeLimit)
+					break;
+				batchSize += size;
+			}
+			size_t imageEnd = imageIndex;
+			for (; imageEnd < imageTransferCount; ++imageEnd) {
+				VkDeviceSize size = m_asyncImageTransfers[m_imageHandlesToBegin[imageEnd]].size;
+				if (batchSize && batchSize + size > m_asyncTransferBatchSizeLimit)
+					break;
+				batchSize += size;
+			}
+
+			AsyncTransferBatch batch = beginAsyncTransferBatch();
+
+			layoutTransitionBarriers.clear();
+			for (size_t i = imageIndex; i < imageEnd; ++i) {
+				layoutTransitionBarriers.push_back(
+					m_asyncImageTransfers[m_imageHandlesToBegin[i]].layoutTransitionBarrier);
+			}
+			if (!layoutTransitionBarriers.empty()) {
+				vkCmdPipelineBarrier(batch.buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+									 0, nullptr, 0, nullptr, static_cast<uint32_t>(layoutTransitionBarriers.size()),
+									 layoutTransitionBarriers.data());
+			}
+
+			bufferReleaseBarriers.clear();
+			for (size_t i = bufferIndex; i < bufferEnd; ++i) {
+				auto& transfer = m_asyncBufferTransfers[m_bufferHandlesToBegin[i]];
+				transfer.batchValue = batch.value;
+				vkCmdCopyBuffer(batch.buffer, transfer.stagingRingAllocation.buffer,
+								m_resourceAllocator->nativeBufferHandle(transfer.dstBufferHandle), 1, &transfer.copy);
+				bufferReleaseBarriers.push_back(transfer.transferBarrier);
+			}
+			imageReleaseBarriers.clear();
+			for (size_t i = imageIndex; i < imageEnd; ++i) {
+				auto& transfer = m_asyncImageTransfers[m_imageHandlesToBegin[i]];
+				transfer.batchValue = batch.value;
+				vkCmdCopyBufferToImage(batch.buffer, transfer.stagingRingAllocation.buffer,
+									   m_resourceAllocator->nativeImageHandle(transfer.dstImageHandle),
+									   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &transfer.copy);
+				imageReleaseBarriers.push_back(transfer.transferBarrier);
+			}
+
+			vkCmdPipelineBarrier(batch.buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+								 0, nullptr, static_cast<uint32_t>(bufferReleaseBarriers.size()),
+								 bufferReleaseBarriers.data(), static_cast<uint32_t>(imageReleaseBarriers.size()),
+								 imageReleaseBarriers.data());
+			verifyResult(vkEndCommandBuffer(batch.buffer));
+
+			VkTimelineSemaphoreSubmitInfoKHR timelineSubmitInfo = {
+				.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR,
+				.signalSemaphoreValueCount = 1,
+				.pSignalSemaphoreValues = &batch.value
+			};
+			VkSubmitInfo submitInfo = { .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+										.commandBufferCount = 1,
+										.pCommandBuffers = &batch.buffer };
+			if (m_asyncTransferSemaphore) {
+				submitInfo.pNext = &timelineSubmitInfo;
+				submitInfo.signalSemaphoreCount = 1;
+				submitInfo.pSignalSemaphores = &m_asyncTransferSemaphore;
+			}
+			verifyResult(vkQueueSubmit(m_context->asyncTransferQueue(), 1, &submitInfo, batch.fence));
+			m_asyncTransferBatches.push_back(batch);
+			lastBatchValue = batch.value;
+
+			bufferIndex = bufferEnd;
+			imageIndex = imageEnd;
+		}
+		m_bufferHandlesToBegin.erase(m_bufferHandlesToBegin.begin(),
+									 m_bufferHandlesToBegin.begin() + static_cast<ptrdiff_t>(bufferTransferCount));
+		m_imageHandlesToBegin.erase(m_imageHandlesToBegin.begin(),
+									m_imageHandlesToBegin.begin() + static_cast<ptrdiff_t>(imageTransferCount));
+		return lastBatchValue;
+	}
+
+	AsyncTransferBatch GPUTransferManager::beginAsyncTransferBatch() {
+		AsyncTransferBatch batch;
+		if (m_freeAsyncTransferBatches.empty()) {
+			VkCommandPoolCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+												   .queueFamilyIndex = m_context->asyncTransferQueueFamilyIndex() };
+			verifyResult(vkCreateCommandPool(m_context->device(), &createInfo, nullptr, &batch.pool));
+
+			VkCommandBufferAllocateInfo allocateInfo = { .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+														 .commandPool = batch.pool,
+														 .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+														 .commandBufferCount = 1 };
+			verifyResult(vkAllocateCommandBuffers(m_context->device(), &allocateInfo, &batch.buffer));
+
+			batch.fence = VK_NULL_HANDLE;
+			if (!m_asyncTransferSemaphore) {
+				VkFenceCreateInfo fenceCreateInfo = { .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+				verifyResult(vkCreateFence(m_context->device(), &fenceCreateInfo, nullptr, &batch.fence));
+			}
+		} else {
+			batch = m_freeAsyncTransferBatches.back();
+			m_freeAsyncTransferBatches.pop_back();
+			if (batch.fence) {
+				verifyResult(vkResetFences(m_context->device(), 1, &batch.fence));
+			}
+			verifyResult(vkResetCommandPool(m_context->device(), batch.pool, 0));
+		}
+		batch.value = m_nextAsyncBatchValue++;
+
+		VkCommandBufferBeginInfo beginInfo = { .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+											   .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT };
+		verifyResult(vkBeginCommandBuffer(batch.buffer, &beginInfo));
+		return batch;
+	}
+
+	void GPUTransferManager::retireAsyncTransferBatches() {
+		uint64_t completedValue = updateCompletedAsyncBatchValue();
+		while (!m_asyncTransferBatches.empty() && m_asyncTransferBatches.front().value <= completedValue) {
+			m_freeAsyncTransferBatches.push_back(m_asyncTransferBatches.front());
+			m_asyncTransferBatches.pop_front();
+		}
+	}
+
+	uint64_t GPUTransferManager::updateCompletedAsyncBatchValue() {
+		uint64_t finishedValue = 0;
+		if (m_asyncTransferSemaphore) {
+			verifyResult(vkGetSemaphoreCounterValueKHR(m_context->device(), m_asyncTransferSemaphore, &finishedValue));
+		} else {
+			for (auto& batch : m_asyncTransferBatches) {
+				VkResult status = vkGetFenceStatus(m_context->device(), batch.fence);
+				if (status == VK_NOT_READY)
+					break;
+				verifyResult(status);
+				finishedValue = batch.value;
+			}
+		}
+
+		uint64_t completedValue = m_completedAsyncBatchValue.load();
+		while (completedValue < finishedValue &&
+			   !m_completedAsyncBatchValue.compare_exchange_weak(completedValue, finishedValue)) {
+		}
+		return std::max(completedValue, finishedValue);
+	}
+
 	void GPUTransferManager::destroy() {
+		m_copyPool.destroy();
 		for (auto& pool : m_transferCommandPools) {
 			vkDestroyCommandPool(m_context->device(), pool, nullptr);
 		}
+		for (auto& batch : m_asyncTransferBatches) {
+			vkDestroyCommandPool(m_context->device(), batch.pool, nullptr);
+			vkDestroyFence(m_context->device(), batch.fence, nullptr);
+		}
+		for (auto& batch : m_freeAsyncTransferBatches) {
+			vkDestroyCommandPool(m_context->device(), batch.pool, nullptr);
+			vkDestroyFence(m_context->device(), batch.fence, nullptr);
+		}
+		m_asyncTransferBatches.clear();
+		m_freeAsyncTransferBatches.clear();
+		vkDestroySemaphore(m_context->device(), m_asyncTransferSemaphore, nullptr);
+		m_asyncTransferSemaphore = VK_NULL_HANDLE;
+		for (auto& retirement : m_stagingRingRetirements) {
+			for (auto& buffer : retirement.retiredBuffers) {
+				m_resourceAllocator->destroyBufferImmediately(buffer);
+			}
+		}
+		for (auto& buffer : m_stagingOverflowBuffers) {
+			m_resourceAllocator->destroyBufferImmediately(buffer);
+		}
+		if (m_stagingRing.buffer != ~0U) {
+			m_resourceAllocator->destroyBufferImmediately(m_stagingRing.buffer);
+		}
+		m_stagingRingRetirements.clear();
+		m_stagingOverflowBuffers.clear();
+		m_queuedFlushRanges.clear();
+		m_stagingRing = {};
+
+		for (auto& readback : m_readbacks) {
+			if (readback.allocation.overflowBuffer != ~0U) {
+				m_resourceAllocator->destroyBufferImmediately(readback.allocation.overflowBuffer);
+			}
+		}
+		if (m_readbackRing.buffer != ~0U) {
+			m_resourceAllocator->destroyBufferImmediately(m_readbackRing.buffer);
+		}
+		m_readbackOrder.clear();
+		m_pendingReadbacks.clear();
+		m_readbackRing = {};
 	}
 
 	StagingBufferAllocation GPUTransferManager::allocateStagingBufferArea(VkDeviceSize size) {
 		for (auto iterator = m_stagingBuffers.begin(); iterator != m_stagingBuffers.end(); ++iterator) {
 			auto& block = *iterator;
+			if (block.maxAllocatableSize < size)
+				continue;
 			bool isCoherent = m_resourceAllocator->bufferMemoryCapabilities(block.buffer).hostCoherent;
 			auto allocResult =
-				allocateFromRanges(block.freeRangesOffsetSorted, block.freeRangesSizeSorted,
-								   isCoherent ? 0 : m_context->properties().limits.nonCoherentAtomSize, size);
+				block.allocator.allocate(isCoherent ? 0 : m_nonCoherentAtomSize, size);
+			block.maxAllocatableSize = block.allocator.maxAllocatableSize();
 			if (allocResult.has_value()) {
 				return { .bufferHandle = m_stagingBuffers.handle(iterator), .allocationResult = allocResult.value() };
 			}
@@ -553,20 +1137,441 @@ namespace vanadium::graphics {
 										newBufferCreateInfo, { .hostVisible = true }, { .hostCoherent = true }, true),
 									.maxAllocatableSize = newBufferCreateInfo.size,
 									.originalSize = newBufferCreateInfo.size,
-									.freeRangesOffsetSorted = { { .offset = 0, .size = newBufferCreateInfo.size } },
-									.freeRangesSizeSorted = { { .offset = 0, .size = newBufferCreateInfo.size } } };
+									.allocator = RangeAllocator(newBufferCreateInfo.size) };
 
 		bool isCoherent = m_resourceAllocator->bufferMemoryCapabilities(newBuffer.buffer).hostCoherent;
-		return { .bufferHandle = m_stagingBuffers.addElement(newBuffer),
-				 .allocationResult =
-					 allocateFromRanges((--m_stagingBuffers.end())->freeRangesOffsetSorted,
-										(--m_stagingBuffers.end())->freeRangesSizeSorted,
-										isCoherent ? 0 : m_context->properties().limits.nonCoherentAtomSize, size)
-						 .value() };
+		auto allocResult =
+			newBuffer.allocator.allocate(isCoherent ? 0 : m_nonCoherentAtomSize, size);
+		newBuffer.maxAllocatableSize = newBuffer.allocator.maxAllocatableSize();
+		return { .bufferHandle = m_stagingBuffers.addElement(newBuffer), .allocationResult = allocResult.value() };
+	}
+
+	void GPUTransferManager::freeStagingBufferArea(const StagingBufferAllocation& allocation) {
+		auto& block = m_stagingBuffers[allocation.bufferHandle];
+		block.allocator.free(allocation.allocationResult.allocationRange.offset,
+							 allocation.allocationResult.allocationRange.size);
+		block.maxAllocatableSize = block.allocator.maxAllocatableSize();
+	}
+
+	StagingRingAllocation GPUTransferManager::allocateStagingRingArea(VkDeviceSize size) {
+		if (m_stagingRing.buffer == ~0U) {
+			createStagingRing(m_minStagingRingSize);
+		}
+		m_stagingFrameAllocatedSize += size;
+
+		// checked once per frame, finding the ring empty lets it restart at the beginning
+		if (m_stagingRingRetirementPending) {
+			retireStagingRingAllocations(~0U);
+			m_stagingRingRetirementPending = false;
+		}
+
+		VkDeviceSize alignment = m_stagingRingAlignment;
+		if (!m_stagingRing.isCoherent) {
+			alignment = std::max(alignment, m_nonCoherentAtomSize);
+		}
+
+		for (uint32_t attempt = 0; attempt < 2; ++attempt) {
+			VkDeviceSize ringOffset = m_stagingRing.head % m_stagingRing.size;
+			VkDeviceSize alignedOffset = roundUpAligned(ringOffset, alignment);
+			if (alignedOffset + size > m_stagingRing.size) {
+				// allocations are never split, skip the rest of the ring
+				alignedOffset = m_stagingRing.size;
+			}
+			VkDeviceSize allocationEnd = m_stagingRing.head + (alignedOffset - ringOffset) + size;
+
+			if (allocationEnd - m_stagingRing.tail <= m_stagingRing.size) {
+				m_stagingRing.head = allocationEnd;
+				m_stagingFramePeakUsage = std::max(m_stagingFramePeakUsage, m_stagingRing.head - m_stagingRing.tail);
+				alignedOffset %= m_stagingRing.size;
+				return { .buffer = m_stagingRing.nativeBuffer,
+						 .offset = alignedOffset,
+						 .data = m_stagingRing.mappedData + alignedOffset,
+						 .ringPosition = allocationEnd - size,
+						 .ringGeneration = m_stagingRing.generation };
+			}
+			retireStagingRingAllocations(~0U);
+		}
+
+		// The ring is full. Keep going with a temporary buffer and grow the ring if this keeps happening.
+		m_stagingRingOverflowed = true;
+		VkBufferCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+										  .size = size,
+										  .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+										  .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+		BufferResourceHandle buffer =
+			m_resourceAllocator->createBuffer(createInfo, { .hostVisible = true }, { .hostCoherent = true }, true);
+		assertFatal(buffer != ~0U, "GPUTransferManager: Couldn't allocate staging memory!\n");
+		m_stagingOverflowBuffers.push_back(buffer);
+		return { .buffer = m_resourceAllocator->nativeBufferHandle(buffer),
+				 .offset = 0,
+				 .data = m_resourceAllocator->mappedBufferData(buffer),
+				 .overflowBuffer = buffer };
+	}
+
+	void GPUTransferManager::createStagingRing(VkDeviceSize size) {
+		VkBufferCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+										  .size = size,
+										  .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+										  .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+		BufferResourceHandle buffer =
+			m_resourceAllocator->createBuffer(createInfo, { .hostVisible = true }, { .hostCoherent = true }, true);
+		assertFatal(buffer != ~0U, "GPUTransferManager: Couldn't allocate the staging ring!\n");
+
+		m_stagingRing = { .buffer = buffer,
+						  .nativeBuffer = m_resourceAllocator->nativeBufferHandle(buffer),
+						  .mappedData = static_cast<unsigned char*>(m_resourceAllocator->mappedBufferData(buffer)),
+						  .size = size,
+						  .isCoherent = m_resourceAllocator->bufferMemoryCapabilities(buffer).hostCoherent,
+						  .generation = m_stagingRing.generation + 1 };
+		m_stagingFramePeakUsage = 0;
+	}
+
+	void GPUTransferManager::retireStagingRingAllocations(uint32_t finishedFrameIndex) {
+		while (!m_stagingRingRetirements.empty()) {
+			auto& retirement = m_stagingRingRetirements.front();
+			// The fence of finishedFrameIndex is already reset for the next submission.
+			bool frameFinished =
+				retirement.frameIndex == finishedFrameIndex ||
+				vkGetFenceStatus(m_context->device(), m_context->frameCompletionFence(retirement.frameIndex)) ==
+					VK_SUCCESS;
+			bool asyncTransferFinished =
+				retirement.asyncBatchValue == 0 || isAsyncBatchFinished(retirement.asyncBatchValue) ||
+				updateCompletedAsyncBatchValue() >= retirement.asyncBatchValue;
+			if (!frameFinished || !asyncTransferFinished)
+				break;
+
+			if (retirement.ringGeneration == m_stagingRing.generation) {
+				m_stagingRing.tail = retirement.end;
+			}
+			for (auto& buffer : retirement.retiredBuffers) {
+				m_resourceAllocator->destroyBufferImmediately(buffer);
+			}
+			m_stagingRingRetirements.pop_front();
+		}
+
+		// restart at the beginning of the ring once it drains, light upload traffic then stays in warm memory
+		if (m_stagingRing.head == m_stagingRing.tail && m_stagingRing.size) {
+			m_stagingRing.head = roundUpAligned(m_stagingRing.head, m_stagingRing.size);
+			m_stagingRing.tail = m_stagingRing.head;
+			m_stagingRing.flushedHead = m_stagingRing.head;
+		}
+	}
+
+	void GPUTransferManager::flushStagingRing() {
+		for (auto& buffer : m_stagingOverflowBuffers) {
+			queueMemoryFlush(buffer, 0, m_resourceAllocator->allocationRange(buffer).size);
+		}
+
+		VkDeviceSize unflushedSize = m_stagingRing.head - m_stagingRing.flushedHead;
+		if (!m_stagingRing.isCoherent && unflushedSize) {
+			VkDeviceSize ringOffset = m_stagingRing.flushedHead % m_stagingRing.size;
+			VkDeviceSize sizeUntilEnd = std::min(unflushedSize, m_stagingRing.size - ringOffset);
+			queueMemoryFlush(m_stagingRing.buffer, ringOffset, sizeUntilEnd);
+			if (sizeUntilEnd < unflushedSize) {
+				queueMemoryFlush(m_stagingRing.buffer, 0, unflushedSize - sizeUntilEnd);
+			}
+		}
+		m_stagingRing.flushedHead = m_stagingRing.head;
+	}
+
+	void GPUTransferManager::updateStagingRingSize() {
+		if (m_stagingRing.buffer == ~0U)
+			return;
+
+		if (m_stagingRingOverflowed) {
+			m_stagingLowUsageFrameCount = 0;
+			if (++m_stagingOverflowFrameCount >= m_stagingRingGrowthFrames &&
+				m_stagingRing.size < m_maxStagingRingSize) {
+				// enough space for every frame in flight to upload as much as this one did
+				VkDeviceSize newSize = std::max(2 * m_stagingRing.size,
+												roundUpAligned(m_stagingFrameAllocatedSize * frameInFlightCount,
+															   m_minStagingRingSize));
+				replaceStagingRing(std::min(newSize, m_maxStagingRingSize));
+				m_stagingOverflowFrameCount = 0;
+			}
+		} else {
+			m_stagingOverflowFrameCount = 0;
+			if (m_stagingFramePeakUsage < m_stagingRing.size / 4 && m_stagingRing.size > m_minStagingRingSize) {
+				if (++m_stagingLowUsageFrameCount >= m_stagingRingShrinkFrames) {
+					replaceStagingRing(std::max(m_stagingRing.size / 2, m_minStagingRingSize));
+					m_stagingLowUsageFrameCount = 0;
+				}
+			} else {
+				m_stagingLowUsageFrameCount = 0;
+			}
+		}
+
+		m_stagingRingOverflowed = false;
+		m_stagingFrameAllocatedSize = 0;
+		m_stagingFramePeakUsage = m_stagingRing.head - m_stagingRing.tail;
+	}
+
+	void GPUTransferManager::replaceStagingRing(VkDeviceSize newSize) {
+		// open uploads and deferred transfers still refer to the current ring
+		for (auto& allocation : m_heldStagingAllocations) {
+			if (allocation.ringPosition != ~0ULL && allocation.ringGeneration == m_stagingRing.generation)
+				return;
+		}
+		// the old ring is destroyed once everything allocated from it has been read
+		if (m_stagingRingRetirements.empty()) {
+			m_resourceAllocator->destroyBufferImmediately(m_stagingRing.buffer);
+		} else {
+			m_stagingRingRetirements.back().retiredBuffers.push_back(m_stagingRing.buffer);
+		}
+		createStagingRing(newSize);
+	}
+
+	GPUReadbackHandle GPUTransferManager::readBuffer(BufferResourceHandle srcBuffer, VkDeviceSize offset,
+													 VkDeviceSize size, VkPipelineStageFlags srcStageFlags,
+													 VkAccessFlags srcAccessFlags) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		return enqueueReadback({ .allocation = allocateReadbackArea(size),
+								 .size = size,
+								 .srcBuffer = srcBuffer,
+								 .bufferCopy = { .srcOffset = offset, .dstOffset = 0, .size = size },
+								 .srcImage = ~0U,
+								 .srcStageFlags = srcStageFlags,
+								 .srcAccessFlags = srcAccessFlags });
+	}
+
+	GPUReadbackHandle GPUTransferManager::readImage(ImageResourceHandle srcImage, const VkBufferImageCopy& copy,
+													VkDeviceSize size, VkImageLayout srcLayout,
+													VkPipelineStageFlags srcStageFlags, VkAccessFlags srcAccessFlags) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		return enqueueReadback({ .allocation = allocateReadbackArea(size),
+								 .size = size,
+								 .srcBuffer = ~0U,
+								 .srcImage = srcImage,
+								 .imageCopy = copy,
+								 .srcLayout = srcLayout,
+								 .srcStageFlags = srcStageFlags,
+								 .srcAccessFlags = srcAccessFlags });
+	}
+
+	GPUReadbackHandle GPUTransferManager::enqueueReadback(GPUReadback readback) {
+		if (readback.srcBuffer != ~0U) {
+			readback.bufferCopy.dstOffset = readback.allocation.offset;
+		} else {
+			readback.imageCopy.bufferOffset += readback.allocation.offset;
+		}
+		GPUReadbackHandle handle = m_readbacks.addElement(readback);
+		m_readbackOrder.push_back(handle);
+		m_pendingReadbacks.push_back(handle);
+		return handle;
+	}
+
+	bool GPUTransferManager::isReadbackFinished(GPUReadbackHandle handle) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		auto& readback = m_readbacks[handle];
+		// the fence is only reset after the frame has been waited for, recordTransfers then finishes the readback
+		if (readback.state == ReadbackState::Recorded &&
+			vkGetFenceStatus(m_context->device(), m_context->frameCompletionFence(readback.frameIndex)) ==
+				VK_SUCCESS) {
+			finishReadback(readback);
+		}
+		return readback.state == ReadbackState::Finished;
+	}
+
+	const void* GPUTransferManager::readbackData(GPUReadbackHandle handle) {
+		auto lock = SharedLockGuard(m_accessMutex);
+		auto& readback = m_readbacks[handle];
+		return readback.state == ReadbackState::Finished ? readback.allocation.data : nullptr;
+	}
+
+	void GPUTransferManager::releaseReadback(GPUReadbackHandle handle) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		auto& readback = m_readbacks[handle];
+		readback.released = true;
+		if (readback.state == ReadbackState::Pending) {
+			std::erase(m_pendingReadbacks, handle);
+		}
+	}
+
+	VkCommandBuffer GPUTransferManager::recordReadbacks(uint32_t frameIndex) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		VkCommandBuffer commandBuffer = m_readbackCommandBuffers[frameIndex];
+		VkCommandBufferBeginInfo info = { .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+										  .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT };
+		verifyResult(vkBeginCommandBuffer(commandBuffer, &info));
+		if (m_pendingReadbacks.empty()) {
+			verifyResult(vkEndCommandBuffer(commandBuffer));
+			return commandBuffer;
+		}
+
+		VkMemoryBarrier memoryBarrier = { .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+		std::vector<VkImageMemoryBarrier> imageBarriers;
+		VkPipelineStageFlags srcStageFlags = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		for (auto& handle : m_pendingReadbacks) {
+			auto& readback = m_readbacks[handle];
+			srcStageFlags |= readback.srcStageFlags;
+			if (readback.srcBuffer != ~0U) {
+				BufferView srcView = m_resourceAllocator->bufferView(readback.srcBuffer);
+				m_bufferCopies.push_back({ .srcBuffer = srcView.buffer,
+										   .dstBuffer = readback.allocation.buffer,
+										   .region = { .srcOffset = srcView.offset + readback.bufferCopy.srcOffset,
+													   .dstOffset = readback.bufferCopy.dstOffset,
+													   .size = readback.bufferCopy.size } });
+				memoryBarrier.srcAccessMask |= readback.srcAccessFlags;
+				memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			} else {
+				imageBarriers.push_back(
+					{ .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+					  .srcAccessMask = readback.srcAccessFlags,
+					  .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+					  .oldLayout = readback.srcLayout,
+					  .newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+					  .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					  .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					  .image = m_resourceAllocator->nativeImageHandle(readback.srcImage),
+					  .subresourceRange = { .aspectMask = readback.imageCopy.imageSubresource.aspectMask,
+											.baseMipLevel = readback.imageCopy.imageSubresource.mipLevel,
+											.levelCount = 1,
+											.baseArrayLayer = readback.imageCopy.imageSubresource.baseArrayLayer,
+											.layerCount = readback.imageCopy.imageSubresource.layerCount } });
+			}
+		}
+		vkCmdPipelineBarrier(commandBuffer, srcStageFlags, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+							 memoryBarrier.dstAccessMask ? 1 : 0, &memoryBarrier, 0, nullptr,
+							 static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+
+		recordBufferCopies(commandBuffer, m_bufferCopies);
+		for (auto& handle : m_pendingReadbacks) {
+			auto& readback = m_readbacks[handle];
+			if (readback.srcImage != ~0U) {
+				vkCmdCopyImageToBuffer(commandBuffer, m_resourceAllocator->nativeImageHandle(readback.srcImage),
+									   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readback.allocation.buffer, 1,
+									   &readback.imageCopy);
+			}
+			readback.state = ReadbackState::Recorded;
+			readback.frameIndex = frameIndex;
+		}
+
+		// the images go back to their layout for the next frame, which doesn't know about the readback
+		for (auto& barrier : imageBarriers) {
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+			std::swap(barrier.oldLayout, barrier.newLayout);
+		}
+		memoryBarrier = { .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+						  .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+						  .dstAccessMask = VK_ACCESS_HOST_READ_BIT };
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+							 VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &memoryBarrier, 0,
+							 nullptr, static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+
+		verifyResult(vkEndCommandBuffer(commandBuffer));
+		m_pendingReadbacks.clear();
+		return commandBuffer;
+	}
+
+	StagingRingAllocation GPUTransferManager::allocateReadbackArea(VkDeviceSize size) {
+		if (m_readbackRing.buffer == ~0U) {
+			VkBufferCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+											  .size = m_readbackRingSize,
+											  .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+											  .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+			BufferResourceHandle buffer =
+				m_resourceAllocator->createBuffer(createInfo, { .hostVisible = true }, { .hostCached = true }, true);
+			assertFatal(buffer != ~0U, "GPUTransferManager: Couldn't allocate the readback ring!\n");
+			m_readbackRing = { .buffer = buffer,
+							   .nativeBuffer = m_resourceAllocator->nativeBufferHandle(buffer),
+							   .mappedData = static_cast<unsigned char*>(m_resourceAllocator->mappedBufferData(buffer)),
+							   .size = m_readbackRingSize,
+							   .isCoherent = m_resourceAllocator->bufferMemoryCapabilities(buffer).hostCoherent };
+		}
+
+		// non-coherent memory is invalidated in whole atoms, which must not reach into the previous readback
+		VkDeviceSize alignment = m_stagingRingAlignment;
+		if (!m_readbackRing.isCoherent) {
+			alignment = std::max(alignment, m_nonCoherentAtomSize);
+		}
+
+		for (uint32_t attempt = 0; attempt < 2; ++attempt) {
+			VkDeviceSize ringOffset = m_readbackRing.head % m_readbackRing.size;
+			VkDeviceSize alignedOffset = roundUpAligned(ringOffset, alignment);
+			if (alignedOffset + size > m_readbackRing.size) {
+				alignedOffset = m_readbackRing.size;
+			}
+			VkDeviceSize allocationEnd = m_readbackRing.head + (alignedOffset - ringOffset) + size;
+
+			if (allocationEnd - m_readbackRing.tail <= m_readbackRing.size) {
+				m_readbackRing.head = allocationEnd;
+				alignedOffset %= m_readbackRing.size;
+				return { .buffer = m_readbackRing.nativeBuffer,
+						 .offset = alignedOffset,
+						 .data = m_readbackRing.mappedData + alignedOffset,
+						 .ringPosition = allocationEnd - size };
+			}
+			retireReadbacks(~0U);
+		}
+
+		// unreleased readbacks block the ring, later ones get buffers of their own until they are released
+		VkBufferCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+										  .size = size,
+										  .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+										  .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+		BufferResourceHandle buffer =
+			m_resourceAllocator->createBuffer(createInfo, { .hostVisible = true }, { .hostCached = true }, true);
+		assertFatal(buffer != ~0U, "GPUTransferManager: Couldn't allocate readback memory!\n");
+		return { .buffer = m_resourceAllocator->nativeBufferHandle(buffer),
+				 .offset = 0,
+				 .data = m_resourceAllocator->mappedBufferData(buffer),
+				 .overflowBuffer = buffer };
+	}
+
+	void GPUTransferManager::retireReadbacks(uint32_t finishedFrameIndex) {
+		bool frameFinished[frameInFlightCount];
+		for (uint32_t i = 0; i < frameInFlightCount; ++i) {
+			frameFinished[i] =
+				i == finishedFrameIndex ||
+				vkGetFenceStatus(m_context->device(), m_context->frameCompletionFence(i)) == VK_SUCCESS;
+		}
+		for (auto& handle : m_readbackOrder) {
+			auto& readback = m_readbacks[handle];
+			if (readback.state == ReadbackState::Recorded && frameFinished[readback.frameIndex]) {
+				finishReadback(readback);
+			}
+		}
+
+		while (!m_readbackOrder.empty()) {
+			auto& readback = m_readbacks[m_readbackOrder.front()];
+			if (!readback.released || readback.state == ReadbackState::Recorded)
+				break;
+			if (readback.allocation.overflowBuffer != ~0U) {
+				m_resourceAllocator->destroyBufferImmediately(readback.allocation.overflowBuffer);
+			} else {
+				m_readbackRing.tail = readback.allocation.ringPosition + readback.size;
+			}
+			m_readbacks.removeElement(m_readbackOrder.front());
+			m_readbackOrder.pop_front();
+		}
+
+		if (m_readbackRing.head == m_readbackRing.tail && m_readbackRing.size) {
+			m_readbackRing.head = roundUpAligned(m_readbackRing.head, m_readbackRing.size);
+			m_readbackRing.tail = m_readbackRing.head;
+		}
+	}
+
+	void GPUTransferManager::finishReadback(GPUReadback& readback) {
+		readback.state = ReadbackState::Finished;
+		BufferResourceHandle buffer = readback.allocation.overflowBuffer != ~0U ? readback.allocation.overflowBuffer
+																				 : m_readbackRing.buffer;
+		if (m_resourceAllocator->bufferMemoryCapabilities(buffer).hostCoherent)
+			return;
+		VkDeviceSize start = m_resourceAllocator->allocationRange(buffer).offset + readback.allocation.offset;
+		VkDeviceSize alignedStart = start / m_nonCoherentAtomSize * m_nonCoherentAtomSize;
+		VkMappedMemoryRange range = { .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+									  .memory = m_resourceAllocator->nativeMemoryHandle(buffer),
+									  .offset = alignedStart,
+									  .size = roundUpAligned(start + readback.size - alignedStart,
+															 m_nonCoherentAtomSize) };
+		verifyResult(vkInvalidateMappedMemoryRanges(m_context->device(), 1, &range));
 	}
 
 	void GPUTransferManager::tryCleanupStagingBuffers() {
 		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
+		// queued flushes may still refer to the memory of the blocks
+		flushQueuedMemoryRanges();
 	blockFreeStart:
 		auto blockIterator = m_stagingBuffers.begin();
 		for (auto& block : m_stagingBuffers) {
@@ -581,69 +1586,48 @@ namespace vanadium::graphics {
 
 	bool GPUTransferManager::isBufferTransferFinished(AsyncBufferTransferHandle handle) {
 		auto lock = SharedLockGuard(m_accessMutex);
-		auto& transfer = m_asyncBufferTransfers[handle];
-
-		if (transfer.containingCommandPool == ~0U) {
-			return false;
-		}
-		VkResult status =
-			vkGetFenceStatus(m_context->device(), m_asyncTransferCommandPools[transfer.containingCommandPool].fence);
-
-		switch (status) {
-			case VK_SUCCESS:
-				return true;
-				break;
-			case VK_NOT_READY:
-				return false;
-			default:
-				verifyResult(status);
-				return false;
-				break;
-		}
+		return isAsyncBatchFinished(m_asyncBufferTransfers[handle].batchValue);
 	}
 
 	bool GPUTransferManager::isImageTransferFinished(AsyncImageTransferHandle handle) {
 		auto lock = SharedLockGuard(m_accessMutex);
-		auto& transfer = m_asyncImageTransfers[handle];
+		return isAsyncBatchFinished(m_asyncImageTransfers[handle].batchValue);
+	}
 
-		if (transfer.containingCommandPool == ~0U) {
-			return false;
-		}
-		VkResult status =
-			vkGetFenceStatus(m_context->device(), m_asyncTransferCommandPools[transfer.containingCommandPool].fence);
+	uint64_t GPUTransferManager::completedTransferValue() {
+		auto lock = SharedLockGuard(m_accessMutex);
+		return updateCompletedAsyncBatchValue();
+	}
 
-		switch (status) {
-			case VK_SUCCESS:
-				return true;
-				break;
-			case VK_NOT_READY:
-				return false;
-			default:
-				verifyResult(status);
-				return false;
-				break;
-		}
+	uint64_t GPUTransferManager::bufferTransferValue(AsyncBufferTransferHandle handle) {
+		auto lock = SharedLockGuard(m_accessMutex);
+		return m_asyncBufferTransfers[handle].batchValue;
+	}
+
+	uint64_t GPUTransferManager::imageTransferValue(AsyncImageTransferHandle handle) {
+		auto lock = SharedLockGuard(m_accessMutex);
+		return m_asyncImageTransfers[handle].batchValue;
 	}
 
 	void GPUTransferManager::finalizeAsyncBufferTransfer(AsyncBufferTransferHandle handle) {
 		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
-		m_bufferFinalizationBarriers.push_back(m_asyncBufferTransfers[handle].acquireBarrier);
-
-		auto bufferHandle = m_asyncBufferTransfers[handle].stagingBufferAllocation.bufferHandle;
-		auto& allocationRange = m_asyncBufferTransfers[handle].stagingBufferAllocation.allocationResult.allocationRange;
-		freeToRanges(m_stagingBuffers[bufferHandle].freeRangesOffsetSorted,
-					 m_stagingBuffers[bufferHandle].freeRangesSizeSorted, allocationRange.offset, allocationRange.size);
+		auto& transfer = m_asyncBufferTransfers[handle];
+		assertFatal(isAsyncBatchFinished(transfer.batchValue) || (m_asyncTransferSemaphore && transfer.batchValue),
+					"GPUTransferManager: Finalized an async transfer that can't be waited for!\n");
+		m_bufferFinalizationBarriers.push_back(transfer.acquireBarrier);
+		m_finalizationStageFlags |= transfer.dstStageFlags;
+		m_finalizedBatchValue = std::max(m_finalizedBatchValue, transfer.batchValue);
 		m_asyncBufferTransfers.removeElement(handle);
 	}
 
 	void GPUTransferManager::finalizeAsyncImageTransfer(AsyncImageTransferHandle handle) {
 		auto lock = std::lock_guard<std::shared_mutex>(m_accessMutex);
-		m_imageFinalizationBarriers.push_back(m_asyncImageTransfers[handle].acquireBarrier);
-
-		auto bufferHandle = m_asyncImageTransfers[handle].stagingBufferAllocation.bufferHandle;
-		auto& allocationRange = m_asyncImageTransfers[handle].stagingBufferAllocation.allocationResult.allocationRange;
-		freeToRanges(m_stagingBuffers[bufferHandle].freeRangesOffsetSorted,
-					 m_stagingBuffers[bufferHandle].freeRangesSizeSorted, allocationRange.offset, allocationRange.size);
+		auto& transfer = m_asyncImageTransfers[handle];
+		assertFatal(isAsyncBatchFinished(transfer.batchValue) || (m_asyncTransferSemaphore && transfer.batchValue),
+					"GPUTransferManager: Finalized an async transfer that can't be waited for!\n");
+		m_imageFinalizationBarriers.push_back(transfer.acquireBarrier);
+		m_finalizationStageFlags |= transfer.dstStageFlags;
+		m_finalizedBatchValue = std::max(m_finalizedBatchValue, transfer.batchValue);
 		m_asyncImageTransfers.removeElement(handle);
 	}
 } // namespace vanadium::graphics
@@ -17,6 +17,7 @@
 #include <Log.hpp>
 #include <graphics/util/RangeAllocator.hpp>
 #include <algorithm>
+#include <bit>
 
 namespace vanadium::graphics {
 	VkDeviceSize roundUpAligned(VkDeviceSize n, VkDeviceSize alignment) { return n + alignmentMargin(n, alignment); }
@@ -70,8 +71,8 @@ namespace vanadium::graphics {
 			std::sort(gapsSizeSorted.begin(), gapsSizeSorted.end(), sizeComparator);
 		} else {
 			gapsOffsetSorted.erase(offsetIterator);
-			auto sizeIterator = std::lower_bound(gapsSizeSorted.begin(), gapsSizeSorted.end(), range, sizeComparator);
-			gapsSizeSorted.erase(sizeIterator);
+			// other gaps may have the same size, erase exactly the one that was used
+			gapsSizeSorted.erase(gapsSizeSorted.begin() + allocationIndex);
 		}
 
 		return result;
@@ -88,6 +89,7 @@ namespace vanadium::graphics {
 			MemoryRange range = { .offset = offset, .size = size };
 			gapsOffsetSorted.push_back(range);
 			gapsSizeSorted.push_back(range);
+			return;
 		}
 
 		MemoryRange range = { .offset = offset, .size = size };
@@ -139,4 +141,290 @@ namespace vanadium::graphics {
 			}
 		}
 	}
+
+	void insertMergedRange(std::vector<MemoryRange>& ranges, MemoryRange range) {
+		if (!range.size)
+			return;
+		VkDeviceSize rangeEnd = range.offset + range.size;
+
+		// first range that ends at or after the new range's start, it and the following ones may need merging
+		auto first = std::lower_bound(ranges.begin(), ranges.end(), range.offset,
+									  [](const MemoryRange& one, VkDeviceSize offset) {
+										  return one.offset + one.size < offset;
+									  });
+		auto last = first;
+		while (last != ranges.end() && last->offset <= rangeEnd) {
+			range.offset = std::min(range.offset, last->offset);
+			rangeEnd = std::max(rangeEnd, last->offset + last->size);
+			++last;
+		}
+		range.size = rangeEnd - range.offset;
+
+		if (first == last) {
+			ranges.insert(first, range);
+		} else {
+			*first = range;
+			ranges.erase(first + 1, last);
+		}
+	}
+
+	void eraseRange(std::vector<MemoryRange>& ranges, MemoryRange range) {
+		if (!range.size)
+			return;
+		VkDeviceSize rangeEnd = range.offset + range.size;
+		std::vector<MemoryRange> remainingRanges;
+		remainingRanges.reserve(ranges.size() + 1);
+		for (auto& existingRange : ranges) {
+			VkDeviceSize existingEnd = existingRange.offset + existingRange.size;
+			if (existingEnd <= range.offset || existingRange.offset >= rangeEnd) {
+				remainingRanges.push_back(existingRange);
+				continue;
+			}
+			if (existingRange.offset < range.offset) {
+				remainingRanges.push_back({ existingRange.offset, range.offset - existingRange.offset });
+			}
+			if (existingEnd > rangeEnd) {
+				remainingRanges.push_back({ rangeEnd, existingEnd - rangeEnd });
+			}
+		}
+		ranges = std::move(remainingRanges);
+	}
+
+	RangeAllocator::RangeAllocator() : RangeAllocator(0) {}
+
+	RangeAllocator::RangeAllocator(VkDeviceSize size) : m_totalSize(size), m_freeSize(size) {
+		m_freeListHeads.fill(m_invalidNodeIndex);
+		if (size) {
+			uint32_t nodeIndex = acquireNode();
+			m_nodes[nodeIndex].offset = 0;
+			m_nodes[nodeIndex].size = size;
+			insertFreeNode(nodeIndex);
+		}
+	}
+
+	std::optional<RangeAllocationResult> RangeAllocator::allocate(VkDeviceSize alignment, VkDeviceSize size) {
+		// zero-sized ranges would share their offset with the next allocation
+		VkDeviceSize allocationSize = std::max(size, VkDeviceSize(1));
+
+		// every range in the list found for the rounded-up size is big enough, only the alignment can make it unusable
+		uint32_t nodeIndex = findFreeNode(roundUpToSizeClass(allocationSize));
+		if (nodeIndex != m_invalidNodeIndex && !fits(nodeIndex, alignment, allocationSize)) {
+			nodeIndex = m_invalidNodeIndex;
+		}
+		if (nodeIndex == m_invalidNodeIndex && alignment > 1) {
+			// ranges at least alignment - 1 bytes bigger than needed fit at any offset
+			nodeIndex = findFreeNode(roundUpToSizeClass(allocationSize + alignment - 1));
+		}
+		if (nodeIndex == m_invalidNodeIndex) {
+			nodeIndex = searchFreeNodes(alignment, allocationSize);
+			if (nodeIndex == m_invalidNodeIndex) {
+				return std::nullopt;
+			}
+		}
+
+		removeFreeNode(nodeIndex);
+
+		VkDeviceSize margin = alignmentMargin(m_nodes[nodeIndex].offset, alignment);
+		VkDeviceSize usedSize = margin + allocationSize;
+
+		if (m_nodes[nodeIndex].size > usedSize) {
+			// make unused part of the range another free range
+			uint32_t remainderIndex = acquireNode();
+			auto& node = m_nodes[nodeIndex];
+			auto& remainder = m_nodes[remainderIndex];
+
+			remainder.offset = node.offset + usedSize;
+			remainder.size = node.size - usedSize;
+			remainder.prevPhysical = nodeIndex;
+			remainder.nextPhysical = node.nextPhysical;
+			if (node.nextPhysical != m_invalidNodeIndex) {
+				m_nodes[node.nextPhysical].prevPhysical = remainderIndex;
+			}
+			node.nextPhysical = remainderIndex;
+			node.size = usedSize;
+
+			insertFreeNode(remainderIndex);
+		}
+
+		auto& node = m_nodes[nodeIndex];
+		m_usedNodes.insert({ node.offset, nodeIndex });
+		m_freeSize -= usedSize;
+
+		return RangeAllocationResult{ .allocationRange = { .offset = node.offset, .size = usedSize },
+									  .usableRange = { .offset = node.offset + margin, .size = size } };
+	}
+
+	void RangeAllocator::free(VkDeviceSize offset, VkDeviceSize size) {
+		auto nodeIterator = m_usedNodes.find(offset);
+		assertFatal(nodeIterator != m_usedNodes.end() && m_nodes[nodeIterator->second].size == size,
+					"RangeAllocator: Freed range was never allocated!");
+		uint32_t nodeIndex = nodeIterator->second;
+		m_usedNodes.erase(nodeIterator);
+		m_freeSize += size;
+
+		uint32_t prevIndex = m_nodes[nodeIndex].prevPhysical;
+		if (prevIndex != m_invalidNodeIndex && m_nodes[prevIndex].isFree) {
+			removeFreeNode(prevIndex);
+			m_nodes[prevIndex].size += m_nodes[nodeIndex].size;
+			m_nodes[prevIndex].nextPhysical = m_nodes[nodeIndex].nextPhysical;
+			if (m_nodes[nodeIndex].nextPhysical != m_invalidNodeIndex) {
+				m_nodes[m_nodes[nodeIndex].nextPhysical].prevPhysical = prevIndex;
+			}
+			releaseNode(nodeIndex);
+			nodeIndex = prevIndex;
+		}
+
+		uint32_t nextIndex = m_nodes[nodeIndex].nextPhysical;
+		if (nextIndex != m_invalidNodeIndex && m_nodes[nextIndex].isFree) {
+			removeFreeNode(nextIndex);
+			m_nodes[nodeIndex].size += m_nodes[nextIndex].size;
+			m_nodes[nodeIndex].nextPhysical = m_nodes[nextIndex].nextPhysical;
+			if (m_nodes[nextIndex].nextPhysical != m_invalidNodeIndex) {
+				m_nodes[m_nodes[nextIndex].nextPhysical].prevPhysical = nodeIndex;
+			}
+			releaseNode(nextIndex);
+		}
+
+		insertFreeNode(nodeIndex);
+	}
+
+	VkDeviceSize RangeAllocator::maxAllocatableSize() const {
+		if (!m_firstLevelBitmap) {
+			return 0;
+		}
+		SizeClass highestClass;
+		highestClass.firstLevel = 63 - std::countl_zero(m_firstLevelBitmap);
+		highestClass.secondLevel = 31 - std::countl_zero(m_secondLevelBitmaps[highestClass.firstLevel]);
+
+		VkDeviceSize maxSize = 0;
+		for (uint32_t nodeIndex = m_freeListHeads[listIndex(highestClass)]; nodeIndex != m_invalidNodeIndex;
+			 nodeIndex = m_nodes[nodeIndex].nextFree) {
+			maxSize = std::max(maxSize, m_nodes[nodeIndex].size);
+		}
+		return maxSize;
+	}
+
+	RangeAllocator::SizeClass RangeAllocator::sizeClass(VkDeviceSize size) {
+		if (size < m_secondLevelCount) {
+			return { .firstLevel = 0, .secondLevel = static_cast<uint32_t>(size) };
+		}
+		uint32_t mostSignificantBit = static_cast<uint32_t>(std::bit_width(size)) - 1;
+		return { .firstLevel = mostSignificantBit - m_secondLevelCountLog2 + 1,
+				 .secondLevel = static_cast<uint32_t>(size >> (mostSignificantBit - m_secondLevelCountLog2)) &
+								(m_secondLevelCount - 1) };
+	}
+
+	VkDeviceSize RangeAllocator::roundUpToSizeClass(VkDeviceSize size) {
+		if (size < m_secondLevelCount) {
+			return size;
+		}
+		uint32_t mostSignificantBit = static_cast<uint32_t>(std::bit_width(size)) - 1;
+		VkDeviceSize classGranularity = VkDeviceSize(1) << (mostSignificantBit - m_secondLevelCountLog2);
+		VkDeviceSize roundedSize = size + classGranularity - 1;
+		return roundedSize < size ? size : roundedSize;
+	}
+
+	bool RangeAllocator::fits(uint32_t nodeIndex, VkDeviceSize alignment, VkDeviceSize size) const {
+		return m_nodes[nodeIndex].size >= size + alignmentMargin(m_nodes[nodeIndex].offset, alignment);
+	}
+
+	uint32_t RangeAllocator::findFreeNode(VkDeviceSize size) const {
+		SizeClass searchClass = sizeClass(size);
+
+		uint32_t secondLevelBitmap = m_secondLevelBitmaps[searchClass.firstLevel] & (~0U << searchClass.secondLevel);
+		if (!secondLevelBitmap) {
+			if (searchClass.firstLevel + 1 >= m_firstLevelCount) {
+				return m_invalidNodeIndex;
+			}
+			uint64_t firstLevelBitmap = m_firstLevelBitmap & (~0ULL << (searchClass.firstLevel + 1));
+			if (!firstLevelBitmap) {
+				return m_invalidNodeIndex;
+			}
+			searchClass.firstLevel = std::countr_zero(firstLevelBitmap);
+			secondLevelBitmap = m_secondLevelBitmaps[searchClass.firstLevel];
+		}
+		searchClass.secondLevel = std::countr_zero(secondLevelBitmap);
+		return m_freeListHeads[listIndex(searchClass)];
+	}
+
+	uint32_t RangeAllocator::searchFreeNodes(VkDeviceSize alignment, VkDeviceSize size) const {
+		SizeClass startClass = sizeClass(size);
+
+		uint32_t secondLevelMask = ~0U << startClass.secondLevel;
+		for (uint32_t firstLevel = startClass.firstLevel; firstLevel < m_firstLevelCount; ++firstLevel) {
+			uint32_t secondLevelBitmap = m_secondLevelBitmaps[firstLevel] & secondLevelMask;
+			secondLevelMask = ~0U;
+
+			while (secondLevelBitmap) {
+				SizeClass listClass = { .firstLevel = firstLevel,
+										.secondLevel = static_cast<uint32_t>(std::countr_zero(secondLevelBitmap)) };
+				for (uint32_t nodeIndex = m_freeListHeads[listIndex(listClass)]; nodeIndex != m_invalidNodeIndex;
+					 nodeIndex = m_nodes[nodeIndex].nextFree) {
+					if (fits(nodeIndex, alignment, size)) {
+						return nodeIndex;
+					}
+				}
+				secondLevelBitmap &= secondLevelBitmap - 1;
+			}
+		}
+		return m_invalidNodeIndex;
+	}
+
+	void RangeAllocator::insertFreeNode(uint32_t nodeIndex) {
+		auto& node = m_nodes[nodeIndex];
+		SizeClass nodeClass = sizeClass(node.size);
+		size_t index = listIndex(nodeClass);
+
+		node.isFree = true;
+		node.prevFree = m_invalidNodeIndex;
+		node.nextFree = m_freeListHeads[index];
+		if (node.nextFree != m_invalidNodeIndex) {
+			m_nodes[node.nextFree].prevFree = nodeIndex;
+		}
+		m_freeListHeads[index] = nodeIndex;
+
+		m_firstLevelBitmap |= 1ULL << nodeClass.firstLevel;
+		m_secondLevelBitmaps[nodeClass.firstLevel] |= 1U << nodeClass.secondLevel;
+		++m_freeRangeCount;
+	}
+
+	void RangeAllocator::removeFreeNode(uint32_t nodeIndex) {
+		auto& node = m_nodes[nodeIndex];
+		SizeClass nodeClass = sizeClass(node.size);
+		size_t index = listIndex(nodeClass);
+
+		if (node.prevFree != m_invalidNodeIndex) {
+			m_nodes[node.prevFree].nextFree = node.nextFree;
+		} else {
+			m_freeListHeads[index] = node.nextFree;
+		}
+		if (node.nextFree != m_invalidNodeIndex) {
+			m_nodes[node.nextFree].prevFree = node.prevFree;
+		}
+
+		if (m_freeListHeads[index] == m_invalidNodeIndex) {
+			m_secondLevelBitmaps[nodeClass.firstLevel] &= ~(1U << nodeClass.secondLevel);
+			if (!m_secondLevelBitmaps[nodeClass.firstLevel]) {
+				m_firstLevelBitmap &= ~(1ULL << nodeClass.firstLevel);
+			}
+		}
+
+		node.isFree = false;
+		node.prevFree = m_invalidNodeIndex;
+		node.nextFree = m_invalidNodeIndex;
+		--m_freeRangeCount;
+	}
+
+	uint32_t RangeAllocator::acquireNode() {
+		if (m_unusedNodeIndices.empty()) {
+			m_nodes.push_back({});
+			return static_cast<uint32_t>(m_nodes.size() - 1);
+		}
+		uint32_t nodeIndex = m_unusedNodeIndices.back();
+		m_unusedNodeIndices.pop_back();
+		m_nodes[nodeIndex] = {};
+		return nodeIndex;
+	}
+
+	void RangeAllocator::releaseNode(uint32_t nodeIndex) { m_unusedNodeIndices.push_back(nodeIndex); }
 } // namespace vanadium::graphics
@@ -0,0 +1,83 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <Log.hpp>
+#include <bit>
+#include <graphics/util/SlabAllocator.hpp>
+
+namespace vanadium::graphics {
+	SlabAllocator::SlabAllocator(VkDeviceSize slotSize, uint32_t slotsPerSlab)
+		: m_slotSize(slotSize), m_slotsPerSlab(slotsPerSlab) {
+		assertFatal(slotsPerSlab > 0 && slotsPerSlab <= maxSlotsPerSlab, "SlabAllocator: Invalid slot count!");
+		m_fullMask = slotsPerSlab == 64 ? ~0ULL : (1ULL << slotsPerSlab) - 1;
+	}
+
+	std::optional<SlabSlot> SlabAllocator::allocate() {
+		if (m_partialSlabs.empty())
+			return std::nullopt;
+		uint32_t slabIndex = m_partialSlabs.back();
+		auto& slab = m_slabs[slabIndex];
+
+		uint32_t slotIndex = static_cast<uint32_t>(std::countr_zero(~slab.usedSlots));
+		slab.usedSlots |= 1ULL << slotIndex;
+		++m_usedSlotCount;
+		if (slab.usedSlots == m_fullMask)
+			removePartialSlab(slabIndex);
+		return SlabSlot{ .slabIndex = slabIndex, .slotIndex = slotIndex };
+	}
+
+	bool SlabAllocator::free(SlabSlot slot) {
+		auto& slab = m_slabs[slot.slabIndex];
+		if (slab.usedSlots == m_fullMask)
+			addPartialSlab(slot.slabIndex);
+		slab.usedSlots &= ~(1ULL << slot.slotIndex);
+		--m_usedSlotCount;
+		return slab.usedSlots == 0;
+	}
+
+	uint32_t SlabAllocator::addSlab(VkDeviceSize offset) {
+		uint32_t slabIndex;
+		if (m_unusedSlabIndices.empty()) {
+			slabIndex = static_cast<uint32_t>(m_slabs.size());
+			m_slabs.push_back({ .offset = offset });
+		} else {
+			slabIndex = m_unusedSlabIndices.back();
+			m_unusedSlabIndices.pop_back();
+			m_slabs[slabIndex] = { .offset = offset };
+		}
+		addPartialSlab(slabIndex);
+		return slabIndex;
+	}
+
+	void SlabAllocator::removeSlab(uint32_t slabIndex) {
+		assertFatal(m_slabs[slabIndex].usedSlots == 0, "SlabAllocator: Removing slab that is still in use!");
+		removePartialSlab(slabIndex);
+		m_unusedSlabIndices.push_back(slabIndex);
+	}
+
+	void SlabAllocator::addPartialSlab(uint32_t slabIndex) {
+		m_slabs[slabIndex].partialSlabIndex = static_cast<uint32_t>(m_partialSlabs.size());
+		m_partialSlabs.push_back(slabIndex);
+	}
+
+	void SlabAllocator::removePartialSlab(uint32_t slabIndex) {
+		uint32_t partialSlabIndex = m_slabs[slabIndex].partialSlabIndex;
+		m_partialSlabs[partialSlabIndex] = m_partialSlabs.back();
+		m_slabs[m_partialSlabs[partialSlabIndex]].partialSlabIndex = partialSlabIndex;
+		m_partialSlabs.pop_back();
+		m_slabs[slabIndex].partialSlabIndex = m_invalidIndex;
+	}
+} // namespace vanadium::graphics
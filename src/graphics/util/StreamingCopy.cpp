@@ -0,0 +1,161 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <graphics/util/StreamingCopy.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VANADIUM_SSE2_STREAMING_STORES
+#endif
+
+namespace vanadium::graphics {
+
+	// below this, the data is likely to be read again soon and normal stores are just as fast
+	constexpr size_t minStreamingCopySize = 256_KiB;
+	// one write-combining buffer
+	constexpr size_t streamingBlockSize = 64;
+
+	void streamingCopy(void* dst, const void* src, size_t size) {
+#ifdef VANADIUM_SSE2_STREAMING_STORES
+		if (size >= minStreamingCopySize) {
+			auto dstBytes = static_cast<unsigned char*>(dst);
+			auto srcBytes = static_cast<const unsigned char*>(src);
+
+			// streaming stores need an aligned destination, the source is loaded unaligned
+			size_t headSize = (16 - reinterpret_cast<uintptr_t>(dstBytes) % 16) % 16;
+			std::memcpy(dstBytes, srcBytes, headSize);
+			dstBytes += headSize;
+			srcBytes += headSize;
+			size -= headSize;
+
+			size_t blockCount = size / streamingBlockSize;
+			for (size_t i = 0; i < blockCount; ++i) {
+				_mm_prefetch(reinterpret_cast<const char*>(srcBytes) + 8 * streamingBlockSize, _MM_HINT_NTA);
+				__m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcBytes));
+				__m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcBytes + 16));
+				__m128i third = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcBytes + 32));
+				__m128i fourth = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcBytes + 48));
+				_mm_stream_si128(reinterpret_cast<__m128i*>(dstBytes), first);
+				_mm_stream_si128(reinterpret_cast<__m128i*>(dstBytes + 16), second);
+				_mm_stream_si128(reinterpret_cast<__m128i*>(dstBytes + 32), third);
+				_mm_stream_si128(reinterpret_cast<__m128i*>(dstBytes + 48), fourth);
+				dstBytes += streamingBlockSize;
+				srcBytes += streamingBlockSize;
+			}
+			// streaming stores are weakly ordered, make them visible before anyone is told the copy is done
+			_mm_sfence();
+			std::memcpy(dstBytes, srcBytes, size % streamingBlockSize);
+			return;
+		}
+#endif
+		std::memcpy(dst, src, size);
+	}
+
+	void StreamingCopyPool::create(uint32_t workerCount) {
+		if (workerCount == 0) {
+			uint32_t hardwareThreadCount = std::thread::hardware_concurrency();
+			workerCount = std::min(m_maxWorkerCount, hardwareThreadCount > 1 ? hardwareThreadCount - 1 : 0);
+		}
+		m_stopping = false;
+		m_workers.reserve(workerCount);
+		for (uint32_t i = 0; i < workerCount; ++i) {
+			m_workers.emplace_back(&StreamingCopyPool::workerLoop, this);
+		}
+	}
+
+	void StreamingCopyPool::destroy() {
+		{
+			auto lock = std::lock_guard<std::mutex>(m_chunkMutex);
+			m_stopping = true;
+		}
+		m_chunksAvailable.notify_all();
+		for (auto& worker : m_workers) {
+			worker.join();
+		}
+		m_workers.clear();
+	}
+
+	void StreamingCopyPool::copy(void* dst, const void* src, size_t size) {
+		size_t chunkCount = std::min(m_workers.size() + 1, size / minChunkSize);
+		if (size < minParallelCopySize || chunkCount < 2) {
+			streamingCopy(dst, src, size);
+			return;
+		}
+		// chunks never share a write-combining buffer
+		size_t chunkSize = (size + chunkCount - 1) / chunkCount;
+		chunkSize = (chunkSize + streamingBlockSize - 1) / streamingBlockSize * streamingBlockSize;
+		chunkCount = (size + chunkSize - 1) / chunkSize;
+
+		auto dstBytes = static_cast<unsigned char*>(dst);
+		auto srcBytes = static_cast<const unsigned char*>(src);
+		std::atomic<size_t> remainingChunks = chunkCount - 1;
+		{
+			auto lock = std::lock_guard<std::mutex>(m_chunkMutex);
+			for (size_t i = 1; i < chunkCount; ++i) {
+				size_t offset = i * chunkSize;
+				m_chunks.push_back({ .dst = dstBytes + offset,
+									 .src = srcBytes + offset,
+									 .size = std::min(chunkSize, size - offset),
+									 .remainingChunks = &remainingChunks });
+			}
+		}
+		m_chunksAvailable.notify_all();
+
+		streamingCopy(dstBytes, srcBytes, chunkSize);
+
+		// help out with whatever is queued until the workers are done with this copy
+		auto lock = std::unique_lock<std::mutex>(m_chunkMutex);
+		while (remainingChunks.load()) {
+			if (!m_chunks.empty()) {
+				CopyChunk chunk = m_chunks.front();
+				m_chunks.pop_front();
+				lock.unlock();
+				copyChunk(chunk);
+				lock.lock();
+			} else {
+				m_chunkFinished.wait(lock, [&] { return !remainingChunks.load() || !m_chunks.empty(); });
+			}
+		}
+	}
+
+	void StreamingCopyPool::workerLoop() {
+		while (true) {
+			CopyChunk chunk;
+			{
+				auto lock = std::unique_lock<std::mutex>(m_chunkMutex);
+				m_chunksAvailable.wait(lock, [this] { return m_stopping || !m_chunks.empty(); });
+				if (m_chunks.empty())
+					return;
+				chunk = m_chunks.front();
+				m_chunks.pop_front();
+			}
+			copyChunk(chunk);
+		}
+	}
+
+	void StreamingCopyPool::copyChunk(const CopyChunk& chunk) {
+		streamingCopy(chunk.dst, chunk.src, chunk.size);
+		if (chunk.remainingChunks->fetch_sub(1) == 1) {
+			// the copying thread may be waiting, it checks the counter with the mutex held
+			auto lock = std::lock_guard<std::mutex>(m_chunkMutex);
+			m_chunkFinished.notify_all();
+		}
+	}
+
+} // namespace vanadium::graphics
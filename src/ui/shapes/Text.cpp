@@ -151,28 +151,11 @@ namespace vanadium::ui::shapes {
 			if (atlas.dirtyFlag) {
 				regenerateFontAtlas(key, frameIndex);
 				regenerateGlyphData(key, frameIndex);
-				if (atlas.glyphDataTransfer != ~0U)
-					m_renderContext.transferManager->updateTransferData(atlas.glyphDataTransfer, frameIndex,
-																		atlas.glyphData.data());
-
 				updateAtlasDescriptors(key, frameIndex);
 			} else if (atlas.bufferDirtyFlag) {
 				regenerateGlyphData(key, frameIndex);
-				m_renderContext.transferManager->updateTransferData(atlas.glyphDataTransfer, frameIndex,
-																	atlas.glyphData.data());
-
 				updateAtlasDescriptors(key, frameIndex);
 			} else {
-				if (atlas.lastUpdateFrameIndex != ~0U) {
-					if (atlas.lastUpdateFrameIndex == frameIndex) {
-						atlas.lastUpdateFrameIndex = ~0U;
-					} else {
-
-						m_renderContext.transferManager->updateTransferData(atlas.glyphDataTransfer, frameIndex,
-																			atlas.glyphData.data());
-					}
-				}
-
 				if (atlas.lastRecreateFrameIndex != ~0U) {
 					if (atlas.lastRecreateFrameIndex == frameIndex) {
 						atlas.lastRecreateFrameIndex = ~0U;
@@ -181,6 +164,11 @@ namespace vanadium::ui::shapes {
 					}
 				}
 			}
+			if (atlas.glyphDataTransfer != ~0U) {
+				m_renderContext.transferManager->flushTransferData(atlas.glyphDataTransfer, frameIndex,
+																   atlas.glyphData.data(),
+																   atlas.glyphData.size() * sizeof(RenderedGlyphData));
+			}
 
 			for (auto& shape : atlas.referencingShapes) {
 				shape->clearDirtyFlag();
@@ -380,7 +368,9 @@ namespace vanadium::ui::shapes {
 		uint32_t atlasWidth = approximateTextureDimensions;
 		uint32_t atlasHeight = pixelPenY + maxLineHeight;
 
-		char* atlasData = new char[atlasWidth * atlasHeight];
+		// the atlas is rasterized straight into upload memory
+		graphics::GPUUpload atlasUpload = m_renderContext.transferManager->beginUpload(atlasWidth * atlasHeight);
+		char* atlasData = static_cast<char*>(atlasUpload.data);
 		std::memset(atlasData, 0, atlasWidth * atlasHeight);
 		for (auto& [glyphIndex, glyphCoord] : m_fontAtlases[identifier].fontAtlasPositions) {
 			FT_Load_Glyph(face, glyphIndex, FT_LOAD_RENDER);
@@ -414,8 +404,8 @@ namespace vanadium::ui::shapes {
 		m_fontAtlases[identifier].fontAtlasImage =
 			m_renderContext.resourceAllocator->createImage(atlasImageCreateInfo, {}, { .deviceLocal = true });
 		m_fontAtlases[identifier].lastRecreateFrameIndex = frameIndex;
-		m_renderContext.transferManager->submitImageTransfer(
-			m_fontAtlases[identifier].fontAtlasImage,
+		m_renderContext.transferManager->commitImageTransfer(
+			atlasUpload.handle, m_fontAtlases[identifier].fontAtlasImage,
 			{ .bufferOffset = 0,
 			  .bufferRowLength = 0,
 			  .bufferImageHeight = 0,
@@ -424,8 +414,8 @@ namespace vanadium::ui::shapes {
 									.baseArrayLayer = 0,
 									.layerCount = 1 },
 			  .imageExtent = atlasImageCreateInfo.extent },
-			atlasData, atlasWidth * atlasHeight, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
-			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_IMAGE_LAYOUT_UNDEFINED, graphics::TransferPriority::Urgent);
 		if constexpr (vanadiumGPUDebug) {
 			setObjectName(
 				m_renderContext.deviceContext->device(), VK_OBJECT_TYPE_IMAGE,
@@ -433,13 +423,13 @@ namespace vanadium::ui::shapes {
 				"Font atlas image (ID hash " + std::to_string(robin_hood::hash<FontAtlasIdentifier>()(identifier)) +
 					")");
 		}
-		delete[] atlasData;
 	}
 
 	void TextShapeRegistry::regenerateGlyphData(const FontAtlasIdentifier& identifier, uint32_t frameIndex) {
 		if (m_fontAtlases[identifier].shapeGlyphData.empty())
 			return;
 
+		std::vector<RenderedGlyphData> previousGlyphData = std::move(m_fontAtlases[identifier].glyphData);
 		m_fontAtlases[identifier].glyphData.clear();
 		for (auto& data : m_fontAtlases[identifier].shapeGlyphData) {
 			Vector2 basePosition = data.referencedShape->position();
@@ -472,15 +462,18 @@ namespace vanadium::ui::shapes {
 				static_cast<VkDeviceSize>(m_fontAtlases[identifier].transferBufferCapacity * 1.61),
 				static_cast<VkDeviceSize>(m_fontAtlases[identifier].glyphData.size() * sizeof(RenderedGlyphData)));
 
-			m_fontAtlases[identifier].glyphData.reserve(m_fontAtlases[identifier].transferBufferCapacity);
-
 			m_fontAtlases[identifier].glyphDataTransfer = m_renderContext.transferManager->createTransfer(
 				m_fontAtlases[identifier].transferBufferCapacity,
 				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
 				VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
 			m_fontAtlases[identifier].lastRecreateFrameIndex = frameIndex;
+		} else {
+			// only the glyphs that moved or changed need to be uploaded again
+			m_renderContext.transferManager->invalidateChangedTransferData(
+				m_fontAtlases[identifier].glyphDataTransfer, previousGlyphData.data(),
+				previousGlyphData.size() * sizeof(RenderedGlyphData), m_fontAtlases[identifier].glyphData.data(),
+				m_fontAtlases[identifier].glyphData.size() * sizeof(RenderedGlyphData), sizeof(RenderedGlyphData));
 		}
-		m_fontAtlases[identifier].lastUpdateFrameIndex = frameIndex;
 	}
 
 	void TextShapeRegistry::updateAtlasDescriptors(const FontAtlasIdentifier& identifier, uint32_t frameIndex) {
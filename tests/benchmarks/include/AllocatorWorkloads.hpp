@@ -0,0 +1,55 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#define VK_NO_PROTOTYPES
+#include <vulkan/vulkan.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class AllocatorOperationType { Allocate, Free };
+
+struct AllocatorOperation {
+	AllocatorOperationType type;
+	// Identifies the allocation across its allocate and free operations.
+	uint32_t id;
+	VkDeviceSize size;
+	VkDeviceSize alignment;
+};
+
+struct AllocatorWorkload {
+	std::string name;
+	VkDeviceSize rangeSize;
+	uint32_t allocationCount;
+	std::vector<AllocatorOperation> operations;
+};
+
+AllocatorWorkload generateUniformWorkload();
+AllocatorWorkload generatePowerLawWorkload();
+AllocatorWorkload generateMixedAlignmentWorkload();
+AllocatorWorkload generateStreamingWorkload();
+
+// Loads an allocation trace recorded by GPUResourceAllocator::startTraceRecording. Creations and destructions of
+// resources placed in blocks become allocations and frees, deferred destructions take effect at the next free list
+// flush of their frame-in-flight slot. Resources of all memory types share one range that is at most three quarters
+// full at the peak of the trace.
+// Files that aren't allocation traces are read as text traces as a fallback. Every line is either
+// "a <id> <size> <alignment>" or "f <id>", lines starting with # are ignored. An optional "r <size>" line sets the
+// size of the range, the default is 32 MiB.
+std::optional<AllocatorWorkload> loadTraceWorkload(const std::string_view& fileName);
@@ -0,0 +1,56 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <AllocatorWorkloads.hpp>
+#include <array>
+#include <string_view>
+
+using WorkloadGenerator = AllocatorWorkload (*)();
+
+struct WorkloadEntry {
+	std::string_view name;
+	WorkloadGenerator generator;
+};
+
+static constexpr std::array<WorkloadEntry, 4> workloads = {
+	WorkloadEntry{ "Uniform", generateUniformWorkload },
+	WorkloadEntry{ "PowerLaw", generatePowerLawWorkload },
+	WorkloadEntry{ "MixedAlignment", generateMixedAlignmentWorkload },
+	WorkloadEntry{ "Streaming", generateStreamingWorkload }
+};
+
+// Runs the workload against every range allocator implementation and prints the results.
+void runRangeAllocatorBenchmarks(const AllocatorWorkload& workload);
+
+// Compares allocation throughput of a single locked range allocator with and without per-thread allocation caches.
+void runMultithreadedAllocatorBenchmarks();
+
+// Compares resolving image views through a locked map, like requestImageView, with declared view handles.
+void runImageViewBenchmarks();
+
+// Replays the workload against blocks sized by the fixed and the default adaptive BlockSizePolicy.
+void runBlockSizePolicyBenchmarks(const AllocatorWorkload& workload);
+
+// Replays the workload through GPUResourceAllocator on a mock device, so the driver calls cost next to nothing.
+void runGPUAllocatorBenchmarks(const AllocatorWorkload& workload);
+
+// Measures one-time buffer uploads through GPUTransferManager on a mock device.
+void runGPUTransferBenchmarks();
+
+// Compares std::memcpy with single-threaded and pooled streaming copies for upload-sized copies.
+void runStreamingCopyBenchmarks();
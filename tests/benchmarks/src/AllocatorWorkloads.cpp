@@ -0,0 +1,291 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <AllocatorWorkloads.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <graphics/util/AllocationTrace.hpp>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+#include <util/MemoryLiterals.hpp>
+
+using namespace vanadium::graphics;
+
+static constexpr VkDeviceSize defaultRangeSize = 32_MiB;
+static constexpr size_t randomOperationCount = 40000;
+
+// Allocates and frees randomly, keeping the range between half and three quarters full.
+template <typename SizeSampler, typename AlignmentSampler>
+AllocatorWorkload generateRandomWorkload(const std::string& name, uint32_t seed, SizeSampler sizeSampler,
+										 AlignmentSampler alignmentSampler) {
+	std::mt19937 generator(seed);
+	AllocatorWorkload workload = { .name = name, .rangeSize = defaultRangeSize, .allocationCount = 0 };
+	workload.operations.reserve(randomOperationCount);
+
+	std::vector<AllocatorOperation> liveAllocations;
+	VkDeviceSize liveBytes = 0;
+	while (workload.operations.size() < randomOperationCount) {
+		uint32_t allocateChance = 2;
+		if (liveBytes < workload.rangeSize / 2) {
+			allocateChance = 3;
+		} else if (liveBytes > workload.rangeSize / 4 * 3) {
+			allocateChance = 1;
+		}
+
+		if (liveAllocations.empty() || generator() % 4 < allocateChance) {
+			AllocatorOperation operation = { .type = AllocatorOperationType::Allocate,
+											 .id = workload.allocationCount++,
+											 .size = sizeSampler(generator),
+											 .alignment = alignmentSampler(generator) };
+			liveBytes += operation.size;
+			liveAllocations.push_back(operation);
+			workload.operations.push_back(operation);
+		} else {
+			size_t index = generator() % liveAllocations.size();
+			liveBytes -= liveAllocations[index].size;
+			workload.operations.push_back({ .type = AllocatorOperationType::Free, .id = liveAllocations[index].id });
+			liveAllocations[index] = liveAllocations.back();
+			liveAllocations.pop_back();
+		}
+	}
+	return workload;
+}
+
+AllocatorWorkload generateUniformWorkload() {
+	return generateRandomWorkload(
+		"Uniform", 1, [](std::mt19937&) { return VkDeviceSize(4_KiB); }, [](std::mt19937&) { return VkDeviceSize(256); });
+}
+
+AllocatorWorkload generatePowerLawWorkload() {
+	return generateRandomWorkload(
+		"PowerLaw", 2,
+		[](std::mt19937& generator) {
+			// Pareto distribution with alpha = 1.2, most allocations are small but a few are several MiB big
+			std::uniform_real_distribution<double> distribution(0.0, 1.0);
+			double size = 256.0 * std::pow(1.0 - distribution(generator), -1.0 / 1.2);
+			return std::min(static_cast<VkDeviceSize>(size) & ~VkDeviceSize(15), VkDeviceSize(4_MiB));
+		},
+		[](std::mt19937&) { return VkDeviceSize(256); });
+}
+
+AllocatorWorkload generateMixedAlignmentWorkload() {
+	return generateRandomWorkload(
+		"MixedAlignment", 3,
+		[](std::mt19937& generator) {
+			return std::uniform_int_distribution<VkDeviceSize>(64, 256_KiB)(generator);
+		},
+		[](std::mt19937& generator) {
+			constexpr VkDeviceSize alignments[] = { 1, 4, 16, 64, 256, 4_KiB, 64_KiB };
+			return alignments[generator() % std::size(alignments)];
+		});
+}
+
+AllocatorWorkload generateStreamingWorkload() {
+	constexpr uint32_t frameCount = 2000;
+	constexpr uint32_t transientLifetime = 3;
+
+	struct LiveAllocation {
+		uint32_t id;
+		VkDeviceSize size;
+		uint32_t lastFrame;
+	};
+
+	std::mt19937 generator(4);
+	AllocatorWorkload workload = { .name = "Streaming", .rangeSize = defaultRangeSize, .allocationCount = 0 };
+	std::vector<LiveAllocation> transientAllocations;
+	std::vector<LiveAllocation> assetAllocations;
+	VkDeviceSize assetBytes = 0;
+
+	auto allocate = [&](VkDeviceSize size, VkDeviceSize alignment, uint32_t lastFrame) {
+		uint32_t id = workload.allocationCount++;
+		workload.operations.push_back(
+			{ .type = AllocatorOperationType::Allocate, .id = id, .size = size, .alignment = alignment });
+		return LiveAllocation{ .id = id, .size = size, .lastFrame = lastFrame };
+	};
+	auto freeExpired = [&](std::vector<LiveAllocation>& allocations, uint32_t frame) {
+		for (size_t i = 0; i < allocations.size();) {
+			if (allocations[i].lastFrame <= frame) {
+				workload.operations.push_back({ .type = AllocatorOperationType::Free, .id = allocations[i].id });
+				allocations[i] = allocations.back();
+				allocations.pop_back();
+			} else {
+				++i;
+			}
+		}
+	};
+
+	for (uint32_t frame = 0; frame < frameCount; ++frame) {
+		freeExpired(transientAllocations, frame);
+		for (auto& allocation : assetAllocations) {
+			if (allocation.lastFrame <= frame) {
+				assetBytes -= allocation.size;
+			}
+		}
+		freeExpired(assetAllocations, frame);
+
+		// per-frame uploads: uniform data, UI vertex data and the like
+		uint32_t transientCount = std::uniform_int_distribution<uint32_t>(20, 60)(generator);
+		for (uint32_t i = 0; i < transientCount; ++i) {
+			VkDeviceSize size = std::uniform_int_distribution<VkDeviceSize>(256, 64_KiB)(generator);
+			transientAllocations.push_back(allocate(size, 256, frame + transientLifetime));
+		}
+
+		// streamed meshes and textures with long, random lifetimes
+		if (generator() % 10 == 0 && assetBytes < workload.rangeSize / 2) {
+			VkDeviceSize size = std::uniform_int_distribution<VkDeviceSize>(64_KiB, 2_MiB)(generator);
+			VkDeviceSize alignment = generator() % 2 ? 4_KiB : 64_KiB;
+			uint32_t lifetime = std::uniform_int_distribution<uint32_t>(50, 500)(generator);
+			assetAllocations.push_back(allocate(size, alignment, frame + lifetime));
+			assetBytes += size;
+		}
+	}
+	return workload;
+}
+
+static bool isDeferredDestroyEvent(AllocationTraceEventType type) {
+	return type == AllocationTraceEventType::DestroyBuffer || type == AllocationTraceEventType::DestroyImage;
+}
+
+static std::optional<AllocatorWorkload> convertAllocationTrace(const std::string_view& name,
+															   const AllocationTrace& trace) {
+	AllocatorWorkload workload = { .name = std::string(name), .rangeSize = 0, .allocationCount = 0 };
+	// buffer and image handles are separate, the lowest bit of the key tells them apart
+	std::unordered_map<uint64_t, AllocatorOperation> liveAllocations;
+	// handles of deferred destructions can be reused before the allocation is freed
+	std::vector<std::vector<AllocatorOperation>> pendingFrees;
+	VkDeviceSize liveBytes = 0;
+	VkDeviceSize peakLiveBytes = 0;
+
+	auto freeAllocation = [&](const AllocatorOperation& allocation) {
+		liveBytes -= allocation.size;
+		workload.operations.push_back({ .type = AllocatorOperationType::Free, .id = allocation.id });
+	};
+
+	for (auto& event : trace.events) {
+		if (event.type == AllocationTraceEventType::FlushFreeList) {
+			if (event.frameInFlightIndex < pendingFrees.size()) {
+				for (auto& allocation : pendingFrees[event.frameInFlightIndex]) {
+					freeAllocation(allocation);
+				}
+				pendingFrees[event.frameInFlightIndex].clear();
+			}
+			continue;
+		}
+		// custom blocks are placed by the application, dedicated allocations don't occupy a block at all
+		if (event.flags & (AllocationTraceFlagCustomBlock | AllocationTraceFlagDedicated) ||
+			event.memoryTypeIndex >= trace.memoryTypes.size()) {
+			continue;
+		}
+
+		uint64_t key = event.handle << 1 | ((event.flags & AllocationTraceFlagImage) ? 1 : 0);
+		switch (event.type) {
+			case AllocationTraceEventType::CreateBuffer:
+			case AllocationTraceEventType::CreatePerFrameBuffer:
+			case AllocationTraceEventType::CreateImage: {
+				AllocatorOperation operation = { .type = AllocatorOperationType::Allocate,
+												 .id = workload.allocationCount,
+												 .size = event.size,
+												 .alignment = event.alignment };
+				if (!liveAllocations.insert({ key, operation }).second) {
+					return std::nullopt;
+				}
+				++workload.allocationCount;
+				liveBytes += operation.size;
+				peakLiveBytes = std::max(peakLiveBytes, liveBytes);
+				workload.operations.push_back(operation);
+				break;
+			}
+			case AllocationTraceEventType::DestroyBuffer:
+			case AllocationTraceEventType::DestroyBufferImmediately:
+			case AllocationTraceEventType::DestroyImage:
+			case AllocationTraceEventType::DestroyImageImmediately: {
+				auto iterator = liveAllocations.find(key);
+				if (iterator == liveAllocations.end()) {
+					return std::nullopt;
+				}
+				if (isDeferredDestroyEvent(event.type)) {
+					if (pendingFrees.size() <= event.frameInFlightIndex) {
+						pendingFrees.resize(event.frameInFlightIndex + 1);
+					}
+					pendingFrees[event.frameInFlightIndex].push_back(iterator->second);
+				} else {
+					freeAllocation(iterator->second);
+				}
+				liveAllocations.erase(iterator);
+				break;
+			}
+			default:
+				break;
+		}
+	}
+	workload.rangeSize = std::max(defaultRangeSize, peakLiveBytes / 3 * 4);
+	return workload;
+}
+
+static std::optional<AllocatorWorkload> loadTextTraceWorkload(const std::string_view& fileName) {
+	std::ifstream stream = std::ifstream(std::string(fileName));
+	if (!stream.is_open()) {
+		return std::nullopt;
+	}
+
+	AllocatorWorkload workload = { .name = std::string(fileName), .rangeSize = defaultRangeSize, .allocationCount = 0 };
+	// trace IDs may be sparse or reused after being freed, map them to dense indices
+	std::unordered_map<uint64_t, uint32_t> liveIDs;
+
+	std::string line;
+	while (std::getline(stream, line)) {
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
+		std::istringstream lineStream = std::istringstream(line);
+		char type;
+		uint64_t id;
+		lineStream >> type;
+		if (type == 'r') {
+			lineStream >> workload.rangeSize;
+		} else if (type == 'a') {
+			AllocatorOperation operation = { .type = AllocatorOperationType::Allocate };
+			lineStream >> id >> operation.size >> operation.alignment;
+			if (!lineStream || liveIDs.contains(id)) {
+				return std::nullopt;
+			}
+			operation.id = workload.allocationCount++;
+			liveIDs.insert({ id, operation.id });
+			workload.operations.push_back(operation);
+		} else if (type == 'f') {
+			lineStream >> id;
+			auto iterator = liveIDs.find(id);
+			if (!lineStream || iterator == liveIDs.end()) {
+				return std::nullopt;
+			}
+			workload.operations.push_back({ .type = AllocatorOperationType::Free, .id = iterator->second });
+			liveIDs.erase(iterator);
+		} else {
+			return std::nullopt;
+		}
+	}
+	return workload;
+}
+
+std::optional<AllocatorWorkload> loadTraceWorkload(const std::string_view& fileName) {
+	auto trace = readAllocationTrace(fileName);
+	if (trace.has_value()) {
+		return convertAllocationTrace(fileName, trace.value());
+	}
+	return loadTextTraceWorkload(fileName);
+}
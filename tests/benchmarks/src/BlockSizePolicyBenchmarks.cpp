@@ -0,0 +1,140 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <BenchmarkList.hpp>
+#include <graphics/util/BlockSizePolicy.hpp>
+#include <graphics/util/RangeAllocator.hpp>
+#include <iomanip>
+#include <iostream>
+
+using namespace vanadium::graphics;
+
+// free list flushes (and with them, block releases) happen once per simulated frame
+static constexpr size_t operationsPerFrame = 256;
+
+// the allocator's behaviour before block sizes adapted: fixed 32 MiB blocks, at most one empty block kept
+static constexpr BlockSizePolicy fixedBlockSizePolicy = { .initialBlockSize = 32_MiB,
+														  .growthFactor = 1.0f,
+														  .maxBlockSize = 32_MiB,
+														  .maxHeapFraction = 1.0f,
+														  .pressureRetention = 0.0f,
+														  .minRetainedSize = 32_MiB };
+
+struct BlockSimulationResult {
+	size_t blockAllocationCount;
+	size_t blockFreeCount;
+	VkDeviceSize peakCommittedSize;
+	double averageCommittedSize;
+	// committed bytes not occupied by allocations, averaged over all operations
+	double averageUnusedSize;
+};
+
+struct SimulatedAllocation {
+	size_t blockIndex;
+	MemoryRange range;
+};
+
+// Replays the workload against a list of blocks like the allocator's shared blocks of one memory type.
+BlockSimulationResult simulateBlockSizePolicy(const AllocatorWorkload& workload, const BlockSizePolicy& policy,
+											  VkDeviceSize heapSize) {
+	BlockSimulationResult result = {};
+	BlockSizer sizer = BlockSizer(policy, heapSize);
+
+	// released blocks are left empty so indices stay stable
+	std::vector<std::optional<RangeAllocator>> blocks;
+	std::vector<std::optional<SimulatedAllocation>> allocations =
+		std::vector<std::optional<SimulatedAllocation>>(workload.allocationCount);
+	VkDeviceSize committedSize = 0;
+	VkDeviceSize usedSize = 0;
+	double committedSizeSum = 0.0;
+	double unusedSizeSum = 0.0;
+
+	for (size_t i = 0; i < workload.operations.size(); ++i) {
+		auto& operation = workload.operations[i];
+		if (operation.type == AllocatorOperationType::Allocate) {
+			std::optional<SimulatedAllocation> allocation;
+			for (size_t j = 0; j < blocks.size() && !allocation.has_value(); ++j) {
+				if (!blocks[j].has_value())
+					continue;
+				auto rangeResult = blocks[j]->allocate(operation.alignment, operation.size);
+				if (rangeResult.has_value())
+					allocation = SimulatedAllocation{ .blockIndex = j, .range = rangeResult->allocationRange };
+			}
+			if (!allocation.has_value()) {
+				VkDeviceSize blockSize = sizer.nextBlockSize(operation.size + operation.alignment);
+				blocks.push_back(RangeAllocator(blockSize));
+				committedSize += blockSize;
+				++result.blockAllocationCount;
+				auto rangeResult = blocks.back()->allocate(operation.alignment, operation.size);
+				allocation = SimulatedAllocation{ .blockIndex = blocks.size() - 1,
+												  .range = rangeResult->allocationRange };
+			}
+			usedSize += allocation->range.size;
+			allocations[operation.id] = allocation;
+		} else if (allocations[operation.id].has_value()) {
+			auto& allocation = allocations[operation.id].value();
+			blocks[allocation.blockIndex]->free(allocation.range.offset, allocation.range.size);
+			usedSize -= allocation.range.size;
+			allocations[operation.id] = std::nullopt;
+		}
+
+		if ((i + 1) % operationsPerFrame == 0) {
+			sizer.decayPressure();
+			VkDeviceSize retainedSize = 0;
+			for (auto& block : blocks) {
+				if (!block.has_value() || !block->empty())
+					continue;
+				if (sizer.shouldReleaseEmptyBlock(block->totalSize(), retainedSize)) {
+					committedSize -= block->totalSize();
+					++result.blockFreeCount;
+					block = std::nullopt;
+				} else {
+					retainedSize += block->totalSize();
+				}
+			}
+		}
+
+		result.peakCommittedSize = std::max(result.peakCommittedSize, committedSize);
+		committedSizeSum += static_cast<double>(committedSize);
+		unusedSizeSum += static_cast<double>(committedSize - usedSize);
+	}
+
+	double operationCount = static_cast<double>(std::max(workload.operations.size(), size_t(1)));
+	result.averageCommittedSize = committedSizeSum / operationCount;
+	result.averageUnusedSize = unusedSizeSum / operationCount;
+	return result;
+}
+
+void printBlockSimulationResult(const std::string_view& policyName, VkDeviceSize heapSize,
+								const BlockSimulationResult& result) {
+	constexpr double mebibyte = 1024.0 * 1024.0;
+	std::cout << "  " << std::left << std::setw(10) << policyName << std::right << std::setw(6) << heapSize / 1_MiB
+			  << " MiB heap" << std::setw(8) << result.blockAllocationCount << " block allocations" << std::setw(8)
+			  << result.blockFreeCount << " block frees" << std::fixed << std::setprecision(1) << std::setw(10)
+			  << static_cast<double>(result.peakCommittedSize) / mebibyte << " MiB peak" << std::setw(10)
+			  << result.averageCommittedSize / mebibyte << " MiB avg committed" << std::setw(10)
+			  << result.averageUnusedSize / mebibyte << " MiB avg unused\n";
+}
+
+void runBlockSizePolicyBenchmarks(const AllocatorWorkload& workload) {
+	std::cout << workload.name << " block sizing (" << operationsPerFrame << " operations per frame):\n";
+	for (VkDeviceSize heapSize : { 256_MiB, 8192_MiB }) {
+		printBlockSimulationResult("Fixed", heapSize,
+								   simulateBlockSizePolicy(workload, fixedBlockSizePolicy, heapSize));
+		printBlockSimulationResult("Adaptive", heapSize,
+								   simulateBlockSizePolicy(workload, BlockSizePolicy(), heapSize));
+	}
+}
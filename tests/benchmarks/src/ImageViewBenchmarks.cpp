@@ -0,0 +1,135 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <BenchmarkList.hpp>
+#include <atomic>
+#include <chrono>
+#include <graphics/util/ImageViewTable.hpp>
+#include <iomanip>
+#include <iostream>
+#include <robin_hood.h>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+using namespace vanadium::graphics;
+
+static constexpr uint32_t viewCount = 512;
+static constexpr size_t lookupsPerThread = 2000000;
+
+static VkImageView fakeImageView(uint64_t index) { return reinterpret_cast<VkImageView>(index + 1); }
+
+// What requestImageView does on a hit: a shared lock on the resource tables and a hash map lookup.
+class LockedViewMap {
+  public:
+	LockedViewMap() {
+		for (uint64_t i = 0; i < viewCount; ++i) {
+			m_views.insert(robin_hood::pair<const uint64_t, VkImageView>(i, fakeImageView(i)));
+		}
+	}
+
+	VkImageView lookup(uint32_t index) {
+		auto lock = std::shared_lock<std::shared_mutex>(m_mutex);
+		return m_views.find(index)->second;
+	}
+
+	// stands in for other threads creating and destroying views
+	void churn(uint64_t iteration) {
+		auto lock = std::lock_guard<std::shared_mutex>(m_mutex);
+		uint64_t key = viewCount + iteration % 64;
+		if (!m_views.erase(key))
+			m_views.insert(robin_hood::pair<const uint64_t, VkImageView>(key, fakeImageView(key)));
+	}
+
+  private:
+	std::shared_mutex m_mutex;
+	robin_hood::unordered_map<uint64_t, VkImageView> m_views;
+};
+
+class DeclaredViewTable {
+  public:
+	DeclaredViewTable() {
+		for (uint64_t i = 0; i < viewCount; ++i) {
+			m_handles.push_back(m_table.acquire(fakeImageView(i)));
+		}
+	}
+
+	VkImageView lookup(uint32_t index) { return m_table.load(m_handles[index]); }
+
+	void churn(uint64_t iteration) {
+		if (m_churnHandles.size() < 64)
+			m_churnHandles.push_back(m_table.acquire(fakeImageView(viewCount + iteration)));
+		else {
+			m_table.release(m_churnHandles.back());
+			m_churnHandles.pop_back();
+		}
+	}
+
+  private:
+	ImageViewTable m_table;
+	std::vector<ImageViewHandle> m_handles;
+	// only touched by the churn thread
+	std::vector<ImageViewHandle> m_churnHandles;
+};
+
+// Returns millions of lookups per second over all reading threads.
+template <typename Views> double runImageViewBenchmark(uint32_t threadCount) {
+	Views views;
+	std::atomic<bool> running = true;
+
+	std::thread churnThread = std::thread([&views, &running]() {
+		uint64_t iteration = 0;
+		while (running.load(std::memory_order_relaxed)) {
+			views.churn(iteration++);
+			std::this_thread::yield();
+		}
+	});
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount);
+	std::vector<uintptr_t> checksums = std::vector<uintptr_t>(threadCount);
+	auto startTime = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < threadCount; ++i) {
+		threads.emplace_back([&views, &checksums, i]() {
+			uintptr_t checksum = 0;
+			for (size_t j = 0; j < lookupsPerThread; ++j) {
+				checksum += reinterpret_cast<uintptr_t>(views.lookup((j * 7 + i) % viewCount));
+			}
+			checksums[i] = checksum;
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	auto duration = std::chrono::steady_clock::now() - startTime;
+	running = false;
+	churnThread.join();
+
+	double seconds = std::chrono::duration<double>(duration).count();
+	return static_cast<double>(threadCount * lookupsPerThread) / std::max(seconds, 1e-9) / 1e6;
+}
+
+void runImageViewBenchmarks() {
+	std::cout << "ImageViews (" << lookupsPerThread << " lookups per thread, " << viewCount
+			  << " views, one thread creating and destroying views):\n";
+	for (uint32_t threadCount : { 1U, 2U, 4U, 8U }) {
+		double lockedThroughput = runImageViewBenchmark<LockedViewMap>(threadCount);
+		double declaredThroughput = runImageViewBenchmark<DeclaredViewTable>(threadCount);
+		std::cout << "  " << threadCount << (threadCount == 1 ? " thread: " : " threads:") << std::fixed
+				  << std::setprecision(2) << std::setw(10) << lockedThroughput << " Mops/s requested"
+				  << std::setw(10) << declaredThroughput << " Mops/s declared\n";
+	}
+}
@@ -0,0 +1,122 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <BenchmarkList.hpp>
+#include <MockDevice.hpp>
+#include <chrono>
+#include <graphics/helper/ErrorHelper.hpp>
+#include <graphics/util/GPUTransferManager.hpp>
+#include <iomanip>
+#include <iostream>
+#include <volk.h>
+
+using namespace vanadium::graphics;
+
+// deferred destructions are flushed once per simulated frame, like in the engine
+static constexpr size_t operationsPerFrame = 256;
+static constexpr uint32_t transferIterations = 64;
+
+void runGPUAllocatorBenchmarks(const AllocatorWorkload& workload) {
+	auto device = MockDevice(discreteMockDeviceConfig());
+	auto context = DeviceContext(device.deviceInfo());
+	GPUResourceAllocator allocator;
+	allocator.create(&context);
+
+	std::vector<BufferResourceHandle> buffers = std::vector<BufferResourceHandle>(workload.allocationCount, ~0U);
+	uint32_t frameIndex = 0;
+
+	// the mock device reports its own alignment, the workload's alignments are ignored
+	auto startTime = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < workload.operations.size(); ++i) {
+		auto& operation = workload.operations[i];
+		if (operation.type == AllocatorOperationType::Allocate) {
+			VkBufferCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+											  .size = operation.size,
+											  .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+											  .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+			buffers[operation.id] = allocator.createBuffer(createInfo, { .deviceLocal = true }, {}, false);
+		} else if (buffers[operation.id] != ~0U) {
+			allocator.destroyBuffer(buffers[operation.id]);
+			buffers[operation.id] = ~0U;
+		}
+
+		if ((i + 1) % operationsPerFrame == 0) {
+			frameIndex = (frameIndex + 1) % frameInFlightCount;
+			allocator.setFrameIndex(frameIndex);
+		}
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+	auto statistics = device.statistics();
+	std::cout << workload.name << " through GPUResourceAllocator on a mock device:\n";
+	std::cout << "  " << std::fixed << std::setprecision(2) << std::setw(8)
+			  << static_cast<double>(workload.operations.size()) / seconds / 1000000.0 << " Mops/s" << std::setw(8)
+			  << statistics.memoryAllocationCount << " memory allocations" << std::setw(10) << std::setprecision(1)
+			  << static_cast<double>(statistics.heapUsages[0]) / (1024.0 * 1024.0) << " MiB committed at the end\n";
+
+	allocator.destroy();
+	context.destroy();
+}
+
+// Returns MiB/s of a one-time upload of size bytes into device-local memory, including recording and submission.
+static double benchmarkUpload(VkDeviceSize size) {
+	auto device = MockDevice(discreteMockDeviceConfig());
+	auto context = DeviceContext(device.deviceInfo());
+	GPUResourceAllocator allocator;
+	allocator.create(&context);
+	GPUTransferManager transferManager;
+	transferManager.create(&context, &allocator);
+
+	VkBufferCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+									  .size = size,
+									  .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+									  .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+	BufferResourceHandle buffer = allocator.createBuffer(createInfo, { .deviceLocal = true }, {}, false);
+	std::vector<unsigned char> data = std::vector<unsigned char>(size, 0x5A);
+
+	auto startTime = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < transferIterations; ++i) {
+		uint32_t frameIndex = i % frameInFlightCount;
+		verifyResult(vkWaitForFences(context.device(), 1, &context.frameCompletionFence(frameIndex), VK_TRUE,
+									 UINT64_MAX));
+		verifyResult(vkResetFences(context.device(), 1, &context.frameCompletionFence(frameIndex)));
+		allocator.setFrameIndex(frameIndex);
+
+		transferManager.submitOneTimeTransfer(size, buffer, data.data(), VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+											  VK_ACCESS_SHADER_READ_BIT);
+		VkCommandBuffer commandBuffer = transferManager.recordTransfers(frameIndex);
+		VkSubmitInfo submitInfo = { .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+									.commandBufferCount = 1,
+									.pCommandBuffers = &commandBuffer };
+		verifyResult(
+			vkQueueSubmit(context.graphicsQueue(), 1, &submitInfo, context.frameCompletionFence(frameIndex)));
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+	transferManager.destroy();
+	allocator.destroy();
+	context.destroy();
+	return static_cast<double>(size) * transferIterations / seconds / (1024.0 * 1024.0);
+}
+
+void runGPUTransferBenchmarks() {
+	std::cout << "One-time uploads through GPUTransferManager on a mock device (" << transferIterations
+			  << " frames):\n";
+	for (VkDeviceSize size : { 64_KiB, 1_MiB, 16_MiB }) {
+		std::cout << "  " << std::setw(6) << size / 1_KiB << " KiB" << std::fixed << std::setprecision(1)
+				  << std::setw(10) << benchmarkUpload(size) << " MiB/s\n";
+	}
+}
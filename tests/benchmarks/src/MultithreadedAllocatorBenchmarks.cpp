@@ -0,0 +1,163 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <BenchmarkList.hpp>
+#include <chrono>
+#include <graphics/util/AllocationCache.hpp>
+#include <graphics/util/RangeAllocator.hpp>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+
+using namespace vanadium::graphics;
+
+static constexpr size_t operationsPerThread = 200000;
+// each thread frees its oldest allocation once it holds this many
+static constexpr size_t liveAllocationsPerThread = 256;
+static constexpr VkDeviceSize benchmarkRangeSize = 1024_MiB;
+static constexpr VkDeviceSize benchmarkAlignment = 256;
+
+// Stands in for the block list of a memory type, only accessible with its lock held.
+struct LockedRangeAllocator {
+	RangeAllocator allocator = RangeAllocator(benchmarkRangeSize);
+	std::mutex mutex;
+};
+
+// Every allocation takes the lock, like GPUResourceAllocator did before its allocation cache.
+class SingleLockAllocator {
+  public:
+	std::optional<RangeAllocationResult> allocate(VkDeviceSize size) {
+		auto lock = std::lock_guard<std::mutex>(m_rangeAllocator.mutex);
+		return m_rangeAllocator.allocator.allocate(benchmarkAlignment, size);
+	}
+	void free(const RangeAllocationResult& result) {
+		auto lock = std::lock_guard<std::mutex>(m_rangeAllocator.mutex);
+		m_rangeAllocator.allocator.free(result.allocationRange.offset, result.allocationRange.size);
+	}
+
+  private:
+	LockedRangeAllocator m_rangeAllocator;
+};
+
+// Mirrors GPUResourceAllocator::allocate: small ranges come from the cache, which is refilled in batches.
+class CachedAllocator {
+  public:
+	std::optional<RangeAllocationResult> allocate(VkDeviceSize size) {
+		uint32_t sizeClass = AllocationCache<RangeAllocationResult>::sizeClass(size, benchmarkAlignment);
+		if (sizeClass == ~0U) {
+			auto lock = std::lock_guard<std::mutex>(m_rangeAllocator.mutex);
+			return m_rangeAllocator.allocator.allocate(benchmarkAlignment, size);
+		}
+
+		auto cachedRange = m_cache.pop(sizeClass);
+		if (cachedRange.has_value())
+			return cachedRange;
+
+		VkDeviceSize classSize = AllocationCache<RangeAllocationResult>::sizeClassSize(sizeClass);
+		std::vector<RangeAllocationResult> ranges;
+		{
+			auto lock = std::lock_guard<std::mutex>(m_rangeAllocator.mutex);
+			for (size_t i = 0; i < AllocationCache<RangeAllocationResult>::refillCount(sizeClass); ++i) {
+				auto result = m_rangeAllocator.allocator.allocate(classSize, classSize);
+				if (!result.has_value())
+					break;
+				ranges.push_back(result.value());
+			}
+		}
+		if (ranges.empty())
+			return std::nullopt;
+
+		RangeAllocationResult result = ranges.back();
+		ranges.pop_back();
+		m_cache.refill(sizeClass, ranges);
+		return result;
+	}
+	void free(const RangeAllocationResult& result) {
+		uint32_t sizeClass = AllocationCache<RangeAllocationResult>::sizeClass(result.usableRange.size, 1);
+		if (result.usableRange.size == AllocationCache<RangeAllocationResult>::sizeClassSize(sizeClass) &&
+			m_cache.push(sizeClass, sizeClass, result))
+			return;
+		auto lock = std::lock_guard<std::mutex>(m_rangeAllocator.mutex);
+		m_rangeAllocator.allocator.free(result.allocationRange.offset, result.allocationRange.size);
+	}
+
+  private:
+	LockedRangeAllocator m_rangeAllocator;
+	AllocationCache<RangeAllocationResult> m_cache;
+};
+
+// Returns millions of operations per second over all threads.
+template <typename Allocator> double runMultithreadedBenchmark(uint32_t threadCount) {
+	Allocator allocator;
+
+	// sizes are generated up front so the timed loop only contains allocator calls
+	std::vector<std::vector<VkDeviceSize>> threadSizes = std::vector<std::vector<VkDeviceSize>>(threadCount);
+	for (uint32_t i = 0; i < threadCount; ++i) {
+		std::mt19937 generator(i + 1);
+		std::uniform_int_distribution<VkDeviceSize> distribution(64, 16_KiB);
+		threadSizes[i].reserve(operationsPerThread);
+		for (size_t j = 0; j < operationsPerThread; ++j) {
+			threadSizes[i].push_back(distribution(generator));
+		}
+	}
+
+	auto threadFunction = [&allocator](const std::vector<VkDeviceSize>& sizes) {
+		std::vector<RangeAllocationResult> liveAllocations;
+		liveAllocations.reserve(liveAllocationsPerThread);
+		size_t oldestIndex = 0;
+		for (auto size : sizes) {
+			if (liveAllocations.size() == liveAllocationsPerThread) {
+				allocator.free(liveAllocations[oldestIndex]);
+				auto result = allocator.allocate(size);
+				if (result.has_value())
+					liveAllocations[oldestIndex] = result.value();
+				oldestIndex = (oldestIndex + 1) % liveAllocationsPerThread;
+			} else {
+				auto result = allocator.allocate(size);
+				if (result.has_value())
+					liveAllocations.push_back(result.value());
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount);
+	auto startTime = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < threadCount; ++i) {
+		threads.emplace_back(threadFunction, std::cref(threadSizes[i]));
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	auto duration = std::chrono::steady_clock::now() - startTime;
+
+	double seconds = std::chrono::duration<double>(duration).count();
+	return static_cast<double>(threadCount * operationsPerThread) / std::max(seconds, 1e-9) / 1e6;
+}
+
+void runMultithreadedAllocatorBenchmarks() {
+	std::cout << "Multithreaded (" << operationsPerThread << " allocations per thread, " << liveAllocationsPerThread
+			  << " live allocations per thread):\n";
+	for (uint32_t threadCount : { 1U, 2U, 4U, 8U }) {
+		double singleLockThroughput = runMultithreadedBenchmark<SingleLockAllocator>(threadCount);
+		double cachedThroughput = runMultithreadedBenchmark<CachedAllocator>(threadCount);
+		std::cout << "  " << threadCount << (threadCount == 1 ? " thread: " : " threads:") << std::fixed
+				  << std::setprecision(2) << std::setw(10) << singleLockThroughput << " Mops/s single lock"
+				  << std::setw(10) << cachedThroughput << " Mops/s cached\n";
+	}
+}
@@ -0,0 +1,138 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <BenchmarkList.hpp>
+#include <chrono>
+#include <graphics/util/RangeAllocator.hpp>
+#include <iomanip>
+#include <iostream>
+
+using namespace vanadium::graphics;
+
+// Drives the sorted-vector functions allocateFromRanges, freeToRanges and mergeFreeAreas (called by freeToRanges).
+class SortedVectorRanges {
+  public:
+	SortedVectorRanges(VkDeviceSize size)
+		: m_gapsOffsetSorted({ { .offset = 0, .size = size } }), m_gapsSizeSorted({ { .offset = 0, .size = size } }) {}
+
+	std::optional<RangeAllocationResult> allocate(VkDeviceSize alignment, VkDeviceSize size) {
+		return allocateFromRanges(m_gapsOffsetSorted, m_gapsSizeSorted, alignment, size);
+	}
+	void free(VkDeviceSize offset, VkDeviceSize size) { freeToRanges(m_gapsOffsetSorted, m_gapsSizeSorted, offset, size); }
+
+	size_t freeRangeCount() const { return m_gapsOffsetSorted.size(); }
+	VkDeviceSize maxAllocatableSize() const { return m_gapsSizeSorted.empty() ? 0 : m_gapsSizeSorted.back().size; }
+
+  private:
+	std::vector<MemoryRange> m_gapsOffsetSorted;
+	std::vector<MemoryRange> m_gapsSizeSorted;
+};
+
+struct BenchmarkResult {
+	double nanosecondsPerOperation;
+	size_t peakFreeRangeCount;
+	// Fragmentation is 1 - largest free range / free bytes.
+	double averageFragmentation;
+	double peakFragmentation;
+	size_t failedAllocationCount;
+};
+
+// Applies one operation, returns false if the operation was skipped because its allocation had failed before.
+template <typename Allocator>
+bool applyOperation(Allocator& allocator, const AllocatorOperation& operation,
+					std::vector<std::optional<MemoryRange>>& allocationRanges) {
+	if (operation.type == AllocatorOperationType::Allocate) {
+		auto result = allocator.allocate(operation.alignment, operation.size);
+		if (result.has_value()) {
+			allocationRanges[operation.id] = result->allocationRange;
+		}
+	} else {
+		auto& range = allocationRanges[operation.id];
+		if (!range.has_value()) {
+			return false;
+		}
+		allocator.free(range->offset, range->size);
+		range = std::nullopt;
+	}
+	return true;
+}
+
+template <typename Allocator> BenchmarkResult runBenchmark(const AllocatorWorkload& workload) {
+	BenchmarkResult result = {};
+
+	std::vector<std::optional<MemoryRange>> allocationRanges = std::vector<std::optional<MemoryRange>>(
+		workload.allocationCount, std::nullopt);
+	// the timed pass only executes the operations, metrics are gathered in a second, identical pass
+	{
+		Allocator allocator = Allocator(workload.rangeSize);
+		size_t executedOperationCount = 0;
+
+		auto startTime = std::chrono::steady_clock::now();
+		for (auto& operation : workload.operations) {
+			executedOperationCount += applyOperation(allocator, operation, allocationRanges);
+		}
+		auto duration = std::chrono::steady_clock::now() - startTime;
+
+		result.nanosecondsPerOperation =
+			static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()) /
+			static_cast<double>(std::max(executedOperationCount, size_t(1)));
+	}
+
+	std::fill(allocationRanges.begin(), allocationRanges.end(), std::nullopt);
+	Allocator allocator = Allocator(workload.rangeSize);
+	VkDeviceSize freeBytes = workload.rangeSize;
+	double fragmentationSum = 0.0;
+
+	for (auto& operation : workload.operations) {
+		if (operation.type == AllocatorOperationType::Free && allocationRanges[operation.id].has_value()) {
+			freeBytes += allocationRanges[operation.id]->size;
+		}
+		applyOperation(allocator, operation, allocationRanges);
+		if (operation.type == AllocatorOperationType::Allocate) {
+			if (allocationRanges[operation.id].has_value()) {
+				freeBytes -= allocationRanges[operation.id]->size;
+			} else {
+				++result.failedAllocationCount;
+			}
+		}
+
+		double fragmentation = 0.0;
+		if (freeBytes) {
+			fragmentation = 1.0 - static_cast<double>(allocator.maxAllocatableSize()) / static_cast<double>(freeBytes);
+		}
+		fragmentationSum += fragmentation;
+		result.peakFragmentation = std::max(result.peakFragmentation, fragmentation);
+		result.peakFreeRangeCount = std::max(result.peakFreeRangeCount, allocator.freeRangeCount());
+	}
+	result.averageFragmentation = fragmentationSum / static_cast<double>(std::max(workload.operations.size(), size_t(1)));
+	return result;
+}
+
+void printResult(const std::string_view& allocatorName, const BenchmarkResult& result) {
+	std::cout << "  " << std::left << std::setw(14) << allocatorName << std::right << std::fixed
+			  << std::setprecision(1) << std::setw(10) << result.nanosecondsPerOperation << " ns/op"
+			  << std::setw(8) << result.peakFreeRangeCount << " peak free ranges" << std::setprecision(2)
+			  << std::setw(8) << result.averageFragmentation * 100.0 << "% avg fragmentation" << std::setw(8)
+			  << result.peakFragmentation * 100.0 << "% peak fragmentation" << std::setw(8)
+			  << result.failedAllocationCount << " failed allocations\n";
+}
+
+void runRangeAllocatorBenchmarks(const AllocatorWorkload& workload) {
+	std::cout << workload.name << " (" << workload.operations.size() << " operations, " << workload.rangeSize
+			  << " byte range):\n";
+	printResult("SortedVector", runBenchmark<SortedVectorRanges>(workload));
+	printResult("TLSF", runBenchmark<RangeAllocator>(workload));
+}
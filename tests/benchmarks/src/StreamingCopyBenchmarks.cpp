@@ -0,0 +1,74 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <BenchmarkList.hpp>
+#include <chrono>
+#include <cstring>
+#include <graphics/util/StreamingCopy.hpp>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace vanadium::graphics;
+
+// every size copies about this much per method, small sizes repeat often enough to be measurable
+static constexpr size_t bytesPerMeasurement = 512_MiB;
+
+template <typename CopyFunction>
+static double measureCopyThroughput(unsigned char* dst, const unsigned char* src, size_t size, CopyFunction copy) {
+	size_t iterations = std::max(bytesPerMeasurement / size, size_t(2));
+	// the first copy faults the pages in and isn't measured
+	copy(dst, src, size);
+
+	auto startTime = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < iterations; ++i) {
+		copy(dst, src, size);
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	return static_cast<double>(size) * iterations / seconds / (1024.0 * 1024.0 * 1024.0);
+}
+
+void runStreamingCopyBenchmarks() {
+	constexpr size_t maxSize = 256_MiB;
+	std::vector<unsigned char> src = std::vector<unsigned char>(maxSize, 0x5A);
+	std::vector<unsigned char> dst = std::vector<unsigned char>(maxSize);
+
+	StreamingCopyPool pool;
+	pool.create();
+
+	// The destination is ordinary cached memory here. Staging memory is write-combined, where streaming stores gain
+	// more because partial line writes are much more expensive there.
+	std::cout << "Copy throughput in GiB/s (" << pool.workerCount() << " copy threads):\n";
+	std::cout << "  " << std::setw(10) << "Size" << std::setw(14) << "std::memcpy" << std::setw(16) << "streamingCopy"
+			  << std::setw(19) << "StreamingCopyPool"
+			  << "\n";
+	for (size_t size = 64_KiB; size <= maxSize; size *= 4) {
+		double memcpyThroughput =
+			measureCopyThroughput(dst.data(), src.data(), size,
+								  [](void* dst, const void* src, size_t size) { std::memcpy(dst, src, size); });
+		double streamingThroughput = measureCopyThroughput(dst.data(), src.data(), size, streamingCopy);
+		double pooledThroughput =
+			measureCopyThroughput(dst.data(), src.data(), size,
+								  [&pool](void* dst, const void* src, size_t size) { pool.copy(dst, src, size); });
+
+		std::cout << "  " << std::setw(6) << (size >= 1_MiB ? size / 1_MiB : size / 1_KiB)
+				  << (size >= 1_MiB ? " MiB" : " KiB") << std::fixed << std::setprecision(2) << std::setw(14)
+				  << memcpyThroughput << std::setw(16) << streamingThroughput << std::setw(19) << pooledThroughput
+				  << "\n";
+	}
+
+	pool.destroy();
+}
@@ -0,0 +1,71 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <BenchmarkList.hpp>
+#include <iostream>
+
+int main(int argc, char** argv) {
+	if (argc > 1 && argv[1] == std::string_view("--trace")) {
+		if (argc == 2) {
+			std::cerr << "Enter at least one trace file.\n";
+			return EXIT_FAILURE;
+		}
+		for (int i = 2; i < argc; ++i) {
+			auto workload = loadTraceWorkload(argv[i]);
+			if (!workload.has_value()) {
+				std::cerr << "Trace " << argv[i] << " could not be loaded.\n";
+				return EXIT_FAILURE;
+			}
+			runRangeAllocatorBenchmarks(workload.value());
+			runBlockSizePolicyBenchmarks(workload.value());
+			runGPUAllocatorBenchmarks(workload.value());
+		}
+		return 0;
+	}
+
+	bool foundWorkload = false;
+	for (auto& workload : workloads) {
+		if (argc == 1 || argv[1] == workload.name) {
+			auto generatedWorkload = workload.generator();
+			runRangeAllocatorBenchmarks(generatedWorkload);
+			runBlockSizePolicyBenchmarks(generatedWorkload);
+			runGPUAllocatorBenchmarks(generatedWorkload);
+			foundWorkload = true;
+		}
+	}
+	if (argc == 1 || argv[1] == std::string_view("Multithreaded")) {
+		runMultithreadedAllocatorBenchmarks();
+		foundWorkload = true;
+	}
+	if (argc == 1 || argv[1] == std::string_view("ImageViews")) {
+		runImageViewBenchmarks();
+		foundWorkload = true;
+	}
+	if (argc == 1 || argv[1] == std::string_view("Transfers")) {
+		runGPUTransferBenchmarks();
+		foundWorkload = true;
+	}
+	// copies several GiB, so it only runs when asked for by name
+	if (argc > 1 && argv[1] == std::string_view("Copies")) {
+		runStreamingCopyBenchmarks();
+		foundWorkload = true;
+	}
+	if (!foundWorkload) {
+		std::cerr << "Workload not found.\n";
+		return EXIT_FAILURE;
+	}
+	return 0;
+}
@@ -0,0 +1,71 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <array>
+#include <string_view>
+
+using TestFunction = void (*)();
+
+struct FunctionEntry {
+	std::string_view name;
+	TestFunction function;
+};
+
+void testAllocatorMockBuffers();
+void testAllocatorMockImages();
+void testAllocatorMockOutOfMemory();
+void testAllocatorMockBudget();
+void testAllocatorMockPriorities();
+void testAllocatorMockSuballocatedBuffers();
+void testAllocatorMockMixedBlocks();
+void testAllocatorMockDefragmentationCached();
+void testAllocatorMockDefragmentationUncached();
+void testTransferManagerMockUpload();
+void testTransferManagerMockStagingRing();
+void testTransferManagerMockPartialUpdate();
+void testTransferManagerMockBatchedCopies();
+void testTransferManagerMockAsyncBatches();
+void testTransferManagerMockAsyncTimeline();
+void testTransferManagerMockDirectUpload();
+void testTransferManagerMockTransferBudget();
+void testTransferManagerMockOverlappingPriorities();
+void testTransferManagerMockReadback();
+void testFrameRingAllocatorMock();
+
+static constexpr std::array<FunctionEntry, 20> testFunctions = {
+	FunctionEntry{ "AllocatorMockBuffers", testAllocatorMockBuffers },
+	FunctionEntry{ "AllocatorMockImages", testAllocatorMockImages },
+	FunctionEntry{ "AllocatorMockOutOfMemory", testAllocatorMockOutOfMemory },
+	FunctionEntry{ "AllocatorMockBudget", testAllocatorMockBudget },
+	FunctionEntry{ "AllocatorMockPriorities", testAllocatorMockPriorities },
+	FunctionEntry{ "AllocatorMockSuballocatedBuffers", testAllocatorMockSuballocatedBuffers },
+	FunctionEntry{ "AllocatorMockMixedBlocks", testAllocatorMockMixedBlocks },
+	FunctionEntry{ "AllocatorMockDefragmentationCached", testAllocatorMockDefragmentationCached },
+	FunctionEntry{ "AllocatorMockDefragmentationUncached", testAllocatorMockDefragmentationUncached },
+	FunctionEntry{ "TransferManagerMockUpload", testTransferManagerMockUpload },
+	FunctionEntry{ "TransferManagerMockStagingRing", testTransferManagerMockStagingRing },
+	FunctionEntry{ "TransferManagerMockPartialUpdate", testTransferManagerMockPartialUpdate },
+	FunctionEntry{ "TransferManagerMockBatchedCopies", testTransferManagerMockBatchedCopies },
+	FunctionEntry{ "TransferManagerMockAsyncBatches", testTransferManagerMockAsyncBatches },
+	FunctionEntry{ "TransferManagerMockAsyncTimeline", testTransferManagerMockAsyncTimeline },
+	FunctionEntry{ "TransferManagerMockDirectUpload", testTransferManagerMockDirectUpload },
+	FunctionEntry{ "TransferManagerMockTransferBudget", testTransferManagerMockTransferBudget },
+	FunctionEntry{ "TransferManagerMockOverlappingPriorities", testTransferManagerMockOverlappingPriorities },
+	FunctionEntry{ "TransferManagerMockReadback", testTransferManagerMockReadback },
+	FunctionEntry{ "FrameRingAllocatorMock", testFrameRingAllocatorMock }
+};
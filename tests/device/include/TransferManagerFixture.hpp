@@ -0,0 +1,59 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <MockDevice.hpp>
+#include <TestUtilCommon.hpp>
+#include <graphics/helper/ErrorHelper.hpp>
+#include <graphics/util/GPUTransferManager.hpp>
+#include <volk.h>
+
+// Mock device with an allocator and a transfer manager on top of it.
+struct TransferManagerFixture {
+	MockDevice device;
+	vanadium::graphics::DeviceContext context;
+	vanadium::graphics::GPUResourceAllocator allocator;
+	vanadium::graphics::GPUTransferManager transferManager;
+
+	TransferManagerFixture(const MockDeviceConfig& config = discreteMockDeviceConfig())
+		: device(config), context(device.deviceInfo()) {
+		allocator.create(&context);
+		transferManager.create(&context, &allocator);
+	}
+
+	// Starts a frame and submits its transfers and readbacks like GraphicsSubsystem does. The previous submission of
+	// frameIndex has to be finished.
+	void submitFrame(uint32_t frameIndex) {
+		allocator.setFrameIndex(frameIndex);
+		verifyResult(vkResetFences(context.device(), 1, &context.frameCompletionFence(frameIndex)));
+		VkCommandBuffer commandBuffers[2] = { transferManager.recordTransfers(frameIndex),
+											  transferManager.recordReadbacks(frameIndex) };
+		VkSubmitInfo submitInfo = { .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+									.commandBufferCount = 2,
+									.pCommandBuffers = commandBuffers };
+		verifyResult(
+			vkQueueSubmit(context.graphicsQueue(), 1, &submitInfo, context.frameCompletionFence(frameIndex)));
+	}
+
+	// Destroys everything in reverse creation order and checks that no device memory is left behind.
+	void destroy() {
+		transferManager.destroy();
+		allocator.destroy();
+		context.destroy();
+		testEqual(uint32_t(0), device.statistics().memoryAllocationCount, "Memory was leaked!");
+	}
+};
@@ -0,0 +1,71 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <MockDevice.hpp>
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <cstring>
+#include <graphics/helper/ErrorHelper.hpp>
+#include <graphics/util/FrameRingAllocator.hpp>
+#include <volk.h>
+
+using namespace vanadium::graphics;
+
+void testFrameRingAllocatorMock() {
+	auto device = MockDevice(discreteMockDeviceConfig());
+	auto context = DeviceContext(device.deviceInfo());
+	GPUResourceAllocator allocator;
+	allocator.create(&context);
+	FrameRingAllocator ringAllocator;
+	ringAllocator.create(&context, &allocator, 64 * 1024);
+
+	ringAllocator.setFrameIndex(0);
+	auto first = ringAllocator.allocate(100, 4);
+	auto second = ringAllocator.allocate(256, 256);
+	testEqual(true, first.has_value() && second.has_value(), "Ring allocation failed!");
+	testEqual(VkDeviceSize(0), first->offset, "First allocation doesn't start the region!");
+	testEqual(VkDeviceSize(256), second->offset, "Allocation isn't aligned!");
+	testEqual(first->buffer, second->buffer, "Allocations use different buffers!");
+
+	uint32_t value = 0xDEADBEEF;
+	std::memcpy(second->data, &value, sizeof(value));
+	auto bufferData = static_cast<unsigned char*>(device.bufferData(second->buffer));
+	testEqual(0, std::memcmp(bufferData + second->offset, &value, sizeof(value)),
+			  "Written data isn't at the allocation's offset!");
+
+	testEqual(false, ringAllocator.allocate(ringAllocator.regionSize(), 1).has_value(), "Region was overcommitted!");
+
+	ringAllocator.setFrameIndex(1);
+	auto nextFrame = ringAllocator.allocate(16, 16);
+	testEqual(true, nextFrame.has_value(), "Ring allocation failed!");
+	testEqual(ringAllocator.regionSize(), nextFrame->offset, "Frame 1 doesn't use its own region!");
+
+	// frame 0 is still in flight, its allocations must survive
+	verifyResult(vkResetFences(context.device(), 1, &context.frameCompletionFence(0)));
+	ringAllocator.setFrameIndex(0);
+	testEqual(VkDeviceSize(512), ringAllocator.usedSize(), "Region of an in-flight frame was reset!");
+
+	VkSubmitInfo submitInfo = { .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO };
+	verifyResult(vkQueueSubmit(context.graphicsQueue(), 1, &submitInfo, context.frameCompletionFence(0)));
+	ringAllocator.setFrameIndex(0);
+	testEqual(VkDeviceSize(0), ringAllocator.usedSize(), "Region of a finished frame wasn't reset!");
+	ringAllocator.flush();
+
+	ringAllocator.destroy();
+	allocator.destroy();
+	context.destroy();
+	testEqual(uint32_t(0), device.statistics().memoryAllocationCount, "Memory was leaked!");
+}
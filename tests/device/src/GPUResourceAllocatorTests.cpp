@@ -0,0 +1,361 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <MockDevice.hpp>
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <TransferManagerFixture.hpp>
+#include <algorithm>
+#include <cstring>
+#include <graphics/util/GPUResourceAllocator.hpp>
+#include <numeric>
+#include <volk.h>
+
+using namespace vanadium::graphics;
+
+void testAllocatorMockBuffers() {
+	auto device = MockDevice(discreteMockDeviceConfig());
+	auto context = DeviceContext(device.deviceInfo());
+	GPUResourceAllocator allocator;
+	allocator.create(&context);
+
+	VkBufferCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+									  .size = 1024 * 1024,
+									  .usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+									  .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+	BufferResourceHandle hostBuffer = allocator.createBuffer(createInfo, { .hostVisible = true }, {}, true);
+	BufferResourceHandle deviceBuffer = allocator.createBuffer(createInfo, { .deviceLocal = true }, {}, false);
+
+	testEqual(true, allocator.bufferMemoryCapabilities(hostBuffer).hostVisible, "Buffer isn't host visible!");
+	testEqual(false, allocator.bufferMemoryCapabilities(deviceBuffer).hostVisible,
+			  "Buffer without host access was placed in host-visible memory!");
+	testEqual(uint32_t(2), device.statistics().bufferCount, "Unexpected VkBuffer count!");
+	testEqual(uint32_t(2), device.statistics().memoryAllocationCount, "Unexpected memory allocation count!");
+
+	std::memset(allocator.mappedBufferData(hostBuffer), 0x5A, createInfo.size);
+	auto deviceData = static_cast<unsigned char*>(device.bufferData(allocator.nativeBufferHandle(hostBuffer)));
+	testEqual(0x5A, static_cast<int>(deviceData[createInfo.size - 1]), "Mapped data didn't reach the buffer!");
+
+	// the small host-visible VRAM heap caps its blocks well below the default maximum block size
+	createInfo.size = 6 * 1024 * 1024;
+	BufferResourceHandle largeBuffer =
+		allocator.createBuffer(createInfo, { .deviceLocal = true, .hostVisible = true }, {}, true);
+	AllocatorStatistics statistics = allocator.statistics(true);
+	testEqual(true,
+			  std::any_of(statistics.blocks.begin(), statistics.blocks.end(),
+						  [](const auto& block) { return block.isDedicatedBlock && block.typeIndex == 3; }),
+			  "Buffer over the block size of its memory type isn't dedicated!");
+
+	allocator.destroyBufferImmediately(hostBuffer);
+	allocator.destroyBufferImmediately(deviceBuffer);
+	allocator.destroyBufferImmediately(largeBuffer);
+	testEqual(uint32_t(0), device.statistics().bufferCount, "Destroyed buffers are still alive!");
+
+	allocator.destroy();
+	context.destroy();
+	testEqual(uint32_t(0), device.statistics().memoryAllocationCount, "Memory was leaked!");
+	testEqual(VkDeviceSize(0), device.statistics().heapUsages[0], "Heap usage wasn't returned!");
+}
+
+void testAllocatorMockImages() {
+	auto device = MockDevice(discreteMockDeviceConfig());
+	auto context = DeviceContext(device.deviceInfo());
+	GPUResourceAllocator allocator;
+	allocator.create(&context);
+
+	VkImageCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+									 .imageType = VK_IMAGE_TYPE_2D,
+									 .format = VK_FORMAT_R8G8B8A8_UNORM,
+									 .extent = { .width = 256, .height = 256, .depth = 1 },
+									 .mipLevels = 1,
+									 .arrayLayers = 1,
+									 .samples = VK_SAMPLE_COUNT_1_BIT,
+									 .tiling = VK_IMAGE_TILING_OPTIMAL,
+									 .usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+									 .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+									 .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED };
+	ImageResourceHandle image = allocator.createImage(createInfo, { .deviceLocal = true }, {});
+	ImageResourceViewInfo viewInfo = { .viewType = VK_IMAGE_VIEW_TYPE_2D,
+									   .subresourceRange = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+															 .levelCount = 1,
+															 .layerCount = 1 } };
+	ImageViewHandle viewHandle = allocator.declareImageView(image, viewInfo);
+
+	testEqual(uint32_t(1), device.statistics().imageCount, "Unexpected VkImage count!");
+	testEqual(uint32_t(1), device.statistics().imageViewCount, "Unexpected VkImageView count!");
+	testEqual(true, allocator.imageView(viewHandle) == allocator.requestImageView(image, viewInfo),
+			  "Declared view differs from the requested one!");
+
+	allocator.destroyImageImmediately(image);
+	testEqual(uint32_t(0), device.statistics().imageCount, "Destroyed image is still alive!");
+	testEqual(uint32_t(0), device.statistics().imageViewCount, "Views of the destroyed image are still alive!");
+
+	allocator.destroy();
+	context.destroy();
+	testEqual(uint32_t(0), device.statistics().memoryAllocationCount, "Memory was leaked!");
+}
+
+void testAllocatorMockOutOfMemory() {
+	auto device = MockDevice(discreteMockDeviceConfig());
+	auto context = DeviceContext(device.deviceInfo());
+	GPUResourceAllocator allocator;
+	allocator.create(&context);
+
+	// the device-local heap fails, the small host-visible VRAM heap has to take over
+	device.failMemoryAllocations(1);
+	VkBufferCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+									  .size = 1024 * 1024,
+									  .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+									  .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+	BufferResourceHandle buffer = allocator.createBuffer(createInfo, { .deviceLocal = true }, {}, false);
+
+	testEqual(true, buffer != ~0U, "Allocation didn't fall back to another memory type!");
+	testEqual(true, allocator.bufferMemoryCapabilities(buffer).hostVisible,
+			  "Buffer wasn't placed in the fallback memory type!");
+	testEqual(VkDeviceSize(0), device.statistics().heapUsages[0], "The failed allocation was counted!");
+
+	allocator.destroy();
+	context.destroy();
+	testEqual(uint32_t(0), device.statistics().memoryAllocationCount, "Memory was leaked!");
+}
+
+void testAllocatorMockBudget() {
+	MockDeviceConfig config = discreteMockDeviceConfig();
+	config.heaps[0].size = 64 * 1024 * 1024;
+	config.heaps[2].size = 16 * 1024 * 1024;
+	auto device = MockDevice(config);
+	auto context = DeviceContext(device.deviceInfo());
+	GPUResourceAllocator allocator;
+	allocator.create(&context);
+	VkDeviceSize overrunSize = 0;
+	allocator.setOverBudgetCallback(
+		[](uint32_t, VkDeviceSize bytesOverBudget, void* userData) {
+			*static_cast<VkDeviceSize*>(userData) += bytesOverBudget;
+		},
+		&overrunSize);
+
+	// the device-local heap only has a budget of 80% of its size, afterwards the host-visible VRAM heap is used
+	VkBufferCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+									  .size = 1024 * 1024,
+									  .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+									  .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+	std::vector<BufferResourceHandle> buffers;
+	for (uint32_t i = 0; i < 56; ++i) {
+		buffers.push_back(allocator.createBuffer(createInfo, { .deviceLocal = true }, {}, false));
+	}
+	testLessEqual(device.statistics().heapUsages[0], VkDeviceSize(config.heaps[0].size * 0.8f),
+				  "Allocations went over the device-local heap's budget!");
+	testEqual(true, allocator.bufferMemoryCapabilities(buffers.back()).hostVisible,
+			  "Allocation over budget didn't fall back to another memory type!");
+	allocator.updateMemoryBudget();
+	testEqual(VkDeviceSize(0), overrunSize, "Over-budget callback was invoked while within budget!");
+
+	// with every heap over budget, allocations still succeed but are reported
+	for (uint32_t i = 0; i < 16; ++i) {
+		buffers.push_back(allocator.createBuffer(createInfo, { .deviceLocal = true }, {}, false));
+	}
+	allocator.updateMemoryBudget();
+	testLess(VkDeviceSize(0), overrunSize, "Over-budget callback wasn't invoked!");
+
+	for (auto& buffer : buffers) {
+		allocator.destroyBufferImmediately(buffer);
+	}
+	allocator.destroy();
+	context.destroy();
+	testEqual(uint32_t(0), device.statistics().memoryAllocationCount, "Memory was leaked!");
+}
+
+void testAllocatorMockPriorities() {
+	VkBufferCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+									  .size = 1024 * 1024,
+									  .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+									  .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+	// blocks only hold allocations of one priority, unless the driver can't make use of priorities
+	for (bool hasMemoryPriority : { true, false }) {
+		MockDeviceConfig config = discreteMockDeviceConfig();
+		config.capabilities.memoryPriority = hasMemoryPriority;
+		auto device = MockDevice(config);
+		auto context = DeviceContext(device.deviceInfo());
+		GPUResourceAllocator allocator;
+		allocator.create(&context);
+
+		BufferResourceHandle lowBuffer =
+			allocator.createBuffer(createInfo, { .deviceLocal = true }, {}, false, MemoryPriority::Low);
+		BufferResourceHandle highBuffer =
+			allocator.createBuffer(createInfo, { .deviceLocal = true }, {}, false, MemoryPriority::High);
+		BufferResourceHandle otherHighBuffer =
+			allocator.createBuffer(createInfo, { .deviceLocal = true }, {}, false, MemoryPriority::High);
+		testEqual(true, allocator.nativeMemoryHandle(highBuffer) == allocator.nativeMemoryHandle(otherHighBuffer),
+				  "Buffers of the same priority don't share a block!");
+		testEqual(hasMemoryPriority,
+				  allocator.nativeMemoryHandle(lowBuffer) != allocator.nativeMemoryHandle(highBuffer),
+				  "Unexpected block sharing between priorities!");
+
+		allocator.destroyBufferImmediately(lowBuffer);
+		allocator.destroyBufferImmediately(highBuffer);
+		allocator.destroyBufferImmediately(otherHighBuffer);
+		allocator.destroy();
+		context.destroy();
+		testEqual(uint32_t(0), device.statistics().memoryAllocationCount, "Memory was leaked!");
+	}
+}
+
+void testAllocatorMockSuballocatedBuffers() {
+	auto device = MockDevice(discreteMockDeviceConfig());
+	auto context = DeviceContext(device.deviceInfo());
+	GPUResourceAllocator allocator;
+	allocator.create(&context);
+
+	constexpr VkDeviceSize bufferSize = 4096;
+	std::vector<BufferResourceHandle> buffers;
+	for (uint32_t i = 0; i < 8; ++i) {
+		buffers.push_back(allocator.createSuballocatedBuffer(bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+															 { .hostVisible = true }, {}, true));
+		std::memset(allocator.mappedBufferData(buffers.back()), i + 1, bufferSize);
+	}
+	testEqual(uint32_t(1), device.statistics().bufferCount, "Suballocated buffers created their own VkBuffers!");
+
+	std::vector<BufferView> views;
+	for (uint32_t i = 0; i < buffers.size(); ++i) {
+		BufferView view = allocator.bufferView(buffers[i]);
+		testEqual(true, view.buffer == allocator.nativeBufferHandle(buffers[0]),
+				  "Suballocated buffers don't share the block's VkBuffer!");
+		testEqual(bufferSize, view.size, "Unexpected view size!");
+		auto deviceData = static_cast<unsigned char*>(device.bufferData(view.buffer)) + view.offset;
+		testEqual(static_cast<int>(i + 1), static_cast<int>(deviceData[bufferSize - 1]),
+				  "Mapped data didn't reach the buffer range!");
+		views.push_back(view);
+	}
+	std::sort(views.begin(), views.end(), [](const auto& one, const auto& other) { return one.offset < other.offset; });
+	for (size_t i = 1; i < views.size(); ++i) {
+		testLessEqual(views[i - 1].offset + views[i - 1].size, views[i].offset, "Buffer ranges overlap!");
+	}
+
+	for (auto& buffer : buffers) {
+		allocator.destroyBufferImmediately(buffer);
+	}
+	allocator.destroy();
+	context.destroy();
+	testEqual(uint32_t(0), device.statistics().bufferCount, "The block's VkBuffer was leaked!");
+	testEqual(uint32_t(0), device.statistics().memoryAllocationCount, "Memory was leaked!");
+}
+
+void testAllocatorMockMixedBlocks() {
+	auto device = MockDevice(discreteMockDeviceConfig());
+	auto context = DeviceContext(device.deviceInfo());
+	GPUResourceAllocator allocator;
+	allocator.create(&context);
+	allocator.setMixedBlocks(true);
+
+	VkBufferCreateInfo bufferCreateInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+											.size = 1024 * 1024,
+											.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+											.sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+	VkImageCreateInfo imageCreateInfo = { .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+										  .imageType = VK_IMAGE_TYPE_2D,
+										  .format = VK_FORMAT_R8G8B8A8_UNORM,
+										  .extent = { .width = 256, .height = 256, .depth = 1 },
+										  .mipLevels = 1,
+										  .arrayLayers = 1,
+										  .samples = VK_SAMPLE_COUNT_1_BIT,
+										  .tiling = VK_IMAGE_TILING_OPTIMAL,
+										  .usage = VK_IMAGE_USAGE_SAMPLED_BIT,
+										  .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+										  .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED };
+	BufferResourceHandle buffer = allocator.createBuffer(bufferCreateInfo, { .deviceLocal = true }, {}, false);
+	ImageResourceHandle image = allocator.createImage(imageCreateInfo, { .deviceLocal = true }, {});
+	BufferResourceHandle otherBuffer = allocator.createBuffer(bufferCreateInfo, { .deviceLocal = true }, {}, false);
+
+	AllocatorStatistics statistics = allocator.statistics(true);
+	testEqual(uint32_t(1), device.statistics().memoryAllocationCount, "Image didn't share the buffers' block!");
+	testEqual(false,
+			  std::any_of(statistics.blocks.begin(), statistics.blocks.end(),
+						  [](const auto& block) { return block.isImageBlock; }),
+			  "Image block was created with mixed blocks enabled!");
+	// the image is padded to bufferImageGranularity on both sides
+	VkDeviceSize imageSize = 256 * 256 * 4;
+	testLessEqual(2 * bufferCreateInfo.size + imageSize, statistics.blocks[0].usedSize, "Resources overlap!");
+
+	allocator.destroyBufferImmediately(buffer);
+	allocator.destroyImageImmediately(image);
+	allocator.destroyBufferImmediately(otherBuffer);
+	testEqual(VkDeviceSize(0), allocator.statistics(true).blocks[0].usedSize, "Block isn't empty after freeing!");
+	allocator.destroy();
+	context.destroy();
+	testEqual(uint32_t(0), device.statistics().memoryAllocationCount, "Memory was leaked!");
+}
+
+// Fills three 1 MiB blocks with movable buffers, then frees a few so that two blocks are enough.
+void testDefragmentation(VkDeviceSize bufferSize) {
+	auto fixture = TransferManagerFixture();
+	auto& [device, context, allocator, transferManager] = fixture;
+	// empty blocks are released right away
+	allocator.setBlockSizePolicy({ .initialBlockSize = 1024 * 1024,
+								   .maxBlockSize = 1024 * 1024,
+								   .pressureRetention = 0.0f,
+								   .minRetainedSize = 0 });
+	auto deviceLocalBlockCount = [&allocator]() {
+		AllocatorStatistics statistics = allocator.statistics(true);
+		return std::count_if(statistics.blocks.begin(), statistics.blocks.end(), [](const auto& block) {
+			return block.typeIndex == 0 && !block.isImageBlock && !block.isCustomBlock && !block.isDedicatedBlock;
+		});
+	};
+
+	VkBufferCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+									  .size = bufferSize,
+									  .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+											   VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+									  .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+	uint32_t buffersPerBlock = static_cast<uint32_t>(1024 * 1024 / ((bufferSize + 255) / 256 * 256));
+	std::vector<BufferResourceHandle> buffers;
+	std::vector<std::vector<unsigned char>> data;
+	for (uint32_t i = 0; i < 2 * buffersPerBlock + 1; ++i) {
+		buffers.push_back(allocator.createBuffer(createInfo, { .deviceLocal = true }, {}, false));
+		allocator.setBufferMovable(buffers.back(), nullptr, nullptr);
+		data.push_back(std::vector<unsigned char>(bufferSize));
+		std::iota(data.back().begin(), data.back().end(), static_cast<unsigned char>(i));
+		transferManager.submitOneTimeTransfer(bufferSize, buffers.back(), data.back().data(),
+											  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+	}
+	uint32_t frameIndex = 0;
+	fixture.submitFrame(frameIndex);
+	testEqual(3L, deviceLocalBlockCount(), "Buffers don't fill three blocks!");
+
+	for (uint32_t i = 0; i < 4; ++i) {
+		allocator.destroyBuffer(buffers[i]);
+	}
+	buffers.erase(buffers.begin(), buffers.begin() + 4);
+	data.erase(data.begin(), data.begin() + 4);
+	for (uint32_t i = 0; i < 30; ++i) {
+		++frameIndex %= frameInFlightCount;
+		fixture.submitFrame(frameIndex);
+	}
+	testEqual(2L, deviceLocalBlockCount(), "Defragmentation didn't release a block!");
+	for (size_t i = 0; i < buffers.size(); ++i) {
+		const void* bufferData = device.bufferData(allocator.nativeBufferHandle(buffers[i]));
+		testEqual(0, std::memcmp(bufferData, data[i].data(), bufferSize), "Moved buffer data doesn't match!");
+	}
+
+	for (auto& buffer : buffers) {
+		allocator.destroyBuffer(buffer);
+	}
+	fixture.destroy();
+}
+
+// small buffers are served by the allocation cache, larger ones directly by the blocks
+void testAllocatorMockDefragmentationCached() { testDefragmentation(32 * 1024); }
+
+void testAllocatorMockDefragmentationUncached() { testDefragmentation(200000); }
@@ -0,0 +1,699 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <MockDevice.hpp>
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <TransferManagerFixture.hpp>
+#include <cstring>
+#include <graphics/helper/ErrorHelper.hpp>
+#include <graphics/util/GPUTransferManager.hpp>
+#include <numeric>
+#include <volk.h>
+
+using namespace vanadium::graphics;
+
+void testTransferManagerMockUpload() {
+	auto fixture = TransferManagerFixture();
+	auto& [device, context, allocator, transferManager] = fixture;
+
+	constexpr VkDeviceSize size = 64 * 1024;
+	VkBufferCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+									  .size = size,
+									  .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+									  .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+	BufferResourceHandle buffer = allocator.createBuffer(createInfo, { .deviceLocal = true }, {}, false);
+
+	std::vector<uint32_t> data = std::vector<uint32_t>(size / sizeof(uint32_t));
+	std::iota(data.begin(), data.end(), 0);
+	transferManager.submitOneTimeTransfer(size, buffer, data.data(), VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+										  VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+
+	fixture.submitFrame(0);
+
+	testEqual(VK_SUCCESS, vkGetFenceStatus(context.device(), context.frameCompletionFence(0)),
+			  "Frame fence wasn't signaled!");
+	testEqual(uint64_t(size), device.statistics().copiedBytes, "Unexpected amount of copied bytes!");
+	testEqual(0, std::memcmp(device.bufferData(allocator.nativeBufferHandle(buffer)), data.data(), size),
+			  "Uploaded data doesn't match!");
+
+	fixture.destroy();
+}
+
+void testTransferManagerMockStagingRing() {
+	auto fixture = TransferManagerFixture();
+	auto& [device, context, allocator, transferManager] = fixture;
+
+	constexpr VkDeviceSize largeSize = 20 * 1024 * 1024;
+	VkBufferCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+									  .size = largeSize,
+									  .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+									  .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+	BufferResourceHandle buffer = allocator.createBuffer(createInfo, { .deviceLocal = true }, {}, false);
+
+	std::vector<uint32_t> data = std::vector<uint32_t>(largeSize / sizeof(uint32_t));
+	std::iota(data.begin(), data.end(), 0);
+
+	// small uploads are served by the ring without allocating memory
+	uint32_t frameIndex = 0;
+	transferManager.submitOneTimeTransfer(4096, buffer, data.data(), VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+										  VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+	fixture.submitFrame(frameIndex);
+	uint32_t allocationCount = device.statistics().memoryAllocationCount;
+	VkDeviceSize initialRingSize = transferManager.stagingRingSize();
+	for (uint32_t i = 0; i < 64; ++i) {
+		++frameIndex %= frameInFlightCount;
+		transferManager.submitOneTimeTransfer(1024 * 1024, buffer, data.data(), VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+											  VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+		fixture.submitFrame(frameIndex);
+	}
+	testEqual(allocationCount, device.statistics().memoryAllocationCount, "Staging memory was reallocated!");
+
+	// uploads larger than the ring overflow, the ring only grows once that happened for several frames
+	for (uint32_t i = 0; i < 4; ++i) {
+		testEqual(initialRingSize, transferManager.stagingRingSize(), "Staging ring grew too early!");
+		++frameIndex %= frameInFlightCount;
+		transferManager.submitOneTimeTransfer(largeSize, buffer, data.data(), VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+											  VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+		fixture.submitFrame(frameIndex);
+		testEqual(0, std::memcmp(device.bufferData(allocator.nativeBufferHandle(buffer)), data.data(), largeSize),
+				  "Uploaded data doesn't match!");
+	}
+	VkDeviceSize grownRingSize = transferManager.stagingRingSize();
+	testLess(initialRingSize, grownRingSize, "Staging ring didn't grow!");
+
+	allocationCount = device.statistics().memoryAllocationCount;
+	++frameIndex %= frameInFlightCount;
+	transferManager.submitOneTimeTransfer(largeSize, buffer, data.data(), VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+										  VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+	fixture.submitFrame(frameIndex);
+	testLessEqual(device.statistics().memoryAllocationCount, allocationCount, "Grown ring still overflows!");
+
+	// shrinks back after staying mostly unused for a while
+	for (uint32_t i = 0; i < 1024 && transferManager.stagingRingSize() == grownRingSize; ++i) {
+		++frameIndex %= frameInFlightCount;
+		fixture.submitFrame(frameIndex);
+	}
+	testLess(transferManager.stagingRingSize(), grownRingSize, "Staging ring didn't shrink!");
+
+	fixture.destroy();
+}
+
+void testTransferManagerMockPartialUpdate() {
+	// without host-visible VRAM, continuous transfers go through staging buffers
+	MockDeviceConfig config = discreteMockDeviceConfig();
+	config.memoryTypes.pop_back();
+	auto fixture = TransferManagerFixture(config);
+	auto& [device, context, allocator, transferManager] = fixture;
+
+	constexpr VkDeviceSize size = 64 * 1024;
+	GPUTransferHandle transfer = transferManager.createTransfer(size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+																VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+																VK_ACCESS_SHADER_READ_BIT);
+	auto dstData = static_cast<unsigned char*>(
+		device.bufferData(allocator.nativeBufferHandle(transferManager.dstBufferHandle(transfer))));
+
+	std::vector<uint32_t> data = std::vector<uint32_t>(size / sizeof(uint32_t));
+	std::iota(data.begin(), data.end(), 0);
+	for (uint32_t i = 0; i < frameInFlightCount; ++i) {
+		transferManager.flushTransferData(transfer, i, data.data(), size);
+		fixture.submitFrame(i);
+	}
+	testEqual(uint64_t(size * frameInFlightCount), device.statistics().copiedBytes,
+			  "Initial uploads didn't copy everything!");
+
+	// up-to-date copies don't upload anything
+	transferManager.flushTransferData(transfer, 0, data.data(), size);
+	fixture.submitFrame(0);
+	uint64_t copiedBytes = device.statistics().copiedBytes;
+	testEqual(uint64_t(size * frameInFlightCount), copiedBytes, "Unchanged data was uploaded!");
+
+	std::vector<uint32_t> previousData = data;
+	data[300] = 0xDEADBEEF;
+	data[301] = 0xDEADBEEF;
+	transferManager.invalidateChangedTransferData(transfer, previousData.data(), size, data.data(), size, 64);
+	for (uint32_t i = 0; i < frameInFlightCount; ++i) {
+		transferManager.flushTransferData(transfer, i, data.data(), size);
+		fixture.submitFrame(i);
+		testEqual(copiedBytes + 64 * (i + 1), device.statistics().copiedBytes, "Changed range wasn't uploaded alone!");
+		testEqual(0, std::memcmp(dstData, data.data(), size), "Uploaded data doesn't match!");
+	}
+	copiedBytes = device.statistics().copiedBytes;
+
+	uint32_t value = 42;
+	transferManager.updateTransferData(transfer, 1, &value, 1000 * sizeof(uint32_t), sizeof(uint32_t));
+	fixture.submitFrame(1);
+	testEqual(copiedBytes + sizeof(uint32_t), device.statistics().copiedBytes, "Partial update copied too much!");
+	testEqual(value, reinterpret_cast<uint32_t*>(dstData)[1000], "Partial update wasn't uploaded!");
+	fixture.submitFrame(1);
+	testEqual(copiedBytes + sizeof(uint32_t), device.statistics().copiedBytes, "Partial update was uploaded twice!");
+
+	transferManager.destroyTransfer(transfer);
+	fixture.destroy();
+}
+
+void testTransferManagerMockBatchedCopies() {
+	// no host-visible VRAM and only non-coherent host memory, so every upload is staged and flushed
+	MockDeviceConfig config = discreteMockDeviceConfig();
+	config.memoryTypes = { { .properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .heapIndex = 0 },
+						   { .properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+							 .heapIndex = 1 } };
+	auto fixture = TransferManagerFixture(config);
+	auto& [device, context, allocator, transferManager] = fixture;
+
+	constexpr uint32_t transferCount = 64;
+	constexpr VkDeviceSize size = 256;
+	std::vector<uint32_t> data = std::vector<uint32_t>(transferCount * size / sizeof(uint32_t));
+	std::iota(data.begin(), data.end(), 0);
+	auto transferData = [&data](uint32_t index) { return data.data() + index * size / sizeof(uint32_t); };
+
+	std::vector<GPUTransferHandle> transfers;
+	std::vector<BufferResourceHandle> buffers;
+	for (uint32_t i = 0; i < transferCount; ++i) {
+		transfers.push_back(transferManager.createTransfer(size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+														   VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+														   VK_ACCESS_SHADER_READ_BIT));
+		// suballocated buffers share the VkBuffer of their block, their uploads become regions of one copy
+		buffers.push_back(allocator.createSuballocatedBuffer(
+			size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, { .deviceLocal = true }, {},
+			false));
+	}
+	for (uint32_t i = 0; i < transferCount; ++i) {
+		for (uint32_t j = 0; j < frameInFlightCount; ++j) {
+			transferManager.updateTransferData(transfers[i], j, transferData(i));
+		}
+		transferManager.submitOneTimeTransfer(size, buffers[i], transferData(i), VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+											  VK_ACCESS_SHADER_READ_BIT);
+	}
+	testEqual(uint64_t(0), device.statistics().flushCallCount, "Memory was flushed before recording!");
+
+	fixture.submitFrame(0);
+
+	MockDeviceStatistics statistics = device.statistics();
+	testEqual(uint64_t(1), statistics.flushCallCount, "Flushes weren't combined into one call!");
+	// the staging areas of the continuous transfers and the staging ring are contiguous
+	testLessEqual(statistics.flushedRangeCount, uint64_t(2), "Adjacent flushed ranges weren't merged!");
+	testEqual(uint64_t(transferCount + 1), statistics.bufferCopyCommandCount,
+			  "Copies into the same buffer weren't batched!");
+	testEqual(uint64_t(2 * transferCount * size), statistics.copiedBytes, "Unexpected amount of copied bytes!");
+
+	for (uint32_t i = 0; i < transferCount; ++i) {
+		VkBuffer transferBuffer = allocator.nativeBufferHandle(transferManager.dstBufferHandle(transfers[i]));
+		testEqual(0, std::memcmp(device.bufferData(transferBuffer), transferData(i), size),
+				  "Continuous transfer data doesn't match!");
+		BufferView view = allocator.bufferView(buffers[i]);
+		testEqual(0,
+				  std::memcmp(static_cast<unsigned char*>(device.bufferData(view.buffer)) + view.offset,
+							  transferData(i), size),
+				  "One-time transfer data doesn't match!");
+	}
+
+	// overlapping uploads are ordered by a barrier, the one submitted last wins
+	transferManager.submitOneTimeTransfer(size, buffers[0], transferData(1), VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+										  VK_ACCESS_SHADER_READ_BIT);
+	transferManager.submitOneTimeTransfer(size, buffers[0], transferData(2), VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+										  VK_ACCESS_SHADER_READ_BIT);
+	fixture.submitFrame(1);
+	BufferView view = allocator.bufferView(buffers[0]);
+	testEqual(0,
+			  std::memcmp(static_cast<unsigned char*>(device.bufferData(view.buffer)) + view.offset, transferData(2),
+						  size),
+			  "Overlapping uploads were reordered!");
+
+	for (uint32_t i = 0; i < transferCount; ++i) {
+		transferManager.destroyTransfer(transfers[i]);
+		allocator.destroyBuffer(buffers[i]);
+	}
+	fixture.destroy();
+}
+
+void testTransferManagerMockAsyncBatches() {
+	// batches are tracked with fences without timeline semaphores
+	MockDeviceConfig config = discreteMockDeviceConfig();
+	config.capabilities.timelineSemaphore = false;
+	config.deferSubmissions = true;
+	auto fixture = TransferManagerFixture(config);
+	auto& [device, context, allocator, transferManager] = fixture;
+
+	constexpr uint32_t transferCount = 10;
+	constexpr VkDeviceSize size = 64 * 1024;
+	VkBufferCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+									  .size = transferCount * size,
+									  .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+									  .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+	BufferResourceHandle buffer = allocator.createBuffer(createInfo, { .deviceLocal = true }, {}, false);
+
+	std::vector<uint32_t> data = std::vector<uint32_t>(transferCount * size / sizeof(uint32_t));
+	std::iota(data.begin(), data.end(), 0);
+
+	// four transfers fit into a batch, so the ten transfers need three submissions
+	transferManager.setAsyncTransferBatchSizeLimit(4 * size);
+	std::vector<AsyncBufferTransferHandle> transfers;
+	for (uint32_t i = 0; i < transferCount; ++i) {
+		transfers.push_back(transferManager.createAsyncBufferTransfer(
+			reinterpret_cast<unsigned char*>(data.data()) + i * size, size, buffer, i * size,
+			VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT));
+	}
+	testEqual(false, transferManager.isBufferTransferFinished(transfers[0]), "Unsubmitted transfer is finished!");
+
+	uint64_t submitCount = device.statistics().submitCount;
+	fixture.submitFrame(0);
+	testEqual(submitCount + 4, device.statistics().submitCount, "Async transfers weren't split into three batches!");
+	testEqual(false, transferManager.isBufferTransferFinished(transfers[transferCount - 1]),
+			  "Transfer finished before its batch was executed!");
+
+	device.completeSubmissions();
+	testEqual(transferManager.bufferTransferValue(transfers.back()), transferManager.completedTransferValue(),
+			  "Completed value doesn't match the last batch!");
+	for (auto& transfer : transfers) {
+		testEqual(true, transferManager.isBufferTransferFinished(transfer), "Executed transfer isn't finished!");
+		transferManager.finalizeAsyncBufferTransfer(transfer);
+	}
+	testEqual(0, std::memcmp(device.bufferData(allocator.nativeBufferHandle(buffer)), data.data(), data.size() * 4),
+			  "Uploaded data doesn't match!");
+
+	// transfers larger than the limit get a batch each
+	transfers.clear();
+	for (uint32_t i = 0; i < 3; ++i) {
+		transfers.push_back(transferManager.createAsyncBufferTransfer(data.data(), size, buffer, 0,
+																	  VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+																	  VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT));
+	}
+	transferManager.setAsyncTransferBatchSizeLimit(1);
+	submitCount = device.statistics().submitCount;
+	fixture.submitFrame(1);
+	testEqual(submitCount + 4, device.statistics().submitCount, "Transfers over the limit weren't submitted alone!");
+	device.completeSubmissions();
+	transferManager.completedTransferValue();
+	for (auto& transfer : transfers) {
+		testEqual(true, transferManager.isBufferTransferFinished(transfer), "Executed transfer isn't finished!");
+		transferManager.finalizeAsyncBufferTransfer(transfer);
+	}
+	fixture.submitFrame(2);
+	device.completeSubmissions();
+
+	allocator.destroyBuffer(buffer);
+	fixture.destroy();
+}
+
+void testTransferManagerMockAsyncTimeline() {
+	MockDeviceConfig config = discreteMockDeviceConfig();
+	config.deferSubmissions = true;
+	auto fixture = TransferManagerFixture(config);
+	auto& [device, context, allocator, transferManager] = fixture;
+	testEqual(true, transferManager.asyncTransferSemaphore() != VK_NULL_HANDLE, "No transfer semaphore was created!");
+
+	// waits on the transfer semaphore like GraphicsSubsystem does
+	auto submitFrame = [&](uint32_t frameIndex) {
+		verifyResult(vkResetFences(context.device(), 1, &context.frameCompletionFence(frameIndex)));
+		VkCommandBuffer commandBuffer = transferManager.recordTransfers(frameIndex);
+		VkSemaphore semaphore = transferManager.asyncTransferSemaphore();
+		uint64_t waitValue = transferManager.transferWaitValue();
+		VkPipelineStageFlags waitStageFlags = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+		VkTimelineSemaphoreSubmitInfoKHR timelineSubmitInfo = {
+			.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR,
+			.waitSemaphoreValueCount = 1,
+			.pWaitSemaphoreValues = &waitValue
+		};
+		VkSubmitInfo submitInfo = { .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+									.pNext = waitValue ? &timelineSubmitInfo : nullptr,
+									.waitSemaphoreCount = waitValue ? 1U : 0U,
+									.pWaitSemaphores = &semaphore,
+									.pWaitDstStageMask = &waitStageFlags,
+									.commandBufferCount = 1,
+									.pCommandBuffers = &commandBuffer };
+		verifyResult(
+			vkQueueSubmit(context.graphicsQueue(), 1, &submitInfo, context.frameCompletionFence(frameIndex)));
+	};
+
+	constexpr uint32_t transferCount = 8;
+	constexpr VkDeviceSize size = 64 * 1024;
+	VkBufferCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+									  .size = transferCount * size,
+									  .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+									  .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+	BufferResourceHandle buffer = allocator.createBuffer(createInfo, { .deviceLocal = true }, {}, false);
+
+	std::vector<uint32_t> data = std::vector<uint32_t>(transferCount * size / sizeof(uint32_t));
+	std::iota(data.begin(), data.end(), 0);
+
+	transferManager.setAsyncTransferBatchSizeLimit(2 * size);
+	std::vector<AsyncBufferTransferHandle> transfers;
+	for (uint32_t i = 0; i < transferCount; ++i) {
+		transfers.push_back(transferManager.createAsyncBufferTransfer(
+			reinterpret_cast<unsigned char*>(data.data()) + i * size, size, buffer, i * size,
+			VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT));
+	}
+	testEqual(uint64_t(0), transferManager.bufferTransferValue(transfers[0]), "Unsubmitted transfer has a value!");
+	submitFrame(0);
+	testEqual(uint64_t(0), transferManager.completedTransferValue(), "Pending batches are completed!");
+	uint64_t lastValue = transferManager.bufferTransferValue(transfers.back());
+	testEqual(transferManager.bufferTransferValue(transfers[0]) + 3, lastValue, "Batch values aren't consecutive!");
+
+	// the semaphore lets the transfers be used before the CPU has seen them finish
+	for (auto& transfer : transfers) {
+		transferManager.finalizeAsyncBufferTransfer(transfer);
+	}
+	submitFrame(1);
+	testEqual(lastValue, transferManager.transferWaitValue(),
+			  "Transfer command buffer doesn't wait for the finalized transfers!");
+
+	device.completeSubmissions();
+	testEqual(lastValue, transferManager.completedTransferValue(), "Completed value doesn't match the last batch!");
+	testEqual(0, std::memcmp(device.bufferData(allocator.nativeBufferHandle(buffer)), data.data(), data.size() * 4),
+			  "Uploaded data doesn't match!");
+
+	// nothing left to wait for
+	submitFrame(2);
+	testEqual(uint64_t(0), transferManager.transferWaitValue(), "Frame waits without finalized transfers!");
+	device.completeSubmissions();
+
+	allocator.destroyBuffer(buffer);
+	fixture.destroy();
+}
+
+void testTransferManagerMockDirectUpload() {
+	auto fixture = TransferManagerFixture();
+	auto& [device, context, allocator, transferManager] = fixture;
+
+	constexpr VkDeviceSize size = 1024 * 1024;
+	VkBufferCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+									  .size = size,
+									  .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+									  .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+	BufferResourceHandle buffer = allocator.createBuffer(createInfo, { .deviceLocal = true }, {}, false);
+	BufferResourceHandle otherBuffer = allocator.createBuffer(createInfo, { .deviceLocal = true }, {}, false);
+
+	std::vector<uint32_t> data = std::vector<uint32_t>(size / sizeof(uint32_t));
+	std::iota(data.begin(), data.end(), 0);
+	std::vector<uint32_t> otherData = std::vector<uint32_t>(size / sizeof(uint32_t), 0xDEADBEEF);
+
+	// the open upload stays untouched while later uploads go around the ring multiple times
+	GPUUpload upload = transferManager.beginUpload(size);
+	std::memcpy(upload.data, data.data(), size / 2);
+	VkDeviceSize ringSize = transferManager.stagingRingSize();
+	uint32_t frameIndex = 0;
+	for (VkDeviceSize uploaded = 0; uploaded < 4 * ringSize; uploaded += size) {
+		transferManager.submitOneTimeTransfer(size, otherBuffer, otherData.data(), VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+											  VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+		fixture.submitFrame(frameIndex);
+		++frameIndex %= frameInFlightCount;
+	}
+	testEqual(ringSize, transferManager.stagingRingSize(), "Staging ring was replaced while an upload was open!");
+	std::memcpy(static_cast<unsigned char*>(upload.data) + size / 2, data.data() + data.size() / 2, size / 2);
+
+	VkDeviceSize copiedBytes = device.statistics().copiedBytes;
+	transferManager.commitOneTimeTransfer(upload.handle, buffer, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+										  VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+	fixture.submitFrame(frameIndex);
+	++frameIndex %= frameInFlightCount;
+	testEqual(uint64_t(copiedBytes + size), device.statistics().copiedBytes, "Unexpected amount of copied bytes!");
+	testEqual(0, std::memcmp(device.bufferData(allocator.nativeBufferHandle(buffer)), data.data(), size),
+			  "Uploaded data doesn't match!");
+
+	// host-visible destinations are written directly, nothing is copied
+	BufferResourceHandle hostVisibleBuffer = allocator.createBuffer(createInfo, { .hostVisible = true }, {}, true);
+	upload = transferManager.beginUpload(size, hostVisibleBuffer);
+	testEqual(allocator.mappedBufferData(hostVisibleBuffer), upload.data, "Upload isn't written directly!");
+	std::memcpy(upload.data, data.data(), size);
+	copiedBytes = device.statistics().copiedBytes;
+	transferManager.commitOneTimeTransfer(upload.handle, hostVisibleBuffer, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+										  VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+	fixture.submitFrame(frameIndex);
+	++frameIndex %= frameInFlightCount;
+	testEqual(copiedBytes, device.statistics().copiedBytes, "Direct upload was copied!");
+	testEqual(0, std::memcmp(device.bufferData(allocator.nativeBufferHandle(hostVisibleBuffer)), data.data(), size),
+			  "Uploaded data doesn't match!");
+
+	// cancelled uploads don't copy anything either
+	upload = transferManager.beginUpload(size);
+	transferManager.cancelUpload(upload.handle);
+	fixture.submitFrame(frameIndex);
+	testEqual(copiedBytes, device.statistics().copiedBytes, "Cancelled upload was copied!");
+
+	fixture.destroy();
+}
+
+void testTransferManagerMockTransferBudget() {
+	auto fixture = TransferManagerFixture();
+	auto& [device, context, allocator, transferManager] = fixture;
+	transferManager.setTransferBudget(1024 * 1024);
+
+	constexpr VkDeviceSize size = 1024 * 1024;
+	constexpr uint32_t lowBufferCount = 4;
+	VkBufferCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+									  .size = size,
+									  .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+									  .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+	std::vector<BufferResourceHandle> lowBuffers;
+	for (uint32_t i = 0; i < lowBufferCount; ++i) {
+		lowBuffers.push_back(allocator.createBuffer(createInfo, { .deviceLocal = true }, {}, false));
+	}
+	BufferResourceHandle urgentBuffer = allocator.createBuffer(createInfo, { .deviceLocal = true }, {}, false);
+	BufferResourceHandle defaultBuffer = allocator.createBuffer(createInfo, { .deviceLocal = true }, {}, false);
+
+	std::vector<std::vector<uint32_t>> lowData;
+	for (uint32_t i = 0; i < lowBufferCount; ++i) {
+		lowData.push_back(std::vector<uint32_t>(size / sizeof(uint32_t)));
+		std::iota(lowData.back().begin(), lowData.back().end(), i * size);
+	}
+	std::vector<uint32_t> otherData = std::vector<uint32_t>(size / sizeof(uint32_t), 0xDEADBEEF);
+	auto lowBufferMatches = [&](uint32_t index) {
+		return std::memcmp(device.bufferData(allocator.nativeBufferHandle(lowBuffers[index])), lowData[index].data(),
+						   size) == 0;
+	};
+
+	// urgent transfers are always recorded, the rest is spread out over the following frames
+	for (uint32_t i = 0; i < lowBufferCount; ++i) {
+		transferManager.submitOneTimeTransfer(size, lowBuffers[i], lowData[i].data(),
+											  VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+											  TransferPriority::Low);
+	}
+	transferManager.submitOneTimeTransfer(size / 2, urgentBuffer, otherData.data(), VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+										  VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, TransferPriority::Urgent);
+	uint32_t frameIndex = 0;
+	VkDeviceSize copiedBytes = device.statistics().copiedBytes;
+	fixture.submitFrame(frameIndex);
+	++frameIndex %= frameInFlightCount;
+	testEqual(uint64_t(copiedBytes + size + size / 2), device.statistics().copiedBytes,
+			  "Transfer budget wasn't applied!");
+	testEqual(true, lowBufferMatches(0), "Uploaded data doesn't match!");
+	testEqual(false, lowBufferMatches(1), "Deferred transfer was recorded!");
+
+	for (uint32_t i = 1; i < lowBufferCount; ++i) {
+		copiedBytes = device.statistics().copiedBytes;
+		fixture.submitFrame(frameIndex);
+		++frameIndex %= frameInFlightCount;
+		testEqual(uint64_t(copiedBytes + size), device.statistics().copiedBytes, "Transfer budget wasn't applied!");
+		testEqual(true, lowBufferMatches(i), "Uploaded data doesn't match!");
+	}
+
+	// default transfers are never deferred, however far they exceed the budget
+	for (uint32_t i = 0; i < lowBufferCount; ++i) {
+		transferManager.submitOneTimeTransfer(size, lowBuffers[i], lowData[i].data(),
+											  VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+	}
+	copiedBytes = device.statistics().copiedBytes;
+	fixture.submitFrame(frameIndex);
+	++frameIndex %= frameInFlightCount;
+	testEqual(uint64_t(copiedBytes + lowBufferCount * size), device.statistics().copiedBytes,
+			  "Default priority transfer was deferred!");
+
+	// higher priorities go first, the deferred staging data stays intact while the ring wraps around
+	transferManager.submitOneTimeTransfer(size, lowBuffers[0], lowData[1].data(), VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+										  VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, TransferPriority::Low);
+	VkDeviceSize ringSize = transferManager.stagingRingSize();
+	for (VkDeviceSize uploaded = 0; uploaded < 4 * ringSize; uploaded += 3 * size) {
+		transferManager.submitOneTimeTransfer(size, defaultBuffer, otherData.data(),
+											  VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+		for (uint32_t i = 0; i < 2; ++i) {
+			transferManager.submitOneTimeTransfer(size, urgentBuffer, otherData.data(),
+												  VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+												  VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, TransferPriority::Urgent);
+		}
+		copiedBytes = device.statistics().copiedBytes;
+		fixture.submitFrame(frameIndex);
+		++frameIndex %= frameInFlightCount;
+		testEqual(uint64_t(copiedBytes + 3 * size), device.statistics().copiedBytes,
+				  "Low priority transfer wasn't deferred!");
+	}
+	testEqual(true, lowBufferMatches(0), "Deferred transfer was recorded!");
+	testEqual(ringSize, transferManager.stagingRingSize(), "Staging ring was replaced while a transfer was deferred!");
+
+	fixture.submitFrame(frameIndex);
+	testEqual(0,
+			  std::memcmp(device.bufferData(allocator.nativeBufferHandle(lowBuffers[0])), lowData[1].data(), size),
+			  "Deferred data doesn't match!");
+
+	fixture.destroy();
+}
+
+void testTransferManagerMockOverlappingPriorities() {
+	auto fixture = TransferManagerFixture();
+	auto& [device, context, allocator, transferManager] = fixture;
+
+	constexpr VkDeviceSize size = 1024 * 1024;
+	VkBufferCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+									  .size = size,
+									  .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+									  .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+	BufferResourceHandle buffer = allocator.createBuffer(createInfo, { .deviceLocal = true }, {}, false);
+	BufferResourceHandle otherBuffer = allocator.createBuffer(createInfo, { .deviceLocal = true }, {}, false);
+	std::vector<uint32_t> olderData = std::vector<uint32_t>(size / sizeof(uint32_t), 0x01234567);
+	std::vector<uint32_t> newerData = std::vector<uint32_t>(size / sizeof(uint32_t), 0x89ABCDEF);
+	auto bufferMatches = [&](const std::vector<uint32_t>& data) {
+		return std::memcmp(device.bufferData(allocator.nativeBufferHandle(buffer)), data.data(), size) == 0;
+	};
+
+	// the newer upload has the higher priority, but still has to overwrite the older one
+	transferManager.submitOneTimeTransfer(size, buffer, olderData.data(), VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+										  VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, TransferPriority::Low);
+	transferManager.submitOneTimeTransfer(size, buffer, newerData.data(), VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+										  VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+	uint32_t frameIndex = 0;
+	fixture.submitFrame(frameIndex);
+	++frameIndex %= frameInFlightCount;
+	testEqual(true, bufferMatches(newerData), "Older upload overwrote the newer one!");
+
+	// an older upload that would be deferred can't land after the newer one either
+	transferManager.setTransferBudget(size);
+	transferManager.submitOneTimeTransfer(size, otherBuffer, olderData.data(), VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+										  VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, TransferPriority::Low);
+	transferManager.submitOneTimeTransfer(size, buffer, olderData.data(), VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+										  VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, TransferPriority::Low);
+	transferManager.submitOneTimeTransfer(size, buffer, newerData.data(), VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+										  VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+	for (uint32_t i = 0; i < 3; ++i) {
+		fixture.submitFrame(frameIndex);
+		++frameIndex %= frameInFlightCount;
+		testEqual(true, bufferMatches(newerData), "Deferred older upload overwrote the newer one!");
+	}
+
+	fixture.destroy();
+}
+
+void testTransferManagerMockReadback() {
+	MockDeviceConfig config = discreteMockDeviceConfig();
+	config.deferSubmissions = true;
+	auto fixture = TransferManagerFixture(config);
+	auto& [device, context, allocator, transferManager] = fixture;
+
+	constexpr VkDeviceSize size = 1024 * 1024;
+	VkBufferCreateInfo createInfo = { .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+									  .size = size,
+									  .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+											   VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+									  .sharingMode = VK_SHARING_MODE_EXCLUSIVE };
+	BufferResourceHandle buffer = allocator.createBuffer(createInfo, { .deviceLocal = true }, {}, false);
+
+	std::vector<uint32_t> data = std::vector<uint32_t>(size / sizeof(uint32_t));
+	std::iota(data.begin(), data.end(), 0);
+	std::vector<uint32_t> otherData = std::vector<uint32_t>(size / sizeof(uint32_t), 0xDEADBEEF);
+	transferManager.submitOneTimeTransfer(size, buffer, data.data(), VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+										  VK_ACCESS_SHADER_READ_BIT);
+	uint32_t frameIndex = 0;
+	fixture.submitFrame(frameIndex);
+	++frameIndex %= frameInFlightCount;
+	device.completeSubmissions();
+
+	// readbacks finish with the frame that recorded them
+	GPUReadbackHandle readback =
+		transferManager.readBuffer(buffer, 4096, 8192, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+	testEqual(false, transferManager.isReadbackFinished(readback), "Readback finished before it was recorded!");
+	fixture.submitFrame(frameIndex);
+	++frameIndex %= frameInFlightCount;
+	testEqual(false, transferManager.isReadbackFinished(readback), "Readback finished before the frame!");
+	testEqual(true, transferManager.readbackData(readback) == nullptr, "Unfinished readback has data!");
+	device.completeSubmissions();
+	testEqual(true, transferManager.isReadbackFinished(readback), "Readback didn't finish with the frame!");
+	testEqual(0, std::memcmp(transferManager.readbackData(readback), data.data() + 4096 / sizeof(uint32_t), 8192),
+			  "Read back data doesn't match!");
+	transferManager.releaseReadback(readback);
+
+	VkImageCreateInfo imageCreateInfo = { .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+										  .imageType = VK_IMAGE_TYPE_2D,
+										  .format = VK_FORMAT_R8G8B8A8_UNORM,
+										  .extent = { .width = 256, .height = 256, .depth = 1 },
+										  .mipLevels = 1,
+										  .arrayLayers = 1,
+										  .samples = VK_SAMPLE_COUNT_1_BIT,
+										  .tiling = VK_IMAGE_TILING_OPTIMAL,
+										  .usage =
+											  VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+										  .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+										  .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED };
+	ImageResourceHandle image = allocator.createImage(imageCreateInfo, { .deviceLocal = true }, {});
+	VkBufferImageCopy copy = { .imageSubresource = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+													 .mipLevel = 0,
+													 .baseArrayLayer = 0,
+													 .layerCount = 1 },
+							   .imageOffset = { .x = 64, .y = 64, .z = 0 },
+							   .imageExtent = { .width = 16, .height = 16, .depth = 1 } };
+	VkDeviceSize copiedBytes = device.statistics().copiedBytes;
+	readback = transferManager.readImage(image, copy, 16 * 16 * 4, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+										 VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+										 VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+	fixture.submitFrame(frameIndex);
+	++frameIndex %= frameInFlightCount;
+	device.completeSubmissions();
+	testEqual(true, transferManager.isReadbackFinished(readback), "Image readback didn't finish!");
+	testEqual(uint64_t(copiedBytes + 16 * 16 * 4), device.statistics().copiedBytes,
+			  "Unexpected amount of copied bytes!");
+	transferManager.releaseReadback(readback);
+
+	// released readbacks free their memory again
+	fixture.submitFrame(frameIndex);
+	++frameIndex %= frameInFlightCount;
+	device.completeSubmissions();
+	uint32_t allocationCount = device.statistics().memoryAllocationCount;
+	for (uint32_t i = 0; i < 64; ++i) {
+		readback = transferManager.readBuffer(buffer, 0, size, VK_PIPELINE_STAGE_TRANSFER_BIT,
+											  VK_ACCESS_TRANSFER_WRITE_BIT);
+		fixture.submitFrame(frameIndex);
+		++frameIndex %= frameInFlightCount;
+		device.completeSubmissions();
+		testEqual(true, transferManager.isReadbackFinished(readback), "Readback didn't finish with the frame!");
+		transferManager.releaseReadback(readback);
+	}
+	testEqual(allocationCount, device.statistics().memoryAllocationCount, "Readback memory was reallocated!");
+
+	// an unreleased readback keeps its data while later readbacks need memory of their own
+	GPUReadbackHandle heldReadback =
+		transferManager.readBuffer(buffer, 0, size, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+	fixture.submitFrame(frameIndex);
+	++frameIndex %= frameInFlightCount;
+	device.completeSubmissions();
+	transferManager.submitOneTimeTransfer(size, buffer, otherData.data(), VK_PIPELINE_STAGE_TRANSFER_BIT,
+										  VK_ACCESS_TRANSFER_READ_BIT);
+	for (uint32_t i = 0; i < 32; ++i) {
+		readback = transferManager.readBuffer(buffer, 0, size, VK_PIPELINE_STAGE_TRANSFER_BIT,
+											  VK_ACCESS_TRANSFER_WRITE_BIT);
+		fixture.submitFrame(frameIndex);
+		++frameIndex %= frameInFlightCount;
+		device.completeSubmissions();
+		testEqual(true, transferManager.isReadbackFinished(readback), "Readback didn't finish with the frame!");
+		testEqual(0, std::memcmp(transferManager.readbackData(readback), otherData.data(), size),
+				  "Read back data doesn't match!");
+		transferManager.releaseReadback(readback);
+	}
+	testEqual(true, transferManager.isReadbackFinished(heldReadback), "Held readback isn't finished!");
+	testEqual(0, std::memcmp(transferManager.readbackData(heldReadback), data.data(), size),
+			  "Held readback was overwritten!");
+
+	allocator.destroyImage(image);
+	allocator.destroyBuffer(buffer);
+	fixture.destroy();
+}
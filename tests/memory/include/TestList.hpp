@@ -0,0 +1,55 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <array>
+#include <string_view>
+
+using TestFunction = void (*)();
+
+struct FunctionEntry {
+	std::string_view name;
+	TestFunction function;
+};
+
+void testRangeAllocatorAlignment();
+void testRangeAllocatorCoalescing();
+void testRangeAllocatorExhaustion();
+void testRangeAllocatorRandomized();
+void testMemoryRangeSetRandomized();
+void testAllocationTraceRoundTrip();
+void testAllocatorStatisticsSizeClasses();
+void testAllocatorStatisticsSerialization();
+void testSlabAllocatorSlots();
+void testSlabAllocatorRandomized();
+void testStreamingCopySizes();
+void testStreamingCopyPoolConcurrent();
+
+static constexpr std::array<FunctionEntry, 12> testFunctions = {
+	FunctionEntry{ "RangeAllocatorAlignment", testRangeAllocatorAlignment },
+	FunctionEntry{ "RangeAllocatorCoalescing", testRangeAllocatorCoalescing },
+	FunctionEntry{ "RangeAllocatorExhaustion", testRangeAllocatorExhaustion },
+	FunctionEntry{ "RangeAllocatorRandomized", testRangeAllocatorRandomized },
+	FunctionEntry{ "MemoryRangeSetRandomized", testMemoryRangeSetRandomized },
+	FunctionEntry{ "AllocationTraceRoundTrip", testAllocationTraceRoundTrip },
+	FunctionEntry{ "AllocatorStatisticsSizeClasses", testAllocatorStatisticsSizeClasses },
+	FunctionEntry{ "AllocatorStatisticsSerialization", testAllocatorStatisticsSerialization },
+	FunctionEntry{ "SlabAllocatorSlots", testSlabAllocatorSlots },
+	FunctionEntry{ "SlabAllocatorRandomized", testSlabAllocatorRandomized },
+	FunctionEntry{ "StreamingCopySizes", testStreamingCopySizes },
+	FunctionEntry{ "StreamingCopyPoolConcurrent", testStreamingCopyPoolConcurrent }
+};
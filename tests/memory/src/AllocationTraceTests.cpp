@@ -0,0 +1,63 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <cstdio>
+#include <graphics/util/AllocationTrace.hpp>
+
+using namespace vanadium::graphics;
+
+void testAllocationTraceRoundTrip() {
+	const char* fileName = "AllocationTraceRoundTrip.vatr";
+
+	AllocationTraceRecorder recorder;
+	AllocationTraceHeader header = { .blockSize = 1024,
+									 .bufferBlockFreeThreshold = 2048,
+									 .imageBlockFreeThreshold = 4096,
+									 .bufferImageGranularity = 64 };
+	testEqual(true, recorder.start(fileName, header, { { .properties = 1, .heapIndex = 0 } }, { 1U << 20 }),
+			  "Couldn't start recording!");
+	recorder.record({ .type = AllocationTraceEventType::CreateBuffer,
+					  .memoryTypeIndex = 0,
+					  .frameInFlightIndex = 1,
+					  .frameIndex = 7,
+					  .handle = 3,
+					  .size = 100,
+					  .alignment = 16 });
+	recorder.record({ .type = AllocationTraceEventType::DestroyImage,
+					  .flags = AllocationTraceFlagImage,
+					  .memoryTypeIndex = 0,
+					  .frameIndex = 8,
+					  .handle = 5,
+					  .size = 200 });
+	recorder.stop();
+	testEqual(false, recorder.isRecording(), "Recorder still records after stopping!");
+
+	auto trace = readAllocationTrace(fileName);
+	std::remove(fileName);
+	testEqual(true, trace.has_value(), "Couldn't read recorded trace!");
+	testEqual(uint64_t(1024), trace->header.blockSize, "Block size doesn't match!");
+	testEqual(size_t(1), trace->memoryTypes.size(), "Memory type count doesn't match!");
+	testEqual(size_t(1), trace->heapBudgets.size(), "Heap count doesn't match!");
+	testEqual(size_t(2), trace->events.size(), "Event count doesn't match!");
+	testEqual(uint64_t(16), trace->events[0].alignment, "Alignment doesn't match!");
+	testEqual(uint32_t(8), trace->events[1].frameIndex, "Frame index doesn't match!");
+	testEqual(true, trace->events[1].type == AllocationTraceEventType::DestroyImage, "Event type doesn't match!");
+	testEqual(true, trace->events[0].timestamp <= trace->events[1].timestamp, "Timestamps aren't monotonic!");
+
+	testEqual(false, readAllocationTrace("NonexistentTrace.vatr").has_value(), "Read a nonexistent trace!");
+}
@@ -0,0 +1,80 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <graphics/util/AllocatorStatistics.hpp>
+
+using namespace vanadium::graphics;
+
+void testAllocatorStatisticsSizeClasses() {
+	testEqual(size_t(0), allocationSizeClass(0), "Empty allocation has the wrong size class!");
+	testEqual(size_t(0), allocationSizeClass(2047), "Small allocation has the wrong size class!");
+	testEqual(size_t(1), allocationSizeClass(2048), "2 KiB allocation has the wrong size class!");
+	testEqual(size_t(1), allocationSizeClass(4095), "Allocation below 4 KiB has the wrong size class!");
+	testEqual(size_t(allocationSizeClassCount - 1), allocationSizeClass(32ULL * 1024 * 1024),
+			  "32 MiB allocation has the wrong size class!");
+	testEqual(size_t(allocationSizeClassCount - 1), allocationSizeClass(~0ULL),
+			  "Huge allocation has the wrong size class!");
+}
+
+void testAllocatorStatisticsSerialization() {
+	MemoryBlockStatistics firstBlock = { .typeIndex = 0,
+										 .isImageBlock = false,
+										 .isCustomBlock = false,
+										 .size = 4096,
+										 .usedSize = 1024,
+										 .largestFreeRange = 2048,
+										 .freeRangeCount = 2,
+										 .allocationCount = 1,
+										 .allocationSizeClassCounts = { 0, 1 } };
+	MemoryBlockStatistics secondBlock = { .typeIndex = 0,
+										  .isImageBlock = true,
+										  .isCustomBlock = false,
+										  .size = 8192,
+										  .usedSize = 8192,
+										  .largestFreeRange = 0,
+										  .freeRangeCount = 0,
+										  .allocationCount = 4,
+										  .allocationSizeClassCounts = { 0, 4 } };
+
+	AllocatorStatistics statistics = { .memoryTypes = { { .properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+														  .heapIndex = 0 } },
+									   .heaps = { { .size = 1 << 20,
+													.budget = 1 << 19,
+													.usage = 12288,
+													.remainingBudget = 1 << 18 } },
+									   .blocks = { firstBlock, secondBlock },
+									   .bufferCount = 1,
+									   .imageCount = 4 };
+	accumulateStatistics(statistics.memoryTypes[0].total, firstBlock);
+	accumulateStatistics(statistics.memoryTypes[0].total, secondBlock);
+
+	auto& total = statistics.memoryTypes[0].total;
+	testEqual(size_t(2), total.blockCount, "Block count doesn't match!");
+	testEqual(VkDeviceSize(12288), total.blockSize, "Block size doesn't match!");
+	testEqual(VkDeviceSize(9216), total.usedSize, "Used size doesn't match!");
+	testEqual(VkDeviceSize(2048), total.largestFreeRange, "Largest free range doesn't match!");
+	testEqual(uint32_t(5), total.allocationSizeClassCounts[1], "Size class counts weren't summed!");
+
+	std::string json = serializeAllocatorStatistics(statistics);
+	testEqual(true, json.find("\"flags\": [ \"DEVICE_LOCAL\" ]") != std::string::npos,
+			  "Memory type flags are missing!");
+	testEqual(true, json.find("\"freeBytes\": 3072") != std::string::npos, "Free bytes are missing!");
+	testEqual(true, json.find("\"2048\": 5") != std::string::npos, "Size classes are missing!");
+	testEqual(true, json.find("\"fragmentation\": 0.333333") != std::string::npos, "Fragmentation is missing!");
+	testEqual(true, json.find("\"image\": true") != std::string::npos, "Block list is missing!");
+}
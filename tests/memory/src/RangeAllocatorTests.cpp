@@ -0,0 +1,161 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <graphics/util/RangeAllocator.hpp>
+#include <random>
+
+using namespace vanadium::graphics;
+
+void testRangeAllocatorAlignment() {
+	RangeAllocator allocator = RangeAllocator(4096);
+	auto first = allocator.allocate(0, 3);
+	testEqual(true, first.has_value(), "Unaligned allocation failed!");
+	testEqual(VkDeviceSize(0), first->usableRange.offset, "First allocation doesn't start at 0!");
+
+	auto second = allocator.allocate(256, 100);
+	testEqual(true, second.has_value(), "Aligned allocation failed!");
+	testEqual(VkDeviceSize(0), second->usableRange.offset % 256, "Allocation isn't aligned!");
+	testEqual(VkDeviceSize(100), second->usableRange.size, "Usable size doesn't match!");
+	testEqual(first->allocationRange.offset + first->allocationRange.size, second->allocationRange.offset,
+			  "Alignment margin isn't part of the allocation range!");
+	testEqual(second->usableRange.offset + second->usableRange.size,
+			  second->allocationRange.offset + second->allocationRange.size,
+			  "Allocation range doesn't end at the usable range end!");
+
+	allocator.free(second->allocationRange.offset, second->allocationRange.size);
+	allocator.free(first->allocationRange.offset, first->allocationRange.size);
+	testEqual(true, allocator.empty(), "Allocator isn't empty after freeing everything!");
+}
+
+void testRangeAllocatorCoalescing() {
+	RangeAllocator allocator = RangeAllocator(1024);
+	std::vector<RangeAllocationResult> results;
+	for (uint32_t i = 0; i < 8; ++i) {
+		results.push_back(allocator.allocate(0, 128).value());
+	}
+	testEqual(size_t(0), allocator.freeRangeCount(), "Full allocator has free ranges!");
+
+	allocator.free(results[1].allocationRange.offset, results[1].allocationRange.size);
+	allocator.free(results[3].allocationRange.offset, results[3].allocationRange.size);
+	testEqual(size_t(2), allocator.freeRangeCount(), "Non-adjacent ranges were merged!");
+	testEqual(VkDeviceSize(128), allocator.maxAllocatableSize(), "Largest free range doesn't match!");
+
+	allocator.free(results[2].allocationRange.offset, results[2].allocationRange.size);
+	testEqual(size_t(1), allocator.freeRangeCount(), "Adjacent ranges weren't merged!");
+	testEqual(VkDeviceSize(384), allocator.maxAllocatableSize(), "Merged range has the wrong size!");
+
+	auto merged = allocator.allocate(0, 384);
+	testEqual(true, merged.has_value(), "Merged range can't be allocated!");
+	testEqual(VkDeviceSize(128), merged->usableRange.offset, "Merged range has the wrong offset!");
+}
+
+void testRangeAllocatorExhaustion() {
+	RangeAllocator allocator = RangeAllocator(1000);
+	auto first = allocator.allocate(0, 600);
+	testEqual(true, first.has_value(), "First allocation failed!");
+	testEqual(false, allocator.allocate(0, 401).has_value(), "Allocation bigger than the free space succeeded!");
+	// 400 bytes are free, but only 360 of them are behind the next offset aligned to 64
+	testEqual(false, allocator.allocate(64, 361).has_value(), "Allocation not fitting after alignment succeeded!");
+
+	auto rest = allocator.allocate(8, 400);
+	testEqual(true, rest.has_value(), "Exact fit allocation failed!");
+	testEqual(VkDeviceSize(0), allocator.freeSize(), "Allocator isn't full!");
+}
+
+void testRangeAllocatorRandomized() {
+	constexpr VkDeviceSize rangeSize = 1 << 20;
+	RangeAllocator allocator = RangeAllocator(rangeSize);
+	std::vector<uint8_t> usedBytes(rangeSize, 0);
+	std::vector<RangeAllocationResult> liveAllocations;
+
+	std::mt19937 generator(1234);
+	std::uniform_int_distribution<VkDeviceSize> sizeDistribution(1, 8192);
+	std::uniform_int_distribution<uint32_t> alignmentExponentDistribution(0, 10);
+
+	for (uint32_t i = 0; i < 20000; ++i) {
+		if (liveAllocations.empty() || generator() % 3) {
+			VkDeviceSize alignment = VkDeviceSize(1) << alignmentExponentDistribution(generator);
+			VkDeviceSize size = sizeDistribution(generator);
+			auto result = allocator.allocate(alignment, size);
+			if (!result.has_value())
+				continue;
+
+			testEqual(VkDeviceSize(0), result->usableRange.offset % alignment, "Allocation isn't aligned!");
+			testLessEqual(result->allocationRange.offset + result->allocationRange.size, rangeSize,
+						  "Allocation exceeds the range!");
+			for (VkDeviceSize j = 0; j < result->allocationRange.size; ++j) {
+				testEqual(uint8_t(0), usedBytes[result->allocationRange.offset + j], "Allocations overlap!");
+				usedBytes[result->allocationRange.offset + j] = 1;
+			}
+			liveAllocations.push_back(result.value());
+		} else {
+			size_t index = generator() % liveAllocations.size();
+			auto& range = liveAllocations[index].allocationRange;
+			for (VkDeviceSize j = 0; j < range.size; ++j) {
+				usedBytes[range.offset + j] = 0;
+			}
+			allocator.free(range.offset, range.size);
+			liveAllocations[index] = liveAllocations.back();
+			liveAllocations.pop_back();
+		}
+	}
+
+	for (auto& allocation : liveAllocations) {
+		allocator.free(allocation.allocationRange.offset, allocation.allocationRange.size);
+	}
+	testEqual(true, allocator.empty(), "Allocator isn't empty after freeing everything!");
+	testEqual(size_t(1), allocator.freeRangeCount(), "Free ranges weren't merged back together!");
+	testEqual(rangeSize, allocator.maxAllocatableSize(), "Whole range isn't allocatable after freeing everything!");
+}
+
+void testMemoryRangeSetRandomized() {
+	constexpr VkDeviceSize rangeSize = 4096;
+	std::vector<MemoryRange> ranges;
+	std::vector<uint8_t> coveredBytes(rangeSize, 0);
+
+	std::mt19937 generator(4321);
+	std::uniform_int_distribution<VkDeviceSize> offsetDistribution(0, rangeSize - 1);
+	std::uniform_int_distribution<VkDeviceSize> sizeDistribution(0, 256);
+
+	for (uint32_t i = 0; i < 5000; ++i) {
+		VkDeviceSize offset = offsetDistribution(generator);
+		VkDeviceSize size = std::min(sizeDistribution(generator), rangeSize - offset);
+		bool insert = generator() % 3;
+		if (insert) {
+			insertMergedRange(ranges, { .offset = offset, .size = size });
+		} else {
+			eraseRange(ranges, { .offset = offset, .size = size });
+		}
+		for (VkDeviceSize j = offset; j < offset + size; ++j) {
+			coveredBytes[j] = insert;
+		}
+
+		std::vector<uint8_t> rangeBytes(rangeSize, 0);
+		for (size_t j = 0; j < ranges.size(); ++j) {
+			testLess(VkDeviceSize(0), ranges[j].size, "Set contains an empty range!");
+			if (j > 0) {
+				testLess(ranges[j - 1].offset + ranges[j - 1].size, ranges[j].offset,
+						 "Ranges aren't sorted, disjoint and merged!");
+			}
+			for (VkDeviceSize k = 0; k < ranges[j].size; ++k) {
+				rangeBytes[ranges[j].offset + k] = 1;
+			}
+		}
+		testEqual(true, rangeBytes == coveredBytes, "Ranges don't cover the inserted bytes!");
+	}
+}
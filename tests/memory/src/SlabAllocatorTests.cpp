@@ -0,0 +1,87 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <graphics/util/SlabAllocator.hpp>
+#include <random>
+
+using namespace vanadium::graphics;
+
+void testSlabAllocatorSlots() {
+	SlabAllocator allocator = SlabAllocator(256, 4);
+	testEqual(false, allocator.allocate().has_value(), "Allocation without slabs succeeded!");
+
+	uint32_t slabIndex = allocator.addSlab(4096);
+	std::vector<SlabSlot> slots;
+	for (uint32_t i = 0; i < 4; ++i) {
+		auto slot = allocator.allocate();
+		testEqual(true, slot.has_value(), "Allocation from a slab with free slots failed!");
+		testEqual(slabIndex, slot->slabIndex, "Slot is in the wrong slab!");
+		testEqual(VkDeviceSize(4096 + i * 256), allocator.slotOffset(slot.value()), "Slots aren't packed!");
+		slots.push_back(slot.value());
+	}
+	testEqual(false, allocator.allocate().has_value(), "Allocation from a full slab succeeded!");
+
+	testEqual(false, allocator.free(slots[2]), "Slab with used slots reported empty!");
+	auto reused = allocator.allocate();
+	testEqual(true, reused.has_value(), "Freed slot can't be reused!");
+	testEqual(VkDeviceSize(4096 + 2 * 256), allocator.slotOffset(reused.value()), "Wrong slot was reused!");
+
+	testEqual(false, allocator.free(slots[0]), "Slab with used slots reported empty!");
+	testEqual(false, allocator.free(slots[1]), "Slab with used slots reported empty!");
+	testEqual(false, allocator.free(reused.value()), "Slab with used slots reported empty!");
+	testEqual(true, allocator.free(slots[3]), "Slab without used slots isn't reported empty!");
+	testEqual(size_t(0), allocator.usedSlotCount(), "Used slots left after freeing everything!");
+
+	allocator.removeSlab(slabIndex);
+	testEqual(size_t(0), allocator.slabCount(), "Removed slab is still counted!");
+	testEqual(false, allocator.allocate().has_value(), "Allocation from a removed slab succeeded!");
+}
+
+void testSlabAllocatorRandomized() {
+	constexpr VkDeviceSize slotSize = 512;
+	SlabAllocator allocator = SlabAllocator(slotSize, SlabAllocator::maxSlotsPerSlab);
+	std::vector<SlabSlot> liveSlots;
+	std::vector<bool> usedSlots;
+
+	std::mt19937 generator(1234);
+	for (uint32_t i = 0; i < 20000; ++i) {
+		if (liveSlots.empty() || generator() % 3) {
+			auto slot = allocator.allocate();
+			if (!slot.has_value()) {
+				// slabs are laid out back to back, like they would be in a block
+				allocator.addSlab(allocator.slabCount() * allocator.slabSize());
+				slot = allocator.allocate();
+			}
+			testEqual(true, slot.has_value(), "Allocation after adding a slab failed!");
+			VkDeviceSize slotIndex = allocator.slotOffset(slot.value()) / slotSize;
+			testEqual(VkDeviceSize(0), allocator.slotOffset(slot.value()) % slotSize, "Slot isn't aligned!");
+			if (slotIndex >= usedSlots.size())
+				usedSlots.resize(slotIndex + 1);
+			testEqual(false, static_cast<bool>(usedSlots[slotIndex]), "Slots overlap!");
+			usedSlots[slotIndex] = true;
+			liveSlots.push_back(slot.value());
+		} else {
+			size_t index = generator() % liveSlots.size();
+			usedSlots[allocator.slotOffset(liveSlots[index]) / slotSize] = false;
+			allocator.free(liveSlots[index]);
+			liveSlots[index] = liveSlots.back();
+			liveSlots.pop_back();
+		}
+	}
+	testEqual(liveSlots.size(), allocator.usedSlotCount(), "Used slot count doesn't match!");
+}
@@ -0,0 +1,96 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <TestList.hpp>
+#include <TestUtilCommon.hpp>
+#include <algorithm>
+#include <cstring>
+#include <graphics/util/StreamingCopy.hpp>
+#include <random>
+#include <thread>
+
+using namespace vanadium::graphics;
+
+void testStreamingCopySizes() {
+	std::mt19937 engine = std::mt19937(42);
+	std::uniform_int_distribution<int> byteDistribution = std::uniform_int_distribution<int>(0, 255);
+
+	constexpr size_t maxSize = 3_MiB;
+	std::vector<unsigned char> src = std::vector<unsigned char>(maxSize + 64);
+	std::vector<unsigned char> dst = std::vector<unsigned char>(maxSize + 64);
+	for (auto& byte : src) {
+		byte = static_cast<unsigned char>(byteDistribution(engine));
+	}
+
+	// odd sizes and misaligned pointers go through the unaligned head and tail of the streaming loop
+	StreamingCopyPool pool;
+	pool.create(3);
+	for (size_t size : { size_t(0), size_t(1), size_t(63), size_t(4097), size_t(256_KiB + 17), size_t(1_MiB),
+						 size_t(1_MiB + 13), maxSize }) {
+		for (size_t misalignment : { size_t(0), size_t(3), size_t(8), size_t(61) }) {
+			std::memset(dst.data(), 0, dst.size());
+			streamingCopy(dst.data() + misalignment, src.data() + 64 - misalignment, size);
+			testEqual(0, std::memcmp(dst.data() + misalignment, src.data() + 64 - misalignment, size),
+					  "Streaming copy doesn't match!");
+			testEqual(true, std::all_of(dst.begin() + misalignment + size, dst.end(), [](auto byte) { return !byte; }),
+					  "Streaming copy wrote past the end!");
+
+			std::memset(dst.data(), 0, dst.size());
+			pool.copy(dst.data() + misalignment, src.data() + misalignment, size);
+			testEqual(0, std::memcmp(dst.data() + misalignment, src.data() + misalignment, size),
+					  "Pooled copy doesn't match!");
+		}
+	}
+	pool.destroy();
+}
+
+void testStreamingCopyPoolConcurrent() {
+	constexpr size_t copySize = 4_MiB;
+	constexpr uint32_t threadCount = 4;
+	constexpr uint32_t copiesPerThread = 16;
+
+	StreamingCopyPool pool;
+	pool.create(2);
+
+	std::vector<std::vector<unsigned char>> sources;
+	std::vector<std::vector<unsigned char>> destinations;
+	for (uint32_t i = 0; i < threadCount; ++i) {
+		sources.push_back(std::vector<unsigned char>(copySize, static_cast<unsigned char>(i + 1)));
+		destinations.push_back(std::vector<unsigned char>(copySize));
+	}
+
+	// chunks of different copies share the queue, every caller has to get back exactly its own data
+	std::vector<std::thread> threads;
+	std::vector<uint32_t> mismatchCounts = std::vector<uint32_t>(threadCount);
+	for (uint32_t i = 0; i < threadCount; ++i) {
+		threads.emplace_back([&, i]() {
+			for (uint32_t j = 0; j < copiesPerThread; ++j) {
+				std::fill(destinations[i].begin(), destinations[i].end(), 0);
+				pool.copy(destinations[i].data(), sources[i].data(), copySize);
+				if (destinations[i] != sources[i])
+					++mismatchCounts[i];
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	pool.destroy();
+
+	for (uint32_t i = 0; i < threadCount; ++i) {
+		testEqual(uint32_t(0), mismatchCounts[i], "Concurrent pooled copy doesn't match!");
+	}
+}
@@ -0,0 +1,138 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <graphics/DeviceContext.hpp>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+struct MockSemaphore;
+
+struct MockMemoryHeap {
+	VkDeviceSize size;
+	VkMemoryHeapFlags flags;
+	// budget reported through VK_EXT_memory_budget, relative to the heap size
+	float budgetFraction = 0.8f;
+};
+
+struct MockMemoryType {
+	VkMemoryPropertyFlags properties;
+	uint32_t heapIndex;
+};
+
+struct MockDeviceConfig {
+	std::vector<MockMemoryHeap> heaps;
+	std::vector<MockMemoryType> memoryTypes;
+	vanadium::graphics::DeviceCapabilities capabilities = {};
+
+	// memory types buffers and images report in their requirements
+	uint32_t bufferMemoryTypeBits = ~0U;
+	uint32_t imageMemoryTypeBits = ~0U;
+	VkDeviceSize bufferAlignment = 256;
+	VkDeviceSize imageAlignment = 64 * 1024;
+	VkDeviceSize bufferImageGranularity = 1024;
+	VkDeviceSize nonCoherentAtomSize = 64;
+	// resources at least this large prefer a dedicated allocation (only reported with dedicatedAllocation)
+	VkDeviceSize dedicatedAllocationThreshold = ~0ULL;
+	uint32_t maxMemoryAllocationCount = 4096;
+
+	// If set, submissions stay pending until completeSubmissions is called, otherwise they complete right away.
+	bool deferSubmissions = false;
+};
+
+// Device-local heap, small host-visible VRAM window and host heap, like a discrete GPU without resizable BAR.
+MockDeviceConfig discreteMockDeviceConfig();
+// A single heap whose memory is both device local and host visible.
+MockDeviceConfig integratedMockDeviceConfig();
+
+struct MockDeviceStatistics {
+	uint32_t memoryAllocationCount;
+	std::vector<VkDeviceSize> heapUsages;
+	uint32_t bufferCount;
+	uint32_t imageCount;
+	uint32_t imageViewCount;
+	uint64_t submitCount;
+	// bytes copied by executed transfer commands
+	uint64_t copiedBytes;
+	uint64_t flushedRangeCount;
+	uint64_t flushCallCount;
+	// vkCmdCopyBuffer commands, counted when they are executed
+	uint64_t bufferCopyCommandCount;
+};
+
+// Implements the Vulkan commands GPUResourceAllocator and GPUTransferManager use on the CPU, so both can be tested
+// and benchmarked without a GPU. The constructor overwrites the volk function pointers, so only one MockDevice may
+// exist at a time and no real device may be used while it does.
+// Device memory is backed by zeroed host memory that is only committed once touched. Buffer copies are executed on
+// the host when their submission completes, image copies only count the copied bytes. Buffer copies writing
+// overlapping memory in one command buffer are rejected unless a transfer barrier separates them.
+class MockDevice {
+  public:
+	MockDevice(const MockDeviceConfig& config);
+	MockDevice(const MockDevice&) = delete;
+	MockDevice(MockDevice&&) = delete;
+	~MockDevice();
+
+	// Handles for DeviceContext(const ExternalDeviceInfo&).
+	vanadium::graphics::ExternalDeviceInfo deviceInfo();
+
+	// Executes every pending submission and signals its fence.
+	void completeSubmissions();
+	// Fails the next count memory allocations with VK_ERROR_OUT_OF_DEVICE_MEMORY.
+	void failMemoryAllocations(uint32_t count) { m_failingAllocationCount = count; }
+
+	// Host pointer to the start of the memory a buffer is bound to, regardless of the memory's properties.
+	void* bufferData(VkBuffer buffer);
+
+	MockDeviceStatistics statistics() const;
+
+	const MockDeviceConfig& config() const { return m_config; }
+
+  private:
+	friend struct MockDeviceFunctions;
+
+	struct PendingSubmission {
+		std::vector<VkCommandBuffer> commandBuffers;
+		VkFence fence;
+		std::vector<std::pair<MockSemaphore*, uint64_t>> semaphoreSignals;
+	};
+
+	void executeCommandBuffer(VkCommandBuffer commandBuffer);
+
+	MockDeviceConfig m_config;
+
+	std::array<std::atomic<VkDeviceSize>, VK_MAX_MEMORY_HEAPS> m_heapUsages = {};
+	std::atomic<uint32_t> m_memoryAllocationCount = 0;
+	std::atomic<uint32_t> m_failingAllocationCount = 0;
+	std::atomic<uint32_t> m_bufferCount = 0;
+	std::atomic<uint32_t> m_imageCount = 0;
+	std::atomic<uint32_t> m_imageViewCount = 0;
+	std::atomic<uint64_t> m_submitCount = 0;
+	std::atomic<uint64_t> m_copiedBytes = 0;
+	std::atomic<uint64_t> m_flushedRangeCount = 0;
+	std::atomic<uint64_t> m_flushCallCount = 0;
+	std::atomic<uint64_t> m_bufferCopyCommandCount = 0;
+
+	uint32_t m_graphicsQueueFamilyIndex = 0;
+	uint32_t m_transferQueueFamilyIndex = 1;
+
+	std::mutex m_submissionMutex;
+	std::vector<PendingSubmission> m_pendingSubmissions;
+};
@@ -0,0 +1,797 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <Log.hpp>
+#include <MockDevice.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <volk.h>
+
+using namespace vanadium;
+using namespace vanadium::graphics;
+
+static MockDevice* activeDevice = nullptr;
+
+struct MockMemory {
+	uint32_t typeIndex;
+	VkDeviceSize size;
+	unsigned char* data;
+	bool isMapped = false;
+};
+
+struct MockBuffer {
+	VkDeviceSize size;
+	MockMemory* memory = nullptr;
+	VkDeviceSize memoryOffset = 0;
+};
+
+struct MockImage {
+	VkFormat format;
+	VkDeviceSize size;
+	MockMemory* memory = nullptr;
+	VkDeviceSize memoryOffset = 0;
+};
+
+struct MockCommand {
+	VkBuffer srcBuffer;
+	VkBuffer dstBuffer;
+	std::vector<VkBufferCopy> regions;
+	// copies involving images aren't executed
+	VkDeviceSize imageByteCount;
+	// a barrier making earlier transfer writes visible to later ones
+	bool ordersTransferWrites = false;
+};
+
+struct MockCommandBuffer {
+	std::vector<MockCommand> commands;
+};
+
+struct MockCommandPool {
+	std::vector<MockCommandBuffer*> commandBuffers;
+};
+
+struct MockFence {
+	std::atomic<bool> signaled;
+};
+
+struct MockSemaphore {
+	bool isTimeline;
+	std::atomic<uint64_t> value;
+	// highest value any submission so far will signal, waits for more would never finish
+	uint64_t pendingValue;
+};
+
+template <typename Object, typename Handle> Object* mockObject(Handle handle) {
+	return reinterpret_cast<Object*>(handle);
+}
+
+static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+static VkDeviceSize texelSize(VkFormat format) {
+	switch (format) {
+		case VK_FORMAT_R8_UNORM:
+		case VK_FORMAT_S8_UINT:
+			return 1;
+		case VK_FORMAT_D16_UNORM:
+			return 2;
+		case VK_FORMAT_D16_UNORM_S8_UINT:
+		case VK_FORMAT_R16G16B16A16_SFLOAT:
+		case VK_FORMAT_D32_SFLOAT_S8_UINT:
+			return 8;
+		case VK_FORMAT_R32G32B32A32_SFLOAT:
+			return 16;
+		default:
+			return 4;
+	}
+}
+
+static VkDeviceSize imageSize(const VkImageCreateInfo& createInfo) {
+	VkDeviceSize size = 0;
+	for (uint32_t i = 0; i < createInfo.mipLevels; ++i) {
+		size += std::max(createInfo.extent.width >> i, 1U) * std::max(createInfo.extent.height >> i, 1U) *
+				std::max(createInfo.extent.depth >> i, 1U);
+	}
+	return size * createInfo.arrayLayers * texelSize(createInfo.format);
+}
+
+// VkBaseOutStructure isn't used to keep this independent of the header version
+struct MockStructureHeader {
+	VkStructureType sType;
+	void* pNext;
+};
+
+template <typename T> T* findStructure(void* pNext, VkStructureType sType) {
+	while (pNext) {
+		auto header = reinterpret_cast<MockStructureHeader*>(pNext);
+		if (header->sType == sType) {
+			return reinterpret_cast<T*>(pNext);
+		}
+		pNext = header->pNext;
+	}
+	return nullptr;
+}
+
+struct MockDeviceFunctions {
+	static VKAPI_ATTR void VKAPI_CALL getPhysicalDeviceProperties(VkPhysicalDevice physicalDevice,
+																  VkPhysicalDeviceProperties* pProperties) {
+		auto& config = activeDevice->m_config;
+		*pProperties = { .apiVersion = VK_API_VERSION_1_0,
+						 .deviceType = VK_PHYSICAL_DEVICE_TYPE_OTHER,
+						 .limits = { .maxMemoryAllocationCount = config.maxMemoryAllocationCount,
+									 .bufferImageGranularity = config.bufferImageGranularity,
+									 .minMemoryMapAlignment = 64,
+									 .minTexelBufferOffsetAlignment = 16,
+									 .minUniformBufferOffsetAlignment = 256,
+									 .minStorageBufferOffsetAlignment = 64,
+									 .nonCoherentAtomSize = config.nonCoherentAtomSize } };
+		std::strcpy(pProperties->deviceName, "Vanadium Mock Device");
+	}
+
+	static VKAPI_ATTR void VKAPI_CALL getPhysicalDeviceMemoryProperties(
+		VkPhysicalDevice physicalDevice, VkPhysicalDeviceMemoryProperties* pMemoryProperties) {
+		auto& config = activeDevice->m_config;
+		*pMemoryProperties = { .memoryTypeCount = static_cast<uint32_t>(config.memoryTypes.size()),
+							   .memoryHeapCount = static_cast<uint32_t>(config.heaps.size()) };
+		for (size_t i = 0; i < config.memoryTypes.size(); ++i) {
+			pMemoryProperties->memoryTypes[i] = { .propertyFlags = config.memoryTypes[i].properties,
+												  .heapIndex = config.memoryTypes[i].heapIndex };
+		}
+		for (size_t i = 0; i < config.heaps.size(); ++i) {
+			pMemoryProperties->memoryHeaps[i] = { .size = config.heaps[i].size, .flags = config.heaps[i].flags };
+		}
+	}
+
+	static VKAPI_ATTR void VKAPI_CALL getPhysicalDeviceMemoryProperties2(
+		VkPhysicalDevice physicalDevice, VkPhysicalDeviceMemoryProperties2* pMemoryProperties) {
+		getPhysicalDeviceMemoryProperties(physicalDevice, &pMemoryProperties->memoryProperties);
+
+		auto budgetProperties = findStructure<VkPhysicalDeviceMemoryBudgetPropertiesEXT>(
+			pMemoryProperties->pNext, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT);
+		if (budgetProperties) {
+			auto& config = activeDevice->m_config;
+			for (size_t i = 0; i < config.heaps.size(); ++i) {
+				double budget = static_cast<double>(config.heaps[i].size) * config.heaps[i].budgetFraction;
+				budgetProperties->heapBudget[i] = static_cast<VkDeviceSize>(budget);
+				budgetProperties->heapUsage[i] = activeDevice->m_heapUsages[i].load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL allocateMemory(VkDevice device, const VkMemoryAllocateInfo* pAllocateInfo,
+														 const VkAllocationCallbacks* pAllocator,
+														 VkDeviceMemory* pMemory) {
+		auto& config = activeDevice->m_config;
+		assertFatal(pAllocateInfo->memoryTypeIndex < config.memoryTypes.size(),
+					"MockDevice: Invalid memory type index!\n");
+
+		uint32_t failingAllocationCount = activeDevice->m_failingAllocationCount.load(std::memory_order_relaxed);
+		while (failingAllocationCount) {
+			if (activeDevice->m_failingAllocationCount.compare_exchange_weak(failingAllocationCount,
+																			  failingAllocationCount - 1)) {
+				return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+			}
+		}
+
+		if (activeDevice->m_memoryAllocationCount.fetch_add(1) >= config.maxMemoryAllocationCount) {
+			--activeDevice->m_memoryAllocationCount;
+			return VK_ERROR_TOO_MANY_OBJECTS;
+		}
+
+		uint32_t heapIndex = config.memoryTypes[pAllocateInfo->memoryTypeIndex].heapIndex;
+		VkDeviceSize previousUsage = activeDevice->m_heapUsages[heapIndex].fetch_add(pAllocateInfo->allocationSize);
+		if (previousUsage + pAllocateInfo->allocationSize > config.heaps[heapIndex].size) {
+			activeDevice->m_heapUsages[heapIndex] -= pAllocateInfo->allocationSize;
+			--activeDevice->m_memoryAllocationCount;
+			return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+		}
+
+		// calloc leaves large allocations uncommitted until they're touched
+		auto data = static_cast<unsigned char*>(std::calloc(pAllocateInfo->allocationSize, 1));
+		if (!data) {
+			activeDevice->m_heapUsages[heapIndex] -= pAllocateInfo->allocationSize;
+			--activeDevice->m_memoryAllocationCount;
+			return VK_ERROR_OUT_OF_HOST_MEMORY;
+		}
+
+		*pMemory = reinterpret_cast<VkDeviceMemory>(new MockMemory{ .typeIndex = pAllocateInfo->memoryTypeIndex,
+																	 .size = pAllocateInfo->allocationSize,
+																	 .data = data });
+		return VK_SUCCESS;
+	}
+
+	static VKAPI_ATTR void VKAPI_CALL freeMemory(VkDevice device, VkDeviceMemory memory,
+												 const VkAllocationCallbacks* pAllocator) {
+		if (!memory)
+			return;
+		auto mockMemory = mockObject<MockMemory>(memory);
+		uint32_t heapIndex = activeDevice->m_config.memoryTypes[mockMemory->typeIndex].heapIndex;
+		activeDevice->m_heapUsages[heapIndex] -= mockMemory->size;
+		--activeDevice->m_memoryAllocationCount;
+		std::free(mockMemory->data);
+		delete mockMemory;
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL mapMemory(VkDevice device, VkDeviceMemory memory, VkDeviceSize offset,
+													VkDeviceSize size, VkMemoryMapFlags flags, void** ppData) {
+		auto mockMemory = mockObject<MockMemory>(memory);
+		if (!(activeDevice->m_config.memoryTypes[mockMemory->typeIndex].properties &
+			  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)) {
+			return VK_ERROR_MEMORY_MAP_FAILED;
+		}
+		assertFatal(!mockMemory->isMapped, "MockDevice: Memory is already mapped!\n");
+		assertFatal(offset < mockMemory->size, "MockDevice: Mapped range is out of bounds!\n");
+		mockMemory->isMapped = true;
+		*ppData = mockMemory->data + offset;
+		return VK_SUCCESS;
+	}
+
+	static VKAPI_ATTR void VKAPI_CALL unmapMemory(VkDevice device, VkDeviceMemory memory) {
+		mockObject<MockMemory>(memory)->isMapped = false;
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL flushMappedMemoryRanges(VkDevice device, uint32_t memoryRangeCount,
+																  const VkMappedMemoryRange* pMemoryRanges) {
+		VkDeviceSize atomSize = activeDevice->m_config.nonCoherentAtomSize;
+		for (uint32_t i = 0; i < memoryRangeCount; ++i) {
+			auto mockMemory = mockObject<MockMemory>(pMemoryRanges[i].memory);
+			assertFatal(mockMemory->isMapped, "MockDevice: Flushed memory isn't mapped!\n");
+			assertFatal(pMemoryRanges[i].offset % atomSize == 0,
+						"MockDevice: Flushed range offset isn't a multiple of nonCoherentAtomSize!\n");
+			assertFatal(pMemoryRanges[i].size == VK_WHOLE_SIZE || pMemoryRanges[i].size % atomSize == 0 ||
+							pMemoryRanges[i].offset + pMemoryRanges[i].size == mockMemory->size,
+						"MockDevice: Flushed range size isn't a multiple of nonCoherentAtomSize!\n");
+		}
+		activeDevice->m_flushedRangeCount += memoryRangeCount;
+		++activeDevice->m_flushCallCount;
+		return VK_SUCCESS;
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL invalidateMappedMemoryRanges(VkDevice device, uint32_t memoryRangeCount,
+																	   const VkMappedMemoryRange* pMemoryRanges) {
+		return VK_SUCCESS;
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL createBuffer(VkDevice device, const VkBufferCreateInfo* pCreateInfo,
+													   const VkAllocationCallbacks* pAllocator, VkBuffer* pBuffer) {
+		*pBuffer = reinterpret_cast<VkBuffer>(new MockBuffer{ .size = pCreateInfo->size });
+		++activeDevice->m_bufferCount;
+		return VK_SUCCESS;
+	}
+
+	static VKAPI_ATTR void VKAPI_CALL destroyBuffer(VkDevice device, VkBuffer buffer,
+													const VkAllocationCallbacks* pAllocator) {
+		if (!buffer)
+			return;
+		delete mockObject<MockBuffer>(buffer);
+		--activeDevice->m_bufferCount;
+	}
+
+	static VKAPI_ATTR void VKAPI_CALL getBufferMemoryRequirements(VkDevice device, VkBuffer buffer,
+																  VkMemoryRequirements* pMemoryRequirements) {
+		auto& config = activeDevice->m_config;
+		*pMemoryRequirements = { .size = alignUp(mockObject<MockBuffer>(buffer)->size, config.bufferAlignment),
+								 .alignment = config.bufferAlignment,
+								 .memoryTypeBits = config.bufferMemoryTypeBits };
+	}
+
+	static VKAPI_ATTR void VKAPI_CALL getBufferMemoryRequirements2(VkDevice device,
+																   const VkBufferMemoryRequirementsInfo2* pInfo,
+																   VkMemoryRequirements2* pMemoryRequirements) {
+		getBufferMemoryRequirements(device, pInfo->buffer, &pMemoryRequirements->memoryRequirements);
+		fillDedicatedRequirements(pMemoryRequirements);
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL bindBufferMemory(VkDevice device, VkBuffer buffer, VkDeviceMemory memory,
+														   VkDeviceSize memoryOffset) {
+		auto mockBuffer = mockObject<MockBuffer>(buffer);
+		auto mockMemory = mockObject<MockMemory>(memory);
+		assertFatal(!mockBuffer->memory, "MockDevice: Buffer is already bound!\n");
+		assertFatal(memoryOffset % activeDevice->m_config.bufferAlignment == 0,
+					"MockDevice: Buffer memory offset is misaligned!\n");
+		assertFatal(memoryOffset + mockBuffer->size <= mockMemory->size,
+					"MockDevice: Buffer exceeds the bound memory!\n");
+		mockBuffer->memory = mockMemory;
+		mockBuffer->memoryOffset = memoryOffset;
+		return VK_SUCCESS;
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL createImage(VkDevice device, const VkImageCreateInfo* pCreateInfo,
+													  const VkAllocationCallbacks* pAllocator, VkImage* pImage) {
+		*pImage = reinterpret_cast<VkImage>(new MockImage{ .format = pCreateInfo->format,
+														   .size = imageSize(*pCreateInfo) });
+		++activeDevice->m_imageCount;
+		return VK_SUCCESS;
+	}
+
+	static VKAPI_ATTR void VKAPI_CALL destroyImage(VkDevice device, VkImage image,
+												   const VkAllocationCallbacks* pAllocator) {
+		if (!image)
+			return;
+		delete mockObject<MockImage>(image);
+		--activeDevice->m_imageCount;
+	}
+
+	static VKAPI_ATTR void VKAPI_CALL getImageMemoryRequirements(VkDevice device, VkImage image,
+																 VkMemoryRequirements* pMemoryRequirements) {
+		auto& config = activeDevice->m_config;
+		*pMemoryRequirements = { .size = alignUp(mockObject<MockImage>(image)->size, config.imageAlignment),
+								 .alignment = config.imageAlignment,
+								 .memoryTypeBits = config.imageMemoryTypeBits };
+	}
+
+	static VKAPI_ATTR void VKAPI_CALL getImageMemoryRequirements2(VkDevice device,
+																  const VkImageMemoryRequirementsInfo2* pInfo,
+																  VkMemoryRequirements2* pMemoryRequirements) {
+		getImageMemoryRequirements(device, pInfo->image, &pMemoryRequirements->memoryRequirements);
+		fillDedicatedRequirements(pMemoryRequirements);
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL bindImageMemory(VkDevice device, VkImage image, VkDeviceMemory memory,
+														  VkDeviceSize memoryOffset) {
+		auto mockImage = mockObject<MockImage>(image);
+		auto mockMemory = mockObject<MockMemory>(memory);
+		assertFatal(!mockImage->memory, "MockDevice: Image is already bound!\n");
+		assertFatal(memoryOffset % activeDevice->m_config.imageAlignment == 0,
+					"MockDevice: Image memory offset is misaligned!\n");
+		assertFatal(memoryOffset + mockImage->size <= mockMemory->size,
+					"MockDevice: Image exceeds the bound memory!\n");
+		mockImage->memory = mockMemory;
+		mockImage->memoryOffset = memoryOffset;
+		return VK_SUCCESS;
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL createImageView(VkDevice device, const VkImageViewCreateInfo* pCreateInfo,
+														  const VkAllocationCallbacks* pAllocator,
+														  VkImageView* pView) {
+		// views only need to be unique
+		*pView = reinterpret_cast<VkImageView>(new char);
+		++activeDevice->m_imageViewCount;
+		return VK_SUCCESS;
+	}
+
+	static VKAPI_ATTR void VKAPI_CALL destroyImageView(VkDevice device, VkImageView imageView,
+													   const VkAllocationCallbacks* pAllocator) {
+		if (!imageView)
+			return;
+		delete mockObject<char>(imageView);
+		--activeDevice->m_imageViewCount;
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL createCommandPool(VkDevice device,
+															const VkCommandPoolCreateInfo* pCreateInfo,
+															const VkAllocationCallbacks* pAllocator,
+															VkCommandPool* pCommandPool) {
+		*pCommandPool = reinterpret_cast<VkCommandPool>(new MockCommandPool());
+		return VK_SUCCESS;
+	}
+
+	static VKAPI_ATTR void VKAPI_CALL destroyCommandPool(VkDevice device, VkCommandPool commandPool,
+														 const VkAllocationCallbacks* pAllocator) {
+		if (!commandPool)
+			return;
+		auto pool = mockObject<MockCommandPool>(commandPool);
+		for (auto& commandBuffer : pool->commandBuffers) {
+			delete commandBuffer;
+		}
+		delete pool;
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL resetCommandPool(VkDevice device, VkCommandPool commandPool,
+														   VkCommandPoolResetFlags flags) {
+		for (auto& commandBuffer : mockObject<MockCommandPool>(commandPool)->commandBuffers) {
+			commandBuffer->commands.clear();
+		}
+		return VK_SUCCESS;
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL allocateCommandBuffers(VkDevice device,
+																 const VkCommandBufferAllocateInfo* pAllocateInfo,
+																 VkCommandBuffer* pCommandBuffers) {
+		auto pool = mockObject<MockCommandPool>(pAllocateInfo->commandPool);
+		for (uint32_t i = 0; i < pAllocateInfo->commandBufferCount; ++i) {
+			pool->commandBuffers.push_back(new MockCommandBuffer());
+			pCommandBuffers[i] = reinterpret_cast<VkCommandBuffer>(pool->commandBuffers.back());
+		}
+		return VK_SUCCESS;
+	}
+
+	static VKAPI_ATTR void VKAPI_CALL freeCommandBuffers(VkDevice device, VkCommandPool commandPool,
+														 uint32_t commandBufferCount,
+														 const VkCommandBuffer* pCommandBuffers) {
+		auto pool = mockObject<MockCommandPool>(commandPool);
+		for (uint32_t i = 0; i < commandBufferCount; ++i) {
+			auto commandBuffer = mockObject<MockCommandBuffer>(pCommandBuffers[i]);
+			std::erase(pool->commandBuffers, commandBuffer);
+			delete commandBuffer;
+		}
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL beginCommandBuffer(VkCommandBuffer commandBuffer,
+															 const VkCommandBufferBeginInfo* pBeginInfo) {
+		mockObject<MockCommandBuffer>(commandBuffer)->commands.clear();
+		return VK_SUCCESS;
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL endCommandBuffer(VkCommandBuffer commandBuffer) { return VK_SUCCESS; }
+
+	static VKAPI_ATTR void VKAPI_CALL cmdCopyBuffer(VkCommandBuffer commandBuffer, VkBuffer srcBuffer,
+													VkBuffer dstBuffer, uint32_t regionCount,
+													const VkBufferCopy* pRegions) {
+		mockObject<MockCommandBuffer>(commandBuffer)
+			->commands.push_back({ .srcBuffer = srcBuffer,
+								   .dstBuffer = dstBuffer,
+								   .regions = std::vector<VkBufferCopy>(pRegions, pRegions + regionCount) });
+	}
+
+	static VKAPI_ATTR void VKAPI_CALL cmdCopyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer srcBuffer,
+														   VkImage dstImage, VkImageLayout dstImageLayout,
+														   uint32_t regionCount, const VkBufferImageCopy* pRegions) {
+		recordImageCopy(commandBuffer, mockObject<MockImage>(dstImage)->format, regionCount, pRegions);
+	}
+
+	static VKAPI_ATTR void VKAPI_CALL cmdCopyImageToBuffer(VkCommandBuffer commandBuffer, VkImage srcImage,
+														   VkImageLayout srcImageLayout, VkBuffer dstBuffer,
+														   uint32_t regionCount, const VkBufferImageCopy* pRegions) {
+		recordImageCopy(commandBuffer, mockObject<MockImage>(srcImage)->format, regionCount, pRegions);
+	}
+
+	static VKAPI_ATTR void VKAPI_CALL cmdCopyImage(VkCommandBuffer commandBuffer, VkImage srcImage,
+												   VkImageLayout srcImageLayout, VkImage dstImage,
+												   VkImageLayout dstImageLayout, uint32_t regionCount,
+												   const VkImageCopy* pRegions) {
+		VkDeviceSize byteCount = 0;
+		for (uint32_t i = 0; i < regionCount; ++i) {
+			byteCount += static_cast<VkDeviceSize>(pRegions[i].extent.width) * pRegions[i].extent.height *
+						 pRegions[i].extent.depth * pRegions[i].srcSubresource.layerCount;
+		}
+		byteCount *= texelSize(mockObject<MockImage>(srcImage)->format);
+		mockObject<MockCommandBuffer>(commandBuffer)->commands.push_back({ .imageByteCount = byteCount });
+	}
+
+	static VKAPI_ATTR void VKAPI_CALL cmdPipelineBarrier(
+		VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask,
+		VkDependencyFlags dependencyFlags, uint32_t memoryBarrierCount, const VkMemoryBarrier* pMemoryBarriers,
+		uint32_t bufferMemoryBarrierCount, const VkBufferMemoryBarrier* pBufferMemoryBarriers,
+		uint32_t imageMemoryBarrierCount, const VkImageMemoryBarrier* pImageMemoryBarriers) {
+		if (!(srcStageMask & (VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_ALL_COMMANDS_BIT)))
+			return;
+		bool ordersTransferWrites = false;
+		for (uint32_t i = 0; i < memoryBarrierCount; ++i) {
+			ordersTransferWrites |= (pMemoryBarriers[i].srcAccessMask & VK_ACCESS_TRANSFER_WRITE_BIT) != 0;
+		}
+		if (ordersTransferWrites) {
+			mockObject<MockCommandBuffer>(commandBuffer)->commands.push_back({ .ordersTransferWrites = true });
+		}
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL createFence(VkDevice device, const VkFenceCreateInfo* pCreateInfo,
+													  const VkAllocationCallbacks* pAllocator, VkFence* pFence) {
+		auto fence = new MockFence();
+		fence->signaled = pCreateInfo->flags & VK_FENCE_CREATE_SIGNALED_BIT;
+		*pFence = reinterpret_cast<VkFence>(fence);
+		return VK_SUCCESS;
+	}
+
+	static VKAPI_ATTR void VKAPI_CALL destroyFence(VkDevice device, VkFence fence,
+												   const VkAllocationCallbacks* pAllocator) {
+		delete mockObject<MockFence>(fence);
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL resetFences(VkDevice device, uint32_t fenceCount, const VkFence* pFences) {
+		for (uint32_t i = 0; i < fenceCount; ++i) {
+			mockObject<MockFence>(pFences[i])->signaled = false;
+		}
+		return VK_SUCCESS;
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL createSemaphore(VkDevice device, const VkSemaphoreCreateInfo* pCreateInfo,
+														  const VkAllocationCallbacks* pAllocator,
+														  VkSemaphore* pSemaphore) {
+		auto typeCreateInfo = findStructure<VkSemaphoreTypeCreateInfoKHR>(
+			const_cast<void*>(pCreateInfo->pNext), VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR);
+		auto semaphore = new MockSemaphore();
+		if (typeCreateInfo && typeCreateInfo->semaphoreType == VK_SEMAPHORE_TYPE_TIMELINE_KHR) {
+			assertFatal(activeDevice->m_config.capabilities.timelineSemaphore,
+						"MockDevice: Timeline semaphores aren't supported!\n");
+			semaphore->isTimeline = true;
+			semaphore->value = typeCreateInfo->initialValue;
+			semaphore->pendingValue = typeCreateInfo->initialValue;
+		}
+		*pSemaphore = reinterpret_cast<VkSemaphore>(semaphore);
+		return VK_SUCCESS;
+	}
+
+	static VKAPI_ATTR void VKAPI_CALL destroySemaphore(VkDevice device, VkSemaphore semaphore,
+													   const VkAllocationCallbacks* pAllocator) {
+		delete mockObject<MockSemaphore>(semaphore);
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL getSemaphoreCounterValue(VkDevice device, VkSemaphore semaphore,
+																   uint64_t* pValue) {
+		assertFatal(mockObject<MockSemaphore>(semaphore)->isTimeline,
+					"MockDevice: Queried the value of a binary semaphore!\n");
+		*pValue = mockObject<MockSemaphore>(semaphore)->value;
+		return VK_SUCCESS;
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL getFenceStatus(VkDevice device, VkFence fence) {
+		return mockObject<MockFence>(fence)->signaled ? VK_SUCCESS : VK_NOT_READY;
+	}
+
+	// Nothing executes asynchronously, so waiting completes every pending submission.
+	static VKAPI_ATTR VkResult VKAPI_CALL waitForFences(VkDevice device, uint32_t fenceCount, const VkFence* pFences,
+														VkBool32 waitAll, uint64_t timeout) {
+		activeDevice->completeSubmissions();
+		return VK_SUCCESS;
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL queueSubmit(VkQueue queue, uint32_t submitCount,
+													  const VkSubmitInfo* pSubmits, VkFence fence) {
+		MockDevice::PendingSubmission submission = { .fence = fence };
+		for (uint32_t i = 0; i < submitCount; ++i) {
+			submission.commandBuffers.insert(submission.commandBuffers.end(), pSubmits[i].pCommandBuffers,
+											 pSubmits[i].pCommandBuffers + pSubmits[i].commandBufferCount);
+
+			// submissions execute in order, so a wait is only valid if an earlier submission signals the value
+			auto timelineInfo = findStructure<VkTimelineSemaphoreSubmitInfoKHR>(
+				const_cast<void*>(pSubmits[i].pNext), VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR);
+			for (uint32_t j = 0; j < pSubmits[i].waitSemaphoreCount; ++j) {
+				auto semaphore = mockObject<MockSemaphore>(pSubmits[i].pWaitSemaphores[j]);
+				if (semaphore->isTimeline) {
+					assertFatal(timelineInfo && timelineInfo->waitSemaphoreValueCount == pSubmits[i].waitSemaphoreCount,
+								"MockDevice: Missing timeline semaphore wait values!\n");
+					assertFatal(timelineInfo->pWaitSemaphoreValues[j] <= semaphore->pendingValue,
+								"MockDevice: Waiting for a timeline value that is never signaled!\n");
+				}
+			}
+			for (uint32_t j = 0; j < pSubmits[i].signalSemaphoreCount; ++j) {
+				auto semaphore = mockObject<MockSemaphore>(pSubmits[i].pSignalSemaphores[j]);
+				if (semaphore->isTimeline) {
+					assertFatal(timelineInfo &&
+									timelineInfo->signalSemaphoreValueCount == pSubmits[i].signalSemaphoreCount,
+								"MockDevice: Missing timeline semaphore signal values!\n");
+					assertFatal(timelineInfo->pSignalSemaphoreValues[j] > semaphore->pendingValue,
+								"MockDevice: Timeline semaphore values have to increase!\n");
+					semaphore->pendingValue = timelineInfo->pSignalSemaphoreValues[j];
+					submission.semaphoreSignals.push_back({ semaphore, semaphore->pendingValue });
+				}
+			}
+		}
+		++activeDevice->m_submitCount;
+		{
+			auto lock = std::lock_guard<std::mutex>(activeDevice->m_submissionMutex);
+			activeDevice->m_pendingSubmissions.push_back(std::move(submission));
+		}
+		if (!activeDevice->m_config.deferSubmissions) {
+			activeDevice->completeSubmissions();
+		}
+		return VK_SUCCESS;
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL queueWaitIdle(VkQueue queue) {
+		activeDevice->completeSubmissions();
+		return VK_SUCCESS;
+	}
+
+	static VKAPI_ATTR VkResult VKAPI_CALL deviceWaitIdle(VkDevice device) {
+		activeDevice->completeSubmissions();
+		return VK_SUCCESS;
+	}
+
+	static void fillDedicatedRequirements(VkMemoryRequirements2* pMemoryRequirements) {
+		auto dedicatedRequirements = findStructure<VkMemoryDedicatedRequirements>(
+			pMemoryRequirements->pNext, VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS);
+		if (dedicatedRequirements) {
+			dedicatedRequirements->prefersDedicatedAllocation =
+				pMemoryRequirements->memoryRequirements.size >= activeDevice->m_config.dedicatedAllocationThreshold;
+			dedicatedRequirements->requiresDedicatedAllocation = VK_FALSE;
+		}
+	}
+
+	static void recordImageCopy(VkCommandBuffer commandBuffer, VkFormat format, uint32_t regionCount,
+								const VkBufferImageCopy* pRegions) {
+		VkDeviceSize byteCount = 0;
+		for (uint32_t i = 0; i < regionCount; ++i) {
+			byteCount += static_cast<VkDeviceSize>(pRegions[i].imageExtent.width) * pRegions[i].imageExtent.height *
+						 pRegions[i].imageExtent.depth * pRegions[i].imageSubresource.layerCount;
+		}
+		byteCount *= texelSize(format);
+		mockObject<MockCommandBuffer>(commandBuffer)->commands.push_back({ .imageByteCount = byteCount });
+	}
+};
+
+static constexpr VkDeviceSize mockGiB = 1024ULL * 1024 * 1024;
+
+static constexpr VkMemoryPropertyFlags hostMemoryProperties =
+	VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+MockDeviceConfig discreteMockDeviceConfig() {
+	return { .heaps = { { .size = 8 * mockGiB, .flags = VK_MEMORY_HEAP_DEVICE_LOCAL_BIT },
+						{ .size = 16 * mockGiB, .flags = 0 },
+						{ .size = mockGiB / 4, .flags = VK_MEMORY_HEAP_DEVICE_LOCAL_BIT } },
+			 .memoryTypes = { { .properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, .heapIndex = 0 },
+							  { .properties = hostMemoryProperties, .heapIndex = 1 },
+							  { .properties = hostMemoryProperties | VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+								.heapIndex = 1 },
+							  { .properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | hostMemoryProperties,
+								.heapIndex = 2 } },
+			 .capabilities = { .memoryBudget = true,
+							   .memoryPriority = true,
+							   .dedicatedAllocation = true,
+							   .timelineSemaphore = true },
+			 .dedicatedAllocationThreshold = 64ULL * 1024 * 1024 };
+}
+
+MockDeviceConfig integratedMockDeviceConfig() {
+	return { .heaps = { { .size = 4 * mockGiB, .flags = VK_MEMORY_HEAP_DEVICE_LOCAL_BIT } },
+			 .memoryTypes = { { .properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | hostMemoryProperties,
+								.heapIndex = 0 } },
+			 .bufferImageGranularity = 1 };
+}
+
+MockDevice::MockDevice(const MockDeviceConfig& config) : m_config(config) {
+	assertFatal(!activeDevice, "MockDevice: Only one mock device can exist at a time!\n");
+	assertFatal(config.heaps.size() <= VK_MAX_MEMORY_HEAPS && config.memoryTypes.size() <= VK_MAX_MEMORY_TYPES,
+				"MockDevice: Too many memory heaps or types!\n");
+	activeDevice = this;
+
+	vkGetPhysicalDeviceProperties = MockDeviceFunctions::getPhysicalDeviceProperties;
+	vkGetPhysicalDeviceMemoryProperties = MockDeviceFunctions::getPhysicalDeviceMemoryProperties;
+	vkGetPhysicalDeviceMemoryProperties2KHR = MockDeviceFunctions::getPhysicalDeviceMemoryProperties2;
+	vkAllocateMemory = MockDeviceFunctions::allocateMemory;
+	vkFreeMemory = MockDeviceFunctions::freeMemory;
+	vkMapMemory = MockDeviceFunctions::mapMemory;
+	vkUnmapMemory = MockDeviceFunctions::unmapMemory;
+	vkFlushMappedMemoryRanges = MockDeviceFunctions::flushMappedMemoryRanges;
+	vkInvalidateMappedMemoryRanges = MockDeviceFunctions::invalidateMappedMemoryRanges;
+	vkCreateBuffer = MockDeviceFunctions::createBuffer;
+	vkDestroyBuffer = MockDeviceFunctions::destroyBuffer;
+	vkGetBufferMemoryRequirements = MockDeviceFunctions::getBufferMemoryRequirements;
+	vkGetBufferMemoryRequirements2KHR = MockDeviceFunctions::getBufferMemoryRequirements2;
+	vkBindBufferMemory = MockDeviceFunctions::bindBufferMemory;
+	vkCreateImage = MockDeviceFunctions::createImage;
+	vkDestroyImage = MockDeviceFunctions::destroyImage;
+	vkGetImageMemoryRequirements = MockDeviceFunctions::getImageMemoryRequirements;
+	vkGetImageMemoryRequirements2KHR = MockDeviceFunctions::getImageMemoryRequirements2;
+	vkBindImageMemory = MockDeviceFunctions::bindImageMemory;
+	vkCreateImageView = MockDeviceFunctions::createImageView;
+	vkDestroyImageView = MockDeviceFunctions::destroyImageView;
+	vkCreateCommandPool = MockDeviceFunctions::createCommandPool;
+	vkDestroyCommandPool = MockDeviceFunctions::destroyCommandPool;
+	vkResetCommandPool = MockDeviceFunctions::resetCommandPool;
+	vkAllocateCommandBuffers = MockDeviceFunctions::allocateCommandBuffers;
+	vkFreeCommandBuffers = MockDeviceFunctions::freeCommandBuffers;
+	vkBeginCommandBuffer = MockDeviceFunctions::beginCommandBuffer;
+	vkEndCommandBuffer = MockDeviceFunctions::endCommandBuffer;
+	vkCmdCopyBuffer = MockDeviceFunctions::cmdCopyBuffer;
+	vkCmdCopyBufferToImage = MockDeviceFunctions::cmdCopyBufferToImage;
+	vkCmdCopyImageToBuffer = MockDeviceFunctions::cmdCopyImageToBuffer;
+	vkCmdCopyImage = MockDeviceFunctions::cmdCopyImage;
+	vkCmdPipelineBarrier = MockDeviceFunctions::cmdPipelineBarrier;
+	vkCreateFence = MockDeviceFunctions::createFence;
+	vkDestroyFence = MockDeviceFunctions::destroyFence;
+	vkResetFences = MockDeviceFunctions::resetFences;
+	vkGetFenceStatus = MockDeviceFunctions::getFenceStatus;
+	vkCreateSemaphore = MockDeviceFunctions::createSemaphore;
+	vkDestroySemaphore = MockDeviceFunctions::destroySemaphore;
+	vkGetSemaphoreCounterValueKHR = MockDeviceFunctions::getSemaphoreCounterValue;
+	vkWaitForFences = MockDeviceFunctions::waitForFences;
+	vkQueueSubmit = MockDeviceFunctions::queueSubmit;
+	vkQueueWaitIdle = MockDeviceFunctions::queueWaitIdle;
+	vkDeviceWaitIdle = MockDeviceFunctions::deviceWaitIdle;
+}
+
+MockDevice::~MockDevice() {
+	completeSubmissions();
+	if (m_memoryAllocationCount || m_bufferCount || m_imageCount || m_imageViewCount) {
+		logWarning("MockDevice: Destroyed with {} memory allocations, {} buffers, {} images and {} image "
+							 "views alive.",
+							 m_memoryAllocationCount.load(), m_bufferCount.load(), m_imageCount.load(),
+							 m_imageViewCount.load());
+	}
+	activeDevice = nullptr;
+}
+
+ExternalDeviceInfo MockDevice::deviceInfo() {
+	// dispatchable handles only need to be unique, the queues point to their family index
+	return { .instance = reinterpret_cast<VkInstance>(this),
+			 .physicalDevice = reinterpret_cast<VkPhysicalDevice>(this),
+			 .device = reinterpret_cast<VkDevice>(this),
+			 .graphicsQueueFamilyIndex = m_graphicsQueueFamilyIndex,
+			 .graphicsQueue = reinterpret_cast<VkQueue>(&m_graphicsQueueFamilyIndex),
+			 .asyncTransferQueueFamilyIndex = m_transferQueueFamilyIndex,
+			 .asyncTransferQueue = reinterpret_cast<VkQueue>(&m_transferQueueFamilyIndex),
+			 .capabilities = m_config.capabilities };
+}
+
+void MockDevice::completeSubmissions() {
+	auto lock = std::lock_guard<std::mutex>(m_submissionMutex);
+	for (auto& submission : m_pendingSubmissions) {
+		for (auto& commandBuffer : submission.commandBuffers) {
+			executeCommandBuffer(commandBuffer);
+		}
+		for (auto& [semaphore, value] : submission.semaphoreSignals) {
+			semaphore->value = value;
+		}
+		if (submission.fence) {
+			mockObject<MockFence>(submission.fence)->signaled = true;
+		}
+	}
+	m_pendingSubmissions.clear();
+}
+
+void* MockDevice::bufferData(VkBuffer buffer) {
+	auto mockBuffer = mockObject<MockBuffer>(buffer);
+	assertFatal(mockBuffer->memory, "MockDevice: Buffer isn't bound to memory!\n");
+	return mockBuffer->memory->data + mockBuffer->memoryOffset;
+}
+
+MockDeviceStatistics MockDevice::statistics() const {
+	MockDeviceStatistics statistics = { .memoryAllocationCount = m_memoryAllocationCount.load(),
+										.bufferCount = m_bufferCount.load(),
+										.imageCount = m_imageCount.load(),
+										.imageViewCount = m_imageViewCount.load(),
+										.submitCount = m_submitCount.load(),
+										.copiedBytes = m_copiedBytes.load(),
+										.flushedRangeCount = m_flushedRangeCount.load(),
+										.flushCallCount = m_flushCallCount.load(),
+										.bufferCopyCommandCount = m_bufferCopyCommandCount.load() };
+	for (size_t i = 0; i < m_config.heaps.size(); ++i) {
+		statistics.heapUsages.push_back(m_heapUsages[i].load());
+	}
+	return statistics;
+}
+
+void MockDevice::executeCommandBuffer(VkCommandBuffer commandBuffer) {
+	// memory ranges written since the last barrier, a real device may execute these writes in any order
+	std::vector<std::pair<unsigned char*, VkDeviceSize>> unorderedWrites;
+	for (auto& command : mockObject<MockCommandBuffer>(commandBuffer)->commands) {
+		if (command.ordersTransferWrites) {
+			unorderedWrites.clear();
+			continue;
+		}
+		if (!command.srcBuffer) {
+			m_copiedBytes += command.imageByteCount;
+			continue;
+		}
+		auto srcBuffer = mockObject<MockBuffer>(command.srcBuffer);
+		auto dstBuffer = mockObject<MockBuffer>(command.dstBuffer);
+		auto dstRegions = command.regions;
+		std::sort(dstRegions.begin(), dstRegions.end(),
+				  [](const VkBufferCopy& one, const VkBufferCopy& other) { return one.dstOffset < other.dstOffset; });
+		for (size_t i = 1; i < dstRegions.size(); ++i) {
+			assertFatal(dstRegions[i - 1].dstOffset + dstRegions[i - 1].size <= dstRegions[i].dstOffset,
+						"MockDevice: Destination regions of a buffer copy overlap!\n");
+		}
+		++m_bufferCopyCommandCount;
+		for (auto& region : command.regions) {
+			assertFatal(region.srcOffset + region.size <= srcBuffer->size &&
+									  region.dstOffset + region.size <= dstBuffer->size,
+								  "MockDevice: Buffer copy is out of bounds!\n");
+			unsigned char* dst = dstBuffer->memory->data + dstBuffer->memoryOffset + region.dstOffset;
+			for (auto& [write, size] : unorderedWrites) {
+				assertFatal(dst + region.size <= write || write + size <= dst,
+							"MockDevice: Overlapping buffer copies aren't separated by a barrier!\n");
+			}
+			unorderedWrites.push_back({ dst, region.size });
+			std::memmove(dst, srcBuffer->memory->data + srcBuffer->memoryOffset + region.srcOffset, region.size);
+			m_copiedBytes += region.size;
+		}
+	}
+}
@@ -0,0 +1,455 @@
+/* VanadiumEngine, a Vulkan rendering toolkit
+ * Copyright (C) 2022 Friedrich Vock
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <graphics/util/AllocationTrace.hpp>
+#include <graphics/util/RangeAllocator.hpp>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace vanadium::graphics;
+
+enum class PlacementPolicy { FirstFit, BestFit };
+
+struct Options {
+	std::vector<VkDeviceSize> blockSizes;
+	std::vector<VkDeviceSize> bufferFreeThresholds;
+	std::vector<VkDeviceSize> imageFreeThresholds;
+	std::vector<PlacementPolicy> policies;
+	std::vector<std::string> traceFiles;
+};
+
+struct ReplayConfig {
+	VkDeviceSize blockSize;
+	// Empty blocks are kept alive as long as their total size stays below the threshold. Blocks bigger than blockSize
+	// are always freed once empty.
+	VkDeviceSize bufferFreeThreshold;
+	VkDeviceSize imageFreeThreshold;
+	PlacementPolicy policy;
+};
+
+struct ReplayResult {
+	VkDeviceSize peakBlockMemory = 0;
+	size_t peakBlockCount = 0;
+	size_t blockAllocationCount = 0;
+	size_t blockFreeCount = 0;
+	size_t failedAllocationCount = 0;
+	// fraction of block memory not occupied by live resources, sampled at each free list flush
+	double averageWaste = 0.0;
+	double peakWaste = 0.0;
+};
+
+struct SimulatedBlock {
+	uint64_t id;
+	RangeAllocator allocator;
+};
+
+struct ResourcePlacement {
+	uint32_t typeIndex;
+	uint64_t blockID;
+	MemoryRange allocationRange;
+	VkDeviceSize size;
+};
+
+struct SimulatedMemoryType {
+	std::vector<SimulatedBlock> blocks;
+	std::vector<SimulatedBlock> imageBlocks;
+};
+
+struct PendingDestroy {
+	uint64_t handle;
+	bool isImage;
+};
+
+bool isCreateEvent(AllocationTraceEventType type) {
+	return type == AllocationTraceEventType::CreateBuffer || type == AllocationTraceEventType::CreatePerFrameBuffer ||
+		   type == AllocationTraceEventType::CreateImage;
+}
+
+bool isDestroyEvent(AllocationTraceEventType type) {
+	return type == AllocationTraceEventType::DestroyBuffer ||
+		   type == AllocationTraceEventType::DestroyBufferImmediately ||
+		   type == AllocationTraceEventType::DestroyImage || type == AllocationTraceEventType::DestroyImageImmediately;
+}
+
+bool isDeferredDestroyEvent(AllocationTraceEventType type) {
+	return type == AllocationTraceEventType::DestroyBuffer || type == AllocationTraceEventType::DestroyImage;
+}
+
+// Replays resource creation and destruction against simulated memory blocks. Resources in custom blocks are
+// skipped, their placement is controlled by the application. Dedicated allocations don't touch blocks either.
+class ReplaySimulation {
+  public:
+	ReplaySimulation(const AllocationTrace& trace, const ReplayConfig& config)
+		: m_trace(trace), m_config(config), m_memoryTypes(trace.memoryTypes.size()) {}
+
+	ReplayResult run() {
+		for (auto& event : m_trace.events) {
+			if (event.type == AllocationTraceEventType::FlushFreeList) {
+				flush(event.frameInFlightIndex);
+				continue;
+			}
+			if (event.flags & (AllocationTraceFlagCustomBlock | AllocationTraceFlagDedicated) ||
+				event.memoryTypeIndex >= m_memoryTypes.size())
+				continue;
+
+			if (isCreateEvent(event.type)) {
+				create(event);
+			} else if (isDeferredDestroyEvent(event.type)) {
+				if (m_pendingDestroys.size() <= event.frameInFlightIndex)
+					m_pendingDestroys.resize(event.frameInFlightIndex + 1);
+				m_pendingDestroys[event.frameInFlightIndex].push_back(
+					{ .handle = event.handle, .isImage = (event.flags & AllocationTraceFlagImage) != 0 });
+			} else if (isDestroyEvent(event.type)) {
+				destroy(event.handle, event.flags & AllocationTraceFlagImage);
+			}
+		}
+
+		if (m_sampleCount)
+			m_result.averageWaste /= static_cast<double>(m_sampleCount);
+		return m_result;
+	}
+
+  private:
+	std::vector<SimulatedBlock>& blockList(uint32_t typeIndex, bool isImage) {
+		return isImage ? m_memoryTypes[typeIndex].imageBlocks : m_memoryTypes[typeIndex].blocks;
+	}
+
+	std::optional<ResourcePlacement> allocateInBlocks(uint32_t typeIndex, bool isImage, VkDeviceSize alignment,
+													  VkDeviceSize size) {
+		auto& blocks = blockList(typeIndex, isImage);
+
+		std::vector<SimulatedBlock*> candidates;
+		candidates.reserve(blocks.size());
+		for (auto& block : blocks) {
+			if (block.allocator.maxAllocatableSize() >= size)
+				candidates.push_back(&block);
+		}
+		if (m_config.policy == PlacementPolicy::BestFit) {
+			std::stable_sort(candidates.begin(), candidates.end(), [](const auto* one, const auto* other) {
+				return one->allocator.maxAllocatableSize() < other->allocator.maxAllocatableSize();
+			});
+		}
+
+		for (auto* block : candidates) {
+			auto result = block->allocator.allocate(alignment, size);
+			if (result.has_value()) {
+				return ResourcePlacement{ .typeIndex = typeIndex,
+										  .blockID = block->id,
+										  .allocationRange = result.value().allocationRange,
+										  .size = size };
+			}
+		}
+		return std::nullopt;
+	}
+
+	void create(const AllocationTraceEvent& event) {
+		bool isImage = event.flags & AllocationTraceFlagImage;
+		VkDeviceSize alignment = std::max(event.alignment, uint64_t{ 1 });
+
+		auto placement = allocateInBlocks(event.memoryTypeIndex, isImage, alignment, event.size);
+		if (!placement.has_value()) {
+			VkDeviceSize blockSize = std::max(m_config.blockSize, event.size);
+			blockList(event.memoryTypeIndex, isImage)
+				.push_back({ .id = m_nextBlockID++, .allocator = RangeAllocator(blockSize) });
+			m_blockMemory += blockSize;
+			++m_blockCount;
+			++m_result.blockAllocationCount;
+			m_result.peakBlockMemory = std::max(m_result.peakBlockMemory, m_blockMemory);
+			m_result.peakBlockCount = std::max(m_result.peakBlockCount, m_blockCount);
+
+			placement = allocateInBlocks(event.memoryTypeIndex, isImage, alignment, event.size);
+			if (!placement.has_value()) {
+				++m_result.failedAllocationCount;
+				return;
+			}
+		}
+
+		m_liveResourceSize += event.size;
+		(isImage ? m_images : m_buffers)[event.handle] = placement.value();
+	}
+
+	void destroy(uint64_t handle, bool isImage) {
+		auto& resources = isImage ? m_images : m_buffers;
+		auto iterator = resources.find(handle);
+		// resources that failed to allocate during replay
+		if (iterator == resources.end())
+			return;
+
+		auto& blocks = blockList(iterator->second.typeIndex, isImage);
+		auto block = std::find_if(blocks.begin(), blocks.end(),
+								  [&iterator](const auto& block) { return block.id == iterator->second.blockID; });
+		block->allocator.free(iterator->second.allocationRange.offset, iterator->second.allocationRange.size);
+		m_liveResourceSize -= iterator->second.size;
+		resources.erase(iterator);
+	}
+
+	void freeEmptyBlocks(std::vector<SimulatedBlock>& blocks, VkDeviceSize threshold) {
+		VkDeviceSize retainedSize = 0;
+		auto newEnd = std::remove_if(blocks.begin(), blocks.end(), [&](const auto& block) {
+			if (!block.allocator.empty())
+				return false;
+			if (block.allocator.totalSize() <= m_config.blockSize &&
+				retainedSize + block.allocator.totalSize() <= threshold) {
+				retainedSize += block.allocator.totalSize();
+				return false;
+			}
+			m_blockMemory -= block.allocator.totalSize();
+			--m_blockCount;
+			++m_result.blockFreeCount;
+			return true;
+		});
+		blocks.erase(newEnd, blocks.end());
+	}
+
+	void flush(uint8_t frameInFlightIndex) {
+		if (frameInFlightIndex < m_pendingDestroys.size()) {
+			for (auto& pendingDestroy : m_pendingDestroys[frameInFlightIndex]) {
+				destroy(pendingDestroy.handle, pendingDestroy.isImage);
+			}
+			m_pendingDestroys[frameInFlightIndex].clear();
+		}
+
+		for (auto& type : m_memoryTypes) {
+			freeEmptyBlocks(type.blocks, m_config.bufferFreeThreshold);
+			freeEmptyBlocks(type.imageBlocks, m_config.imageFreeThreshold);
+		}
+
+		if (m_blockMemory) {
+			double waste = 1.0 - static_cast<double>(m_liveResourceSize) / static_cast<double>(m_blockMemory);
+			m_result.averageWaste += waste;
+			m_result.peakWaste = std::max(m_result.peakWaste, waste);
+			++m_sampleCount;
+		}
+	}
+
+	const AllocationTrace& m_trace;
+	ReplayConfig m_config;
+	ReplayResult m_result;
+
+	std::vector<SimulatedMemoryType> m_memoryTypes;
+	uint64_t m_nextBlockID = 0;
+	VkDeviceSize m_blockMemory = 0;
+	size_t m_blockCount = 0;
+
+	VkDeviceSize m_liveResourceSize = 0;
+	size_t m_sampleCount = 0;
+
+	robin_hood::unordered_map<uint64_t, ResourcePlacement> m_buffers;
+	robin_hood::unordered_map<uint64_t, ResourcePlacement> m_images;
+	std::vector<std::vector<PendingDestroy>> m_pendingDestroys;
+};
+
+// Block statistics of the recorded run itself, for comparison with the simulated configurations.
+ReplayResult recordedResult(const AllocationTrace& trace) {
+	ReplayResult result;
+	VkDeviceSize blockMemory = 0;
+	size_t blockCount = 0;
+	for (auto& event : trace.events) {
+		if (event.flags & AllocationTraceFlagCustomBlock)
+			continue;
+		if (event.type == AllocationTraceEventType::AllocateBlock) {
+			blockMemory += event.size;
+			++blockCount;
+			++result.blockAllocationCount;
+			result.peakBlockMemory = std::max(result.peakBlockMemory, blockMemory);
+			result.peakBlockCount = std::max(result.peakBlockCount, blockCount);
+		} else if (event.type == AllocationTraceEventType::FreeBlock) {
+			blockMemory -= event.size;
+			--blockCount;
+			++result.blockFreeCount;
+		}
+	}
+	return result;
+}
+
+VkDeviceSize parseSize(const std::string_view& string) {
+	size_t suffixIndex;
+	VkDeviceSize size = std::stoull(std::string(string), &suffixIndex);
+	if (suffixIndex < string.size()) {
+		switch (string[suffixIndex]) {
+			case 'G':
+			case 'g':
+				size *= 1024;
+				[[fallthrough]];
+			case 'M':
+			case 'm':
+				size *= 1024;
+				[[fallthrough]];
+			case 'K':
+			case 'k':
+				size *= 1024;
+				break;
+			default:
+				throw std::invalid_argument("invalid size suffix");
+		}
+	}
+	return size;
+}
+
+template <typename T, typename Parser>
+bool parseList(const std::string_view& argName, const std::string_view& list, std::vector<T>& values, Parser parser) {
+	size_t start = 0;
+	while (start <= list.size()) {
+		size_t end = std::min(list.find(',', start), list.size());
+		try {
+			values.push_back(parser(list.substr(start, end - start)));
+		} catch (const std::exception&) {
+			std::cout << "Warning: Invalid value " << list.substr(start, end - start) << " for " << argName << ".\n";
+			return false;
+		}
+		start = end + 1;
+	}
+	return true;
+}
+
+PlacementPolicy parsePolicy(const std::string_view& string) {
+	if (string == "first-fit")
+		return PlacementPolicy::FirstFit;
+	else if (string == "best-fit")
+		return PlacementPolicy::BestFit;
+	throw std::invalid_argument("invalid policy");
+}
+
+bool checkOption(int argc, char** argv, size_t index, const std::string_view& argName) {
+	if (static_cast<size_t>(argc) <= index + 1) {
+		std::cout << "Warning: Not enough arguments given to " << argName << ".\n";
+		return false;
+	} else if (*argv[index + 1] == '-') {
+		std::cout << "Warning: " << argv[index + 1] << "Invalid argument for " << argName << ".\n";
+		return false;
+	}
+	return true;
+}
+
+size_t parseOption(int argc, char** argv, size_t index, Options& options) {
+	std::string_view argName = argv[index];
+	if (argName == "--block-size" || argName == "--buffer-free-threshold" || argName == "--image-free-threshold") {
+		if (checkOption(argc, argv, index, argName)) {
+			auto& values = argName == "--block-size"			  ? options.blockSizes
+						   : argName == "--buffer-free-threshold" ? options.bufferFreeThresholds
+																  : options.imageFreeThresholds;
+			parseList(argName, argv[index + 1], values, parseSize);
+			return index + 1;
+		}
+	} else if (argName == "--policy") {
+		if (checkOption(argc, argv, index, argName)) {
+			parseList(argName, argv[index + 1], options.policies, parsePolicy);
+			return index + 1;
+		}
+	} else {
+		std::cout << "Warning: Skipping unknown command line option " << argv[index] << ".\n";
+	}
+	return index;
+}
+
+Options parseArguments(int argc, char** argv) {
+	Options options;
+	for (size_t i = 1; i < static_cast<size_t>(argc); ++i) {
+		if (*argv[i] == '-') {
+			i = parseOption(argc, argv, i, options);
+			continue;
+		}
+		options.traceFiles.push_back(argv[i]);
+	}
+	return options;
+}
+
+void printResult(const std::string_view& name, const ReplayResult& result) {
+	std::cout << "  " << std::left << std::setw(40) << name << std::right << std::fixed << std::setprecision(1)
+			  << std::setw(10) << static_cast<double>(result.peakBlockMemory) / (1024.0 * 1024.0) << " MiB peak"
+			  << std::setw(7) << result.peakBlockCount << " blocks" << std::setw(7) << result.blockAllocationCount
+			  << " allocs" << std::setw(7) << result.blockFreeCount << " frees";
+	if (result.averageWaste > 0.0 || result.peakWaste > 0.0) {
+		std::cout << std::setw(7) << result.averageWaste * 100.0 << "% avg waste" << std::setw(7)
+				  << result.peakWaste * 100.0 << "% peak waste";
+	}
+	if (result.failedAllocationCount)
+		std::cout << "  " << result.failedAllocationCount << " failed";
+	std::cout << "\n";
+}
+
+std::string sizeString(VkDeviceSize size) {
+	if (size >= 1024 * 1024 && size % (1024 * 1024) == 0)
+		return std::to_string(size / (1024 * 1024)) + "M";
+	else if (size >= 1024 && size % 1024 == 0)
+		return std::to_string(size / 1024) + "K";
+	return std::to_string(size);
+}
+
+int main(int argc, char** argv) {
+	if (argc == 1) {
+		std::cerr << "Usage: AllocationReplay [--block-size 32M,64M] [--buffer-free-threshold 32M,64M]\n"
+					 "                        [--image-free-threshold 128M] [--policy first-fit,best-fit] traces...\n"
+					 "Free thresholds default to one block, matching the engine's current behaviour."
+				  << std::endl;
+		return 1;
+	}
+
+	Options options = parseArguments(argc, argv);
+	if (options.traceFiles.empty()) {
+		std::cerr << "Error: Enter at least one allocation trace file." << std::endl;
+		return 1;
+	}
+	if (options.policies.empty())
+		options.policies.push_back(PlacementPolicy::FirstFit);
+
+	for (auto& fileName : options.traceFiles) {
+		auto trace = readAllocationTrace(fileName);
+		if (!trace.has_value()) {
+			std::cerr << "Error: " << fileName << ": Couldn't read allocation trace." << std::endl;
+			return 2;
+		}
+
+		uint32_t frameCount = trace->events.empty() ? 0 : trace->events.back().frameIndex;
+		std::cout << fileName << " (" << trace->events.size() << " events, " << frameCount << " frames, "
+				  << trace->memoryTypes.size() << " memory types, recorded with "
+				  << sizeString(trace->header.blockSize) << " blocks)\n";
+		printResult("recorded", recordedResult(trace.value()));
+
+		auto blockSizes = options.blockSizes;
+		if (blockSizes.empty())
+			blockSizes.push_back(trace->header.blockSize);
+
+		for (auto blockSize : blockSizes) {
+			auto bufferFreeThresholds = options.bufferFreeThresholds;
+			if (bufferFreeThresholds.empty())
+				bufferFreeThresholds.push_back(blockSize);
+			auto imageFreeThresholds = options.imageFreeThresholds;
+			if (imageFreeThresholds.empty())
+				imageFreeThresholds.push_back(blockSize);
+
+			for (auto bufferFreeThreshold : bufferFreeThresholds) {
+				for (auto imageFreeThreshold : imageFreeThresholds) {
+					for (auto policy : options.policies) {
+						ReplayConfig config = { .blockSize = blockSize,
+												.bufferFreeThreshold = bufferFreeThreshold,
+												.imageFreeThreshold = imageFreeThreshold,
+												.policy = policy };
+						std::string name = "block " + sizeString(blockSize) + ", keep " +
+										   sizeString(bufferFreeThreshold) + "/" + sizeString(imageFreeThreshold) +
+										   (policy == PlacementPolicy::FirstFit ? ", first-fit" : ", best-fit");
+						printResult(name, ReplaySimulation(trace.value(), config).run());
+					}
+				}
+			}
+		}
+	}
+	return 0;
+}